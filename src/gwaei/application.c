@@ -47,6 +47,7 @@ static void gw_application_remove_signals (GwApplication*);
 static void gw_application_activate (GApplication*);
 static gboolean gw_application_local_command_line (GApplication*, gchar***, gint*);
 static int gw_application_command_line (GApplication*, GApplicationCommandLine*);
+static gint gw_application_export_pdf (GwApplication*);
 static void gw_application_startup (GApplication*);
 static void gw_application_load_app_menu (GwApplication*);
 static void gw_application_load_menubar (GwApplication*);
@@ -135,6 +136,7 @@ gw_application_finalize (GObject *object)
 
     if (priv->context != NULL) g_option_context_free (priv->context); priv->context = NULL;
     if (priv->arg_query != NULL) g_free(priv->arg_query); priv->arg_query = NULL;
+    if (priv->arg_export_pdf != NULL) g_free(priv->arg_export_pdf); priv->arg_export_pdf = NULL;
     if (priv->preferences != NULL) lw_preferences_free (priv->preferences); priv->preferences = NULL;
 #if WITH_MECAB
     if (lw_morphologyengine_has_default ()) 
@@ -217,6 +219,8 @@ gw_application_parse_args (GwApplication *application, int *argc, char** argv[])
     priv->arg_dictionary = NULL;
     if (priv->arg_query != NULL) g_free (priv->arg_query);
     priv->arg_query = NULL;
+    if (priv->arg_export_pdf != NULL) g_free (priv->arg_export_pdf);
+    priv->arg_export_pdf = NULL;
     priv->arg_version_switch = FALSE;
     priv->arg_new_vocabulary_window_switch = FALSE;
 
@@ -225,6 +229,7 @@ gw_application_parse_args (GwApplication *application, int *argc, char** argv[])
       { "dictionary", 'd', 0, G_OPTION_ARG_STRING, &(priv->arg_dictionary), gettext("Choose the dictionary to use"), "English" },
       { "word", 'o', 0, G_OPTION_ARG_NONE, &(priv->arg_new_vocabulary_window_switch), gettext("Open the vocabulary manager window"), NULL },
       { "version", 'v', 0, G_OPTION_ARG_NONE, &(priv->arg_version_switch), gettext("Check the gWaei version information"), NULL },
+      { "export-pdf", 'p', 0, G_OPTION_ARG_FILENAME, &(priv->arg_export_pdf), gettext("Write the results of the query to a PDF file without opening a window"), "FILE" },
       { NULL }
     };
 
@@ -689,6 +694,78 @@ gw_application_command_line (GApplication *application, GApplicationCommandLine
 }
 
 
+//!
+//! @brief Searches for the query given on the command line and writes the
+//!        results to the PDF file of --export-pdf.  No window is opened so
+//!        this works without a display.
+//! @returns The exit status for the program
+//!
+static gint
+gw_application_export_pdf (GwApplication *application)
+{
+    //Declarations
+    GwApplicationPrivate *priv;
+    LwDictionaryList *dictionarylist;
+    LwPreferences *preferences;
+    LwDictionary *dictionary;
+    LwSearch *search;
+    LwSearchFlags flags;
+    GwPrintJob *job;
+    GtkPaperSize *paper;
+    GError *error;
+    gint resolution;
+
+    //Initializations
+    priv = application->priv;
+    dictionarylist = LW_DICTIONARYLIST (gw_application_get_installed_dictionarylist (application));
+    preferences = gw_application_get_preferences (application);
+    dictionary = lw_dictionarylist_get_dictionary_fuzzy (dictionarylist, priv->arg_dictionary);
+    paper = gtk_paper_size_new (NULL);
+    search = NULL;
+    job = NULL;
+    error = NULL;
+    resolution = EXIT_FAILURE;
+
+    if (priv->arg_query == NULL)
+    {
+      g_printerr ("%s\n", gettext("A query is needed to export its results"));
+      goto errored;
+    }
+    if (dictionary == NULL)
+    {
+      g_printerr (gettext("\"%s\" Dictionary was not found!\n"), priv->arg_dictionary);
+      goto errored;
+    }
+
+    flags = lw_search_get_flags_from_preferences (preferences);
+    search = lw_search_new (dictionary, priv->arg_query, flags, &error);
+    if (search == NULL) goto errored;
+    lw_search_start (search, FALSE);
+
+    job = gw_printjob_new (search, priv->arg_query);
+    if (!gw_printjob_export_pdf (job, priv->arg_export_pdf, 
+                                 gtk_paper_size_get_width (paper, GTK_UNIT_POINTS), 
+                                 gtk_paper_size_get_height (paper, GTK_UNIT_POINTS), 
+                                 &error)) goto errored;
+
+    resolution = EXIT_SUCCESS;
+
+errored:
+    if (error != NULL)
+    {
+      g_printerr ("%s\n", error->message);
+      g_error_free (error); error = NULL;
+    }
+
+    //Cleanup
+    if (job != NULL) gw_printjob_free (job); job = NULL;
+    if (search != NULL) lw_search_free (search); search = NULL;
+    gtk_paper_size_free (paper); paper = NULL;
+
+    return resolution;
+}
+
+
 static gboolean 
 gw_application_local_command_line (GApplication *application, 
                                    gchar ***argv, gint *exit_status)
@@ -716,6 +793,14 @@ gw_application_local_command_line (GApplication *application,
         gw_application_parse_args (GW_APPLICATION (application), &argc, argv);
         break;
       }
+      //Exports are done here before GTK is started so they don't need a display
+      else if (strcmp((*argv)[i], "-p") == 0 || g_str_has_prefix ((*argv)[i], "--export-pdf"))
+      {
+        handled = TRUE;
+        gw_application_parse_args (GW_APPLICATION (application), &argc, argv);
+        *exit_status = gw_application_export_pdf (GW_APPLICATION (application));
+        break;
+      }
     }
 
     return handled;
@@ -74,7 +74,7 @@ gw_flashcardstore_init (GwFlashCardStore *store)
        G_TYPE_STRING,  //GW_FLASHCARDSTORE_COLUMN_ANSWER
        G_TYPE_BOOLEAN, //GW_FLASHCARDSTORE_COLUMN_IS_COMPLETED
        G_TYPE_POINTER, //GW_FLASHCARDSTORE_COLUMN_TREE_PATH
-       G_TYPE_INT,     //GW_FLASHCARDSTORE_COLUMN_WEIGHT
+       G_TYPE_UINT,    //GW_FLASHCARDSTORE_COLUMN_DUE
        G_TYPE_INT,     //GW_FLASHCARDSTORE_ORDER
        G_TYPE_INT,     //GW_FLASHCARDSTORE_CORRECT_GUESSES
        G_TYPE_INT      //GW_FLASHCARDSTORE_INCORRECT_GUESSES
@@ -216,7 +216,7 @@ void gw_flashcardstore_set_vocabularywordstore (GwFlashCardStore      *store,
     GtkListStore *target_store;
     GtkTreeIter source_iter;
     GtkTreeIter target_iter;
-    gint weight;
+    guint32 due;
     gint order;
     gchar *question, *answer;
     GtkTreePath *path;
@@ -241,14 +241,14 @@ void gw_flashcardstore_set_vocabularywordstore (GwFlashCardStore      *store,
 
       if (path != NULL && question != NULL && strlen (question) && answer != NULL && strlen (answer))
       {
-        weight = gw_vocabularywordstore_calculate_weight (wordstore, &source_iter);
+        due = gw_vocabularywordstore_get_due_hours_by_iter (wordstore, &source_iter);
         gtk_list_store_append (target_store, &target_iter);
         gtk_list_store_set (target_store, &target_iter,
             GW_FLASHCARDSTORE_COLUMN_QUESTION, question,
             GW_FLASHCARDSTORE_COLUMN_ANSWER, answer,
             GW_FLASHCARDSTORE_COLUMN_TREE_PATH, path,
             GW_FLASHCARDSTORE_COLUMN_IS_COMPLETED, FALSE,
-            GW_FLASHCARDSTORE_COLUMN_WEIGHT, weight,
+            GW_FLASHCARDSTORE_COLUMN_DUE, due,
             GW_FLASHCARDSTORE_COLUMN_ORDER, order,
             GW_FLASHCARDSTORE_COLUMN_CORRECT_GUESSES, 0,
             GW_FLASHCARDSTORE_COLUMN_INCORRECT_GUESSES, 0,
@@ -265,6 +265,14 @@ void gw_flashcardstore_set_vocabularywordstore (GwFlashCardStore      *store,
 }
 
 
+//!
+//! @brief Cuts the deck down to the cards that are due for review, the most
+//!        overdue first.  The cards are put in a scheduler in one batch and
+//!        only the ones kept are taken out of it.  When nothing is due yet
+//!        the cards due soonest are kept so there is still a deck to study.
+//! @param store The GwFlashCardStore to trim
+//! @param max The number of cards to keep at most
+//!
 void gw_flashcardstore_trim (GwFlashCardStore *store, gint max)
 {
     //Sanity Checks
@@ -275,42 +283,73 @@ void gw_flashcardstore_trim (GwFlashCardStore *store, gint max)
     GtkTreeModel *model;
     GtkTreePath *path;
     GtkTreeIter iter;
+    LwScheduler *scheduler;
+    GList *due_cards;
+    GList *link;
     gboolean valid;
     gint children;
-    gchar *path_string;
-    GRand *random;
+    gint *order;
+    guint32 *due;
+    gpointer *cards;
     gint position;
+    gint kept;
 
-    gtk_tree_sortable_set_sort_column_id (
-        GTK_TREE_SORTABLE (store), 
-        GW_FLASHCARDSTORE_COLUMN_WEIGHT, 
-        GTK_SORT_DESCENDING);
-
+    //Initializations
     model = GTK_TREE_MODEL (store);
-    random = g_rand_new ();
     children = gtk_tree_model_iter_n_children (model, NULL);
+    if (children == 0) return;
+    scheduler = lw_scheduler_new ();
+    order = g_new (gint, children);
+    due = g_new (guint32, children);
+    cards = g_new (gpointer, children);
+    valid = gtk_tree_model_get_iter_first (model, &iter);
+    position = 0;
+
+    //Queue up every card by the time it is due
+    while (valid && position < children)
+    {
+      gtk_tree_model_get (model, &iter, GW_FLASHCARDSTORE_COLUMN_DUE, &due[position], -1);
+      cards[position] = GINT_TO_POINTER (position);
+      order[position] = -1;
+      valid = gtk_tree_model_iter_next (model, &iter);
+      position++;
+    }
+    lw_scheduler_add_many (scheduler, due, cards, position);
 
-    if (random != NULL)
+    //The due cards that come out first make the deck
+    due_cards = lw_scheduler_pop_due (scheduler, lw_scheduler_get_hours (), max);
+    kept = 0;
+    for (link = due_cards; link != NULL; link = link->next)
     {
-      while (children > max && children > 0)
+      order[GPOINTER_TO_INT (link->data)] = kept++;
+    }
+    //With nothing due yet the deck is the cards that will be due soonest
+    while (due_cards == NULL && kept < max && lw_scheduler_length (scheduler) > 0)
+    {
+      order[GPOINTER_TO_INT (lw_scheduler_pop (scheduler, NULL))] = kept++;
+    }
+
+    //Remove the rest from the back so the positions stay valid
+    for (position = children - 1; position >= 0; position--)
+    {
+      if (!gtk_tree_model_iter_nth_child (model, &iter, NULL, position)) continue;
+      if (order[position] < 0)
       {
-        position = g_rand_int_range (random, 0, children);
-        path_string = g_strdup_printf ("%d", position);
-        if (path_string != NULL)
-        {
-          valid = gtk_tree_model_get_iter_from_string (model, &iter, path_string);
-          if (valid)
-          {
-            gtk_tree_model_get (model, &iter, GW_FLASHCARDSTORE_COLUMN_TREE_PATH, &path, -1);
-            if (path != NULL) gtk_tree_path_free (path); path = NULL;
-            gtk_list_store_remove (GTK_LIST_STORE (store), &iter);
-          }
-          g_free (path_string); path_string = NULL;
-        }
-        children--;
+        gtk_tree_model_get (model, &iter, GW_FLASHCARDSTORE_COLUMN_TREE_PATH, &path, -1);
+        if (path != NULL) gtk_tree_path_free (path); path = NULL;
+        gtk_list_store_remove (GTK_LIST_STORE (store), &iter);
+      }
+      else
+      {
+        gtk_list_store_set (GTK_LIST_STORE (store), &iter, GW_FLASHCARDSTORE_COLUMN_ORDER, order[position], -1);
       }
-      g_rand_free (random); random = NULL;
-    } 
+    }
+
+    g_list_free (due_cards); due_cards = NULL;
+    lw_scheduler_free (scheduler); scheduler = NULL;
+    g_free (order); order = NULL;
+    g_free (due); due = NULL;
+    g_free (cards); cards = NULL;
 
     gtk_tree_sortable_set_sort_column_id (
         GTK_TREE_SORTABLE (store), 
@@ -420,9 +459,11 @@ gw_flashcardstore_set_correct_guesses (GwFlashCardStore *store, GtkTreeIter *fla
     {
       guesses = gw_vocabularywordstore_get_correct_guesses_by_iter (priv->store, &iter);
       gw_vocabularywordstore_set_correct_guesses_by_iter (priv->store, &iter, guesses + guess_delta);
-      gw_vocabularywordstore_update_timestamp_by_iter (priv->store, &iter);
-      gw_vocabularywordstore_set_has_changes (priv->store, TRUE);
-      gw_vocabularywordstore_save (priv->store, NULL);
+      if (guess_delta > 0)
+        gw_vocabularywordstore_review_by_iter (priv->store, &iter, LW_SCHEDULER_GRADE_GOOD);
+      else
+        gw_vocabularywordstore_update_timestamp_by_iter (priv->store, &iter);
+      gw_vocabularywordstore_save_guesses_by_iter (priv->store, &iter);
     }
 
     //set the new flashcard word number
@@ -481,9 +522,11 @@ gw_flashcardstore_set_incorrect_guesses (GwFlashCardStore *store, GtkTreeIter *f
     {
       guesses = gw_vocabularywordstore_get_incorrect_guesses_by_iter (priv->store, &iter);
       gw_vocabularywordstore_set_incorrect_guesses_by_iter (priv->store, &iter, guesses + guess_delta);
-      gw_vocabularywordstore_update_timestamp_by_iter (priv->store, &iter);
-      gw_vocabularywordstore_set_has_changes (priv->store, TRUE);
-      gw_vocabularywordstore_save (priv->store, NULL);
+      if (guess_delta > 0)
+        gw_vocabularywordstore_review_by_iter (priv->store, &iter, LW_SCHEDULER_GRADE_AGAIN);
+      else
+        gw_vocabularywordstore_update_timestamp_by_iter (priv->store, &iter);
+      gw_vocabularywordstore_save_guesses_by_iter (priv->store, &iter);
     }
 
     //set the new flashcard word number
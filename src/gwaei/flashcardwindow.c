@@ -293,8 +293,7 @@ gw_flashcardwindow_user_answer_is_correct (GwFlashCardWindow *window)
     }
     else if (convertable)
     {
-      strcpy(katakana, hiragana);
-      lw_util_str_shift_hira_to_kata (katakana);
+      lw_util_str_roma_to_kata (user, katakana, MAX);
       is_correct = (strstr(card, user) != NULL || strstr(card, hiragana) != NULL || strstr(card, katakana) != NULL);
     }
     else
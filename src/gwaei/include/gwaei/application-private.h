@@ -30,6 +30,7 @@ struct _GwApplicationPrivate {
   GOptionContext *context;
   gchar   *arg_dictionary;
   gchar   *arg_query;
+  gchar   *arg_export_pdf;
   gboolean arg_version_switch;
   gboolean arg_new_vocabulary_window_switch;
 
@@ -11,7 +11,7 @@ typedef enum {
   GW_FLASHCARDSTORE_COLUMN_ANSWER,
   GW_FLASHCARDSTORE_COLUMN_IS_COMPLETED,
   GW_FLASHCARDSTORE_COLUMN_TREE_PATH,
-  GW_FLASHCARDSTORE_COLUMN_WEIGHT,
+  GW_FLASHCARDSTORE_COLUMN_DUE,
   GW_FLASHCARDSTORE_COLUMN_ORDER,
   GW_FLASHCARDSTORE_COLUMN_CORRECT_GUESSES,
   GW_FLASHCARDSTORE_COLUMN_INCORRECT_GUESSES,
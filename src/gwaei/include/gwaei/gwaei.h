@@ -14,6 +14,7 @@
 #include <gwaei/texttagtable.h>
 #include <gwaei/spellcheck.h>
 #include <gwaei/printing.h>
+#include <gwaei/printjob.h>
 
 #include <gwaei/window.h>
 #include <gwaei/searchwindow.h>
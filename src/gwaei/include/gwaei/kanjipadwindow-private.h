@@ -1,6 +1,8 @@
 #ifndef GW_KANJIPADWINDOW_PRIVATE_INCLUDED
 #define GW_KANJIPADWINDOW_PRIVATE_INCLUDED
 
+#include <kpengine/kpengine.h>
+
 G_BEGIN_DECLS
 
 struct _GwKanjipadWindowPrivate {
@@ -14,13 +16,16 @@ struct _GwKanjipadWindowPrivate {
   cairo_surface_t *ksurface;
   GList *curstroke;
   gboolean instroke;
-  char kselected[2];
-  char kanji_candidates[GW_KANJIPADWINDOW_MAX_GUESSES][2];
+  gunichar kselected;
+  gunichar kanji_candidates[GW_KANJIPADWINDOW_MAX_GUESSES];
   int total_candidates;
-  GPid engine_pid;
-  GIOChannel *from_engine;
-  GIOChannel *to_engine;
-  guint iowatchid;
+  KpEngine *engine;
+  KpRecognizer *recognizer;
+  GMutex recognizer_mutex;
+  guint recognizer_drawing;
+  gint recognizer_strokes;
+  guint drawing_serial;
+  guint lookup_serial;
 };
 
 #define GW_KANJIPADWINDOW_GET_PRIVATE(object)(G_TYPE_INSTANCE_GET_PRIVATE ((object), GW_TYPE_KANJIPADWINDOW, GwKanjipadWindowPrivate))
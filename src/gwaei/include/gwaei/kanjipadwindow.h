@@ -38,6 +38,8 @@ struct _GwKanjipadWindowClass {
 GtkWindow* gw_kanjipadwindow_new (GtkApplication *application);
 GType gw_kanjipadwindow_get_type (void) G_GNUC_CONST;
 
+void gw_kanjipadwindow_look_up (GwKanjipadWindow*);
+
 #include "kanjipadwindow-callbacks.h"
 #include "kanjipad-candidatearea.h"
 #include "kanjipad-drawingarea.h"
@@ -0,0 +1,47 @@
+#ifndef GW_PRINTJOB_INCLUDED
+#define GW_PRINTJOB_INCLUDED
+
+#include <cairo.h>
+
+G_BEGIN_DECLS
+
+#define GW_PRINTJOB_HEADER_HEIGHT 16.0
+#define GW_PRINTJOB_RESULTS_FONT "sans 10"
+#define GW_PRINTJOB_HEADER_FONT "sans 8"
+
+struct _GwPrintJob {
+  LwDictionary *dictionary;
+  LwSearch *search;       //Copy of the search that replays its snapshot
+  gchar *title;
+
+  gdouble width;          //Size of the printable area of a page in points
+  gdouble height;
+
+  GThread *thread;
+  GMutex mutex;
+  GPtrArray *pages;       //Pango markup of each page that has been laid out
+  gint laid_out;          //Number of results laid out so far
+  gint total;             //Number of results the copy of the search found
+  gint cancel;
+  gint finished;
+};
+typedef struct _GwPrintJob GwPrintJob;
+
+#define GW_PRINTJOB(object) (GwPrintJob*) object
+
+GwPrintJob* gw_printjob_new (LwSearch*, const gchar*);
+void gw_printjob_free (GwPrintJob*);
+
+void gw_printjob_start (GwPrintJob*, gdouble, gdouble);
+gboolean gw_printjob_layout (GwPrintJob*, gdouble, gdouble);
+void gw_printjob_cancel (GwPrintJob*);
+gboolean gw_printjob_is_finished (GwPrintJob*);
+gdouble gw_printjob_get_progress (GwPrintJob*);
+
+gint gw_printjob_get_n_pages (GwPrintJob*);
+void gw_printjob_draw_page (GwPrintJob*, cairo_t*, gint);
+gboolean gw_printjob_export_pdf (GwPrintJob*, const gchar*, gdouble, gdouble, GError**);
+
+G_END_DECLS
+
+#endif
@@ -8,6 +8,8 @@ struct _GwRadicalsWindowPrivate {
   GtkToolPalette *toolpalette;
   GtkSpinButton *strokes_spinbutton;
 
+  guint index_timeoutid; //Checks for the radical index while it is loaded in another thread
+
   char cache[300 * 4];
 };
 
@@ -43,6 +43,8 @@ char* gw_radicalswindow_strdup_prefered_stroke_count (GwRadicalsWindow*);
 void gw_radicalswindow_deselect (GwRadicalsWindow*);
 void gw_radicalswindow_set_strokes_checkbox_state (GwRadicalsWindow*, gboolean);
 void gw_radicalswindow_update_sensitivities (GwRadicalsWindow*, const gchar*);
+void gw_radicalswindow_sync_sensitivities (GwRadicalsWindow*);
+gboolean gw_radicalswindow_has_index (GwRadicalsWindow*);
 void gw_radicalswindow_update_strokes_checkbox_state (GwRadicalsWindow*);
 
 #include "radicalswindow-callbacks.h"
@@ -0,0 +1,44 @@
+#ifndef GW_SPELLCHECK_CACHE_INCLUDED
+#define GW_SPELLCHECK_CACHE_INCLUDED
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define GW_SPELLCHECK_CACHE_SIZE 512
+
+//A remembered Hunspell answer for a word of the current dictionary
+struct _GwSpellcheckCacheEntry {
+  gchar *word;
+  gboolean correct;
+  gchar **suggestions; //NULL until they are looked up
+  GList *link;         //The entry's place in the recently used queue
+};
+typedef struct _GwSpellcheckCacheEntry GwSpellcheckCacheEntry;
+
+//The Hunspell answers of the most recently checked words
+struct _GwSpellcheckCache {
+  GHashTable *table;  //Words to GwSpellcheckCacheEntrys
+  GQueue order;       //Most recently used entries first
+  guint size;         //The most entries kept
+  guint generation;   //Bumped whenever the cache is emptied
+  GMutex mutex;       //The cache is shared with the worker thread
+};
+typedef struct _GwSpellcheckCache GwSpellcheckCache;
+
+GwSpellcheckCache* gw_spellcheck_cache_new (guint);
+void gw_spellcheck_cache_free (GwSpellcheckCache*);
+
+void gw_spellcheck_cache_clear (GwSpellcheckCache*);
+guint gw_spellcheck_cache_length (GwSpellcheckCache*);
+gboolean gw_spellcheck_cache_lookup (GwSpellcheckCache*, const gchar*, gboolean*, guint*);
+void gw_spellcheck_cache_insert (GwSpellcheckCache*, const gchar*, gboolean, guint);
+void gw_spellcheck_cache_remove (GwSpellcheckCache*, const gchar*);
+
+void gw_spellcheck_cache_set_suggestions (GwSpellcheckCache*, const gchar*, gchar**, guint);
+gchar** gw_spellcheck_cache_get_suggestions (GwSpellcheckCache*, const gchar*);
+gboolean gw_spellcheck_cache_has_suggestions (GwSpellcheckCache*, const gchar*);
+
+G_END_DECLS
+
+#endif
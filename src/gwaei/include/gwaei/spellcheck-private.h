@@ -2,6 +2,7 @@
 #define GW_SPELLCHECK_PRIVATE_INCLUDED
 
 #include <hunspell/hunspell.h>
+#include <gwaei/spellcheck-cache.h>
 
 G_BEGIN_DECLS
 
@@ -23,12 +24,28 @@ typedef enum {
 } GwSpellcheckTimeoutid;
 
 
+//The tolkens of the entry text waiting to be checked by the worker thread
+struct _GwSpellcheckRequest {
+  GwSpellcheck *spellcheck;
+  gint serial;
+  gchar **tolkens;
+  GList *misspelled;
+};
+typedef struct _GwSpellcheckRequest GwSpellcheckRequest;
+
+
 struct _GwSpellcheckPrivate {
   GwApplication *application;
 
   GtkEntry *entry;
 
   Hunhandle *handle;
+  GMutex handle_mutex; //Hunspell handles aren't thread safe
+
+  GThreadPool *pool;   //A single worker that does the Hunspell lookups
+  gint serial;         //Bumped whenever the text changes so stale requests are dropped
+
+  GwSpellcheckCache *cache; //Answers of recently checked words
 
   gchar** tolkens;           //A list of tolkens taken from the search entry
   GList *misspelled; //gchar* pointers to individual tolkens above
@@ -44,6 +44,7 @@ void gw_spellcheck_record_mouse_cordinates (GwSpellcheck*, GdkEvent*);
 void gw_spellcheck_populate_popup (GwSpellcheck*, GtkMenu*);
 
 void gw_spellcheck_load_dictionary (GwSpellcheck*);
+void gw_spellcheck_add_word (GwSpellcheck*, const gchar*);
 
 #include <gwaei/spellcheck-callbacks.h>
 
@@ -20,6 +20,8 @@ typedef enum {
   GW_VOCABULARYWORDSTORE_COLUMN_TIMESTAMP,
   GW_VOCABULARYWORDSTORE_COLUMN_DAYS,
   GW_VOCABULARYWORDSTORE_COLUMN_WEIGHT,
+  GW_VOCABULARYWORDSTORE_COLUMN_EASE,
+  GW_VOCABULARYWORDSTORE_COLUMN_INTERVAL,
   TOTAL_GW_VOCABULARYWORDSTORE_COLUMNS
 } GwVocabularyWordStoreColumn;
 
@@ -69,6 +71,8 @@ void gw_vocabularywordstore_set_string (GwVocabularyWordStore*, GtkTreeIter*, gi
 gchar* gw_vocabularywordstore_iter_to_string (GwVocabularyWordStore*, GtkTreeIter*);
 
 void gw_vocabularywordstore_update_timestamp_by_iter (GwVocabularyWordStore*, GtkTreeIter*);
+void gw_vocabularywordstore_review_by_iter (GwVocabularyWordStore*, GtkTreeIter*, LwSchedulerGrade);
+void gw_vocabularywordstore_save_guesses_by_iter (GwVocabularyWordStore*, GtkTreeIter*);
 
 gint gw_vocabularywordstore_get_correct_guesses_by_iter (GwVocabularyWordStore*, GtkTreeIter*);
 void gw_vocabularywordstore_set_correct_guesses_by_iter (GwVocabularyWordStore*, GtkTreeIter*, gint);
@@ -76,7 +80,7 @@ void gw_vocabularywordstore_set_correct_guesses_by_iter (GwVocabularyWordStore*,
 gint gw_vocabularywordstore_get_incorrect_guesses_by_iter (GwVocabularyWordStore*, GtkTreeIter*);
 void gw_vocabularywordstore_set_incorrect_guesses_by_iter (GwVocabularyWordStore*, GtkTreeIter*, gint);
 
-gint gw_vocabularywordstore_calculate_weight (GwVocabularyWordStore*, GtkTreeIter*);
+guint32 gw_vocabularywordstore_get_due_hours_by_iter (GwVocabularyWordStore*, GtkTreeIter*);
 
 G_END_DECLS
 
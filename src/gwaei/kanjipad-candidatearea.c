@@ -102,28 +102,16 @@ static void _kanjipadwindow_get_candidate_character_size (GwKanjipadWindow *wind
 //!
 //! @brief To be written
 //!
-static gchar *_kanjipadwindow_utf8_for_char (char wide_character[])
+static gchar *_kanjipadwindow_utf8_for_char (gunichar character)
 {
     //Declarations
-    gchar *string_utf;
-    GError *error;
-    gchar str[3];
-
-    //Initializaitons
-    error = NULL;
-    str[0] = wide_character[0] + 0x80;
-    str[1] = wide_character[1] + 0x80;
-    str[2] = '\0';
-    string_utf = g_convert (str, -1, "UTF-8", "EUC-JP", NULL, NULL, &error);
+    gchar buffer[7];
+    gint length;
 
-    if (error != NULL)
-    {
-      g_printerr ("Cannot convert string from EUC-JP to UTF-8: %s\n",
-      error->message);
-      exit (EXIT_FAILURE);
-    }
+    //Initializations
+    length = (character != 0) ? g_unichar_to_utf8 (character, buffer) : 0;
 
-    return string_utf;
+    return g_strndup (buffer, length);
 }
 
 
@@ -225,7 +213,7 @@ void gw_kanjipadwindow_draw_candidates (GwKanjipadWindow *window)
 
     for (i = 0; i < priv->total_candidates; i++)
     {
-      if (strcmp (priv->kselected, priv->kanji_candidates[i]) == 0)
+      if (priv->kselected == priv->kanji_candidates[i])
         _kanjipadwindow_draw_candidate_character (window, i, 1);
       else
         _kanjipadwindow_draw_candidate_character (window, i, -1);
@@ -295,11 +283,11 @@ static int _kanjipadwindow_erase_candidate_selection (GwKanjipadWindow *window)
     //Initializations
     priv = window->priv;
 
-    if (priv->kselected[0] || priv->kselected[1])
+    if (priv->kselected != 0)
     {
       for (i = 0; i < priv->total_candidates; i++)
       {
-        if (strncmp (priv->kselected, priv->kanji_candidates[i], 2))
+        if (priv->kselected != priv->kanji_candidates[i])
         {
           _kanjipadwindow_draw_candidate_character (window, i, 0);
         }
@@ -323,8 +311,7 @@ static void _kanjipadwindow_primary_candidates_clear (GtkClipboard *clipboard, g
 
     _kanjipadwindow_erase_candidate_selection (window);
 
-    priv->kselected[0] = 0;
-    priv->kselected[1] = 0;
+    priv->kselected = 0;
 
     gtk_widget_queue_draw (GTK_WIDGET (priv->candidates));
 }
@@ -342,7 +329,7 @@ static void _kanjipadwindow_primary_candidates_get (GtkClipboard *clipboard, Gtk
     window = GW_KANJIPADWINDOW (data);
     priv = window->priv;
 
-    if (priv->kselected[0] || priv->kselected[1])
+    if (priv->kselected != 0)
     {
       string_utf = _kanjipadwindow_utf8_for_char (priv->kselected);
       gtk_selection_data_set_text (selection_data, string_utf, -1);
@@ -386,7 +373,7 @@ G_MODULE_EXPORT gboolean gw_kanjipadwindow_candidatearea_button_press_event_cb (
     if (j < priv->total_candidates)
     {
       gw_kanjipadwindow_draw_candidates (window); 
-      strncpy(priv->kselected, priv->kanji_candidates[j], 2);
+      priv->kselected = priv->kanji_candidates[j];
       _kanjipadwindow_draw_candidate_character (window, j, 1);
       
       if (!gtk_clipboard_set_with_owner (clipboard, targets, G_N_ELEMENTS (targets),
@@ -395,8 +382,7 @@ G_MODULE_EXPORT gboolean gw_kanjipadwindow_candidatearea_button_press_event_cb (
     }
     else
     {
-      priv->kselected[0] = 0;
-      priv->kselected[1] = 0;
+      priv->kselected = 0;
       if (gtk_clipboard_get_owner (clipboard) == G_OBJECT (widget))
         gtk_clipboard_clear (clipboard);
     }
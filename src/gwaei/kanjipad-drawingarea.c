@@ -433,6 +433,7 @@ gw_kanjipadwindow_clear_drawingarea (GwKanjipadWindow *window)
     }
     g_list_free (priv->strokes); priv->strokes = NULL;
     g_list_free (priv->curstroke); priv->curstroke = NULL;
+    priv->drawing_serial++;
 
     _kanjipadwindow_initialize_drawingarea (window);
 }
@@ -47,56 +47,19 @@
 
 
 //!
-//! @brief Does the needed calls to kpad to look up the kanji
+//! @brief Hands the drawing to the recognition engine to look up the kanji
 //! 
 G_MODULE_EXPORT gboolean 
 gw_kanjipadwindow_look_up_cb (GtkWidget *widget, GdkEventButton *event, gpointer data)
 {
     //Declarations
     GwKanjipadWindow *window;
-    GwKanjipadWindowPrivate *priv;
-    GList *iter;
-    GList *inner_iter;
-    GString *message;
-    GError *error;
-    gint16 x;
-    gint16 y;
 
     //Initializations
     window = GW_KANJIPADWINDOW (gtk_widget_get_ancestor (GTK_WIDGET (data), GW_TYPE_KANJIPADWINDOW));
     g_return_val_if_fail (window != NULL, FALSE);
-    priv = window->priv;
-
-    if (priv->to_engine == NULL)
-      return FALSE;
-    message = g_string_new (NULL);
-    error = NULL;
-      
-    for (iter = priv->strokes; iter != NULL; iter = iter->next)
-    {
-      for (inner_iter = iter->data; inner_iter != NULL; inner_iter = inner_iter->next)
-      {
-        x = ((GdkPoint*) inner_iter->data)->x;
-        y = ((GdkPoint*) inner_iter->data)->y;
-        g_string_append_printf (message, "%d %d ", x, y);
-      }
-      g_string_append (message, "\n");
-    }
-    g_string_append (message, "\n");
-
-    if (g_io_channel_write_chars (priv->to_engine, message->str, message->len, NULL, &error) != G_IO_STATUS_NORMAL)
-    {
-      fprintf (stderr, "Cannot write message to engine: %s\n", error->message);
-      exit (EXIT_FAILURE);
-    }
-
-    if (g_io_channel_flush (priv->to_engine, &error) != G_IO_STATUS_NORMAL)
-    {
-      fprintf (stderr, "Error flushing message to engine: %s\n", error->message);
-      exit (EXIT_FAILURE);
-    }
-
-    g_string_free (message, TRUE);
+
+    gw_kanjipadwindow_look_up (window);
 
     return FALSE;
 }
@@ -46,11 +46,24 @@
 #include <gwaei/kanjipadwindow-private.h>
 #include <gwaei/kanjipadwindow-callbacks.h>
 
-#define BUFLEN 256
-
 
 static void _kanjipadwindow_initialize_engine (GwKanjipadWindow*);
-static gboolean _kanjipadwindow_engine_input_handler (GIOChannel*, GIOCondition, gpointer);
+static gpointer _kanjipadwindow_look_up_thread (gpointer);
+static gboolean _kanjipadwindow_look_up_finished (gpointer);
+
+//!
+//! @brief A snapshot of the drawing handed to the recognition thread
+//!
+struct _GwKanjipadLookUp {
+  GwKanjipadWindow *window;
+  guint serial;
+  guint drawing;
+  KpStroke *strokes;
+  gint total_strokes;
+  gunichar candidates[GW_KANJIPADWINDOW_MAX_GUESSES];
+  gint total_candidates;
+};
+typedef struct _GwKanjipadLookUp GwKanjipadLookUp;
 
 G_DEFINE_TYPE (GwKanjipadWindow, gw_kanjipadwindow, GW_TYPE_WINDOW)
 
@@ -81,6 +94,8 @@ gw_kanjipadwindow_init (GwKanjipadWindow *window)
 {
     window->priv = GW_KANJIPADWINDOW_GET_PRIVATE (window);
     memset(window->priv, 0, sizeof(GwKanjipadWindowPrivate));
+
+    g_mutex_init (&window->priv->recognizer_mutex);
 }
 
 
@@ -89,13 +104,10 @@ gw_kanjipadwindow_finalize (GObject *object)
 {
     GwKanjipadWindow *window;
     GwKanjipadWindowPrivate *priv;
-    GSource *source;
-    GError *error;
     GList *link;
 
     window = GW_KANJIPADWINDOW (object);
     priv = window->priv;
-    error = NULL;
 
     for (link = priv->strokes; link != NULL; link = link->next)
       gw_kanjipadwindow_free_drawingarea_stroke (link->data);
@@ -105,40 +117,10 @@ gw_kanjipadwindow_finalize (GObject *object)
     if (priv->ksurface != NULL) cairo_surface_destroy (priv->ksurface); priv->ksurface = NULL;
     if (priv->surface != NULL) cairo_surface_destroy (priv->surface); priv->surface = NULL;
 
-    if (g_main_current_source () != NULL &&
-        !g_source_is_destroyed (g_main_current_source ()) &&
-        priv->iowatchid > 0
-       )
-    {
-      source = g_main_context_find_source_by_id (NULL, priv->iowatchid);
-      if (source != NULL)
-      {
-        g_source_destroy (source);
-      }
-    }
-    priv->iowatchid = 0;
-
-    if (error == NULL) 
-    {
-      g_io_channel_shutdown (priv->from_engine, FALSE, &error);
-      g_io_channel_unref (priv->from_engine);
-      priv->from_engine = NULL;
-    }
-
-    if (error == NULL)
-    {
-      g_io_channel_shutdown (priv->to_engine, FALSE, &error);
-      g_io_channel_unref (priv->to_engine);
-      priv->to_engine = NULL;
-    }
-
-    g_spawn_close_pid (priv->engine_pid);
-
-    if (error != NULL)
-    {
-      fprintf(stderr, "Errored: %s\n", error->message);
-      exit(EXIT_FAILURE);
-    }
+    //Running look ups hold a reference to the window so none can be left by now
+    if (priv->recognizer != NULL) kp_recognizer_free (priv->recognizer); priv->recognizer = NULL;
+    if (priv->engine != NULL) kp_engine_free (priv->engine); priv->engine = NULL;
+    g_mutex_clear (&priv->recognizer_mutex);
 
     G_OBJECT_CLASS (gw_kanjipadwindow_parent_class)->finalize (object);
 }
@@ -228,123 +210,162 @@ gw_kanjipadwindow_class_init (GwKanjipadWindowClass *klass)
 
 
 //!
-//! @brief Open the connection to the engine
+//! @brief Loads the handwriting recognition engine
 //!
 static void _kanjipadwindow_initialize_engine (GwKanjipadWindow *window)
 {
     //Declarations
     GwApplication *application;
     GwKanjipadWindowPrivate *priv;
-    char *path;
-    char *argv[2];
     GError *error;
-    int stdin_fd;
-    int stdout_fd;
 
     //Initializations
     application = gw_window_get_application (GW_WINDOW (window));
     priv = window->priv;
     error = NULL;
-#ifndef G_OS_WIN32
-    path = g_build_filename (LIBDIR, PACKAGE, "kpengine", NULL);
-#else
-    gchar *prefix;
-
-    prefix = g_win32_get_package_installation_directory_of_module (NULL);
-    path = g_build_filename (prefix, "lib", PACKAGE, "kpengine.exe", NULL);
-    g_free (prefix);
-#endif
-    argv[0] = path;
-    argv[1] = NULL;
 
-    if (!g_file_test(argv[0], G_FILE_TEST_EXISTS)) 
+    priv->engine = kp_engine_new (NULL, &error);
+    if (priv->engine != NULL) priv->recognizer = kp_recognizer_new (priv->engine);
+
+    //Without the engine look ups are skipped, but the pad is still usable
+    gw_application_handle_error (application, GTK_WINDOW (window), FALSE, &error);
+}
+
+
+//!
+//! @brief Recognizes the current drawing on a worker thread.  The
+//!        candidates are redrawn once the results come back.
+//! @param window The GwKanjipadWindow to look up the drawing of
+//!
+void
+gw_kanjipadwindow_look_up (GwKanjipadWindow *window)
+{
+    //Sanity checks
+    g_return_if_fail (window != NULL);
+
+    //Declarations
+    GwKanjipadWindowPrivate *priv;
+    GwKanjipadLookUp *lookup;
+    KpPoint *points;
+    GList *link;
+    GList *inner_link;
+    GdkPoint *point;
+    GThread *thread;
+    GError *error;
+    gint i, j;
+
+    //Initializations
+    priv = window->priv;
+    if (priv->recognizer == NULL) return;
+    lookup = g_new0 (GwKanjipadLookUp, 1);
+    lookup->window = GW_KANJIPADWINDOW (g_object_ref (window));
+    lookup->serial = ++priv->lookup_serial;
+    lookup->drawing = priv->drawing_serial;
+    lookup->total_strokes = g_list_length (priv->strokes);
+    lookup->strokes = g_new0 (KpStroke, lookup->total_strokes);
+    error = NULL;
+
+    //Copy the strokes so the user can keep drawing while the thread works
+    for (link = priv->strokes, i = 0; link != NULL; link = link->next, i++)
     {
-      fprintf(stderr, "Error: Can't find kpengine at %s\n", argv[0]);
-      exit (EXIT_FAILURE);
+      points = g_new (KpPoint, g_list_length (link->data));
+      for (inner_link = link->data, j = 0; inner_link != NULL; inner_link = inner_link->next, j++)
+      {
+        point = (GdkPoint*) inner_link->data;
+        points[j].x = point->x;
+        points[j].y = point->y;
+      }
+      lookup->strokes[i].points = points;
+      lookup->strokes[i].total_points = j;
     }
 
-    if (!g_spawn_async_with_pipes (NULL, /* working directory */
-           argv, NULL,  /* argv, envp */
-           0,
-           NULL, NULL,  /* child_setup */
-           (gpointer)&priv->engine_pid,   /* child pid */
-           &stdin_fd, &stdout_fd, NULL,
-           &error))
+    thread = g_thread_try_new ("gwaei-kanjipad-thread", _kanjipadwindow_look_up_thread, lookup, &error);
+    if (thread != NULL)
+    {
+      g_thread_unref (thread);
+    }
+    else
     {
-      gw_application_handle_error (application, NULL, FALSE, &error);
-      exit (EXIT_FAILURE);
+      g_warning ("Could not start the handwriting recognition: %s", error->message);
+      g_error_free (error);
+      _kanjipadwindow_look_up_finished (lookup);
     }
+}
 
-    if (!(priv->to_engine = g_io_channel_unix_new (stdin_fd)))
-      g_error ("Couldn't create pipe to child process: %s", g_strerror(errno));
-    if (!(priv->from_engine = g_io_channel_unix_new (stdout_fd)))
-      g_error ("Couldn't create pipe from child process: %s", g_strerror(errno));
 
-    priv->iowatchid = g_io_add_watch (priv->from_engine, G_IO_IN, _kanjipadwindow_engine_input_handler, window);
+static gpointer
+_kanjipadwindow_look_up_thread (gpointer data)
+{
+    //Declarations
+    GwKanjipadLookUp *lookup;
+    GwKanjipadWindowPrivate *priv;
 
-    //Cleanup
-    g_free(path);
+    //Initializations
+    lookup = data;
+    priv = lookup->window->priv;
+
+    g_mutex_lock (&priv->recognizer_mutex);
+
+    //The recognizer keeps the scores of the strokes it was already given, so
+    //only the strokes drawn since the last look up need scoring.  It starts
+    //over for a new drawing or for an older snapshot that arrived late.
+    if (priv->recognizer_drawing != lookup->drawing || priv->recognizer_strokes > lookup->total_strokes)
+    {
+      kp_recognizer_clear (priv->recognizer);
+      priv->recognizer_drawing = lookup->drawing;
+      priv->recognizer_strokes = 0;
+    }
+    while (priv->recognizer_strokes < lookup->total_strokes)
+    {
+      kp_recognizer_add_stroke (priv->recognizer, &lookup->strokes[priv->recognizer_strokes]);
+      priv->recognizer_strokes++;
+    }
+
+    lookup->total_candidates = kp_recognizer_get_candidates (
+      priv->recognizer,
+      lookup->candidates, GW_KANJIPADWINDOW_MAX_GUESSES
+    );
+
+    g_mutex_unlock (&priv->recognizer_mutex);
+
+    g_idle_add (_kanjipadwindow_look_up_finished, lookup);
+
+    return NULL;
 }
 
 
 //!
-//! @brief To be written
+//! @brief Shows the results of a look up in the main thread unless a
+//!        newer look up has already been started
 //!
-static gboolean _kanjipadwindow_engine_input_handler (GIOChannel *source, GIOCondition condition, gpointer data)
+static gboolean
+_kanjipadwindow_look_up_finished (gpointer data)
 {
-    GwKanjipadWindow *window;
+    //Declarations
+    GwKanjipadLookUp *lookup;
     GwKanjipadWindowPrivate *priv;
-    static gchar *p;
-    static gchar *line;
-    GError *error;
-    GIOStatus status;
-    int i;
+    gint i;
 
-    window = GW_KANJIPADWINDOW (data);
-    priv = window->priv;
-    error = NULL;
-    status = g_io_channel_read_line (priv->from_engine, &line, NULL, NULL, &error);
-
-    switch (status)
-    {
-      case G_IO_STATUS_ERROR:
-        fprintf (stderr, "Error reading from engine: %s\n", error->message);
-        exit(EXIT_FAILURE);
-        break;
-      case G_IO_STATUS_NORMAL:
-        break;
-      case G_IO_STATUS_EOF:
-        fprintf (stderr, "Engine no longer exists");
-        exit (EXIT_FAILURE);
-        break;
-      case G_IO_STATUS_AGAIN:
-        g_assert_not_reached ();
-        break;
-    }
+    //Initializations
+    lookup = data;
+    priv = lookup->window->priv;
 
-    if (line[0] == 'K')
+    if (lookup->serial == priv->lookup_serial)
     {
-      unsigned int t1, t2;
-      p = line + 1;
-      for (i = 0; i < GW_KANJIPADWINDOW_MAX_GUESSES; i++)
-      {
-        while (*p && isspace(*p)) p++;
-        if (!*p || sscanf(p, "%2x%2x", &t1, &t2) != 2)
-        {
-            i--;
-            break;
-        }
-        priv->kanji_candidates[i][0] = t1;
-        priv->kanji_candidates[i][1] = t2;
-        while (*p && !isspace(*p)) p++;
-      }
-      priv->total_candidates = i + 1;
+      for (i = 0; i < lookup->total_candidates; i++)
+        priv->kanji_candidates[i] = lookup->candidates[i];
+      priv->total_candidates = lookup->total_candidates;
 
-      gw_kanjipadwindow_draw_candidates (window);
+      if (priv->ksurface != NULL) gw_kanjipadwindow_draw_candidates (lookup->window);
     }
 
-    g_free (line);
+    //Cleanup
+    for (i = 0; i < lookup->total_strokes; i++)
+      g_free ((KpPoint*) lookup->strokes[i].points);
+    g_free (lookup->strokes);
+    g_object_unref (lookup->window);
+    g_free (lookup);
 
-    return TRUE;
+    return FALSE;
 }
 
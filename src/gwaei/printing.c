@@ -22,7 +22,9 @@
 //!
 //! @file printing.c
 //!
-//! @brief To be written
+//! @brief Printing of the search results.  The whole result list is laid
+//!        out by a GwPrintJob in the background, and only a selection of the
+//!        results text buffer is still paginated from the buffer itself.
 //!
 
 #ifdef HAVE_CONFIG_H
@@ -86,6 +88,7 @@ void gw_pageinfo_free (GwPageInfo *pi) {
 struct _GwPrintData {
   GList *pages;
   GwSearchWindow *window;
+  GwPrintJob *job; //!< Lays out the result list when there is no selection to print
 };
 typedef struct _GwPrintData GwPrintData;
 
@@ -100,6 +103,7 @@ GwPrintData* gw_printdata_new (GwSearchWindow *window)
     {
       temp->pages = NULL;
       temp->window = window;
+      temp->job = NULL;
     }
     
     return temp;
@@ -119,19 +123,27 @@ void gw_printdata_free (GwPrintData *data)
 
     }
     g_list_free (data->pages);
+
+    if (data->job != NULL) gw_printjob_free (data->job); data->job = NULL;
     
     free (data);
 }
 
 
 //!
-//! @brief function for signal fired upon start of printing.
+//! @brief function for signal fired upon start of printing.  The page size is
+//!        known from here on so the layout of the result list is started.
 //! @sa _done() _begin_print() draw() _paginate()
 //!
 static void _begin_print (GtkPrintOperation *operation,
                           GtkPrintContext   *context,
-                          GwPrintData       *data      ) {
-  printf("begin_print!\n");
+                          GwPrintData       *data      ) 
+{
+    if (data->job != NULL)
+    {
+      gtk_print_operation_set_show_progress (operation, TRUE);
+      gw_printjob_start (data->job, gtk_print_context_get_width (context), gtk_print_context_get_height (context));
+    }
 }
 
 
@@ -274,8 +286,6 @@ static gboolean _paginate (GtkPrintOperation *operation,
                            GtkPrintContext   *context,
                            GwPrintData       *data      )
 {
-    printf("paginate!\n");
-
     //Declarations
     GwPageInfo *page;
     GwPageInfo *prev_page;
@@ -285,6 +295,14 @@ static gboolean _paginate (GtkPrintOperation *operation,
     GtkTextView *view;
     GtkTextBuffer *buffer;
 
+    //The result list is laid out in the background so just check on it
+    if (data->job != NULL)
+    {
+      if (!gw_printjob_is_finished (data->job)) return FALSE;
+      gtk_print_operation_set_n_pages (operation, MAX (gw_printjob_get_n_pages (data->job), 1));
+      return TRUE;
+    }
+
     //Initializations
     view = gw_searchwindow_get_current_textview (data->window);
     buffer = gtk_text_view_get_buffer (view);
@@ -345,11 +363,15 @@ static void _draw_page (GtkPrintOperation *operation,
                         gint               page_nr,
                         GwPrintData       *data     )
 {
-    printf("draw!\n");
-
     //Declarations
     GwPageInfo *page;
 
+    if (data->job != NULL)
+    {
+      gw_printjob_draw_page (data->job, gtk_print_context_get_cairo_context (context), page_nr);
+      return;
+    }
+
     //Initializations
     page = GW_PAGEINFO (g_list_nth_data (data->pages, page_nr));
 
@@ -378,7 +400,7 @@ static void _done (GtkPrintOperation       *operation,
                    GtkPrintOperationResult  result,
                    GwPrintData             *data      ) 
 {
-    printf("done\n");
+    if (data->job != NULL) gw_printjob_cancel (data->job);
 }
 
 
@@ -395,15 +417,30 @@ void gw_print (const GtkPrintOperationAction ACTION, GwSearchWindow *window)
     GwPrintData *data;
     GtkPrintOperation *operation;
     GtkPrintOperationResult res;
+    GtkTextBuffer *buffer;
+    LwSearch *search;
+    gchar *title;
+    gint index;
     
     //Initializations
     data = gw_printdata_new (window);
     operation = gtk_print_operation_new ();
+    buffer = gtk_text_view_get_buffer (gw_searchwindow_get_current_textview (window));
+    index = gw_searchwindow_get_current_tab_index (window);
+    search = gw_searchwindow_get_searchitem_by_index (window, index);
+
+    //Print the whole result list without going through the text buffer
+    if (search != NULL && !gtk_text_buffer_get_has_selection (buffer))
+    {
+      title = gw_searchwindow_get_title_by_searchitem (window, search);
+      data->job = gw_printjob_new (search, title);
+      g_free (title); title = NULL;
+    }
 
     //Force at least some minimal margins on the pages that print
     gtk_print_operation_set_default_page_setup (operation, NULL);
     gtk_print_operation_set_use_full_page (operation, FALSE);
-    gtk_print_operation_set_unit (operation, GTK_UNIT_MM);
+    gtk_print_operation_set_unit (operation, (data->job != NULL) ? GTK_UNIT_POINTS : GTK_UNIT_MM);
 
     if (_settings != NULL)
       gtk_print_operation_set_print_settings (operation, _settings);
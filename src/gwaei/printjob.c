@@ -0,0 +1,576 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file printjob.c
+//!
+//! @brief Lays out the results of a search into pages for printing.  The
+//!        results are read back from the dictionary file by a copy of the
+//!        search that replays its snapshot, so the text buffer of the search
+//!        window isn't needed and duplicates and variants come out the same.
+//!        Pages are laid out one result at a time in a thread with its own
+//!        font map, and only the finished markup of each page is handed to
+//!        the main loop to draw.  Without a window the pages can be rendered
+//!        straight to a PDF file with Cairo.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdarg.h>
+
+#include <gtk/gtk.h>
+#include <cairo-pdf.h>
+
+#include <gwaei/gwaei.h>
+#include <gwaei/gettext.h>
+
+
+//!
+//! @brief Creates a new print job for the results of a search
+//! @param search The LwSearch whose results should be printed.  Only the
+//!               results found so far are taken.
+//! @param TITLE The title drawn at the top of each page or NULL
+//! @returns An allocated GwPrintJob that should be freed with gw_printjob_free
+//!
+GwPrintJob*
+gw_printjob_new (LwSearch *search, const gchar *TITLE)
+{
+    //Sanity checks
+    g_return_val_if_fail (search != NULL, NULL);
+    g_return_val_if_fail (search->dictionary != NULL, NULL);
+
+    //Declarations
+    GwPrintJob *job;
+
+    //Initializations
+    job = g_new0 (GwPrintJob, 1);
+    job->dictionary = LW_DICTIONARY (g_object_ref (search->dictionary));
+    job->search = lw_search_new_from_snapshot (search);
+    job->title = g_strdup ((TITLE != NULL) ? TITLE : "");
+    job->pages = g_ptr_array_new_with_free_func (g_free);
+    g_mutex_init (&job->mutex);
+
+    return job;
+}
+
+
+//!
+//! @brief Frees a GwPrintJob, canceling and waiting for the layout thread first
+//! @param job The GwPrintJob to free
+//!
+void
+gw_printjob_free (GwPrintJob *job)
+{
+    //Sanity checks
+    if (job == NULL) return;
+
+    gw_printjob_cancel (job);
+    if (job->thread != NULL) g_thread_join (job->thread); job->thread = NULL;
+
+    g_ptr_array_free (job->pages, TRUE); job->pages = NULL;
+    if (job->search != NULL) lw_search_free (job->search); job->search = NULL;
+    g_object_unref (job->dictionary); job->dictionary = NULL;
+    if (job->title != NULL) g_free (job->title); job->title = NULL;
+    g_mutex_clear (&job->mutex);
+
+    g_free (job);
+}
+
+
+//!
+//! @brief Appends to the markup of a result.  The arguments are escaped since
+//!        the text of the dictionaries isn't markup.
+//!
+static void
+gw_printjob_append_markup (GString *markup, const gchar *FORMAT, ...)
+{
+    //Declarations
+    va_list args;
+    gchar *text;
+
+    va_start (args, FORMAT);
+    text = g_markup_vprintf_escaped (FORMAT, args);
+    va_end (args);
+
+    g_string_append (markup, text);
+    g_free (text);
+}
+
+
+static void
+gw_printjob_append_edict_result (GString *markup, LwResult *result)
+{
+    //Declarations
+    LwResultVariant *variant;
+    GList *link;
+    gint i;
+
+    if (result->kanji_start != NULL)
+      gw_printjob_append_markup (markup, "<b>%s</b>", result->kanji_start);
+    if (result->furigana_start != NULL)
+      gw_printjob_append_markup (markup, " [%s]", result->furigana_start);
+    if (result->classification_start != NULL)
+      gw_printjob_append_markup (markup, " <i>%s</i>", result->classification_start);
+    if (result->important)
+      g_string_append (markup, " P");
+    for (link = result->variants; link != NULL; link = link->next)
+    {
+      variant = LW_RESULTVARIANT (link->data);
+      gw_printjob_append_markup (markup, " / <b>%s</b>", (variant->kanji_start != NULL) ? variant->kanji_start : "");
+      if (variant->furigana_start != NULL)
+        gw_printjob_append_markup (markup, " [%s]", variant->furigana_start);
+    }
+
+    for (i = 0; i < result->def_total; i++)
+    {
+      g_string_append (markup, "\n      ");
+      if (result->number[i] != NULL) gw_printjob_append_markup (markup, "<b>%s</b> ", result->number[i]);
+      if (result->def_start[i] != NULL) gw_printjob_append_markup (markup, "%s", result->def_start[i]);
+    }
+}
+
+
+static void
+gw_printjob_append_kanjidict_result (GString *markup, LwResult *result)
+{
+    if (result->kanji != NULL)
+      gw_printjob_append_markup (markup, "<span size=\"xx-large\">%s</span>", result->kanji);
+    if (result->radicals != NULL)
+      gw_printjob_append_markup (markup, "\n<b>%s</b>%s", gettext("Radicals:"), result->radicals);
+    if (result->strokes != NULL)
+      gw_printjob_append_markup (markup, "\n<b>%s</b>%s", gettext("Stroke:"), result->strokes);
+    if (result->frequency != NULL)
+      gw_printjob_append_markup (markup, "  <b>%s</b>%s", gettext("Freq:"), result->frequency);
+    if (result->grade != NULL)
+      gw_printjob_append_markup (markup, "  <b>%s</b>%s", gettext("Grade:"), result->grade);
+    if (result->jlpt != NULL)
+      gw_printjob_append_markup (markup, "  <b>%s</b>%s", gettext("JLPT:"), result->jlpt);
+    if (result->readings[0] != NULL)
+      gw_printjob_append_markup (markup, "\n<b>%s</b>%s", gettext("Readings:"), result->readings[0]);
+    if (result->readings[1] != NULL)
+      gw_printjob_append_markup (markup, "\n<b>%s</b>%s", gettext("Name:"), result->readings[1]);
+    if (result->readings[2] != NULL)
+      gw_printjob_append_markup (markup, "\n<b>%s</b>%s", gettext("Radical Name:"), result->readings[2]);
+    if (result->meanings != NULL)
+      gw_printjob_append_markup (markup, "\n<b>%s</b>%s", gettext("Meanings:"), result->meanings);
+}
+
+
+static void
+gw_printjob_append_examplesdict_result (GString *markup, LwResult *result)
+{
+    if (result->def_start[0] != NULL)
+      gw_printjob_append_markup (markup, "<b>%s</b>%s", gettext("E:\t"), result->def_start[0]);
+    if (result->kanji_start != NULL)
+      gw_printjob_append_markup (markup, "\n<b>%s</b>%s", gettext("J:\t"), result->kanji_start);
+    if (result->furigana_start != NULL)
+      gw_printjob_append_markup (markup, "\n<b>%s</b>%s", gettext("D:\t"), result->furigana_start);
+}
+
+
+//!
+//! @brief Gets the Pango markup of a parsed result
+//!
+static gchar*
+gw_printjob_get_result_markup (GwPrintJob *job, LwResult *result)
+{
+    //Declarations
+    GType type;
+    GString *markup;
+    gint length;
+
+    //Initializations
+    type = G_OBJECT_TYPE (job->dictionary);
+    markup = g_string_new (NULL);
+
+    if (g_type_is_a (type, LW_TYPE_EDICTIONARY))
+      gw_printjob_append_edict_result (markup, result);
+    else if (g_type_is_a (type, LW_TYPE_KANJIDICTIONARY))
+      gw_printjob_append_kanjidict_result (markup, result);
+    else if (g_type_is_a (type, LW_TYPE_EXAMPLEDICTIONARY))
+      gw_printjob_append_examplesdict_result (markup, result);
+    else
+      gw_printjob_append_markup (markup, "%s", result->text);
+
+    //Trailing newlines would throw off the measured height
+    length = markup->len;
+    while (length > 0 && markup->str[length - 1] == '\n') length--;
+    g_string_truncate (markup, length);
+
+    return g_string_free (markup, FALSE);
+}
+
+
+static void
+gw_printjob_add_page (GwPrintJob *job, GString *page)
+{
+    g_mutex_lock (&job->mutex);
+    g_ptr_array_add (job->pages, g_strdup (page->str));
+    g_mutex_unlock (&job->mutex);
+
+    g_string_truncate (page, 0);
+}
+
+
+//!
+//! @brief Lays out the results into pages.  Each result is measured on its
+//!        own, so the work only grows with the number of results.  Results
+//!        are never split over two pages.
+//! @param job The GwPrintJob to lay out
+//! @param width The width of the printable area of a page in points
+//! @param height The height of the printable area of a page in points
+//! @returns FALSE if the job was canceled or the query of the search couldn't
+//!          be parsed again
+//!
+gboolean
+gw_printjob_layout (GwPrintJob *job, gdouble width, gdouble height)
+{
+    //Sanity checks
+    g_return_val_if_fail (job != NULL, FALSE);
+
+    //Declarations
+    PangoFontMap *fontmap;
+    PangoContext *context;
+    PangoLayout *layout;
+    PangoFontDescription *desc;
+    LwResult *result;
+    GString *page;
+    gchar *markup;
+    gint result_height;
+    gint spacing;
+    gint page_height;
+    gint available;
+
+    //Initializations
+    job->width = width;
+    job->height = height;
+    if (job->search == NULL) goto errored;
+
+    //The lines go through the same checks as the search so duplicates are
+    //dropped and variants are grouped like in the search window
+    lw_search_start (job->search, FALSE);
+    g_atomic_int_set (&job->total, lw_search_get_total_results (job->search));
+
+    fontmap = pango_cairo_font_map_new ();
+    context = pango_font_map_create_context (fontmap);
+    pango_cairo_context_set_resolution (context, 72.0);
+    layout = pango_layout_new (context);
+    desc = pango_font_description_from_string (GW_PRINTJOB_RESULTS_FONT);
+    pango_layout_set_font_description (layout, desc);
+    pango_layout_set_width (layout, (gint) (width * PANGO_SCALE));
+    pango_layout_set_wrap (layout, PANGO_WRAP_WORD_CHAR);
+    page = g_string_new (NULL);
+    page_height = 0;
+    available = (gint) ((height - GW_PRINTJOB_HEADER_HEIGHT) * PANGO_SCALE);
+
+    while (!g_atomic_int_get (&job->cancel) && (result = lw_search_get_result (job->search)) != NULL)
+    {
+      markup = gw_printjob_get_result_markup (job, result);
+      pango_layout_set_markup (layout, markup, -1);
+      pango_layout_get_size (layout, NULL, &result_height);
+
+      //Results are separated by a blank line about as tall as one of their lines
+      spacing = (page->len > 0) ? result_height / MAX (pango_layout_get_line_count (layout), 1) : 0;
+      if (page->len > 0 && page_height + spacing + result_height > available)
+      {
+        gw_printjob_add_page (job, page);
+        page_height = 0;
+        spacing = 0;
+      }
+      if (page->len > 0) g_string_append (page, "\n\n");
+      g_string_append (page, markup);
+      page_height += spacing + result_height;
+
+      g_atomic_int_inc (&job->laid_out);
+      g_free (markup); markup = NULL;
+      lw_result_free (result); result = NULL;
+    }
+
+    if (page->len > 0 && !g_atomic_int_get (&job->cancel)) gw_printjob_add_page (job, page);
+
+    //Cleanup
+    g_string_free (page, TRUE);
+    pango_font_description_free (desc);
+    g_object_unref (layout);
+    g_object_unref (context);
+    g_object_unref (fontmap);
+
+errored:
+
+    g_atomic_int_set (&job->finished, TRUE);
+
+    return (job->search != NULL && !g_atomic_int_get (&job->cancel));
+}
+
+
+static gpointer
+gw_printjob_layout_thread (gpointer data)
+{
+    //Declarations
+    GwPrintJob *job;
+
+    //Initializations
+    job = GW_PRINTJOB (data);
+
+    gw_printjob_layout (job, job->width, job->height);
+
+    return NULL;
+}
+
+
+//!
+//! @brief Starts laying out the pages of a job in a thread.  Use
+//!        gw_printjob_is_finished to know when it is done.
+//! @param job The GwPrintJob to start
+//! @param width The width of the printable area of a page in points
+//! @param height The height of the printable area of a page in points
+//!
+void
+gw_printjob_start (GwPrintJob *job, gdouble width, gdouble height)
+{
+    //Sanity checks
+    g_return_if_fail (job != NULL);
+    g_return_if_fail (job->thread == NULL);
+
+    //Declarations
+    GError *error;
+
+    //Initializations
+    error = NULL;
+    job->width = width;
+    job->height = height;
+
+    job->thread = g_thread_try_new ("gwaei-printjob", gw_printjob_layout_thread, job, &error);
+    if (job->thread == NULL)
+    {
+      g_warning ("Thread Creation Error: %s\n", error->message);
+      g_error_free (error); error = NULL;
+      gw_printjob_layout (job, width, height);
+    }
+}
+
+
+//!
+//! @brief Asks the layout of a job to stop.  This doesn't wait for it.
+//! @param job The GwPrintJob to cancel
+//!
+void
+gw_printjob_cancel (GwPrintJob *job)
+{
+    g_return_if_fail (job != NULL);
+
+    g_atomic_int_set (&job->cancel, TRUE);
+}
+
+
+gboolean
+gw_printjob_is_finished (GwPrintJob *job)
+{
+    g_return_val_if_fail (job != NULL, TRUE);
+
+    return g_atomic_int_get (&job->finished);
+}
+
+
+//!
+//! @brief Gets how much of the layout is done
+//! @param job The GwPrintJob to check
+//! @returns A fraction between 0.0 and 1.0
+//!
+gdouble
+gw_printjob_get_progress (GwPrintJob *job)
+{
+    //Sanity checks
+    g_return_val_if_fail (job != NULL, 0.0);
+
+    //Declarations
+    gint total;
+
+    //Initializations
+    total = g_atomic_int_get (&job->total);
+
+    if (g_atomic_int_get (&job->finished)) return 1.0;
+    if (total == 0) return 0.0;
+
+    return ((gdouble) g_atomic_int_get (&job->laid_out) / (gdouble) total);
+}
+
+
+gint
+gw_printjob_get_n_pages (GwPrintJob *job)
+{
+    //Sanity checks
+    g_return_val_if_fail (job != NULL, 0);
+
+    //Declarations
+    gint n_pages;
+
+    g_mutex_lock (&job->mutex);
+    n_pages = job->pages->len;
+    g_mutex_unlock (&job->mutex);
+
+    return n_pages;
+}
+
+
+static void
+gw_printjob_draw_text (cairo_t *cr, const gchar *MARKUP, const gchar *FONT, gdouble x, gdouble y, gdouble width, PangoAlignment alignment)
+{
+    //Declarations
+    PangoLayout *layout;
+    PangoFontDescription *desc;
+
+    //Initializations
+    layout = pango_cairo_create_layout (cr);
+    desc = pango_font_description_from_string (FONT);
+
+    //Measure in points the same way gw_printjob_layout does
+    pango_cairo_context_set_resolution (pango_layout_get_context (layout), 72.0);
+    pango_layout_context_changed (layout);
+
+    pango_layout_set_font_description (layout, desc);
+    pango_layout_set_width (layout, (gint) (width * PANGO_SCALE));
+    pango_layout_set_wrap (layout, PANGO_WRAP_WORD_CHAR);
+    pango_layout_set_alignment (layout, alignment);
+    pango_layout_set_markup (layout, MARKUP, -1);
+
+    cairo_move_to (cr, x, y);
+    pango_cairo_show_layout (cr, layout);
+
+    //Cleanup
+    pango_font_description_free (desc);
+    g_object_unref (layout);
+}
+
+
+//!
+//! @brief Draws a laid out page.  The units of the cairo context should be points.
+//! @param job The GwPrintJob to draw from
+//! @param cr The cairo context to draw on
+//! @param page_nr The page to draw starting from 0
+//!
+void
+gw_printjob_draw_page (GwPrintJob *job, cairo_t *cr, gint page_nr)
+{
+    //Sanity checks
+    g_return_if_fail (job != NULL);
+    g_return_if_fail (cr != NULL);
+
+    //Declarations
+    gchar *markup;
+    gchar *number;
+    gchar *title;
+    gint n_pages;
+
+    //Initializations
+    g_mutex_lock (&job->mutex);
+    n_pages = job->pages->len;
+    markup = (page_nr >= 0 && page_nr < n_pages) ? g_strdup (g_ptr_array_index (job->pages, page_nr)) : NULL;
+    g_mutex_unlock (&job->mutex);
+    if (markup == NULL) return;
+    number = g_strdup_printf (gettext("Page %d/%d"), page_nr + 1, n_pages);
+    title = g_markup_printf_escaped ("<b>%s</b>", job->title);
+
+    cairo_set_source_rgb (cr, 0.0, 0.0, 0.0);
+    gw_printjob_draw_text (cr, title, GW_PRINTJOB_HEADER_FONT, 0.0, 0.0, job->width, PANGO_ALIGN_LEFT);
+    gw_printjob_draw_text (cr, number, GW_PRINTJOB_HEADER_FONT, 0.0, 0.0, job->width, PANGO_ALIGN_RIGHT);
+    gw_printjob_draw_text (cr, markup, GW_PRINTJOB_RESULTS_FONT, 0.0, GW_PRINTJOB_HEADER_HEIGHT, job->width, PANGO_ALIGN_LEFT);
+
+    //Cleanup
+    g_free (title);
+    g_free (number);
+    g_free (markup);
+}
+
+
+//!
+//! @brief Renders all of the results of a job to a PDF file.  This doesn't
+//!        need a display so it can be used for batch exports.  The layout
+//!        runs in the calling thread and can be stopped with gw_printjob_cancel.
+//! @param job A GwPrintJob that hasn't been started
+//! @param FILENAME The path of the PDF file to write
+//! @param width The width of the paper in points
+//! @param height The height of the paper in points
+//! @param error A GError to set if something goes wrong
+//! @returns TRUE if the file was written
+//!
+gboolean
+gw_printjob_export_pdf (GwPrintJob *job, const gchar *FILENAME, gdouble width, gdouble height, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (job != NULL, FALSE);
+    g_return_val_if_fail (job->thread == NULL, FALSE);
+    g_return_val_if_fail (FILENAME != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    const gdouble MARGIN = 36.0;
+    cairo_surface_t *surface;
+    cairo_t *cr;
+    cairo_status_t status;
+    gint n_pages;
+    gint i;
+
+    if (!gw_printjob_layout (job, width - MARGIN * 2, height - MARGIN * 2))
+    {
+      if (!g_atomic_int_get (&job->cancel))
+      {
+        g_set_error (error, g_quark_from_string (LW_IO_ERROR), LW_IO_READ_ERROR,
+          gettext("Could not open the dictionary file of the results")
+        );
+      }
+      return FALSE;
+    }
+
+    //Initializations
+    surface = cairo_pdf_surface_create (FILENAME, width, height);
+    cr = cairo_create (surface);
+    n_pages = gw_printjob_get_n_pages (job);
+
+    for (i = 0; i < n_pages && !g_atomic_int_get (&job->cancel); i++)
+    {
+      cairo_save (cr);
+      cairo_translate (cr, MARGIN, MARGIN);
+      gw_printjob_draw_page (job, cr, i);
+      cairo_restore (cr);
+      cairo_show_page (cr);
+    }
+
+    //Cleanup
+    cairo_destroy (cr);
+    cairo_surface_finish (surface);
+    status = cairo_surface_status (surface);
+    cairo_surface_destroy (surface);
+
+    if (status != CAIRO_STATUS_SUCCESS)
+    {
+      g_set_error (error, g_quark_from_string (LW_IO_ERROR), LW_IO_WRITE_ERROR,
+        "%s: %s", FILENAME, cairo_status_to_string (status)
+      );
+      return FALSE;
+    }
+
+    return !g_atomic_int_get (&job->cancel);
+}
@@ -84,7 +84,7 @@ gw_radicalswindow_toggled_cb (GtkWidget *widget, gpointer data)
     g_return_if_fail (window != NULL);
     klass = GW_RADICALSWINDOW_CLASS (G_OBJECT_GET_CLASS (window));
 
-    gw_radicalswindow_update_sensitivities (window, NULL);
+    gw_radicalswindow_sync_sensitivities (window);
 
     g_signal_emit (
       G_OBJECT (window), 
@@ -113,7 +113,7 @@ gw_radicalswindow_strokes_checkbox_toggled_cb (GtkWidget *widget, gpointer data)
     priv = window->priv;
     request = gtk_toggle_button_get_active (priv->strokes_checkbutton);
 
-    gw_radicalswindow_update_sensitivities (window, NULL);
+    gw_radicalswindow_sync_sensitivities (window);
     gtk_widget_set_sensitive (GTK_WIDGET (priv->strokes_spinbutton), request);
 
     g_signal_emit (
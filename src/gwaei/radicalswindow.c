@@ -35,6 +35,7 @@
 #include <gtk/gtk.h>
 
 #include <libwaei/libwaei.h>
+#include <gwaei/gwaei.h>
 #include <gwaei/gettext.h>
 #include <gwaei/radicalswindow.h>
 #include <gwaei/radicalswindow-private.h>
@@ -42,6 +43,7 @@
 
 static void gw_radicalswindow_fill_radicals (GwRadicalsWindow*);
 static void gw_radicalswindow_init_accelerators (GwRadicalsWindow*);
+static gboolean gw_radicalswindow_index_timeout (gpointer);
 
 static char *_radical_array[][5] =
 {
@@ -351,11 +353,14 @@ gw_radicalswindow_init (GwRadicalsWindow *window)
 static void 
 gw_radicalswindow_finalize (GObject *object)
 {
-/*
     GwRadicalsWindow *window;
+    GwRadicalsWindowPrivate *priv;
 
     window = GW_RADICALSWINDOW (object);
-*/
+    priv = window->priv;
+
+    if (priv->index_timeoutid != 0) g_source_remove (priv->index_timeoutid); priv->index_timeoutid = 0;
+
     G_OBJECT_CLASS (gw_radicalswindow_parent_class)->finalize (object);
 }
 
@@ -705,6 +710,156 @@ gw_radicalswindow_update_sensitivities (GwRadicalsWindow *window, const gchar *T
     g_list_free (grouplist); grouplist = NULL;
 }
 
+//!
+//! @brief Gets the radical index of the Kanji dictionary.  It is loaded in
+//!        another thread, and the sensitivities are synced again once it is
+//!        ready.  It is asked for every time since the dictionary can be
+//!        reinstalled while the window is open.
+//! @returns A reference to the LwRadicalIndex to be released with
+//!          lw_radicalindex_unref or NULL if the Kanji dictionary isn't
+//!          installed or the index isn't loaded yet
+//!
+static LwRadicalIndex*
+gw_radicalswindow_get_index (GwRadicalsWindow *window)
+{
+    //Declarations
+    GwRadicalsWindowPrivate *priv;
+    GwApplication *application;
+    LwDictionaryList *dictionarylist;
+    LwDictionary *dictionary;
+    LwRadicalIndex *index;
+
+    //Initializations
+    priv = window->priv;
+    application = gw_window_get_application (GW_WINDOW (window));
+    dictionarylist = LW_DICTIONARYLIST (gw_application_get_installed_dictionarylist (application));
+    dictionary = lw_dictionarylist_get_dictionary (dictionarylist, LW_TYPE_KANJIDICTIONARY, "Kanji");
+    index = NULL;
+
+    if (dictionary != NULL)
+    {
+      index = lw_radicalindex_peek_for_dictionary (dictionary);
+      if (index == NULL && priv->index_timeoutid == 0)
+        priv->index_timeoutid = g_timeout_add_full (
+          G_PRIORITY_LOW,
+          250,
+          gw_radicalswindow_index_timeout,
+          window,
+          NULL
+        );
+    }
+
+    return index;
+}
+
+
+//!
+//! @brief Syncs the sensitivities once the radical index is loaded
+//!
+static gboolean
+gw_radicalswindow_index_timeout (gpointer data)
+{
+    //Declarations
+    GwRadicalsWindow *window;
+    GwRadicalsWindowPrivate *priv;
+    LwRadicalIndex *index;
+
+    //Initializations
+    window = GW_RADICALSWINDOW (data);
+    priv = window->priv;
+    priv->index_timeoutid = 0;
+
+    //Asking for the index again adds a new timeout if it still isn't ready
+    index = gw_radicalswindow_get_index (window);
+    if (index != NULL)
+    {
+      lw_radicalindex_unref (index); index = NULL;
+      gw_radicalswindow_sync_sensitivities (window);
+    }
+
+    return FALSE;
+}
+
+
+//!
+//! @brief Tells if the sensitivities come from the radical index instead of the search results
+//!
+gboolean
+gw_radicalswindow_has_index (GwRadicalsWindow *window)
+{
+    //Sanity checks
+    g_return_val_if_fail (window != NULL, FALSE);
+
+    //Declarations
+    LwRadicalIndex *index;
+    gboolean has_index;
+
+    //Initializations
+    index = gw_radicalswindow_get_index (window);
+    has_index = (index != NULL);
+
+    if (index != NULL) lw_radicalindex_unref (index); index = NULL;
+
+    return has_index;
+}
+
+
+//!
+//! @brief Makes only the radicals that still lead to kanji sensitive after the
+//!        selection changed.  Without a radical index, everything is made
+//!        insensitive until the search results come back.
+//!
+void
+gw_radicalswindow_sync_sensitivities (GwRadicalsWindow *window)
+{
+    //Sanity checks
+    g_return_if_fail (window != NULL);
+
+    //Declarations
+    GwRadicalsWindowPrivate *priv;
+    LwRadicalIndex *index;
+    gchar *selected;
+    gchar *possible;
+    gchar *text;
+    gint strokes;
+
+    //Initializations
+    priv = window->priv;
+    index = gw_radicalswindow_get_index (window);
+
+    if (index == NULL)
+    {
+      gw_radicalswindow_update_sensitivities (window, NULL);
+      return;
+    }
+
+    selected = gw_radicalswindow_strdup_selected (window);
+    strokes = 0;
+    if (gtk_toggle_button_get_active (priv->strokes_checkbutton))
+      strokes = (gint) gtk_spin_button_get_value (priv->strokes_spinbutton);
+
+    if (*selected == '\0' && strokes == 0)
+    {
+      gw_radicalswindow_deselect (window);
+    }
+    else
+    {
+      //The selected radicals stay sensitive so they can be unselected
+      possible = lw_radicalindex_strdup_possible_radicals (index, selected, strokes);
+      text = g_strjoin ("", possible, selected, NULL);
+
+      gw_radicalswindow_update_sensitivities (window, NULL);
+      gw_radicalswindow_update_sensitivities (window, text);
+
+      g_free (text); text = NULL;
+      g_free (possible); possible = NULL;
+    }
+
+    g_free (selected); selected = NULL;
+    lw_radicalindex_unref (index); index = NULL;
+}
+
+
 //!
 //! @brief Copies the stroke count in the prefered format
 //!
@@ -257,6 +257,7 @@ gw_searchwindow_get_iter_for_button_release_cb (GtkWidget      *widget,
       search = lw_search_new (dictionary, query, 0, &error);
       if (search != NULL && error == NULL)
       {
+        lw_search_set_priority (search, LW_SEARCH_PRIORITY_TOOLTIP);
         lw_search_start (search, TRUE);
         priv->mouse_item = search;
       }
@@ -1097,6 +1098,12 @@ gw_searchwindow_search_cb (GtkWidget *widget, gpointer data)
       return;
     }
 
+    //Typing more of the same query only has to look through what already matched
+    if (search != NULL && search->dictionary == dictionary)
+    {
+      lw_search_set_parent (new_item, search);
+    }
+
     if (priv->new_tab)
     {
       gw_searchwindow_new_tab (window);
@@ -1514,6 +1521,8 @@ gw_searchwindow_switch_tab_cb (GtkNotebook *notebook,
     GwSearchWindowPrivate *priv;
     LwSearch *search;
     GtkWidget *container;
+    LwSearchPriority priority;
+    gint i;
 
     //Initializations
     window = GW_SEARCHWINDOW (gtk_widget_get_ancestor (GTK_WIDGET (data), GW_TYPE_SEARCHWINDOW));
@@ -1521,6 +1530,16 @@ gw_searchwindow_switch_tab_cb (GtkNotebook *notebook,
     priv = window->priv;
     search = NULL;
 
+    //The search of the visible tab goes before the ones of hidden tabs
+    for (i = 0; i < gtk_notebook_get_n_pages (priv->notebook); i++)
+    {
+      container = gtk_notebook_get_nth_page (priv->notebook, i);
+      search = LW_SEARCH (g_object_get_data (G_OBJECT (container), "searchitem"));
+      priority = (i == page_num) ? LW_SEARCH_PRIORITY_INTERACTIVE : LW_SEARCH_PRIORITY_BACKGROUND;
+      if (search != NULL) lw_search_set_priority (search, priority);
+    }
+    search = NULL;
+
     container = gtk_notebook_get_nth_page (priv->notebook, page_num);
     if (container != NULL)
     {
@@ -164,9 +164,9 @@ gw_add_match_highlights (gint line, gint start_offset, gint end_offset, LwSearch
     GtkTextIter start_iter;
     GtkTextIter end_iter;
     gchar *text;
-    GRegex *regex;
+    LwMatcher *matcher;
     GList *link;
-    GMatchInfo *match_info;
+    gint offset;
 
     //Initializations
     sdata = GW_SEARCHDATA (lw_search_get_data (search));
@@ -177,24 +177,27 @@ gw_add_match_highlights (gint line, gint start_offset, gint end_offset, LwSearch
     gtk_text_buffer_get_iter_at_line_offset (buffer, &end_iter, line, end_offset);
     text = gtk_text_buffer_get_slice (buffer, &start_iter, &end_iter, FALSE);
 
+    //A GtkTextBuffer only holds valid UTF-8, so the matcher doesn't check
+    //the text again on every call of the loops below
+
     //Look for kanji atoms
     link = lw_query_regexgroup_get (query, LW_QUERY_TYPE_KANJI, LW_RELEVANCE_LOW);
     while (link != NULL)
     {
-      regex = link->data;
-      if (regex != NULL && g_regex_match (regex, text, 0, &match_info))
-      { 
-        while (g_match_info_matches (match_info))
-        {
-          g_match_info_fetch_pos (match_info, 0, &match_start_byte_offset, &match_end_byte_offset);
-          match_character_offset = g_utf8_pointer_to_offset (text, text + match_start_byte_offset);
-          gtk_text_buffer_get_iter_at_line_offset (buffer, &start_iter, line, match_character_offset + start_offset);
-          match_character_offset = g_utf8_pointer_to_offset (text, text + match_end_byte_offset);
-          gtk_text_buffer_get_iter_at_line_offset (buffer, &end_iter, line, match_character_offset + start_offset);
-          gtk_text_buffer_apply_tag_by_name (buffer, "match", &start_iter, &end_iter);
-          g_match_info_next (match_info, NULL);
-        }
-        g_match_info_free (match_info); match_info = NULL;
+      matcher = link->data;
+      offset = 0;
+      while (matcher != NULL && lw_matcher_find_full (matcher, text, offset, LW_MATCHER_FLAG_VALID_UTF8, &match_start_byte_offset, &match_end_byte_offset))
+      {
+        match_character_offset = g_utf8_pointer_to_offset (text, text + match_start_byte_offset);
+        gtk_text_buffer_get_iter_at_line_offset (buffer, &start_iter, line, match_character_offset + start_offset);
+        match_character_offset = g_utf8_pointer_to_offset (text, text + match_end_byte_offset);
+        gtk_text_buffer_get_iter_at_line_offset (buffer, &end_iter, line, match_character_offset + start_offset);
+        gtk_text_buffer_apply_tag_by_name (buffer, "match", &start_iter, &end_iter);
+
+        //An empty match would be found again at the same place
+        if (match_end_byte_offset > match_start_byte_offset) offset = match_end_byte_offset;
+        else if (text[match_end_byte_offset] != '\0') offset = g_utf8_next_char (text + match_end_byte_offset) - text;
+        else break;
       }
       link = link->next;
     }
@@ -203,20 +206,20 @@ gw_add_match_highlights (gint line, gint start_offset, gint end_offset, LwSearch
     link = lw_query_regexgroup_get (query, LW_QUERY_TYPE_FURIGANA, LW_RELEVANCE_LOW);
     while (link != NULL)
     {
-      regex = link->data;
-      if (regex != NULL && g_regex_match (regex, text, 0, &match_info))
-      { 
-        while (g_match_info_matches (match_info))
-        {
-          g_match_info_fetch_pos (match_info, 0, &match_start_byte_offset, &match_end_byte_offset);
-          match_character_offset = g_utf8_pointer_to_offset (text, text + match_start_byte_offset);
-          gtk_text_buffer_get_iter_at_line_offset (buffer, &start_iter, line, match_character_offset + start_offset);
-          match_character_offset = g_utf8_pointer_to_offset (text, text + match_end_byte_offset);
-          gtk_text_buffer_get_iter_at_line_offset (buffer, &end_iter, line, match_character_offset + start_offset);
-          gtk_text_buffer_apply_tag_by_name (buffer, "match", &start_iter, &end_iter);
-          g_match_info_next (match_info, NULL);
-        }
-        g_match_info_free (match_info); match_info = NULL;
+      matcher = link->data;
+      offset = 0;
+      while (matcher != NULL && lw_matcher_find_full (matcher, text, offset, LW_MATCHER_FLAG_VALID_UTF8, &match_start_byte_offset, &match_end_byte_offset))
+      {
+        match_character_offset = g_utf8_pointer_to_offset (text, text + match_start_byte_offset);
+        gtk_text_buffer_get_iter_at_line_offset (buffer, &start_iter, line, match_character_offset + start_offset);
+        match_character_offset = g_utf8_pointer_to_offset (text, text + match_end_byte_offset);
+        gtk_text_buffer_get_iter_at_line_offset (buffer, &end_iter, line, match_character_offset + start_offset);
+        gtk_text_buffer_apply_tag_by_name (buffer, "match", &start_iter, &end_iter);
+
+        //An empty match would be found again at the same place
+        if (match_end_byte_offset > match_start_byte_offset) offset = match_end_byte_offset;
+        else if (text[match_end_byte_offset] != '\0') offset = g_utf8_next_char (text + match_end_byte_offset) - text;
+        else break;
       }
       link = link->next;
     }
@@ -225,20 +228,20 @@ gw_add_match_highlights (gint line, gint start_offset, gint end_offset, LwSearch
     link = lw_query_regexgroup_get (query, LW_QUERY_TYPE_ROMAJI, LW_RELEVANCE_LOW);
     while (link != NULL)
     {
-      regex = link->data;
-      if (regex != NULL && g_regex_match (regex, text, 0, &match_info))
+      matcher = link->data;
+      offset = 0;
+      while (matcher != NULL && lw_matcher_find_full (matcher, text, offset, LW_MATCHER_FLAG_VALID_UTF8, &match_start_byte_offset, &match_end_byte_offset))
       {
-        while (g_match_info_matches (match_info))
-        {
-          g_match_info_fetch_pos (match_info, 0, &match_start_byte_offset, &match_end_byte_offset);
-          match_character_offset = g_utf8_pointer_to_offset (text, text + match_start_byte_offset);
-          gtk_text_buffer_get_iter_at_line_offset (buffer, &start_iter, line, match_character_offset + start_offset);
-          match_character_offset = g_utf8_pointer_to_offset (text, text + match_end_byte_offset);
-          gtk_text_buffer_get_iter_at_line_offset (buffer, &end_iter, line, match_character_offset + start_offset);
-          gtk_text_buffer_apply_tag_by_name (buffer, "match", &start_iter, &end_iter);
-          g_match_info_next (match_info, NULL);
-        }
-        g_match_info_free (match_info); match_info = NULL;
+        match_character_offset = g_utf8_pointer_to_offset (text, text + match_start_byte_offset);
+        gtk_text_buffer_get_iter_at_line_offset (buffer, &start_iter, line, match_character_offset + start_offset);
+        match_character_offset = g_utf8_pointer_to_offset (text, text + match_end_byte_offset);
+        gtk_text_buffer_get_iter_at_line_offset (buffer, &end_iter, line, match_character_offset + start_offset);
+        gtk_text_buffer_apply_tag_by_name (buffer, "match", &start_iter, &end_iter);
+
+        //An empty match would be found again at the same place
+        if (match_end_byte_offset > match_start_byte_offset) offset = match_end_byte_offset;
+        else if (text[match_end_byte_offset] != '\0') offset = g_utf8_next_char (text + match_end_byte_offset) - text;
+        else break;
       }
       link = link->next;
     }
@@ -247,20 +250,20 @@ gw_add_match_highlights (gint line, gint start_offset, gint end_offset, LwSearch
     link = lw_query_regexgroup_get (query, LW_QUERY_TYPE_MIX, LW_RELEVANCE_LOW);
     while (link != NULL)
     {
-      regex = link->data;
-      if (regex != NULL && g_regex_match (regex, text, 0, &match_info))
+      matcher = link->data;
+      offset = 0;
+      while (matcher != NULL && lw_matcher_find_full (matcher, text, offset, LW_MATCHER_FLAG_VALID_UTF8, &match_start_byte_offset, &match_end_byte_offset))
       {
-        while (g_match_info_matches (match_info))
-        {
-          g_match_info_fetch_pos (match_info, 0, &match_start_byte_offset, &match_end_byte_offset);
-          match_character_offset = g_utf8_pointer_to_offset (text, text + match_start_byte_offset);
-          gtk_text_buffer_get_iter_at_line_offset (buffer, &start_iter, line, match_character_offset + start_offset);
-          match_character_offset = g_utf8_pointer_to_offset (text, text + match_end_byte_offset);
-          gtk_text_buffer_get_iter_at_line_offset (buffer, &end_iter, line, match_character_offset + start_offset);
-          gtk_text_buffer_apply_tag_by_name (buffer, "match", &start_iter, &end_iter);
-          g_match_info_next (match_info, NULL);
-        }
-        g_match_info_free (match_info); match_info = NULL;
+        match_character_offset = g_utf8_pointer_to_offset (text, text + match_start_byte_offset);
+        gtk_text_buffer_get_iter_at_line_offset (buffer, &start_iter, line, match_character_offset + start_offset);
+        match_character_offset = g_utf8_pointer_to_offset (text, text + match_end_byte_offset);
+        gtk_text_buffer_get_iter_at_line_offset (buffer, &end_iter, line, match_character_offset + start_offset);
+        gtk_text_buffer_apply_tag_by_name (buffer, "match", &start_iter, &end_iter);
+
+        //An empty match would be found again at the same place
+        if (match_end_byte_offset > match_start_byte_offset) offset = match_end_byte_offset;
+        else if (text[match_end_byte_offset] != '\0') offset = g_utf8_next_char (text + match_end_byte_offset) - text;
+        else break;
       }
       link = link->next;
     }
@@ -411,6 +414,38 @@ gw_searchwindow_append_def_same_to_buffer (GwSearchWindow *window, LwSearch* sea
 }
 
 
+//!
+//! @brief PRIVATE FUNCTION.  Adds the headword of an entry that libwaei grouped
+//!        under a result after the headword of the result.
+//!
+static void
+gw_searchwindow_append_variant_to_buffer (GwSearchWindow *window, LwSearch *search, LwResult *result, LwResultVariant *variant)
+{
+    //Declarations
+    LwResult *temp;
+    gint i;
+
+    //Initializations
+    temp = lw_result_new ();
+    if (temp == NULL) return;
+
+    for (i = 0; i <= result->def_total && i < G_N_ELEMENTS (temp->def_start); i++)
+    {
+      temp->def_start[i] = result->def_start[i];
+      temp->number[i] = result->number[i];
+    }
+    temp->def_total = result->def_total;
+    temp->kanji_start = variant->kanji_start;
+    temp->furigana_start = variant->furigana_start;
+    temp->classification_start = variant->classification_start;
+    temp->important = variant->important;
+
+    gw_searchwindow_append_def_same_to_buffer (window, search, temp);
+
+    lw_result_free (temp);
+}
+
+
 gboolean lw_search_next_is_same (LwSearch *search, LwResult *current)
 {
   //Declarations
@@ -448,6 +483,7 @@ gw_searchwindow_append_edict_result (GwSearchWindow *window, LwSearch *search)
     GtkTextBuffer *buffer;
     GtkTextMark *mark;
     GtkTextIter iter;
+    GList *link;
     int line, start_offset, end_offset;
 
     //Initializations
@@ -461,6 +497,10 @@ gw_searchwindow_append_edict_result (GwSearchWindow *window, LwSearch *search)
     if (lw_search_next_is_same (search, result))
     {
       gw_searchwindow_append_def_same_to_buffer (window, search, result);
+      for (link = result->variants; link != NULL; link = link->next)
+      {
+        gw_searchwindow_append_variant_to_buffer (window, search, result, LW_RESULTVARIANT (link->data));
+      }
       gw_searchdata_set_result (sdata, result);
       return;
     }
@@ -529,6 +569,12 @@ gw_searchwindow_append_edict_result (GwSearchWindow *window, LwSearch *search)
       g_quark_from_static_string ("edict"), 
       result
     );
+
+    //Entries with the same definitions that libwaei grouped under this one
+    for (link = result->variants; link != NULL; link = link->next)
+    {
+      gw_searchwindow_append_variant_to_buffer (window, search, result, LW_RESULTVARIANT (link->data));
+    }
 }
 
 
@@ -712,7 +758,7 @@ gw_searchwindow_append_kanjidict_result (GwSearchWindow *window, LwSearch *searc
     {
       GwRadicalsWindow *radicalswindow;
       radicalswindow =  GW_RADICALSWINDOW (gw_application_get_window_by_type (application, GW_TYPE_RADICALSWINDOW));
-      if (radicalswindow != NULL && result->radicals != NULL)
+      if (radicalswindow != NULL && !gw_radicalswindow_has_index (radicalswindow))
       {
         gw_radicalswindow_update_sensitivities (radicalswindow, result->radicals);
       }
@@ -103,6 +103,7 @@ gw_searchwindow_finalize (GObject *object)
 #ifdef WITH_HUNSPELL
     if (priv->spellcheck) g_object_unref (priv->spellcheck); priv->spellcheck = NULL;
 #endif
+    if (priv->history) lw_history_save (LW_HISTORY (priv->history), NULL, NULL);
     if (priv->history) g_object_unref (priv->history); priv->history = NULL;
     if (priv->keep_searching_query) g_free (priv->keep_searching_query); priv->keep_searching_query = NULL;
 
@@ -251,6 +252,12 @@ gw_searchwindow_constructed (GObject *object)
     priv->statusbar_progressbar = GTK_PROGRESS_BAR (gw_window_get_object (GW_WINDOW (window), "statusbar_progressbar"));
 
     priv->history = gw_history_new (20);
+    lw_history_load (
+      LW_HISTORY (priv->history), 
+      LW_DICTIONARYLIST (gw_application_get_installed_dictionarylist (application)), 
+      NULL, 
+      NULL
+    );
 
     gw_searchwindow_initialize_toolbar (window);
     gw_searchwindow_initialize_search_toolbar (window);
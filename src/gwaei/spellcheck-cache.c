@@ -0,0 +1,302 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file spellcheck-cache.c
+//!
+//! @brief A least recently used cache of Hunspell answers shared by the
+//!        spellcheck worker thread and the main loop.  It doesn't need
+//!        Hunspell or GTK so it can be checked on its own.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+
+#include <gwaei/spellcheck-cache.h>
+
+
+static void
+gw_spellcheck_cache_entry_free (gpointer data)
+{
+    //Declarations
+    GwSpellcheckCacheEntry *entry;
+
+    //Initializations
+    entry = (GwSpellcheckCacheEntry*) data;
+
+    if (entry->suggestions != NULL) g_strfreev (entry->suggestions); entry->suggestions = NULL;
+    g_free (entry->word); entry->word = NULL;
+    g_free (entry);
+}
+
+
+//!
+//! @brief Creates an empty cache
+//! @param size The most words to remember before the least recently used
+//!             ones are dropped
+//! @returns A GwSpellcheckCache to be freed with gw_spellcheck_cache_free
+//!
+GwSpellcheckCache*
+gw_spellcheck_cache_new (guint size)
+{
+    //Sanity checks
+    g_return_val_if_fail (size > 0, NULL);
+
+    //Declarations
+    GwSpellcheckCache *cache;
+
+    //Initializations
+    cache = g_new0 (GwSpellcheckCache, 1);
+    cache->table = g_hash_table_new_full (g_str_hash, g_str_equal, NULL, gw_spellcheck_cache_entry_free);
+    cache->size = size;
+    g_queue_init (&cache->order);
+    g_mutex_init (&cache->mutex);
+
+    return cache;
+}
+
+
+void
+gw_spellcheck_cache_free (GwSpellcheckCache *cache)
+{
+    //Sanity checks
+    g_return_if_fail (cache != NULL);
+
+    g_queue_clear (&cache->order);
+    g_hash_table_unref (cache->table); cache->table = NULL;
+    g_mutex_clear (&cache->mutex);
+
+    g_free (cache);
+}
+
+
+//!
+//! @brief Empties the cache of Hunspell answers, for when the dictionary changes
+//!
+void
+gw_spellcheck_cache_clear (GwSpellcheckCache *cache)
+{
+    //Sanity checks
+    g_return_if_fail (cache != NULL);
+
+    g_mutex_lock (&cache->mutex);
+    g_queue_clear (&cache->order);
+    g_hash_table_remove_all (cache->table);
+    cache->generation++;
+    g_mutex_unlock (&cache->mutex);
+}
+
+
+//!
+//! @brief Gets the number of words in the cache
+//!
+guint
+gw_spellcheck_cache_length (GwSpellcheckCache *cache)
+{
+    //Sanity checks
+    g_return_val_if_fail (cache != NULL, 0);
+
+    //Declarations
+    guint length;
+
+    g_mutex_lock (&cache->mutex);
+    length = g_hash_table_size (cache->table);
+    g_mutex_unlock (&cache->mutex);
+
+    return length;
+}
+
+
+//!
+//! @brief Looks up if the word was checked recently, and moves it to the front if so
+//! @param cache The GwSpellcheckCache to look in
+//! @param WORD The word to look up
+//! @param correct Set to if the word is spelled correctly when found
+//! @param generation Set to the generation of the cache to hand back to gw_spellcheck_cache_insert
+//! @returns TRUE if the word was in the cache
+//!
+gboolean
+gw_spellcheck_cache_lookup (GwSpellcheckCache *cache, const gchar *WORD, gboolean *correct, guint *generation)
+{
+    //Sanity checks
+    g_return_val_if_fail (cache != NULL, FALSE);
+    g_return_val_if_fail (WORD != NULL, FALSE);
+
+    //Declarations
+    GwSpellcheckCacheEntry *entry;
+
+    g_mutex_lock (&cache->mutex);
+    entry = (GwSpellcheckCacheEntry*) g_hash_table_lookup (cache->table, WORD);
+    if (entry != NULL)
+    {
+      g_queue_unlink (&cache->order, entry->link);
+      g_queue_push_head_link (&cache->order, entry->link);
+      *correct = entry->correct;
+    }
+    *generation = cache->generation;
+    g_mutex_unlock (&cache->mutex);
+
+    return (entry != NULL);
+}
+
+
+//!
+//! @brief Remembers a Hunspell answer, dropping the least recently used one when full
+//! @param cache The GwSpellcheckCache to add to
+//! @param WORD The word that was checked
+//! @param correct If the word is spelled correctly
+//! @param generation The generation the answer was looked up in, so answers
+//!                   from a dictionary that has since been swapped out are ignored
+//!
+void
+gw_spellcheck_cache_insert (GwSpellcheckCache *cache, const gchar *WORD, gboolean correct, guint generation)
+{
+    //Sanity checks
+    g_return_if_fail (cache != NULL);
+    g_return_if_fail (WORD != NULL);
+
+    //Declarations
+    GwSpellcheckCacheEntry *entry;
+    GList *link;
+
+    g_mutex_lock (&cache->mutex);
+    if (generation == cache->generation && g_hash_table_lookup (cache->table, WORD) == NULL)
+    {
+      entry = g_new0 (GwSpellcheckCacheEntry, 1);
+      entry->word = g_strdup (WORD);
+      entry->correct = correct;
+      g_queue_push_head (&cache->order, entry);
+      entry->link = cache->order.head;
+      g_hash_table_insert (cache->table, entry->word, entry);
+
+      if (g_queue_get_length (&cache->order) > cache->size)
+      {
+        link = g_queue_pop_tail_link (&cache->order);
+        entry = (GwSpellcheckCacheEntry*) link->data;
+        g_list_free_1 (link);
+        g_hash_table_remove (cache->table, entry->word);
+      }
+    }
+    g_mutex_unlock (&cache->mutex);
+}
+
+
+//!
+//! @brief Forgets the answer for a word, for when it is added to the dictionary
+//!
+void
+gw_spellcheck_cache_remove (GwSpellcheckCache *cache, const gchar *WORD)
+{
+    //Sanity checks
+    g_return_if_fail (cache != NULL);
+    g_return_if_fail (WORD != NULL);
+
+    //Declarations
+    GwSpellcheckCacheEntry *entry;
+
+    g_mutex_lock (&cache->mutex);
+    entry = (GwSpellcheckCacheEntry*) g_hash_table_lookup (cache->table, WORD);
+    if (entry != NULL)
+    {
+      g_queue_delete_link (&cache->order, entry->link);
+      g_hash_table_remove (cache->table, WORD);
+    }
+    g_mutex_unlock (&cache->mutex);
+}
+
+
+//!
+//! @brief Stores the suggestions for a cached misspelled word
+//! @param suggestions A NULL terminated array the cache takes ownership of
+//!
+void
+gw_spellcheck_cache_set_suggestions (GwSpellcheckCache *cache, const gchar *WORD, gchar **suggestions, guint generation)
+{
+    //Sanity checks
+    g_return_if_fail (cache != NULL);
+    g_return_if_fail (WORD != NULL);
+
+    //Declarations
+    GwSpellcheckCacheEntry *entry;
+
+    g_mutex_lock (&cache->mutex);
+    entry = (GwSpellcheckCacheEntry*) g_hash_table_lookup (cache->table, WORD);
+    if (generation == cache->generation && entry != NULL && entry->suggestions == NULL)
+    {
+      entry->suggestions = suggestions;
+      suggestions = NULL;
+    }
+    g_mutex_unlock (&cache->mutex);
+
+    if (suggestions != NULL) g_strfreev (suggestions);
+}
+
+
+//!
+//! @brief Gets the suggestions the worker looked up for a misspelled word
+//! @returns A copy of the suggestions to be freed with g_strfreev or NULL
+//!          if they haven't been looked up yet
+//!
+gchar**
+gw_spellcheck_cache_get_suggestions (GwSpellcheckCache *cache, const gchar *WORD)
+{
+    //Sanity checks
+    g_return_val_if_fail (cache != NULL, NULL);
+    g_return_val_if_fail (WORD != NULL, NULL);
+
+    //Declarations
+    GwSpellcheckCacheEntry *entry;
+    gchar **suggestions;
+
+    //Initializations
+    suggestions = NULL;
+
+    g_mutex_lock (&cache->mutex);
+    entry = (GwSpellcheckCacheEntry*) g_hash_table_lookup (cache->table, WORD);
+    if (entry != NULL && entry->suggestions != NULL)
+      suggestions = g_strdupv (entry->suggestions);
+    g_mutex_unlock (&cache->mutex);
+
+    return suggestions;
+}
+
+
+gboolean
+gw_spellcheck_cache_has_suggestions (GwSpellcheckCache *cache, const gchar *WORD)
+{
+    //Sanity checks
+    g_return_val_if_fail (cache != NULL, FALSE);
+    g_return_val_if_fail (WORD != NULL, FALSE);
+
+    //Declarations
+    GwSpellcheckCacheEntry *entry;
+    gboolean has_suggestions;
+
+    g_mutex_lock (&cache->mutex);
+    entry = (GwSpellcheckCacheEntry*) g_hash_table_lookup (cache->table, WORD);
+    has_suggestions = (entry != NULL && entry->suggestions != NULL);
+    g_mutex_unlock (&cache->mutex);
+
+    return has_suggestions;
+}
@@ -22,7 +22,9 @@
 //!
 //! @file spellcheck.c
 //!
-//! @brief To be written
+//! @brief Underlines misspelled words of a GtkEntry.  Hunspell runs on a
+//!        worker thread with a small cache of its answers so typing never
+//!        waits on it.
 //!
 
 #ifdef HAVE_CONFIG_H
@@ -43,6 +45,7 @@
 
 static void gw_spellcheck_attach_signals (GwSpellcheck*);
 static void gw_spellcheck_remove_signals (GwSpellcheck*);
+static void gw_spellcheck_check_thread (gpointer, gpointer);
 
 G_DEFINE_TYPE (GwSpellcheck, gw_spellcheck, G_TYPE_OBJECT)
 
@@ -213,8 +216,10 @@ gw_spellcheck_load_dictionary (GwSpellcheck *spellcheck)
     const gint MAX = 100;
     const gchar *locale;
     gchar preferred[MAX];
+    Hunhandle *handle;
 
     priv = spellcheck->priv;
+    handle = NULL;
     preferences = gw_application_get_preferences (priv->application);
     lw_preferences_get_string_by_schema (
       preferences, 
@@ -224,33 +229,72 @@ gw_spellcheck_load_dictionary (GwSpellcheck *spellcheck)
       100);
     locale = setlocale (LC_ALL, NULL);
 
-    //Clear the previous handle
-    if (priv->handle != NULL) Hunspell_destroy (priv->handle); priv->handle = NULL;
-
     //See if we should try setting the prefered handle
-    if (priv->handle == NULL && strncmp("auto", preferred, strlen("auto")) != 0)
-      priv->handle = gw_spellcheck_get_hunhandle (preferred);
+    if (handle == NULL && strncmp("auto", preferred, strlen("auto")) != 0)
+      handle = gw_spellcheck_get_hunhandle (preferred);
 
     //Load from locale if it starts with en
-    if (priv->handle == NULL && strncmp("en", locale, strlen("en")) == 0)
-      priv->handle = gw_spellcheck_get_hunhandle (locale);
+    if (handle == NULL && strncmp("en", locale, strlen("en")) == 0)
+      handle = gw_spellcheck_get_hunhandle (locale);
 
     //Load from en_US
-    if (priv->handle == NULL)
-      priv->handle = gw_spellcheck_get_hunhandle ("en_US");
+    if (handle == NULL)
+      handle = gw_spellcheck_get_hunhandle ("en_US");
 
     //Load from en
-    if (priv->handle == NULL)
-      priv->handle = gw_spellcheck_get_hunhandle ("en");
+    if (handle == NULL)
+      handle = gw_spellcheck_get_hunhandle ("en");
+
+    //Swap out the previous handle once the worker is done with it
+    g_mutex_lock (&priv->handle_mutex);
+    if (priv->handle != NULL) Hunspell_destroy (priv->handle);
+    priv->handle = handle;
+    g_mutex_unlock (&priv->handle_mutex);
+
+    gw_spellcheck_cache_clear (priv->cache);
+}
+
+
+//!
+//! @brief Adds a word to the personal dictionary of the current Hunspell handle
+//! @param spellcheck The GwSpellcheck to add the word to
+//! @param WORD The word to no longer mark as misspelled
+//!
+void
+gw_spellcheck_add_word (GwSpellcheck *spellcheck, const gchar *WORD)
+{
+    g_return_if_fail (spellcheck != NULL);
+    g_return_if_fail (WORD != NULL);
+
+    //Declarations
+    GwSpellcheckPrivate *priv;
+
+    //Initializations
+    priv = spellcheck->priv;
+
+    g_mutex_lock (&priv->handle_mutex);
+    if (priv->handle != NULL) Hunspell_add (priv->handle, WORD);
+    g_mutex_unlock (&priv->handle_mutex);
+
+    //Forget the old answer for the word
+    gw_spellcheck_cache_remove (priv->cache, WORD);
 }
 
 
 static void
 gw_spellcheck_init (GwSpellcheck *spellcheck)
 {
+    GwSpellcheckPrivate *priv;
+
     spellcheck->priv = GW_SPELLCHECK_GET_PRIVATE (spellcheck);
     memset(spellcheck->priv, 0, sizeof(GwSpellcheckPrivate));
 
+    priv = spellcheck->priv;
+
+    g_mutex_init (&priv->handle_mutex);
+    priv->cache = gw_spellcheck_cache_new (GW_SPELLCHECK_CACHE_SIZE);
+    priv->pool = g_thread_pool_new (gw_spellcheck_check_thread, spellcheck, 1, FALSE, NULL);
+
     gw_spellcheck_set_timeout_threshold (spellcheck, 2);
 
     gw_spellcheck_attach_signals (spellcheck);
@@ -266,11 +310,17 @@ gw_spellcheck_finalize (GObject *object)
     spellcheck = GW_SPELLCHECK (object);
     priv = spellcheck->priv;
 
+    //Pending requests hold a reference, so the worker is idle by now
+    if (priv->pool != NULL) g_thread_pool_free (priv->pool, FALSE, TRUE); priv->pool = NULL;
+
     if (priv->handle != NULL) Hunspell_destroy (priv->handle); priv->handle = NULL;
 
     gw_spellcheck_remove_signals (spellcheck);
     gw_spellcheck_clear (spellcheck);
 
+    if (priv->cache != NULL) gw_spellcheck_cache_free (priv->cache); priv->cache = NULL;
+    g_mutex_clear (&priv->handle_mutex);
+
     if (priv->entry != NULL) gtk_widget_queue_draw (GTK_WIDGET (priv->entry));
 
     G_OBJECT_CLASS (gw_spellcheck_parent_class)->finalize (object);
@@ -638,6 +688,9 @@ gw_spellcheck_queue (GwSpellcheck *spellcheck)
 
     g_return_if_fail (priv->handle != NULL);
 
+    //Whatever the worker is checking is out of date now
+    g_atomic_int_inc (&priv->serial);
+
     if (should_check)
     {
       priv->timeout = 0;
@@ -688,14 +741,131 @@ gw_spellcheck_is_common_script (const gchar *TEXT)
 }
 
 
+static gboolean
+gw_spellcheck_request_is_stale (GwSpellcheckRequest *request)
+{
+    return (g_atomic_int_get (&request->spellcheck->priv->serial) != request->serial);
+}
+
+
+static void
+gw_spellcheck_request_free (GwSpellcheckRequest *request)
+{
+    if (request->tolkens != NULL) g_strfreev (request->tolkens); request->tolkens = NULL;
+    if (request->misspelled != NULL) g_list_free (request->misspelled); request->misspelled = NULL;
+    g_object_unref (request->spellcheck); request->spellcheck = NULL;
+    g_free (request);
+}
+
+
+//!
+//! @brief Hands the worker's results back to the entry on the main loop,
+//!        unless the text changed while it was checking.
+//!
+static gboolean
+gw_spellcheck_check_finished_idle (gpointer data)
+{
+    //Declarations
+    GwSpellcheckRequest *request;
+    GwSpellcheckPrivate *priv;
+    gboolean should_redraw;
+
+    //Initializations
+    request = (GwSpellcheckRequest*) data;
+    priv = request->spellcheck->priv;
+
+    if (!gw_spellcheck_request_is_stale (request) && priv->entry != NULL)
+    {
+      should_redraw = gw_spellcheck_clear (request->spellcheck);
+      priv->tolkens = request->tolkens; request->tolkens = NULL;
+      priv->misspelled = request->misspelled; request->misspelled = NULL;
+
+      if (should_redraw || priv->misspelled != NULL) 
+        gtk_widget_queue_draw (GTK_WIDGET (priv->entry));
+    }
+
+    gw_spellcheck_request_free (request);
+
+    return FALSE;
+}
+
+
+//!
+//! @brief Checks the tolkens of a request on the worker thread.  Answers come
+//!        from the cache when they can, and the suggestions of the misspelled
+//!        words are looked up ahead of time so the popup menu doesn't have to.
+//!        The request gives up as soon as the entry text changes.
+//!
+static void
+gw_spellcheck_check_thread (gpointer data, gpointer user_data)
+{
+    //Declarations
+    GwSpellcheckRequest *request;
+    GwSpellcheck *spellcheck;
+    GwSpellcheckPrivate *priv;
+    gchar **iter;
+    GList *link;
+    gboolean correct;
+    guint generation;
+    gchar **list;
+    gchar **suggestions;
+    gint total;
+    gint i;
+
+    //Initializations
+    request = (GwSpellcheckRequest*) data;
+    spellcheck = request->spellcheck;
+    priv = spellcheck->priv;
+    generation = 0;
+
+    for (iter = request->tolkens; *iter != NULL && !gw_spellcheck_request_is_stale (request); iter++)
+    {
+      if (**iter == '\0' || !gw_spellcheck_is_common_script (*iter)) continue;
+
+      if (!gw_spellcheck_cache_lookup (priv->cache, *iter, &correct, &generation))
+      {
+        g_mutex_lock (&priv->handle_mutex);
+        correct = (priv->handle == NULL || Hunspell_spell (priv->handle, *iter) != 0);
+        g_mutex_unlock (&priv->handle_mutex);
+        gw_spellcheck_cache_insert (priv->cache, *iter, correct, generation);
+      }
+
+      if (!correct) request->misspelled = g_list_append (request->misspelled, *iter);
+    }
+
+    for (link = request->misspelled; link != NULL && !gw_spellcheck_request_is_stale (request); link = link->next)
+    {
+      if (gw_spellcheck_cache_has_suggestions (priv->cache, link->data)) continue;
+
+      suggestions = NULL;
+      g_mutex_lock (&priv->handle_mutex);
+      if (priv->handle != NULL)
+      {
+        list = NULL;
+        total = Hunspell_suggest (priv->handle, &list, link->data);
+        suggestions = g_new0 (gchar*, total + 1);
+        for (i = 0; i < total && list != NULL; i++)
+          suggestions[i] = g_strdup (list[i]);
+        if (list != NULL) Hunspell_free_list (priv->handle, &list, total);
+      }
+      g_mutex_unlock (&priv->handle_mutex);
+
+      if (suggestions != NULL)
+        gw_spellcheck_cache_set_suggestions (priv->cache, link->data, suggestions, generation);
+    }
+
+    g_idle_add (gw_spellcheck_check_finished_idle, request);
+}
+
+
 gboolean
 gw_spellcheck_update (GwSpellcheck *spellcheck)
 {
     GwSpellcheckPrivate *priv;
+    GwSpellcheckRequest *request;
     gboolean should_check;
     gboolean should_redraw;
     const gchar *query;
-    gchar **iter;
 
     priv = spellcheck->priv;
 
@@ -715,15 +885,11 @@ gw_spellcheck_update (GwSpellcheck *spellcheck)
     if (should_check)
     {
       query = gtk_entry_get_text (priv->entry);
-      priv->tolkens = g_strsplit (query, " ", -1);
-
-      for (iter = priv->tolkens; *iter != NULL; iter++)
-      {
-        if (**iter != '\0' && gw_spellcheck_is_common_script (*iter) && Hunspell_spell (priv->handle, *iter) == 0)
-        {
-          priv->misspelled = g_list_append (priv->misspelled, *iter);
-        }
-      }
+      request = g_new0 (GwSpellcheckRequest, 1);
+      request->spellcheck = g_object_ref (spellcheck);
+      request->serial = g_atomic_int_get (&priv->serial);
+      request->tolkens = g_strsplit (query, " ", -1);
+      g_thread_pool_push (priv->pool, request, NULL);
     }
 
     if (should_redraw) gtk_widget_queue_draw (GTK_WIDGET (priv->entry));
@@ -798,11 +964,9 @@ gw_spellcheck_populate_popup (GwSpellcheck *spellcheck, GtkMenu *menu)
     int i;
     gchar **iter;
     gchar **suggestions;
-    size_t total_suggestions;
 
     priv = spellcheck->priv;
     if (priv->tolkens == NULL) return;
-    g_return_if_fail (priv->handle != NULL);
 
     xoffset = gw_spellcheck_get_layout_x_offset (spellcheck);
     yoffset = gw_spellcheck_get_layout_y_offset (spellcheck);
@@ -820,40 +984,41 @@ gw_spellcheck_populate_popup (GwSpellcheck *spellcheck, GtkMenu *menu)
     if (*iter == NULL) return;
     end_offset = start_offset + strlen(*iter);
 
-    if (Hunspell_spell (priv->handle, *iter) == 0)
+    if (g_list_find (priv->misspelled, *iter) != NULL)
     {
-      total_suggestions = Hunspell_suggest (priv->handle, &suggestions, *iter);
-      if (total_suggestions > 0 && suggestions != NULL)
+      menuitem = gtk_separator_menu_item_new ();
+      gtk_menu_shell_prepend (GTK_MENU_SHELL (menu), menuitem);
+      gtk_widget_show (menuitem);
+
+      spellmenu = gtk_menu_new ();
+      spellmenuitem = gtk_image_menu_item_new_from_stock (GTK_STOCK_SPELL_CHECK, NULL);
+      gtk_menu_item_set_submenu (GTK_MENU_ITEM (spellmenuitem), spellmenu);
+      gtk_menu_shell_prepend (GTK_MENU_SHELL (menu), spellmenuitem);
+      gtk_widget_show (spellmenuitem);
+
+      gchar *text = g_strdup_printf (gettext("Add \"%s\" to the dictionary"), *iter);
+      if (text != NULL)
       {
-        menuitem = gtk_separator_menu_item_new ();
-        gtk_menu_shell_prepend (GTK_MENU_SHELL (menu), menuitem);
+        GtkWidget *image = gtk_image_new_from_stock (GTK_STOCK_ADD, GTK_ICON_SIZE_MENU);
+        menuitem = gtk_image_menu_item_new_with_label (text);
+        g_object_set_data_full (G_OBJECT (menuitem), "word", g_strdup (*iter), g_free);
+        g_signal_connect (G_OBJECT (menuitem), "activate", G_CALLBACK (gw_spellcheck_add_menuitem_activated_cb), spellcheck);
+        gtk_image_menu_item_set_image (GTK_IMAGE_MENU_ITEM (menuitem), image);
+        gtk_menu_shell_append (GTK_MENU_SHELL (spellmenu), menuitem);
+        g_free (text); text = NULL;
         gtk_widget_show (menuitem);
+      }
 
-        spellmenu = gtk_menu_new ();
-        spellmenuitem = gtk_image_menu_item_new_from_stock (GTK_STOCK_SPELL_CHECK, NULL);
-        gtk_menu_item_set_submenu (GTK_MENU_ITEM (spellmenuitem), spellmenu);
-        gtk_menu_shell_prepend (GTK_MENU_SHELL (menu), spellmenuitem);
-        gtk_widget_show (spellmenuitem);
-
-        gchar *text = g_strdup_printf (gettext("Add \"%s\" to the dictionary"), *iter);
-        if (text != NULL)
-        {
-          GtkWidget *image = gtk_image_new_from_stock (GTK_STOCK_ADD, GTK_ICON_SIZE_MENU);
-          menuitem = gtk_image_menu_item_new_with_label (text);
-          g_object_set_data_full (G_OBJECT (menuitem), "word", g_strdup (*iter), g_free);
-          g_signal_connect (G_OBJECT (menuitem), "activate", G_CALLBACK (gw_spellcheck_add_menuitem_activated_cb), spellcheck);
-          gtk_image_menu_item_set_image (GTK_IMAGE_MENU_ITEM (menuitem), image);
-          gtk_menu_shell_append (GTK_MENU_SHELL (spellmenu), menuitem);
-          g_free (text); text = NULL;
-          gtk_widget_show (menuitem);
-        }
-
+      //The worker looks the suggestions up right after finding the misspelling
+      suggestions = gw_spellcheck_cache_get_suggestions (priv->cache, *iter);
+      if (suggestions != NULL && suggestions[0] != NULL)
+      {
         menuitem = gtk_separator_menu_item_new ();
         gtk_menu_shell_append (GTK_MENU_SHELL (spellmenu), menuitem);
         gtk_widget_show (menuitem);
 
         //Menuitems
-        for (i = 0; i < total_suggestions; i++)
+        for (i = 0; suggestions[i] != NULL; i++)
         {
           menuitem = gtk_menu_item_new_with_label (suggestions[i]);
           g_object_set_data (G_OBJECT (menuitem), "start-offset", GINT_TO_POINTER (start_offset));
@@ -862,9 +1027,8 @@ gw_spellcheck_populate_popup (GwSpellcheck *spellcheck, GtkMenu *menu)
           gtk_widget_show (GTK_WIDGET (menuitem));
           gtk_menu_shell_append (GTK_MENU_SHELL (spellmenu), menuitem);
         }
-
-        Hunspell_free_list (priv->handle, &suggestions, total_suggestions);
       }
+      if (suggestions != NULL) g_strfreev (suggestions); suggestions = NULL;
     }
 }
 
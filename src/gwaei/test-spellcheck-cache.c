@@ -0,0 +1,237 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file test-spellcheck-cache.c
+//!
+//! @brief Checks for the cache of Hunspell answers the spellcheck worker
+//!        keeps.  It is built without Hunspell or GTK, so the checks run
+//!        whether or not the spellcheck itself is.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+
+#include <gwaei/spellcheck-cache.h>
+
+
+//!
+//! @brief Checks the words of a cache, most recently used first
+//! @param EXPECTED A space separated list of the words
+//!
+static void
+gw_test_spellcheck_cache_check_order (GwSpellcheckCache *cache, const gchar *EXPECTED)
+{
+    //Declarations
+    GString *order;
+    GList *link;
+    GwSpellcheckCacheEntry *entry;
+
+    //Initializations
+    order = g_string_new (NULL);
+
+    for (link = cache->order.head; link != NULL; link = link->next)
+    {
+      entry = (GwSpellcheckCacheEntry*) link->data;
+      g_assert (entry->link == link);
+      g_assert (g_hash_table_lookup (cache->table, entry->word) == entry);
+      if (order->len > 0) g_string_append_c (order, ' ');
+      g_string_append (order, entry->word);
+    }
+
+    g_assert_cmpstr (order->str, ==, EXPECTED);
+    g_assert_cmpuint (gw_spellcheck_cache_length (cache), ==, g_queue_get_length (&cache->order));
+
+    g_string_free (order, TRUE); order = NULL;
+}
+
+
+static void
+gw_test_spellcheck_cache_eviction (void)
+{
+    //Declarations
+    GwSpellcheckCache *cache;
+    gboolean correct;
+    guint generation;
+
+    //Initializations
+    cache = gw_spellcheck_cache_new (3);
+    g_assert (cache != NULL);
+
+    g_assert (!gw_spellcheck_cache_lookup (cache, "one", &correct, &generation));
+    gw_spellcheck_cache_insert (cache, "one", TRUE, generation);
+    gw_spellcheck_cache_insert (cache, "two", FALSE, generation);
+    gw_spellcheck_cache_insert (cache, "three", TRUE, generation);
+    gw_test_spellcheck_cache_check_order (cache, "three two one");
+
+    //A second answer for a word doesn't replace the first
+    gw_spellcheck_cache_insert (cache, "two", TRUE, generation);
+    gw_test_spellcheck_cache_check_order (cache, "three two one");
+
+    //Looking a word up makes it the most recently used
+    correct = TRUE;
+    g_assert (gw_spellcheck_cache_lookup (cache, "two", &correct, &generation));
+    g_assert (!correct);
+    g_assert (gw_spellcheck_cache_lookup (cache, "one", &correct, &generation));
+    g_assert (correct);
+    gw_test_spellcheck_cache_check_order (cache, "one two three");
+
+    //So the least recently used word is the one dropped when full
+    gw_spellcheck_cache_insert (cache, "four", FALSE, generation);
+    gw_test_spellcheck_cache_check_order (cache, "four one two");
+    g_assert (!gw_spellcheck_cache_lookup (cache, "three", &correct, &generation));
+
+    gw_spellcheck_cache_remove (cache, "one");
+    gw_spellcheck_cache_remove (cache, "five");
+    gw_test_spellcheck_cache_check_order (cache, "four two");
+
+    gw_spellcheck_cache_free (cache); cache = NULL;
+}
+
+
+static void
+gw_test_spellcheck_cache_size (void)
+{
+    //Declarations
+    GwSpellcheckCache *cache;
+    gchar *word;
+    gboolean correct;
+    guint generation;
+    gint i;
+
+    //Initializations
+    cache = gw_spellcheck_cache_new (GW_SPELLCHECK_CACHE_SIZE);
+    gw_spellcheck_cache_lookup (cache, "word0", &correct, &generation);
+
+    for (i = 0; i < GW_SPELLCHECK_CACHE_SIZE * 2; i++)
+    {
+      word = g_strdup_printf ("word%d", i);
+      gw_spellcheck_cache_insert (cache, word, (i % 2 == 0), generation);
+      g_free (word); word = NULL;
+      g_assert_cmpuint (gw_spellcheck_cache_length (cache), ==, MIN (i + 1, GW_SPELLCHECK_CACHE_SIZE));
+    }
+
+    //Only the newest half is left
+    g_assert (!gw_spellcheck_cache_lookup (cache, "word0", &correct, &generation));
+    word = g_strdup_printf ("word%d", GW_SPELLCHECK_CACHE_SIZE - 1);
+    g_assert (!gw_spellcheck_cache_lookup (cache, word, &correct, &generation));
+    g_free (word); word = NULL;
+    word = g_strdup_printf ("word%d", GW_SPELLCHECK_CACHE_SIZE);
+    g_assert (gw_spellcheck_cache_lookup (cache, word, &correct, &generation));
+    g_assert (correct);
+    g_free (word); word = NULL;
+
+    gw_spellcheck_cache_free (cache); cache = NULL;
+}
+
+
+static void
+gw_test_spellcheck_cache_generation (void)
+{
+    //Declarations
+    GwSpellcheckCache *cache;
+    gboolean correct;
+    guint generation;
+    guint stale;
+
+    //Initializations
+    cache = gw_spellcheck_cache_new (GW_SPELLCHECK_CACHE_SIZE);
+
+    gw_spellcheck_cache_lookup (cache, "teh", &correct, &stale);
+    gw_spellcheck_cache_insert (cache, "teh", FALSE, stale);
+    g_assert_cmpuint (gw_spellcheck_cache_length (cache), ==, 1);
+
+    //Loading another dictionary empties the cache
+    gw_spellcheck_cache_clear (cache);
+    g_assert_cmpuint (gw_spellcheck_cache_length (cache), ==, 0);
+    g_assert (!gw_spellcheck_cache_lookup (cache, "teh", &correct, &generation));
+    g_assert_cmpuint (generation, !=, stale);
+
+    //And answers a worker got from the old one are ignored
+    gw_spellcheck_cache_insert (cache, "teh", FALSE, stale);
+    g_assert_cmpuint (gw_spellcheck_cache_length (cache), ==, 0);
+
+    gw_spellcheck_cache_insert (cache, "teh", FALSE, generation);
+    gw_spellcheck_cache_set_suggestions (cache, "teh", g_strsplit ("the,ten", ",", -1), stale);
+    g_assert (!gw_spellcheck_cache_has_suggestions (cache, "teh"));
+
+    gw_spellcheck_cache_free (cache); cache = NULL;
+}
+
+
+static void
+gw_test_spellcheck_cache_suggestions (void)
+{
+    //Declarations
+    GwSpellcheckCache *cache;
+    gchar **suggestions;
+    gboolean correct;
+    guint generation;
+
+    //Initializations
+    cache = gw_spellcheck_cache_new (GW_SPELLCHECK_CACHE_SIZE);
+    gw_spellcheck_cache_lookup (cache, "teh", &correct, &generation);
+
+    //Suggestions are only kept for words in the cache
+    gw_spellcheck_cache_set_suggestions (cache, "teh", g_strsplit ("the", ",", -1), generation);
+    g_assert (!gw_spellcheck_cache_has_suggestions (cache, "teh"));
+
+    gw_spellcheck_cache_insert (cache, "teh", FALSE, generation);
+    g_assert (!gw_spellcheck_cache_has_suggestions (cache, "teh"));
+    g_assert (gw_spellcheck_cache_get_suggestions (cache, "teh") == NULL);
+
+    gw_spellcheck_cache_set_suggestions (cache, "teh", g_strsplit ("the,ten", ",", -1), generation);
+    g_assert (gw_spellcheck_cache_has_suggestions (cache, "teh"));
+
+    //The first suggestions looked up stay
+    gw_spellcheck_cache_set_suggestions (cache, "teh", g_strsplit ("tea", ",", -1), generation);
+
+    suggestions = gw_spellcheck_cache_get_suggestions (cache, "teh");
+    g_assert (suggestions != NULL);
+    g_assert_cmpuint (g_strv_length (suggestions), ==, 2);
+    g_assert_cmpstr (suggestions[0], ==, "the");
+    g_assert_cmpstr (suggestions[1], ==, "ten");
+    g_strfreev (suggestions); suggestions = NULL;
+
+    //Adding the word to the dictionary forgets them with the answer
+    gw_spellcheck_cache_remove (cache, "teh");
+    g_assert (!gw_spellcheck_cache_has_suggestions (cache, "teh"));
+    g_assert (!gw_spellcheck_cache_lookup (cache, "teh", &correct, &generation));
+
+    gw_spellcheck_cache_free (cache); cache = NULL;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/gwaei/spellcheck-cache/eviction", gw_test_spellcheck_cache_eviction);
+    g_test_add_func ("/gwaei/spellcheck-cache/size", gw_test_spellcheck_cache_size);
+    g_test_add_func ("/gwaei/spellcheck-cache/generation", gw_test_spellcheck_cache_generation);
+    g_test_add_func ("/gwaei/spellcheck-cache/suggestions", gw_test_spellcheck_cache_suggestions);
+
+    return g_test_run ();
+}
@@ -265,7 +265,8 @@ gw_vocabularyliststore_get_wordstore_by_name (GwVocabularyListStore *store, cons
 
 
 //!
-//! @brief Deletes files that have to coresponding word list
+//! @brief Deletes files that have to coresponding word list.  Journals are
+//!        kept as long as the list they belong to is.
 //!
 void
 gw_vocabularyliststore_clean_files (GwVocabularyListStore *store)
@@ -274,6 +275,7 @@ gw_vocabularyliststore_clean_files (GwVocabularyListStore *store)
     GDir *dir;
     gchar *uri;
     gchar *filename;
+    gchar *listname;
     const gchar *name;
 
     if ((uri = lw_util_build_filename (LW_PATH_VOCABULARY, NULL)) != NULL)
@@ -282,7 +284,8 @@ gw_vocabularyliststore_clean_files (GwVocabularyListStore *store)
       {
         while ((name = g_dir_read_name (dir)) != NULL)
         {
-          if (!gw_vocabularyliststore_list_exists (store, name))
+          listname = lw_vocabulary_filename_to_name (name);
+          if (!gw_vocabularyliststore_list_exists (store, listname))
           {
             if ((filename = g_build_filename (uri, name, NULL)) != NULL)
             {
@@ -290,6 +293,7 @@ gw_vocabularyliststore_clean_files (GwVocabularyListStore *store)
               g_free (filename); filename = NULL;
             }
           }
+          g_free (listname); listname = NULL;
         }
         g_dir_close (dir); dir = NULL;
       }
@@ -79,7 +79,9 @@ gw_vocabularywordstore_init (GwVocabularyWordStore *model)
       G_TYPE_STRING, //GW_VOCABULARYWORDSTORE_COLUMN_SCORE
       G_TYPE_UINT,   //GW_VOCABULARYWORDSTORE_COLUMN_TIMESTAMP
       G_TYPE_STRING, //GW_VOCABULARYWORDSTORE_COLUMN_DAYS
-      G_TYPE_INT     //GW_VOCABULARYWORDSTORE_COLUMN_WEIGHT
+      G_TYPE_INT,    //GW_VOCABULARYWORDSTORE_COLUMN_WEIGHT
+      G_TYPE_INT,    //GW_VOCABULARYWORDSTORE_COLUMN_EASE
+      G_TYPE_INT     //GW_VOCABULARYWORDSTORE_COLUMN_INTERVAL
     };
 
     gtk_list_store_set_column_types (GTK_LIST_STORE (model), TOTAL_GW_VOCABULARYWORDSTORE_COLUMNS, types);
@@ -259,7 +261,13 @@ gw_vocabularywordstore_save (GwVocabularyWordStore *store, const gchar *FILENAME
           gtk_tree_model_get (model, &iter,  GW_VOCABULARYWORDSTORE_COLUMN_TIMESTAMP, &number, -1);
           lw_word_set_hours (word, number);
 
-          priv->vocabulary_list->items = g_list_append (priv->vocabulary_list->items, word);
+          gtk_tree_model_get (model, &iter,  GW_VOCABULARYWORDSTORE_COLUMN_EASE, &number, -1);
+          lw_word_set_ease (word, number);
+
+          gtk_tree_model_get (model, &iter,  GW_VOCABULARYWORDSTORE_COLUMN_INTERVAL, &number, -1);
+          lw_word_set_interval (word, number);
+
+          g_ptr_array_add (priv->vocabulary_list->items, word);
           gtk_list_store_set (GTK_LIST_STORE (model), &iter, GW_VOCABULARYWORDSTORE_COLUMN_WEIGHT, weight, -1);
         }
         valid = gtk_tree_model_iter_next (model, &iter);
@@ -267,7 +275,12 @@ gw_vocabularywordstore_save (GwVocabularyWordStore *store, const gchar *FILENAME
       }
 
       lw_vocabulary_save (priv->vocabulary_list, FILENAME, NULL);
-      lw_vocabulary_free (priv->vocabulary_list); priv->vocabulary_list = NULL;
+
+      //Keep the list's own snapshot around so later changes can be journaled against it
+      if (FILENAME != NULL)
+      {
+        lw_vocabulary_free (priv->vocabulary_list); priv->vocabulary_list = NULL;
+      }
       gw_vocabularywordstore_set_has_changes (store, FALSE);
     }
 }
@@ -285,11 +298,11 @@ gw_vocabularywordstore_load (GwVocabularyWordStore *store, const gchar *FILENAME
     GwVocabularyWordStorePrivate *priv;
     GtkTreeModel *model;
     GtkTreeIter iter;
-    GList *link;
     LwWord *word;
     const gint MAX = 100;
     gchar buffer[MAX];
     guint position;
+    guint i;
 
     //Initializations
     priv = store->priv;
@@ -301,9 +314,9 @@ gw_vocabularywordstore_load (GwVocabularyWordStore *store, const gchar *FILENAME
 
     lw_vocabulary_load (priv->vocabulary_list, FILENAME, NULL);
 
-    for (link = priv->vocabulary_list->items; link != NULL; link = link->next)
+    for (i = 0; i < priv->vocabulary_list->items->len; i++)
     {
-      word = LW_WORD (link->data);
+      word = LW_WORD (g_ptr_array_index (priv->vocabulary_list->items, i));
       g_snprintf (buffer, MAX, "%d", position);
 
       gtk_list_store_append (GTK_LIST_STORE (model), &iter);
@@ -319,6 +332,8 @@ gw_vocabularywordstore_load (GwVocabularyWordStore *store, const gchar *FILENAME
           GW_VOCABULARYWORDSTORE_COLUMN_DAYS, lw_word_get_timestamp_as_string (word),
           GW_VOCABULARYWORDSTORE_COLUMN_SCORE, lw_word_get_score_as_string (word),
           GW_VOCABULARYWORDSTORE_COLUMN_WEIGHT, PANGO_WEIGHT_NORMAL,
+          GW_VOCABULARYWORDSTORE_COLUMN_EASE, word->ease,
+          GW_VOCABULARYWORDSTORE_COLUMN_INTERVAL, lw_word_get_interval (word),
       -1);
 
       position++;
@@ -451,8 +466,8 @@ gw_vocabularywordstore_iter_to_string (GwVocabularyWordStore *store, GtkTreeIter
     GtkTreeModel *model;
     gchar *text;
     gchar *kanji, *furigana, *definitions;
-    gint correct_guesses, incorrect_guesses, timestamp;
-    gchar *correct_guesses_string, *incorrect_guesses_string, *timestamp_string;
+    gint correct_guesses, incorrect_guesses, timestamp, ease, interval;
+    gchar *correct_guesses_string, *incorrect_guesses_string, *timestamp_string, *ease_string, *interval_string;
 
     model = GTK_TREE_MODEL (store);
 
@@ -463,12 +478,16 @@ gw_vocabularywordstore_iter_to_string (GwVocabularyWordStore *store, GtkTreeIter
         GW_VOCABULARYWORDSTORE_COLUMN_CORRECT_GUESSES,   &correct_guesses,
         GW_VOCABULARYWORDSTORE_COLUMN_INCORRECT_GUESSES, &incorrect_guesses,
         GW_VOCABULARYWORDSTORE_COLUMN_TIMESTAMP,         &timestamp,
+        GW_VOCABULARYWORDSTORE_COLUMN_EASE,              &ease,
+        GW_VOCABULARYWORDSTORE_COLUMN_INTERVAL,          &interval,
     -1);
 
     correct_guesses_string = g_strdup_printf("%d", correct_guesses);
     incorrect_guesses_string = g_strdup_printf("%d", incorrect_guesses);
     timestamp_string = g_strdup_printf("%d", timestamp);
-    text = g_strjoin (";", kanji, furigana, definitions, correct_guesses_string, incorrect_guesses_string, timestamp_string, NULL);
+    ease_string = g_strdup_printf("%d", ease);
+    interval_string = g_strdup_printf("%d", interval);
+    text = g_strjoin (";", kanji, furigana, definitions, correct_guesses_string, incorrect_guesses_string, timestamp_string, ease_string, interval_string, NULL);
 
     if (kanji != NULL) g_free (kanji); 
     if (furigana != NULL) g_free (furigana); 
@@ -476,6 +495,8 @@ gw_vocabularywordstore_iter_to_string (GwVocabularyWordStore *store, GtkTreeIter
     if (correct_guesses_string != NULL) g_free (correct_guesses_string);
     if (incorrect_guesses_string != NULL) g_free (incorrect_guesses_string);
     if (timestamp_string != NULL) g_free (timestamp_string);
+    if (ease_string != NULL) g_free (ease_string);
+    if (interval_string != NULL) g_free (interval_string);
 
     return text;
 }
@@ -574,6 +595,8 @@ gw_vocabularywordstore_append_text (GwVocabularyWordStore *store, GtkTreeIter *s
             GW_VOCABULARYWORDSTORE_COLUMN_TIMESTAMP, lw_word_get_hours (word),
             GW_VOCABULARYWORDSTORE_COLUMN_DAYS, lw_word_get_timestamp_as_string (word),
             GW_VOCABULARYWORDSTORE_COLUMN_WEIGHT, PANGO_WEIGHT_SEMIBOLD,
+            GW_VOCABULARYWORDSTORE_COLUMN_EASE, word->ease,
+            GW_VOCABULARYWORDSTORE_COLUMN_INTERVAL, lw_word_get_interval (word),
           -1);
           lw_word_free (word);
           modified = TRUE;
@@ -624,6 +647,8 @@ gw_vocabularywordstore_new_word (GwVocabularyWordStore *store,
         GW_VOCABULARYWORDSTORE_COLUMN_INCORRECT_GUESSES, 0,
         GW_VOCABULARYWORDSTORE_COLUMN_TIMESTAMP,         0,
         GW_VOCABULARYWORDSTORE_COLUMN_DAYS,              gettext("New"),
+        GW_VOCABULARYWORDSTORE_COLUMN_EASE,              0,
+        GW_VOCABULARYWORDSTORE_COLUMN_INTERVAL,          0,
     -1);
     gw_vocabularywordstore_set_has_changes (store, TRUE);
 }
@@ -766,39 +791,125 @@ gw_vocabularywordstore_update_timestamp_by_iter (GwVocabularyWordStore *store, G
 }
 
 
-gint
-gw_vocabularywordstore_calculate_weight (GwVocabularyWordStore *store, GtkTreeIter *iter)
+//!
+//! @brief Reschedules a word after it was answered in a flashcard session
+//! @param store The GwVocabularyWordStore the word is in
+//! @param iter The GtkTreeIter of the word
+//! @param grade How well the word was remembered
+//!
+void
+gw_vocabularywordstore_review_by_iter (GwVocabularyWordStore *store, GtkTreeIter *iter, LwSchedulerGrade grade)
 {
-    if (store == NULL) return -1;
-    if (iter == NULL) return -1;
+    LwWord *word;
+    gchar *text;
+
+    text = gw_vocabularywordstore_iter_to_string (store, iter);
+    word = lw_word_new_from_string (text);
+    if (text != NULL)
+    {
+      if (word != NULL)
+      {
+        lw_scheduler_review_word (word, grade, lw_scheduler_get_hours ());
+
+        gtk_list_store_set (GTK_LIST_STORE (store), iter, 
+          GW_VOCABULARYWORDSTORE_COLUMN_TIMESTAMP, lw_word_get_hours (word),
+          GW_VOCABULARYWORDSTORE_COLUMN_DAYS, lw_word_get_timestamp_as_string (word),
+          GW_VOCABULARYWORDSTORE_COLUMN_EASE, word->ease,
+          GW_VOCABULARYWORDSTORE_COLUMN_INTERVAL, lw_word_get_interval (word),
+        -1);
+
+        lw_word_free (word);
+      }
+      g_free (text);
+    }
+}
+
 
-    //The effect of this is short term score is important.
-    //long term, time is important for deciding weight
+//!
+//! @brief Writes the guesses and timestamp of a word to disk.  When the list has
+//!        no other unsaved changes, only the word is appended to the list's
+//!        journal instead of the whole list being rewritten.
+//! @param store The GwVocabularyWordStore the word is in
+//! @param iter The GtkTreeIter of the word
+//!
+void
+gw_vocabularywordstore_save_guesses_by_iter (GwVocabularyWordStore *store, GtkTreeIter *iter)
+{
+    //Sanity checks
+    g_return_if_fail (store != NULL);
+    g_return_if_fail (iter != NULL);
+
+    //Declarations
+    GwVocabularyWordStorePrivate *priv;
+    GtkTreePath *path;
+    LwWord *word;
+    gchar *text;
+    gboolean journaled;
+
+    //Initializations
+    priv = store->priv;
+    journaled = FALSE;
+
+    if (!gw_vocabularywordstore_has_changes (store) && priv->vocabulary_list != NULL)
+    {
+      path = gtk_tree_model_get_path (GTK_TREE_MODEL (store), iter);
+      text = gw_vocabularywordstore_iter_to_string (store, iter);
+      word = lw_word_new_from_string (text);
+
+      if (path != NULL && word != NULL)
+      {
+        journaled = lw_vocabulary_journal (
+          priv->vocabulary_list,
+          LW_VOCABULARY_RECORD_GUESSES,
+          gtk_tree_path_get_indices (path)[0],
+          word,
+          NULL
+        );
+        if (journaled && lw_vocabulary_journal_is_full (priv->vocabulary_list)) journaled = FALSE;
+      }
+
+      if (word != NULL) lw_word_free (word); word = NULL;
+      if (text != NULL) g_free (text); text = NULL;
+      if (path != NULL) gtk_tree_path_free (path); path = NULL;
+    }
+
+    //Fall back to compacting everything into a new snapshot
+    if (!journaled)
+    {
+      gw_vocabularywordstore_set_has_changes (store, TRUE);
+      gw_vocabularywordstore_save (store, NULL);
+    }
+}
+
+
+//!
+//! @brief Gets when a word is next due for review
+//! @param store The GwVocabularyWordStore the word is in
+//! @param iter The GtkTreeIter of the word
+//! @returns The due time in hours like lw_word_get_due_hours
+//!
+guint32
+gw_vocabularywordstore_get_due_hours_by_iter (GwVocabularyWordStore *store, GtkTreeIter *iter)
+{
+    //Sanity checks
+    g_return_val_if_fail (store != NULL, 0);
+    g_return_val_if_fail (iter != NULL, 0);
+
+    //Declarations
     GtkTreeModel *model;
-    gint score;
-    gint numerator;
-    gint denominator;
-    gint incorrect;
-    gint correct;
-    gint weight;
+    LwWord word;
     guint32 hours;
 
+    //Initializations
     model = GTK_TREE_MODEL (store);
+    memset(&word, 0, sizeof(LwWord));
+
     gtk_tree_model_get (model, iter, 
           GW_VOCABULARYWORDSTORE_COLUMN_TIMESTAMP, &hours,
-          GW_VOCABULARYWORDSTORE_COLUMN_CORRECT_GUESSES, &correct,
-          GW_VOCABULARYWORDSTORE_COLUMN_INCORRECT_GUESSES, &incorrect,
+          GW_VOCABULARYWORDSTORE_COLUMN_INTERVAL, &(word.interval),
         -1);
-    numerator = correct * 100;
-    denominator = incorrect + correct;
-  
-    if (denominator != 0)
-      score = (numerator / denominator);
-    else
-      score = 0;
-  
-    weight = ((gint) hours + score);
-  
-    return weight;
+    word.timestamp = hours;
+
+    return lw_word_get_due_hours (&word);
 }
 
@@ -0,0 +1,626 @@
+/******************************************************************************
+    AUTHOR:
+    KanjiPad - Japanese handwriting recognition front end
+    Copyright (C) 1997 Owen Taylor
+    File heavily modified and updated by Zachary Dovel.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file engine.c
+//!
+//! @brief The jstroke handwriting recognizer as an in-process library
+//!
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "jstroke/jstroke.h"
+#include "kpengine.h"
+
+
+struct _KpEngine {
+  gchar *stroke_dicts[KP_ENGINE_MAX_STROKES + 1];
+  gchar **entries[KP_ENGINE_MAX_STROKES + 1];
+  gint total_entries[KP_ENGINE_MAX_STROKES + 1];
+  GHashTable *characters;
+};
+
+struct _KpRecognizer {
+  KpEngine *engine;
+  RawStroke *raw_strokes;
+  Byte *segments[KP_ENGINE_MAX_STROKES];
+  gint total_strokes;
+  gchar **cursors[KP_ENGINE_MAX_STROKES + 1];
+  ULong *scores[KP_ENGINE_MAX_STROKES + 1];
+};
+
+
+//!
+//! @brief Converts a Shift-JIS pair into the JIS row and cell
+//!
+//! From Ken Lunde's _Understanding Japanese Information Processing_
+//! O'Reilly, 1993
+//!
+static void
+kp_engine_sjis_to_jis (guchar *p1, guchar *p2)
+{
+    guchar c1 = *p1;
+    guchar c2 = *p2;
+    gint adjust = c2 < 159;
+    gint row_offset = c1 < 160 ? 112 : 176;
+    gint cell_offset = adjust ? (c2 > 127 ? 32 : 31) : 126;
+
+    *p1 = ((c1 - row_offset) << 1) - adjust;
+    *p2 -= cell_offset;
+}
+
+
+//!
+//! @brief Walks the entries of a stroke dictionary and records the unicode
+//!        character of each one so that results never need converting later
+//! @param engine The engine to add the characters to
+//! @param dictionary A nul terminated block of jstroke entries
+//! @param converter An iconv descriptor from EUC-JP to UTF-8
+//!
+static void
+kp_engine_index_characters (KpEngine *engine, gchar *dictionary, GIConv converter)
+{
+    //Declarations
+    gchar *ptr;
+    gchar *entry;
+    guchar jis[2];
+    gchar euc[2];
+    gchar utf8[8];
+    gchar *inbuf, *outbuf;
+    gsize inleft, outleft;
+    gunichar character;
+
+    ptr = dictionary;
+
+    while (*ptr != '\0')
+    {
+      //Every entry starts with an SJIS pair.  The second byte may be plain
+      //ASCII, but the next byte with the high bit set starts a new entry.
+      entry = ptr;
+      if (*ptr != '\0') ptr++;
+      if (*ptr != '\0') ptr++;
+      while (*ptr != '\0' && !(*ptr & 0x80)) ptr++;
+
+      jis[0] = entry[0];
+      jis[1] = entry[1];
+      kp_engine_sjis_to_jis (&jis[0], &jis[1]);
+      euc[0] = jis[0] + 0x80;
+      euc[1] = jis[1] + 0x80;
+
+      inbuf = euc;
+      inleft = 2;
+      outbuf = utf8;
+      outleft = sizeof(utf8) - 1;
+      g_iconv (converter, NULL, NULL, NULL, NULL);
+      if (g_iconv (converter, &inbuf, &inleft, &outbuf, &outleft) == (gsize) -1) continue;
+      *outbuf = '\0';
+
+      character = g_utf8_get_char_validated (utf8, -1);
+      if (character == (gunichar) -1 || character == (gunichar) -2) continue;
+
+      g_hash_table_insert (engine->characters, entry, GUINT_TO_POINTER (character));
+    }
+}
+
+
+//!
+//! @brief Records where every entry of a stroke dictionary starts
+//! @param engine The engine to add the entries to
+//! @param total_strokes The stroke count of the dictionary bucket
+//!
+static void
+kp_engine_index_entries (KpEngine *engine, gint total_strokes)
+{
+    //Declarations
+    gchar *ptr;
+    gint total;
+
+    //Initializations
+    total = 0;
+
+    for (ptr = engine->stroke_dicts[total_strokes]; *ptr != '\0'; ptr = StrokeDicNextEntry (ptr))
+      total++;
+
+    engine->entries[total_strokes] = g_new (gchar*, total + 1);
+    engine->total_entries[total_strokes] = total;
+
+    total = 0;
+    for (ptr = engine->stroke_dicts[total_strokes]; *ptr != '\0'; ptr = StrokeDicNextEntry (ptr))
+      engine->entries[total_strokes][total++] = ptr;
+    engine->entries[total_strokes][total] = NULL;
+}
+
+
+//!
+//! @brief Returns the path of the installed stroke database.  It should be freed with g_free
+//!
+static gchar*
+kp_engine_get_default_data_file ()
+{
+    //Declarations
+    gchar *directory;
+    gchar *path;
+
+#ifndef G_OS_WIN32
+    directory = g_strdup (KP_LIBDIR);
+#else
+    gchar *prefix = g_win32_get_package_installation_directory_of_module (NULL);
+    directory = g_build_filename (prefix, "..", "..", "share", "gwaei", NULL);
+    g_free (prefix);
+#endif
+    path = g_build_filename (directory, "jdata.dat", NULL);
+
+    g_free (directory);
+
+    return path;
+}
+
+
+//!
+//! @brief Loads the stroke database and prepares it for recognition
+//! @param FILENAME The path to jdata.dat or NULL for the installed copy
+//! @param error A GError to write errors to or NULL
+//! @returns A new KpEngine that should be freed with kp_engine_free or NULL on error
+//!
+KpEngine*
+kp_engine_new (const gchar *FILENAME, GError **error)
+{
+    //Sanity checks
+    if (error != NULL && *error != NULL) return NULL;
+
+    //Declarations
+    KpEngine *engine;
+    gchar *path;
+    FILE *file;
+    GIConv converter;
+    guint32 header[2];
+    guint32 total_strokes;
+    guint32 length;
+    GQuark quark;
+    gboolean is_corrupt;
+
+    //Initializations
+    engine = NULL;
+    path = (FILENAME != NULL) ? g_strdup (FILENAME) : kp_engine_get_default_data_file ();
+    file = g_fopen (path, "rb");
+    quark = g_quark_from_string (KP_ENGINE_ERROR);
+    is_corrupt = FALSE;
+
+    if (file == NULL)
+    {
+      g_set_error (error, quark, KP_ENGINE_READ_ERROR, "Can't open %s", path);
+      goto errored;
+    }
+
+    engine = g_new0 (KpEngine, 1);
+    engine->characters = g_hash_table_new (g_direct_hash, g_direct_equal);
+
+    while (TRUE)
+    {
+      if (fread (header, sizeof(guint32), 2, file) != 2)
+      {
+        is_corrupt = TRUE;
+        break;
+      }
+
+      total_strokes = GUINT32_FROM_BE (header[0]);
+      length = GUINT32_FROM_BE (header[1]);
+
+      if (total_strokes == 0) break;
+      if (total_strokes > KP_ENGINE_MAX_STROKES || length == 0 || engine->stroke_dicts[total_strokes] != NULL)
+      {
+        is_corrupt = TRUE;
+        break;
+      }
+
+      engine->stroke_dicts[total_strokes] = g_malloc (length);
+      if (fread (engine->stroke_dicts[total_strokes], 1, length, file) != length)
+      {
+        is_corrupt = TRUE;
+        break;
+      }
+      engine->stroke_dicts[total_strokes][length - 1] = '\0';
+    }
+
+    fclose (file);
+
+    if (is_corrupt)
+    {
+      g_set_error (error, quark, KP_ENGINE_CORRUPT_DATA_ERROR, "Corrupt stroke database %s", path);
+      goto errored;
+    }
+
+    converter = g_iconv_open ("UTF-8", "EUC-JP");
+    if (converter == (GIConv) -1)
+    {
+      g_set_error (error, quark, KP_ENGINE_READ_ERROR, "Can't convert from EUC-JP to UTF-8");
+      goto errored;
+    }
+    for (total_strokes = 1; total_strokes <= KP_ENGINE_MAX_STROKES; total_strokes++)
+    {
+      if (engine->stroke_dicts[total_strokes] != NULL)
+      {
+        kp_engine_index_characters (engine, engine->stroke_dicts[total_strokes], converter);
+        kp_engine_index_entries (engine, total_strokes);
+      }
+    }
+    g_iconv_close (converter);
+
+    g_free (path);
+
+    return engine;
+
+errored:
+    kp_engine_free (engine);
+    g_free (path);
+
+    return NULL;
+}
+
+
+//!
+//! @brief Frees a KpEngine and its stroke database
+//! @param engine The KpEngine to free
+//!
+void
+kp_engine_free (KpEngine *engine)
+{
+    //Sanity checks
+    if (engine == NULL) return;
+
+    //Declarations
+    gint i;
+
+    for (i = 0; i <= KP_ENGINE_MAX_STROKES; i++)
+    {
+      if (engine->stroke_dicts[i] != NULL) g_free (engine->stroke_dicts[i]); engine->stroke_dicts[i] = NULL;
+      if (engine->entries[i] != NULL) g_free (engine->entries[i]); engine->entries[i] = NULL;
+    }
+    if (engine->characters != NULL) g_hash_table_unref (engine->characters); engine->characters = NULL;
+
+    g_free (engine);
+}
+
+
+//!
+//! @brief Copies a stroke into the byte coordinates jstroke works with
+//! @param STROKE The stroke to convert.  It must have at least one point
+//! @param raw_stroke The RawStroke to write to
+//!
+static void
+kp_engine_convert_stroke (const KpStroke *STROKE, RawStroke *raw_stroke)
+{
+    //Declarations
+    gint i;
+
+    raw_stroke->m_len = MIN (STROKE->total_points, KP_ENGINE_MAX_STROKE_POINTS);
+    for (i = 0; i < raw_stroke->m_len; i++)
+    {
+      raw_stroke->m_x[i] = CLAMP (STROKE->points[i].x, 0, 255);
+      raw_stroke->m_y[i] = CLAMP (STROKE->points[i].y, 0, 255);
+    }
+}
+
+
+//!
+//! @brief Ranks the kanji that best match a drawing
+//!
+//! The engine is never written to after it is loaded, so this may be
+//! called from any number of threads at once.
+//!
+//! @param engine The KpEngine to use
+//! @param STROKES The strokes of the drawing in the order they were drawn
+//! @param total_strokes The number of strokes
+//! @param candidates An array to fill with the best matches, best first
+//! @param max_candidates The size of the candidates array
+//! @returns The number of candidates written
+//!
+gint
+kp_engine_recognize (KpEngine       *engine,
+                     const KpStroke *STROKES,
+                     gint            total_strokes,
+                     gunichar       *candidates,
+                     gint            max_candidates)
+{
+    //Sanity checks
+    g_return_val_if_fail (engine != NULL, 0);
+    g_return_val_if_fail (STROKES != NULL || total_strokes == 0, 0);
+    g_return_val_if_fail (candidates != NULL || max_candidates == 0, 0);
+
+    //Declarations
+    RawStroke *raw_strokes;
+    StrokeScorer *scorer;
+    gint total_raw_strokes;
+    gint total_candidates;
+    gpointer value;
+    gint i;
+
+    //Initializations
+    raw_strokes = g_new (RawStroke, KP_ENGINE_MAX_STROKES);
+    total_raw_strokes = 0;
+    total_candidates = 0;
+
+    //Convert to the byte coordinates jstroke works with, dropping empty strokes
+    for (i = 0; i < total_strokes && total_raw_strokes < KP_ENGINE_MAX_STROKES; i++)
+    {
+      if (STROKES[i].total_points < 1) continue;
+      kp_engine_convert_stroke (&STROKES[i], &raw_strokes[total_raw_strokes++]);
+    }
+
+    if (total_raw_strokes > 0 && engine->stroke_dicts[total_raw_strokes] != NULL)
+    {
+      scorer = StrokeScorerCreate (engine->stroke_dicts[total_raw_strokes], raw_strokes, total_raw_strokes);
+      if (scorer != NULL)
+      {
+        StrokeScorerProcess (scorer, -1);
+        for (i = 0; i < scorer->m_iScoreLen && total_candidates < max_candidates; i++)
+        {
+          value = g_hash_table_lookup (engine->characters, scorer->m_pScores[i].m_cp);
+          if (value != NULL) candidates[total_candidates++] = GPOINTER_TO_UINT (value);
+        }
+        StrokeScorerDestroy (scorer);
+      }
+    }
+
+    g_free (raw_strokes);
+
+    return total_candidates;
+}
+
+
+//!
+//! @brief Creates a recognizer that is fed a drawing one stroke at a time
+//!
+//! kp_engine_recognize scores every stroke of the drawing again each time it
+//! is called.  A KpRecognizer instead keeps the partial score of every entry
+//! with more strokes than have been drawn, so adding a stroke costs one
+//! stroke comparison per entry and asking for candidates only re-ranks.
+//! A KpRecognizer is not locked and may only be used by one thread at a time.
+//!
+//! @param engine The KpEngine to recognize with.  It must outlive the recognizer
+//! @returns A new KpRecognizer that should be freed with kp_recognizer_free
+//!
+KpRecognizer*
+kp_recognizer_new (KpEngine *engine)
+{
+    //Sanity checks
+    g_return_val_if_fail (engine != NULL, NULL);
+
+    //Declarations
+    KpRecognizer *recognizer;
+    gint i;
+
+    //Initializations
+    recognizer = g_new0 (KpRecognizer, 1);
+    recognizer->engine = engine;
+    recognizer->raw_strokes = g_new (RawStroke, KP_ENGINE_MAX_STROKES);
+
+    for (i = 1; i <= KP_ENGINE_MAX_STROKES; i++)
+    {
+      if (engine->entries[i] == NULL) continue;
+      recognizer->cursors[i] = g_new (gchar*, engine->total_entries[i]);
+      recognizer->scores[i] = g_new (ULong, engine->total_entries[i]);
+    }
+
+    kp_recognizer_clear (recognizer);
+
+    return recognizer;
+}
+
+
+//!
+//! @brief Frees a KpRecognizer
+//! @param recognizer The KpRecognizer to free
+//!
+void
+kp_recognizer_free (KpRecognizer *recognizer)
+{
+    //Sanity checks
+    if (recognizer == NULL) return;
+
+    //Declarations
+    gint i;
+
+    kp_recognizer_clear (recognizer);
+
+    for (i = 0; i <= KP_ENGINE_MAX_STROKES; i++)
+    {
+      if (recognizer->cursors[i] != NULL) g_free (recognizer->cursors[i]); recognizer->cursors[i] = NULL;
+      if (recognizer->scores[i] != NULL) g_free (recognizer->scores[i]); recognizer->scores[i] = NULL;
+    }
+    if (recognizer->raw_strokes != NULL) g_free (recognizer->raw_strokes); recognizer->raw_strokes = NULL;
+
+    g_free (recognizer);
+}
+
+
+//!
+//! @brief Forgets the strokes of the current drawing
+//! @param recognizer The KpRecognizer to clear
+//!
+void
+kp_recognizer_clear (KpRecognizer *recognizer)
+{
+    //Sanity checks
+    g_return_if_fail (recognizer != NULL);
+
+    //Declarations
+    KpEngine *engine;
+    gint i, j;
+
+    //Initializations
+    engine = recognizer->engine;
+
+    for (i = 0; i < recognizer->total_strokes; i++)
+    {
+      if (recognizer->segments[i] != NULL) MemPtrFree (recognizer->segments[i]); recognizer->segments[i] = NULL;
+    }
+    recognizer->total_strokes = 0;
+
+    //Every entry starts over at its first stroke description, just past its SJIS pair
+    for (i = 1; i <= KP_ENGINE_MAX_STROKES; i++)
+    {
+      for (j = 0; j < engine->total_entries[i]; j++)
+      {
+        recognizer->cursors[i][j] = engine->entries[i][j];
+        if (*recognizer->cursors[i][j] != '\0') recognizer->cursors[i][j]++;
+        if (*recognizer->cursors[i][j] != '\0') recognizer->cursors[i][j]++;
+        recognizer->scores[i][j] = 0;
+      }
+    }
+}
+
+
+//!
+//! @brief Adds the next stroke of the drawing, scoring it against the matching
+//!        stroke of every entry that has more strokes than the drawing had
+//! @param recognizer The KpRecognizer to add to
+//! @param STROKE The stroke that was drawn.  Strokes without points are ignored
+//! @returns FALSE if the stroke could not be added
+//!
+gboolean
+kp_recognizer_add_stroke (KpRecognizer *recognizer, const KpStroke *STROKE)
+{
+    //Sanity checks
+    g_return_val_if_fail (recognizer != NULL, FALSE);
+    g_return_val_if_fail (STROKE != NULL, FALSE);
+    if (STROKE->total_points < 1) return TRUE;
+    if (recognizer->total_strokes >= KP_ENGINE_MAX_STROKES) return FALSE;
+
+    //Declarations
+    KpEngine *engine;
+    RawStroke *raw_stroke;
+    Byte *segments;
+    char path[diPathBufLen + 1];
+    UInt path_length;
+    gint i, j;
+
+    //Initializations
+    engine = recognizer->engine;
+    raw_stroke = &recognizer->raw_strokes[recognizer->total_strokes];
+    kp_engine_convert_stroke (STROKE, raw_stroke);
+    segments = StrokeBuildSegments (raw_stroke);
+    if (segments == NULL) return FALSE;
+
+    recognizer->segments[recognizer->total_strokes] = segments;
+    recognizer->total_strokes++;
+
+    for (i = recognizer->total_strokes; i <= KP_ENGINE_MAX_STROKES; i++)
+    {
+      for (j = 0; j < engine->total_entries[i]; j++)
+      {
+        path_length = StrokeDicParsePath (&recognizer->cursors[i][j], path);
+        if (path_length == 0) continue;
+        recognizer->scores[i][j] = StrokeScoreAdd (
+          recognizer->scores[i][j],
+          StrokeDicScoreRawStroke (raw_stroke, segments, path, path_length)
+        );
+      }
+    }
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Returns the number of strokes that have been added
+//! @param recognizer The KpRecognizer to check
+//!
+gint
+kp_recognizer_get_total_strokes (KpRecognizer *recognizer)
+{
+    //Sanity checks
+    g_return_val_if_fail (recognizer != NULL, 0);
+
+    return recognizer->total_strokes;
+}
+
+
+//!
+//! @brief Ranks the kanji that best match the strokes added so far
+//!
+//! The candidates are the same ones kp_engine_recognize gives for the
+//! whole drawing.
+//!
+//! @param recognizer The KpRecognizer to use
+//! @param candidates An array to fill with the best matches, best first
+//! @param max_candidates The size of the candidates array
+//! @returns The number of candidates written
+//!
+gint
+kp_recognizer_get_candidates (KpRecognizer *recognizer,
+                              gunichar     *candidates,
+                              gint          max_candidates)
+{
+    //Sanity checks
+    g_return_val_if_fail (recognizer != NULL, 0);
+    g_return_val_if_fail (candidates != NULL || max_candidates == 0, 0);
+
+    //Declarations
+    KpEngine *engine;
+    StrokeScorer scorer;
+    ScoreItem picks[diMaxListCount];
+    gint total_picks;
+    gint total_strokes;
+    gint total_candidates;
+    ULong score;
+    gpointer value;
+    gint i, j;
+
+    //Initializations
+    engine = recognizer->engine;
+    total_strokes = recognizer->total_strokes;
+    total_picks = 0;
+    total_candidates = 0;
+    if (total_strokes < 1 || engine->entries[total_strokes] == NULL) return 0;
+
+    memset (&scorer, 0, sizeof(StrokeScorer));
+    scorer.m_cpStrokeDic = engine->stroke_dicts[total_strokes];
+    scorer.m_pRawStrokes = recognizer->raw_strokes;
+    scorer.m_iStrokeCnt = total_strokes;
+
+    //Keep the best picks sorted, breaking ties by dictionary order like StrokeScorerProcess
+    for (i = 0; i < engine->total_entries[total_strokes]; i++)
+    {
+      StrokeScorerFinishItem (&scorer, recognizer->cursors[total_strokes][i], recognizer->scores[total_strokes][i], &score);
+      if (total_picks == diMaxListCount && score >= picks[total_picks - 1].m_iScore) continue;
+      if (total_picks < diMaxListCount) total_picks++;
+      for (j = total_picks - 1; j > 0 && picks[j - 1].m_iScore > score; j--)
+        picks[j] = picks[j - 1];
+      picks[j].m_iScore = score;
+      picks[j].m_cp = engine->entries[total_strokes][i];
+    }
+
+    for (i = 0; i < total_picks && total_candidates < max_candidates; i++)
+    {
+      value = g_hash_table_lookup (engine->characters, picks[i].m_cp);
+      if (value != NULL) candidates[total_candidates++] = GPOINTER_TO_UINT (value);
+    }
+
+    return total_candidates;
+}
@@ -55,6 +55,7 @@
  */
 #define diMaxListCount       5
 #define diMaxXyPairs       256	/* Max pairs in stroke... */
+#define diPathBufLen        16	/* Max directions in a stroke description */
 
 /* ----- List Memory ---------------------------------------------------------
  * The idea here is to have a single nonmovable chunk of memory which contains
@@ -95,7 +96,7 @@ typedef struct StrokeScorerStruct {
 	UInt        m_iStrokeCnt;
 	ScoreItem*  m_pScores;
 	UInt        m_iScoreLen;
-	CharPtr     m_cpPath;
+	Byte**      m_ppSegments;	/* Per stroke angle table, see scoring.c */
 } StrokeScorer;
 
 ListMem*  AppEmptyList();
@@ -112,12 +113,36 @@ void          StrokeScorerDestroy  (StrokeScorer *pScorer);
 
 /* Process some database entries (maximum iMaxCnt, -1 for all).
  * Returns 0 when none remaining (should eventually return count remaining
- * to facilitate a progressbar.
+ * to facilitate a progressbar.  The entries may be split between several
+ * threads; the picks are the same as when processed one by one.
  */
 Long          StrokeScorerProcess  (StrokeScorer *pScorer, Long iMaxCnt);
 
 /* Return best diMaxListCount candidates processed so far */
 ListMem*      StrokeScorerTopPicks (StrokeScorer *pScorer);
 
+/* The pieces StrokeScorerEvalItem is made of, for callers that score the
+ * strokes of an entry one at a time as they are drawn.  Scores of single
+ * strokes are squared, summed with StrokeScoreAdd, and turned into the
+ * score of the entry by StrokeScorerFinishItem.
+ */
+
+/* Returns the entry following cp, or cp itself at the end of the bucket */
+CharPtr       StrokeDicNextEntry   (CharPtr cp);
+
+/* Angle table of a stroke, to be freed with MemPtrFree (NULL if no memory) */
+Byte*         StrokeBuildSegments  (RawStroke* rsp);
+
+/* Decodes the next stroke description, returning 0 when there are none */
+UInt          StrokeDicParsePath   (CharPtr* cppEntry, CharPtr cpPath);
+
+ULong         StrokeDicScoreRawStroke (RawStroke* rsp, Byte* bpSegs,
+									   CharPtr cpPath, UInt iPathLen);
+
+ULong         StrokeScoreAdd       (ULong iScore, ULong iThisScore);
+
+CharPtr       StrokeScorerFinishItem (StrokeScorer *pScorer, CharPtr cp,
+									  ULong iScore, ULong* ipScore);
+
 #endif /*__JSTROKE_H__*/
 /* ----- End of jstroke.h ------------------------------------------------- */
@@ -28,6 +28,14 @@
 #include "jstroke.h"
 #include "memowrite.h"
 
+#ifdef FOR_PILOT_COMPAT
+#include <glib.h>
+#endif /*FOR_PILOT_COMPAT*/
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif /*__SSE2__*/
+
 #define diAngCostBase       52	// See angles.pl for derivation.
 #define diAngCostScale      98	// See angles.pl for derivation.
 #define diHugeCost          (((((ULong)24)*diAngCostScale)+diAngCostBase)*100)
@@ -41,15 +49,28 @@
  */
 #define diScoreTextLen (2 + 2+2 + 9 + 1 + 10)
 
-#define diPathBufLen        16
+/* Segment table codes.  The low bits hold the Angle32 direction of the
+ * segment, diSegNoAngle when its ends are at the same place, and
+ * diSegLongFlag is set when it is long enough to be subdivided.
+ */
+#define diSegAngleMask      0x3f
+#define diSegNoAngle        32
+#define diSegLongFlag       0x40
+
+/* Threads are only worth starting for buckets with plenty of entries. */
+#define diMaxThreads        4
+#define diMinThreadItems    64
 
 CharPtr   StrokeScorerEvalItem(StrokeScorer *pScorer, CharPtr cpEntry,
-							   ULong* ipScore /*OUT*/);
+							   ULong* ipScore /*OUT*/, CharPtr cpPath);
 
-ULong     StrokeDicScoreStroke(Byte* bpX, Byte* bpY, UInt iLen,
+ULong     StrokeDicScoreStroke(Byte* bpSegs, UInt iStride,
+							   UInt iStart, UInt iLen,
 							   CharPtr cpPath, UInt iPathLen,
 							   UInt iDepth);
 
+Boolean   StrokeScorerBuildSegments(StrokeScorer *pScorer);
+
 CharPtr   StrokeScorerExtraFilters(StrokeScorer *pscorer,
 								   CharPtr cp, ULong* ipScore /*OUT*/);
 
@@ -111,12 +132,11 @@ StrokeScorer *StrokeScorerCreate  (CharPtr cpStrokeDic, RawStroke *rsp,
 		return NULL;
 	}
 
-	pScorer->m_cpPath = MemPtrNew(diPathBufLen+1);
+	pScorer->m_ppSegments = NULL;
 
-	if (!pScorer->m_cpPath) {
+	if (!StrokeScorerBuildSegments(pScorer)) {
 		ErrBox("Not enough memory.");
-		MemPtrFree(pScorer->m_pScores);
-		MemPtrFree(pScorer);
+		StrokeScorerDestroy(pScorer);
 		return NULL;
 	}
 
@@ -127,72 +147,216 @@ StrokeScorer *StrokeScorerCreate  (CharPtr cpStrokeDic, RawStroke *rsp,
 /* Destroy a StrokeScorer object */
 
 void StrokeScorerDestroy  (StrokeScorer *pScorer) {
+	UInt iStroke;
+
 	if (pScorer) {
+		if (pScorer->m_ppSegments) {
+			for (iStroke = 0; iStroke < pScorer->m_iStrokeCnt; iStroke++)
+				if (pScorer->m_ppSegments[iStroke])
+					MemPtrFree (pScorer->m_ppSegments[iStroke]);
+			MemPtrFree (pScorer->m_ppSegments);
+		}
 		MemPtrFree (pScorer->m_pScores);
-		MemPtrFree (pScorer->m_cpPath);
 		MemPtrFree (pScorer);
 	}
 }
 
+/* ----- ScoreHeap ----------------------------------------------------------
+ * Top picks are gathered in a max-heap of diMaxListCount items with the
+ * worst kept pick at the root.  Equal scores are ordered by position in
+ * the dictionary, as the shifting insertion used to do, so the picks do
+ * not depend on how the entries were split between threads.
+ */
+
+static Boolean ScoreItemWorse(ScoreItem* pA, ScoreItem* pB) {
+	return (pA->m_iScore > pB->m_iScore ||
+			(pA->m_iScore == pB->m_iScore && pA->m_cp > pB->m_cp));
+}
+
+static void ScoreHeapPush(ScoreItem* pHeap, UInt* ipLen,
+						  ULong iScore, CharPtr cp) {
+	ScoreItem item, tmp;
+	UInt      i, iChild;
+
+	item.m_iScore = iScore;
+	item.m_cp = cp;
+
+	if (*ipLen < diMaxListCount) {
+		/* Not full yet, sift the new item up from the bottom. */
+		i = (*ipLen)++;
+		pHeap[i] = item;
+		while (i > 0 && ScoreItemWorse(&pHeap[i], &pHeap[(i - 1) >> 1])) {
+			tmp = pHeap[i];
+			pHeap[i] = pHeap[(i - 1) >> 1];
+			pHeap[(i - 1) >> 1] = tmp;
+			i = (i - 1) >> 1;
+		}
+		return;
+	}
+
+	/* Full, so it has to beat the worst pick and then sift down. */
+	if (!ScoreItemWorse(&pHeap[0], &item))
+		return;
+
+	pHeap[0] = item;
+	for (i = 0; (iChild = 2 * i + 1) < *ipLen; i = iChild) {
+		if (iChild + 1 < *ipLen && ScoreItemWorse(&pHeap[iChild + 1], &pHeap[iChild]))
+			iChild++;
+		if (!ScoreItemWorse(&pHeap[iChild], &pHeap[i]))
+			break;
+		tmp = pHeap[i];
+		pHeap[i] = pHeap[iChild];
+		pHeap[iChild] = tmp;
+	}
+}
+
+/* ----- ScoreWorker --------------------------------------------------------*/
+
+typedef struct {
+	StrokeScorer* m_pScorer;
+	CharPtr*      m_cppEntries;
+	UInt          m_iEntryCnt;
+	ScoreItem     m_scores[diMaxListCount];
+	UInt          m_iScoreLen;
+	char          m_path[diPathBufLen+1];
+} ScoreWorker;
+
+static VoidPtr StrokeScorerWork(VoidPtr pData) {
+	ScoreWorker* pWorker = (ScoreWorker*) pData;
+	ULong        iScore;
+	UInt         i;
+
+	for (i = 0; i < pWorker->m_iEntryCnt; i++) {
+		StrokeScorerEvalItem(pWorker->m_pScorer, pWorker->m_cppEntries[i],
+							 &iScore, pWorker->m_path);
+		ScoreHeapPush(pWorker->m_scores, &pWorker->m_iScoreLen,
+					  iScore, pWorker->m_cppEntries[i]);
+	}
+
+	return NULL;
+}
+
+/* ----- StrokeDicNextEntry -------------------------------------------------*/
+/* Skips to the start of the next entry: past the SJIS pair and then up to
+ * the next byte with the high order bit set.
+ */
+
+CharPtr StrokeDicNextEntry(CharPtr cp) {
+	if (*cp) cp++;
+	if (*cp) cp++;
+	while (*cp && !(*cp & 0x80))
+		cp++;
+	return cp;
+}
+
 /* ----- StrokeScorerProcess-------------------------------------------------*/
 /* Process some database entries (maximum iMaxCnt, -1 for all).
    Returns 0 when none remaining (should eventually return count remaining
    to facilitate a progressbar */
 
 Long     StrokeScorerProcess  (StrokeScorer *pScorer, Long iMaxCnt) {
-	CharPtr      cp, cpNext;
-	ULong        iScore;
+	CharPtr      cp;
+	CharPtr*     cppEntries;
+	ScoreWorker* pWorkers;
+	ScoreItem    heap[diMaxListCount];
+	UInt         iHeapLen;
+	ScoreItem    tmp;
 	Long         iCnt;
-	ScoreItemPtr pScore, pScoreBase, pSrc;
+	UInt         iWorkerCnt, iWorker, iPer, i, j;
+#ifdef FOR_PILOT_COMPAT
+	GThread*     threads[diMaxThreads];
+#endif /*FOR_PILOT_COMPAT*/
 
 	if (!pScorer) {
 		ErrBox("StrokeScorerProcess: pScorer == NULL.");
 		return 0;
 	}
 
-	pScoreBase = pScorer->m_pScores;
-
-	/* Evaluate all the items in cpStrokeDic against Context,
-	 * and update ScoreItems list as we go.
-	 */
+	/* Find the entries in cpStrokeDic to evaluate against Context. */
 
 	iCnt = 0;
-	for (cp = pScorer->m_cpStrokeDic; *cp; cp = cpNext) {
-
+	for (cp = pScorer->m_cpStrokeDic; *cp && (iMaxCnt < 0 || iCnt < iMaxCnt); cp = StrokeDicNextEntry(cp))
 		iCnt++;
-		if (iMaxCnt >= 0 && iCnt > iMaxCnt)
-			break;
 
-		cpNext = StrokeScorerEvalItem(pScorer, cp, &iScore);
+	cppEntries = (CharPtr*) MemPtrNew((iCnt + 1) * sizeof(CharPtr));
+	if (!cppEntries) {
+		ErrBox("Not enough memory.");
+		return 0;
+	}
 
-		for (pScore = pScoreBase+pScorer->m_iScoreLen-1;
-			 pScore>=pScoreBase; pScore--) { 
-			if (iScore >= pScore->m_iScore)
-				break;
-		}
-		pScore++;
+	i = 0;
+	for (cp = pScorer->m_cpStrokeDic; i < iCnt; cp = StrokeDicNextEntry(cp))
+		cppEntries[i++] = cp;
 
-		/* If we have a top score, lets register it. */
-		if (pScore < (pScoreBase + diMaxListCount)) {
+	/* Split them into contiguous runs, one for each worker. */
 
-			/* Increase the score list length if it isn't full yet. */
-			if (pScorer->m_iScoreLen < diMaxListCount)
-				pScorer->m_iScoreLen++;
+	iWorkerCnt = 1;
+#ifdef FOR_PILOT_COMPAT
+	iWorkerCnt = iCnt / diMinThreadItems;
+	if (iWorkerCnt > diMaxThreads)
+		iWorkerCnt = diMaxThreads;
+	if (iWorkerCnt < 1)
+		iWorkerCnt = 1;
+#endif /*FOR_PILOT_COMPAT*/
 
-			/* Push down all lower scores in the list to make room. */
-			for (pSrc = pScoreBase+pScorer->m_iScoreLen-2; pSrc >= pScore; pSrc--) {
-				pSrc[1].m_iScore = pSrc->m_iScore;
-				pSrc[1].m_cp     = pSrc->m_cp;
-			}
+	pWorkers = (ScoreWorker*) MemPtrNew(iWorkerCnt * sizeof(ScoreWorker));
+	if (!pWorkers) {
+		ErrBox("Not enough memory.");
+		MemPtrFree(cppEntries);
+		return 0;
+	}
 
-			/* Actually store our info in the list. */
-			pScore->m_iScore = iScore;
-			pScore->m_cp = cp;
-		}
+	iPer = (iCnt + iWorkerCnt - 1) / iWorkerCnt;
+	for (iWorker = 0; iWorker < iWorkerCnt; iWorker++) {
+		pWorkers[iWorker].m_pScorer = pScorer;
+		pWorkers[iWorker].m_cppEntries = cppEntries + iWorker * iPer;
+		pWorkers[iWorker].m_iEntryCnt = (iWorker == iWorkerCnt - 1) ? iCnt - iWorker * iPer : iPer;
+		pWorkers[iWorker].m_iScoreLen = 0;
+	}
+
+	/* The calling thread takes the first run itself. */
+
+#ifdef FOR_PILOT_COMPAT
+	for (iWorker = 1; iWorker < iWorkerCnt; iWorker++) {
+		threads[iWorker] = g_thread_try_new("jstroke-scorer", StrokeScorerWork, &pWorkers[iWorker], NULL);
+		if (!threads[iWorker])
+			StrokeScorerWork(&pWorkers[iWorker]);
+	}
+#endif /*FOR_PILOT_COMPAT*/
+
+	StrokeScorerWork(&pWorkers[0]);
 
-	} /* for each stroke description... */
+#ifdef FOR_PILOT_COMPAT
+	for (iWorker = 1; iWorker < iWorkerCnt; iWorker++)
+		if (threads[iWorker])
+			g_thread_join(threads[iWorker]);
+#endif /*FOR_PILOT_COMPAT*/
 
-	if (cp)
+	/* Merge the picks from earlier calls and from each worker... */
+
+	iHeapLen = 0;
+	for (i = 0; i < pScorer->m_iScoreLen; i++)
+		ScoreHeapPush(heap, &iHeapLen, pScorer->m_pScores[i].m_iScore, pScorer->m_pScores[i].m_cp);
+	for (iWorker = 0; iWorker < iWorkerCnt; iWorker++)
+		for (i = 0; i < pWorkers[iWorker].m_iScoreLen; i++)
+			ScoreHeapPush(heap, &iHeapLen, pWorkers[iWorker].m_scores[i].m_iScore, pWorkers[iWorker].m_scores[i].m_cp);
+
+	/* ...and store them best first. */
+
+	for (i = 1; i < iHeapLen; i++) {
+		tmp = heap[i];
+		for (j = i; j > 0 && ScoreItemWorse(&heap[j - 1], &tmp); j--)
+			heap[j] = heap[j - 1];
+		heap[j] = tmp;
+	}
+	for (i = 0; i < iHeapLen; i++)
+		pScorer->m_pScores[i] = heap[i];
+	pScorer->m_iScoreLen = iHeapLen;
+
+	MemPtrFree(pWorkers);
+	MemPtrFree(cppEntries);
+
+	if (*cp)
 		return 1;				/* should be count remaining */
 	else
 		return 0;
@@ -270,117 +434,119 @@ ListMem*      StrokeScorerTopPicks (StrokeScorer *pScorer)
 	return pListMem;
 }
 
-/* ----- StrokeScorerEvalItem -----------------------------------------------*/
-
-CharPtr StrokeScorerEvalItem(StrokeScorer *pScorer, CharPtr cpEntry,
-							 ULong* ipScore /*OUT*/) {
-	CharPtr cp = cpEntry;
-	UInt    iStroke;
-	CharPtr cpPath = pScorer->m_cpPath;
-	CharPtr cpPathEnd;
-	RawStroke* rsp;
-	ULong   iThisScore;
-	ULong   iScore = 0;
-
-	MemoWriteLen(pScorer->m_cpStrokeDic, 2); /* DEBUG: tag trace with SJIS char. */
-
-	if (*cp) cp++;				/* Skip over first half SJIS char. */
-	if (*cp) cp++;				/* Skip over second half SJIS char. */
-
-	/* The first char must have high order bit set,
-	 * and the second char MAY have high order bit set,
-	 * but a subsequent char with high order bit set must be
-	 * the beginning of the next entry.  -rwells, 970712.
-	 */
-
-	/* Loop through stroke descriptions */
-	for (iStroke = 0; iStroke < pScorer->m_iStrokeCnt; iStroke++) {
+/* ----- StrokeDicParsePath --------------------------------------------------
+ * Decodes the next stroke description of an entry into Angle32 directions
+ * at cpPath and steps *cppEntry past it.  Returns the number of directions,
+ * or 0 if there are no more stroke descriptions.
+ */
 
-		cpPathEnd = cpPath;
+UInt StrokeDicParsePath(CharPtr* cppEntry, CharPtr cpPath) {
+	CharPtr cp = *cppEntry;
+	CharPtr cpPathEnd = cpPath;
+
+	switch (*cp) {		/* Break out on first char value... */
+	case 'A':			/* TDR='1' CLK=07:30 DEG=225 */
+		*cpPathEnd++ = 20; break; 
+	case 'B':			/* TDR='2' CLK=06:00 DEG=180 */
+		*cpPathEnd++ = 16; break; 
+	case 'C':			/* TDR='3' CLK=04:30 DEG=135 */
+		*cpPathEnd++ = 12; break; 
+	case 'D':			/* TDR='4' CLK=09:00 DEG=270 */
+		*cpPathEnd++ = 24; break; 
+	case 'F':			/* TDR='6' CLK=03:00 DEG=090 */
+		*cpPathEnd++ =  8; break; 
+	case 'G':			/* TDR='7' CLK=10:30 DEG=315 */
+		*cpPathEnd++ = 28; break; 
+	case 'H':			/* TDR='8' CLK=12:00 DEG=360 */
+		*cpPathEnd++ =  0; break; 
+	case 'I':			/* TDR='9' CLK=01:30 DEG=045 */
+		*cpPathEnd++ =  4; break; 
+	case 'J':			/* TDR='x' down   06:00 then 07:30 */
+		*cpPathEnd++ = 16; *cpPathEnd++ = 20; break; 
+	case 'K':			/* TDR='y' down   06:00 then 04:30 */
+		*cpPathEnd++ = 16; *cpPathEnd++ = 12; break; 
+	case 'L':			/* TDR='c' down   06:00 then 03:00 */
+		*cpPathEnd++ = 16; *cpPathEnd++ =  8; break; 
+	case 'M':			/* TDR='b' across 03:00 then 06:00 */
+		*cpPathEnd++ =  8; *cpPathEnd++ = 16; break; 
+	default:
+		return 0;
+	} /* end switch on first char value */
 
-		switch (*cp) {		/* Break out on first char value... */
-		case 'A':			/* TDR='1' CLK=07:30 DEG=225 */
+	for (cp++; ; cp++) {	/* Loop through following chars for stroke */
+		switch (*cp) {		/* Break out on char value... */
+		case 'a':			/* TDR='1' CLK=07:30 DEG=225 */
 			*cpPathEnd++ = 20; break; 
-		case 'B':			/* TDR='2' CLK=06:00 DEG=180 */
+		case 'b':			/* TDR='2' CLK=06:00 DEG=180 */
 			*cpPathEnd++ = 16; break; 
-		case 'C':			/* TDR='3' CLK=04:30 DEG=135 */
+		case 'c':			/* TDR='3' CLK=04:30 DEG=135 */
 			*cpPathEnd++ = 12; break; 
-		case 'D':			/* TDR='4' CLK=09:00 DEG=270 */
+		case 'd':			/* TDR='4' CLK=09:00 DEG=270 */
 			*cpPathEnd++ = 24; break; 
-		case 'F':			/* TDR='6' CLK=03:00 DEG=090 */
+		case 'f':			/* TDR='6' CLK=03:00 DEG=090 */
 			*cpPathEnd++ =  8; break; 
-		case 'G':			/* TDR='7' CLK=10:30 DEG=315 */
+		case 'g':			/* TDR='7' CLK=10:30 DEG=315 */
 			*cpPathEnd++ = 28; break; 
-		case 'H':			/* TDR='8' CLK=12:00 DEG=360 */
+		case 'h':			/* TDR='8' CLK=12:00 DEG=360 */
 			*cpPathEnd++ =  0; break; 
-		case 'I':			/* TDR='9' CLK=01:30 DEG=045 */
+		case 'i':			/* TDR='9' CLK=01:30 DEG=045 */
 			*cpPathEnd++ =  4; break; 
-		case 'J':			/* TDR='x' down   06:00 then 07:30 */
+		case 'j':			/* TDR='x' down   06:00 then 07:30 */
 			*cpPathEnd++ = 16; *cpPathEnd++ = 20; break; 
-		case 'K':			/* TDR='y' down   06:00 then 04:30 */
+		case 'k':			/* TDR='y' down   06:00 then 04:30 */
 			*cpPathEnd++ = 16; *cpPathEnd++ = 12; break; 
-		case 'L':			/* TDR='c' down   06:00 then 03:00 */
+		case 'l':			/* TDR='c' down   06:00 then 03:00 */
 			*cpPathEnd++ = 16; *cpPathEnd++ =  8; break; 
-		case 'M':			/* TDR='b' across 03:00 then 06:00 */
+		case 'm':			/* TDR='b' across 03:00 then 06:00 */
 			*cpPathEnd++ =  8; *cpPathEnd++ = 16; break; 
 		default:
-			goto NoMoreStrokes;
-		} /* end switch on first char value */
-
-		for (cp++; ; cp++) {	/* Loop through following chars for stroke */
-			switch (*cp) {		/* Break out on char value... */
-			case 'a':			/* TDR='1' CLK=07:30 DEG=225 */
-				*cpPathEnd++ = 20; break; 
-			case 'b':			/* TDR='2' CLK=06:00 DEG=180 */
-				*cpPathEnd++ = 16; break; 
-			case 'c':			/* TDR='3' CLK=04:30 DEG=135 */
-				*cpPathEnd++ = 12; break; 
-			case 'd':			/* TDR='4' CLK=09:00 DEG=270 */
-				*cpPathEnd++ = 24; break; 
-			case 'f':			/* TDR='6' CLK=03:00 DEG=090 */
-				*cpPathEnd++ =  8; break; 
-			case 'g':			/* TDR='7' CLK=10:30 DEG=315 */
-				*cpPathEnd++ = 28; break; 
-			case 'h':			/* TDR='8' CLK=12:00 DEG=360 */
-				*cpPathEnd++ =  0; break; 
-			case 'i':			/* TDR='9' CLK=01:30 DEG=045 */
-				*cpPathEnd++ =  4; break; 
-			case 'j':			/* TDR='x' down   06:00 then 07:30 */
-				*cpPathEnd++ = 16; *cpPathEnd++ = 20; break; 
-			case 'k':			/* TDR='y' down   06:00 then 04:30 */
-				*cpPathEnd++ = 16; *cpPathEnd++ = 12; break; 
-			case 'l':			/* TDR='c' down   06:00 then 03:00 */
-				*cpPathEnd++ = 16; *cpPathEnd++ =  8; break; 
-			case 'm':			/* TDR='b' across 03:00 then 06:00 */
-				*cpPathEnd++ =  8; *cpPathEnd++ = 16; break; 
-			default:
-				goto ThisStrokeDone;
-			} /* end switch on char value */
-		} /* end loop through chars for stroke */
+			goto ThisStrokeDone;
+		} /* end switch on char value */
+	} /* end loop through chars for stroke */
 ThisStrokeDone:
 
-		rsp = &(pScorer->m_pRawStrokes[iStroke]);
+	*cppEntry = cp;
+	return (cpPathEnd - cpPath);
+}
 
-		iThisScore = StrokeDicScoreStroke(rsp->m_x, rsp->m_y, rsp->m_len,
-										  cpPath, (cpPathEnd - cpPath),
-										  0 /*depth*/);
-		
-		MemoWrite2d(" s", iStroke+1);
-		MemoWrite2d("=", iThisScore); /* DEBUG: stroke score */
+/* ----- StrokeDicScoreRawStroke ---------------------------------------------
+ * Scores one drawn stroke against one stroke description, returning the
+ * squared score that goes into the sum for the whole entry.
+ */
 
-		if (iThisScore >= diMaxScoreToSquare)
-			iThisScore = diMaxScoreSquared;
-		else
-			iThisScore = (iThisScore * iThisScore);
+ULong StrokeDicScoreRawStroke(RawStroke* rsp, Byte* bpSegs,
+							  CharPtr cpPath, UInt iPathLen) {
+	ULong iThisScore;
 
-		if (iScore >= (diMaxScoreSquared - iThisScore))
-			iScore = diMaxScoreSquared;
-		else
-			iScore += iThisScore;
+	iThisScore = StrokeDicScoreStroke(bpSegs, rsp->m_len,
+									  0, rsp->m_len,
+									  cpPath, iPathLen,
+									  0 /*depth*/);
 
-	} /* end loop through stroke descriptions */
-NoMoreStrokes:
+	if (iThisScore >= diMaxScoreToSquare)
+		return diMaxScoreSquared;
+	else
+		return (iThisScore * iThisScore);
+}
+
+/* ----- StrokeScoreAdd ----------------------------------------------------*/
 
+ULong StrokeScoreAdd(ULong iScore, ULong iThisScore) {
+	if (iScore >= (diMaxScoreSquared - iThisScore))
+		return diMaxScoreSquared;
+	else
+		return iScore + iThisScore;
+}
+
+/* ----- StrokeScorerFinishItem ----------------------------------------------
+ * Turns the summed squares of the stroke scores of an entry into its final
+ * score, applying the extra filters that follow the stroke descriptions.
+ * cp points just past the last stroke description; returns the start of
+ * the next entry.
+ */
+
+CharPtr StrokeScorerFinishItem(StrokeScorer *pScorer, CharPtr cp,
+							   ULong iScore, ULong* ipScore /*OUT*/) {
 	iScore = SqrtULong(iScore);
 	*ipScore = iScore;
 
@@ -391,8 +557,6 @@ NoMoreStrokes:
 		cp = StrokeScorerExtraFilters(pScorer, cp+1, ipScore);
 	}
 
-	if (iStroke != pScorer->m_iStrokeCnt)
-		ErrBox("JStrokeDic miscount");
 	if (!(*cp & 0x80) && (*cp != '\0'))
 		ErrBox("JStrokeDic leftovers");
 
@@ -403,40 +567,205 @@ NoMoreStrokes:
 	return cp;
 }
 
+/* ----- StrokeScorerEvalItem -----------------------------------------------*/
+
+CharPtr StrokeScorerEvalItem(StrokeScorer *pScorer, CharPtr cpEntry,
+							 ULong* ipScore /*OUT*/, CharPtr cpPath) {
+	CharPtr cp = cpEntry;
+	UInt    iStroke;
+	UInt    iPathLen;
+	ULong   iThisScore;
+	ULong   iScore = 0;
+
+	MemoWriteLen(pScorer->m_cpStrokeDic, 2); /* DEBUG: tag trace with SJIS char. */
+
+	if (*cp) cp++;				/* Skip over first half SJIS char. */
+	if (*cp) cp++;				/* Skip over second half SJIS char. */
+
+	/* The first char must have high order bit set,
+	 * and the second char MAY have high order bit set,
+	 * but a subsequent char with high order bit set must be
+	 * the beginning of the next entry.  -rwells, 970712.
+	 */
+
+	/* Loop through stroke descriptions */
+	for (iStroke = 0; iStroke < pScorer->m_iStrokeCnt; iStroke++) {
+
+		if (!(iPathLen = StrokeDicParsePath(&cp, cpPath)))
+			break;
+
+		iThisScore = StrokeDicScoreRawStroke(&(pScorer->m_pRawStrokes[iStroke]),
+											 pScorer->m_ppSegments[iStroke],
+											 cpPath, iPathLen);
+		
+		MemoWrite2d(" s", iStroke+1);
+		MemoWrite2d("=", iThisScore); /* DEBUG: stroke score */
+
+		iScore = StrokeScoreAdd(iScore, iThisScore);
+
+	} /* end loop through stroke descriptions */
+
+	if (iStroke != pScorer->m_iStrokeCnt)
+		ErrBox("JStrokeDic miscount");
+
+	return StrokeScorerFinishItem(pScorer, cp, iScore, ipScore);
+}
+
+/* ----- StrokeSegmentCode -------------------------------------------------*/
+
+static Byte StrokeSegmentCode(Long iDifX, Long iDifY) {
+	Byte iCode;
+
+	if (iDifX == 0 && iDifY == 0) /* Two samples at same place... */
+		return diSegNoAngle;
+
+	iCode = (Byte) Angle32(iDifX, iDifY);
+	if ((iDifX*iDifX + iDifY*iDifY) > (20*20))
+		iCode |= diSegLongFlag;
+
+	return iCode;
+}
+
+/* ----- StrokeBuildSegments ------------------------------------------------
+ * StrokeDicScoreStroke only ever looks at the two ends of a piece of a
+ * stroke, and the same pieces come up again for every entry in the
+ * dictionary.  So the direction and length test of every piece of every
+ * stroke are worked out once up front, m_ppSegments[stroke][start*len+end],
+ * eight ends at a time with SSE2, and scoring is left with table lookups.
+ */
+
+Byte* StrokeBuildSegments(RawStroke* rsp) {
+	Byte*      bpSegs;
+	Byte*      bpRow;
+	UInt       iStart, iEnd, iLen;
+
+	iLen = rsp->m_len;
+	bpSegs = (Byte*) MemPtrNew(iLen * iLen + 1);
+	if (!bpSegs)
+		return NULL;
+
+	for (iStart = 0; iStart < iLen; iStart++) {
+		bpRow = bpSegs + iStart * iLen;
+		iEnd = iStart;
+#ifdef __SSE2__
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i x0 = _mm_set1_epi16(rsp->m_x[iStart]);
+			const __m128i y0 = _mm_set1_epi16(rsp->m_y[iStart]);
+			__m128i x, y, dx, dy, xneg, yneg, ax, ay, flip, lo, hi, mn, mx;
+			__m128i isLong, i32nd, same, lt;
+			static const short thresholds[4] = { 10, 31, 54, 83 };
+			int t;
+
+			for (; iEnd + 8 <= iLen; iEnd += 8) {
+				x = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*) (rsp->m_x + iEnd)), zero);
+				y = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*) (rsp->m_y + iEnd)), zero);
+				dx = _mm_sub_epi16(x, x0);
+				dy = _mm_sub_epi16(y0, y); /* Flip from display to math axes. */
+
+				lo = _mm_unpacklo_epi16(dx, dy);
+				hi = _mm_unpackhi_epi16(dx, dy);
+				isLong = _mm_packs_epi32(
+					_mm_cmpgt_epi32(_mm_madd_epi16(lo, lo), _mm_set1_epi32(20*20)),
+					_mm_cmpgt_epi32(_mm_madd_epi16(hi, hi), _mm_set1_epi32(20*20)));
+
+				/* Angle32, with islope < T tested as 100*xdif < T*ydif. */
+				xneg = _mm_cmplt_epi16(dx, zero);
+				yneg = _mm_cmplt_epi16(dy, zero);
+				ax = _mm_sub_epi16(_mm_xor_si128(dx, xneg), xneg);
+				ay = _mm_sub_epi16(_mm_xor_si128(dy, yneg), yneg);
+				flip = _mm_cmplt_epi16(ay, ax);
+				mn = _mm_min_epi16(ax, ay);
+				mx = _mm_max_epi16(ax, ay);
+
+				i32nd = zero;
+				for (t = 0; t < 4; t++) {
+					lt = _mm_cmplt_epi16(_mm_mullo_epi16(mn, _mm_set1_epi16(100)),
+										 _mm_mullo_epi16(mx, _mm_set1_epi16(thresholds[t])));
+					i32nd = _mm_add_epi16(i32nd, _mm_andnot_si128(lt, _mm_set1_epi16(1)));
+				}
+				i32nd = _mm_or_si128(_mm_and_si128(flip, _mm_sub_epi16(_mm_set1_epi16(8), i32nd)),
+									 _mm_andnot_si128(flip, i32nd));
+				i32nd = _mm_or_si128(_mm_and_si128(yneg, _mm_sub_epi16(_mm_set1_epi16(16), i32nd)),
+									 _mm_andnot_si128(yneg, i32nd));
+				i32nd = _mm_or_si128(_mm_and_si128(xneg, _mm_sub_epi16(_mm_set1_epi16(32), i32nd)),
+									 _mm_andnot_si128(xneg, i32nd));
+				i32nd = _mm_and_si128(i32nd, _mm_set1_epi16(31));
+
+				same = _mm_cmpeq_epi16(_mm_or_si128(ax, ay), zero);
+				i32nd = _mm_or_si128(_mm_and_si128(same, _mm_set1_epi16(diSegNoAngle)),
+									 _mm_andnot_si128(same, i32nd));
+				i32nd = _mm_or_si128(i32nd, _mm_and_si128(isLong, _mm_set1_epi16(diSegLongFlag)));
+
+				_mm_storel_epi64((__m128i*) (bpRow + iEnd), _mm_packus_epi16(i32nd, i32nd));
+			}
+		}
+#endif /*__SSE2__*/
+		for (; iEnd < iLen; iEnd++)
+			bpRow[iEnd] = StrokeSegmentCode(((Long) rsp->m_x[iEnd]) - rsp->m_x[iStart],
+											((Long) rsp->m_y[iStart]) - rsp->m_y[iEnd]);
+	}
+
+	return bpSegs;
+}
+
+/* ----- StrokeScorerBuildSegments ----------------------------------------*/
+
+Boolean StrokeScorerBuildSegments(StrokeScorer *pScorer) {
+	UInt       iStroke;
+
+	pScorer->m_ppSegments = (Byte**) MemPtrNew(pScorer->m_iStrokeCnt * sizeof(Byte*));
+	if (!pScorer->m_ppSegments)
+		return false;
+	for (iStroke = 0; iStroke < pScorer->m_iStrokeCnt; iStroke++)
+		pScorer->m_ppSegments[iStroke] = NULL;
+
+	for (iStroke = 0; iStroke < pScorer->m_iStrokeCnt; iStroke++) {
+		pScorer->m_ppSegments[iStroke] = StrokeBuildSegments(&(pScorer->m_pRawStrokes[iStroke]));
+		if (!pScorer->m_ppSegments[iStroke])
+			return false;
+	}
+
+	return true;
+}
+
 /* ----- StrokeDicScoreStroke ---------------------------------------------- */
+/* Scores the piece of a stroke from iStart running iLen samples, using the
+ * segment table of the stroke (iStride is the stroke length).
+ */
 
-ULong StrokeDicScoreStroke(Byte* bpX, Byte* bpY, UInt iLen,
+ULong StrokeDicScoreStroke(Byte* bpSegs, UInt iStride,
+						   UInt iStart, UInt iLen,
 						   CharPtr cpPath, UInt iPathLen,
-								  UInt iDepth) {
+						   UInt iDepth) {
 	ULong iScore, iThisScore;
 	Long iMid, iStep, iPathMid, iPathRest;
-	Long iDifX, iDifY;
+	UInt iSeg;
 	UInt iAng32, iPath32, iDif32;
 
 	if (iLen < 2 || iPathLen < 1)
 		return diHugeCost;
 
 	if (iPathLen == 1) {
-		iDifX = bpX[iLen-1] - bpX[0];
-		iDifY = bpY[0] - bpY[iLen-1]; /* Flip from display to math axes. */
+		iSeg = bpSegs[iStart * iStride + iStart + iLen - 1];
 
-		if (iDifX == 0 && iDifY == 0) /* Two samples at same place... */
+		if ((iSeg & diSegAngleMask) == diSegNoAngle) /* Two samples at same place... */
 			return diHugeCost;
 
 		/* Subdivide recursively while stroke is long and depth is shallow.
 		 * $$$ These values are pretty magic... review later. -rwells, 970719.
 		 * TDR used 20*20... -rwells, 970719.
 		 */
-		if ((iDifX*iDifX + iDifY*iDifY) > (20*20) && iLen > 5 && iDepth < 4) {
+		if ((iSeg & diSegLongFlag) && iLen > 5 && iDepth < 4) {
 
 			iMid = iLen >> 1;
 
 			/* Note that we use the middle point on both sides... */
 
-			iScore  = StrokeDicScoreStroke(bpX, bpY, iMid+1,
+			iScore  = StrokeDicScoreStroke(bpSegs, iStride, iStart, iMid+1,
 										   cpPath, iPathLen, iDepth+1);
 
-			iScore += StrokeDicScoreStroke(bpX+iMid, bpY+iMid, iLen-iMid,
+			iScore += StrokeDicScoreStroke(bpSegs, iStride, iStart+iMid, iLen-iMid,
 										   cpPath, iPathLen, iDepth+1);
 
 			return (iScore >> 1);
@@ -445,7 +774,7 @@ ULong StrokeDicScoreStroke(Byte* bpX, Byte* bpY, UInt iLen,
 
 		/* Time to score this segment against desired direction. */
 		
-		iAng32 = Angle32(iDifX, iDifY);
+		iAng32 = iSeg & diSegAngleMask;
 
 		iPath32 = *cpPath;
 
@@ -472,10 +801,10 @@ ULong StrokeDicScoreStroke(Byte* bpX, Byte* bpY, UInt iLen,
 
 			/* TDR original doesn't increase iDepth... -rwells, 970719. */
 
-			iThisScore  = StrokeDicScoreStroke(bpX, bpY, iMid+1,
+			iThisScore  = StrokeDicScoreStroke(bpSegs, iStride, iStart, iMid+1,
 											   cpPath, iPathMid, iDepth+1);
 
-			iThisScore += StrokeDicScoreStroke(bpX+iMid, bpY+iMid, iLen-iMid,
+			iThisScore += StrokeDicScoreStroke(bpSegs, iStride, iStart+iMid, iLen-iMid,
 											   cpPath+iPathMid, iPathRest,
 											   iDepth+1);
 
@@ -21,106 +21,35 @@
 #include <string.h>
 #include <errno.h>
 #include <glib.h>
-#include "jstroke/jstroke.h"
+#include "kpengine.h"
 
-#define MAX_STROKES 32
 #define BUFLEN 1024
 
-static char *stroke_dicts[MAX_STROKES];
+static KpEngine *engine;
 static char *progname;
 static char *data_file;
 
 void
 load_database()
 {
-  FILE *file;
-  int i;
+  GError *error = NULL;
 
-  if (data_file)
-    {
-      file = fopen (data_file, "rb");
-    }
-  else
-    {
-#ifndef G_OS_WIN32
-      gchar *dir = g_strdup (KP_LIBDIR);
-#else
-      gchar *prefix = g_win32_get_package_installation_directory_of_module (NULL);
-      gchar *dir = g_build_filename (prefix, "..", "..", "share", "gwaei", NULL);
-      g_free (prefix);
-#endif
-      char *fname = g_build_filename (dir, "jdata.dat", NULL);
-      file = fopen (fname, "rb");
-      
-      g_free (fname);
-      g_free (dir);
-    }
+  engine = kp_engine_new (data_file, &error);
 
-  if (!file)
+  if (!engine)
     {
-      fprintf(stderr,"%s: Can't open %s\n", progname,
-	      data_file ? data_file : "jdata.dat");
+      fprintf(stderr,"%s: %s\n", progname, error->message);
+      g_error_free (error);
       exit(1);
     }
-
-
-  for (i=0;i<MAX_STROKES;i++)
-    stroke_dicts[i] = NULL;
-
-  while (1)
-    {
-      int n_read;
-      unsigned int nstrokes;
-      unsigned int len;
-      int buf[2];
-
-      n_read = fread (buf, sizeof(int), 2, file);
-      
-      nstrokes = GUINT32_FROM_BE(buf[0]);
-      len = GUINT32_FROM_BE(buf[1]);
-
-      if ((n_read != 2) || (nstrokes > MAX_STROKES))
-	{
-	  fprintf(stderr, "%s: Corrupt stroke database\n", progname);
-	  exit(1);
-	}
-
-      if (nstrokes == 0)
-	break;
-
-      stroke_dicts[nstrokes] = malloc(len);
-      n_read = fread(stroke_dicts[nstrokes], 1, len, file);
-
-      if (n_read != len)
-	{
-	  fprintf(stderr, "%s: Corrupt stroke database", progname);
-	  exit(1);
-	}
-    }
-  
-  fclose (file);
-}
-
-/* From Ken Lunde's _Understanding Japanese Information Processing_
-   O'Reilly, 1993 */
-
-void 
-sjis2jis(unsigned char *p1, unsigned char *p2)
-{
-  unsigned char c1 = *p1;
-  unsigned char c2 = *p2;
-  int adjust = c2 < 159;
-  int rowOffset = c1 < 160 ? 112 : 176;
-  int cellOffset = adjust ? (c2 > 127 ? 32 : 31) : 126;
-  
-  *p1 = ((c1 - rowOffset) << 1) - adjust;
-  *p2 -= cellOffset;  
 }
 
 int
 process_strokes (FILE *file)
 {
-  RawStroke strokes[MAX_STROKES];
+  static KpPoint points[KP_ENGINE_MAX_STROKES][KP_ENGINE_MAX_STROKE_POINTS];
+  KpStroke strokes[KP_ENGINE_MAX_STROKES];
+  gunichar candidates[KP_ENGINE_MAX_CANDIDATES];
   char *buffer = malloc(BUFLEN);
   int buflen = BUFLEN;
   int nstrokes = 0;
@@ -148,11 +77,11 @@ process_strokes (FILE *file)
       len = 0;
       p = buffer;
       
-      while (1) {
+      while (len < KP_ENGINE_MAX_STROKE_POINTS) {
 	while (isspace (*p)) p++;
 	if (*p == 0)
 	  break;
-	strokes[nstrokes].m_x[len] = strtol (p, &q, 0);
+	points[nstrokes][len].x = strtol (p, &q, 0);
 	if (p == q)
 	  break;
 	p = q;
@@ -160,7 +89,7 @@ process_strokes (FILE *file)
 	while (isspace (*p)) p++;
 	if (*p == 0)
 	  break;
-	strokes[nstrokes].m_y[len] = strtol (p, &q, 0);
+	points[nstrokes][len].y = strtol (p, &q, 0);
 	if (p == q)
 	  break;
 	p = q;
@@ -171,38 +100,28 @@ process_strokes (FILE *file)
       if (len == 0)
 	break;
       
-      strokes[nstrokes].m_len = len;
+      strokes[nstrokes].points = points[nstrokes];
+      strokes[nstrokes].total_points = len;
       nstrokes++;
-      if (nstrokes == MAX_STROKES)
+      if (nstrokes == KP_ENGINE_MAX_STROKES)
 	break;
     }
+
+  free (buffer);
   
-  if (nstrokes != 0 && stroke_dicts[nstrokes])
+  if (nstrokes != 0)
     {
       int i;
-      ListMem *top_picks;
-      StrokeScorer *scorer = StrokeScorerCreate (stroke_dicts[nstrokes],
-						 strokes, nstrokes);
-      if (scorer)
-	{
-	  StrokeScorerProcess(scorer, -1);
-	  top_picks = StrokeScorerTopPicks(scorer);
-	  StrokeScorerDestroy(scorer);
-	  
-	  printf("K");
-	  for (i=0;i<top_picks->m_argc;i++)
-	    {
-	      unsigned char c[2];
-	      if (i)
-		printf(" ");
-	      c[0] = top_picks->m_argv[i][0];
-	      c[1] = top_picks->m_argv[i][1];
-	      sjis2jis(&c[0],&c[1]);
-	      printf("%2x%2x",c[0],c[1]);
-	    }
-	  
-	  free(top_picks);
-	}
+      int ncandidates = kp_engine_recognize (engine, strokes, nstrokes,
+                                             candidates, KP_ENGINE_MAX_CANDIDATES);
+      
+      printf("K");
+      for (i=0;i<ncandidates;i++)
+        {
+          char utf8[7];
+          utf8[g_unichar_to_utf8 (candidates[i], utf8)] = '\0';
+          printf(i ? " %s" : "%s", utf8);
+        }
       printf("\n");
 
       fflush(stdout);
@@ -250,6 +169,8 @@ real_main(int argc, char **argv)
   while (process_strokes (stdin))
     ;
 
+  kp_engine_free (engine);
+
   return 0;
 }
 
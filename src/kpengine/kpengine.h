@@ -0,0 +1,48 @@
+#ifndef KP_ENGINE_INCLUDED
+#define KP_ENGINE_INCLUDED
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+#define KP_ENGINE_ERROR "kpengine error"
+#define KP_ENGINE_MAX_STROKES 32
+#define KP_ENGINE_MAX_STROKE_POINTS 256
+#define KP_ENGINE_MAX_CANDIDATES 5
+
+typedef enum {
+  KP_ENGINE_READ_ERROR,
+  KP_ENGINE_CORRUPT_DATA_ERROR
+} KpEngineErrorTypes;
+
+struct _KpPoint {
+  gint x;
+  gint y;
+};
+typedef struct _KpPoint KpPoint;
+
+struct _KpStroke {
+  const KpPoint *points;
+  gint total_points;
+};
+typedef struct _KpStroke KpStroke;
+
+typedef struct _KpEngine KpEngine;
+typedef struct _KpRecognizer KpRecognizer;
+
+KpEngine* kp_engine_new (const gchar*, GError**);
+void kp_engine_free (KpEngine*);
+
+gint kp_engine_recognize (KpEngine*, const KpStroke*, gint, gunichar*, gint);
+
+KpRecognizer* kp_recognizer_new (KpEngine*);
+void kp_recognizer_free (KpRecognizer*);
+void kp_recognizer_clear (KpRecognizer*);
+
+gboolean kp_recognizer_add_stroke (KpRecognizer*, const KpStroke*);
+gint kp_recognizer_get_total_strokes (KpRecognizer*);
+gint kp_recognizer_get_candidates (KpRecognizer*, gunichar*, gint);
+
+G_END_DECLS
+
+#endif
@@ -0,0 +1,874 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file annotator.c
+//!
+//! @brief Splits Japanese text into words and finds the dictionary lines of
+//!        each of them in a single pass over the text.  MeCab is used to
+//!        find the words when it is available.  Otherwise the longest
+//!        headword of an EDICT style dictionary starting at each position is
+//!        taken, looking through the trie of the headwords that is built
+//!        when the dictionary is installed, and conjugations are undone
+//!        with the LwDeinflector.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <glib.h>
+
+#include <libwaei/libwaei.h>
+
+
+//!
+//! @brief Creates an annotator with an empty trie that isn't attached to a
+//!        dictionary, to be filled with lw_annotator_build or lw_annotator_load
+//! @returns An allocated LwAnnotator that should be freed with lw_annotator_free
+//!
+LwAnnotator*
+lw_annotator_new ()
+{
+    //Declarations
+    LwAnnotator *annotator;
+    LwAnnotatorNode root;
+
+    //Initializations
+    annotator = g_new0 (LwAnnotator, 1);
+    annotator->nodes = g_array_new (FALSE, FALSE, sizeof(LwAnnotatorNode));
+    annotator->roots = g_hash_table_new (g_direct_hash, g_direct_equal);
+    annotator->postings = g_array_new (FALSE, FALSE, sizeof(LwAnnotatorPosting));
+    annotator->hits = g_array_new (FALSE, FALSE, sizeof(glong));
+
+    memset (&root, 0, sizeof(LwAnnotatorNode));
+    g_array_append_val (annotator->nodes, root);
+
+    return annotator;
+}
+
+
+//!
+//! @brief Creates an annotator for the headwords of a dictionary.  The trie
+//!        is read from the cache folder and only built from the dictionary
+//!        if it is missing or the dictionary changed since.
+//! @param dictionary An installed EDICT style LwDictionary
+//! @param error A GError to place errors into or NULL
+//! @returns An allocated LwAnnotator that should be freed with lw_annotator_free or NULL on error
+//!
+LwAnnotator*
+lw_annotator_new_for_dictionary (LwDictionary *dictionary, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+    if (error != NULL && *error != NULL) return NULL;
+
+    //Declarations
+    LwAnnotator *annotator;
+    gchar *path;
+    GQuark quark;
+
+    //Initializations
+    annotator = lw_annotator_new ();
+    annotator->dictionary = dictionary;
+    path = lw_dictionary_get_path (dictionary);
+
+    if (!lw_sidecar_load_or_build (annotator, dictionary, LW_ANNOTATOR_SUFFIX, (LwSidecarLoadFunc) lw_annotator_load, (LwSidecarBuildFunc) lw_annotator_build, (LwSidecarSaveFunc) lw_annotator_save, error))
+      goto errored;
+
+    //The results of the hits are read from the dictionary itself
+    if (path != NULL) annotator->file = fopen (path, "r");
+    if (annotator->file == NULL)
+    {
+      quark = g_quark_from_string (LW_IO_ERROR);
+      g_set_error (error, quark, LW_IO_READ_ERROR, "Could not open the %s dictionary to annotate with", lw_dictionary_get_name (dictionary));
+      goto errored;
+    }
+
+    goto finished;
+
+errored:
+    lw_annotator_free (annotator); annotator = NULL;
+
+finished:
+    if (path != NULL) g_free (path); path = NULL;
+
+    return annotator;
+}
+
+
+void
+lw_annotator_free (LwAnnotator *annotator)
+{
+    //Sanity checks
+    if (annotator == NULL) return;
+
+    if (annotator->file != NULL) fclose (annotator->file); annotator->file = NULL;
+    g_array_free (annotator->nodes, TRUE); annotator->nodes = NULL;
+    g_hash_table_unref (annotator->roots); annotator->roots = NULL;
+    g_array_free (annotator->postings, TRUE); annotator->postings = NULL;
+    g_array_free (annotator->hits, TRUE); annotator->hits = NULL;
+
+    g_free (annotator);
+}
+
+
+//!
+//! @brief Empties the trie of an annotator down to its root
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static void
+lw_annotator_clear (LwAnnotator *annotator)
+{
+    g_array_set_size (annotator->nodes, 1);
+    memset (&g_array_index (annotator->nodes, LwAnnotatorNode, 0), 0, sizeof(LwAnnotatorNode));
+    g_hash_table_remove_all (annotator->roots);
+    g_array_set_size (annotator->postings, 0);
+    memset (&annotator->stamp, 0, sizeof(LwSidecarStamp));
+}
+
+
+//!
+//! @brief Builds the path of the trie of a dictionary in the cache folder
+//! @param FILENAME The filename of the dictionary
+//! @returns An allocated path that should be freed with g_free
+//!
+gchar*
+lw_annotator_build_path (const gchar *FILENAME)
+{
+    return lw_sidecar_build_path (FILENAME, LW_ANNOTATOR_SUFFIX);
+}
+
+
+//!
+//! @brief Finds the child of a node for the next character of a headword.
+//!        The children of the root are hashed since nearly every kana and
+//!        kanji starts a headword.
+//! @returns The position of the child or 0 if there is none
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static guint32
+lw_annotator_get_child (LwAnnotator *annotator, guint32 position, gunichar c)
+{
+    //Declarations
+    LwAnnotatorNode *node;
+    guint32 child;
+
+    if (position == 0) return GPOINTER_TO_UINT (g_hash_table_lookup (annotator->roots, GUINT_TO_POINTER (c)));
+
+    node = &g_array_index (annotator->nodes, LwAnnotatorNode, position);
+    for (child = node->child; child != 0; child = g_array_index (annotator->nodes, LwAnnotatorNode, child).sibling)
+    {
+      if (g_array_index (annotator->nodes, LwAnnotatorNode, child).character == c) break;
+    }
+
+    return child;
+}
+
+
+//!
+//! @brief Adds the nodes of a headword missing from the trie
+//! @returns The position of the node of the whole headword
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static guint32
+lw_annotator_insert (LwAnnotator *annotator, const gchar *WORD, gint length)
+{
+    //Declarations
+    LwAnnotatorNode node;
+    const gchar *ptr;
+    const gchar *end;
+    guint32 position;
+    guint32 child;
+
+    //Initializations
+    end = WORD + length;
+    position = 0;
+
+    for (ptr = WORD; ptr < end; ptr = g_utf8_next_char (ptr))
+    {
+      node.character = g_utf8_get_char (ptr);
+      child = lw_annotator_get_child (annotator, position, node.character);
+
+      if (child == 0)
+      {
+        //The children of the root are linked too so a loaded trie can hash them again
+        child = annotator->nodes->len;
+        node.child = 0;
+        node.posting = 0;
+        node.sibling = g_array_index (annotator->nodes, LwAnnotatorNode, position).child;
+        g_array_index (annotator->nodes, LwAnnotatorNode, position).child = child;
+        if (position == 0)
+          g_hash_table_insert (annotator->roots, GUINT_TO_POINTER (node.character), GUINT_TO_POINTER (child));
+        g_array_append_val (annotator->nodes, node);
+      }
+
+      position = child;
+    }
+
+    return position;
+}
+
+
+//!
+//! @brief Adds every alternative of the kanji or reading field of an EDICT
+//!        line as a headword of the line.  The tags in parenthesis after an
+//!        alternative, like (P), aren't part of it.
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static void
+lw_annotator_add_headwords (LwAnnotator *annotator, const gchar *FIELD, gint length, glong offset)
+{
+    //Declarations
+    LwAnnotatorNode *node;
+    LwAnnotatorPosting posting;
+    const gchar *ptr;
+    const gchar *end;
+    const gchar *next;
+    guint32 position;
+    gint headword_length;
+
+    //Initializations
+    end = FIELD + length;
+
+    for (ptr = FIELD; ptr < end; ptr = next + 1)
+    {
+      next = memchr (ptr, ';', end - ptr);
+      if (next == NULL) next = end;
+
+      for (headword_length = 0; ptr + headword_length < next && ptr[headword_length] != '('; headword_length++);
+      if (headword_length == 0) continue;
+
+      position = lw_annotator_insert (annotator, ptr, headword_length);
+      node = &g_array_index (annotator->nodes, LwAnnotatorNode, position);
+
+      //The same headword can be both written form and reading of a line
+      if (node->posting != 0 && g_array_index (annotator->postings, LwAnnotatorPosting, node->posting - 1).offset == offset)
+        continue;
+
+      posting.offset = offset;
+      posting.next = node->posting;
+      g_array_append_val (annotator->postings, posting);
+      node->posting = annotator->postings->len;
+    }
+}
+
+
+//!
+//! @brief Adds the headwords of an EDICT line, which are the kanji before
+//!        the first space and the readings between the brackets after it
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static void
+lw_annotator_parse_line (LwAnnotator *annotator, const gchar *LINE, glong offset)
+{
+    //Declarations
+    const gchar *ptr;
+    const gchar *end;
+
+    //Initializations
+    ptr = strchr (LINE, ' ');
+    if (ptr == NULL) return;
+
+    lw_annotator_add_headwords (annotator, LINE, ptr - LINE, offset);
+
+    if (ptr[1] != '[') return;
+    ptr += 2;
+    end = strchr (ptr, ']');
+    if (end == NULL) return;
+
+    lw_annotator_add_headwords (annotator, ptr, end - ptr, offset);
+}
+
+
+//!
+//! @brief Indexes the headwords of every line of a dictionary file
+//! @param annotator The LwAnnotator to fill
+//! @param PATH The EDICT style dictionary file
+//! @param cancellable A GCancellable to stop building or NULL
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE if the whole file was indexed
+//!
+gboolean
+lw_annotator_build (LwAnnotator *annotator, const gchar *PATH, GCancellable *cancellable, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (annotator != NULL, FALSE);
+    g_return_val_if_fail (PATH != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    FILE *file;
+    gchar line[LW_IO_MAX_FGETS_LINE];
+    glong offset;
+    GQuark quark;
+
+    //Initializations
+    file = fopen (PATH, "r");
+    lw_annotator_clear (annotator);
+    offset = 0;
+
+    if (file == NULL)
+    {
+      quark = g_quark_from_string (LW_IO_ERROR);
+      g_set_error (error, quark, LW_IO_READ_ERROR, "Could not open %s to index its headwords", PATH);
+      return FALSE;
+    }
+
+    while (fgets (line, LW_IO_MAX_FGETS_LINE, file) != NULL)
+    {
+      if (cancellable != NULL && g_cancellable_is_cancelled (cancellable)) break;
+      if (line[0] != '#') lw_annotator_parse_line (annotator, line, offset);
+      offset += strlen (line);
+    }
+
+    fclose (file); file = NULL;
+
+    lw_sidecar_stamp_file (&annotator->stamp, PATH);
+
+    return (cancellable == NULL || !g_cancellable_is_cancelled (cancellable));
+}
+
+
+//!
+//! @brief Writes the trie so it doesn't have to be rebuilt from the dictionary.
+//!        The first line is the LwSidecarStamp of the dictionary and each
+//!        following line is a node, starting with the root.  A node is its
+//!        character, child and sibling followed by the offsets of the lines
+//!        of its headword in dictionary order, all separated by spaces.
+//! @param annotator The LwAnnotator to save
+//! @param PATH The file to write to
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE on success
+//!
+gboolean
+lw_annotator_save (LwAnnotator *annotator, const gchar *PATH, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (annotator != NULL, FALSE);
+    g_return_val_if_fail (PATH != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    LwAnnotatorNode *node;
+    LwAnnotatorPosting *posting;
+    GString *text;
+    GArray *offsets;
+    gboolean success;
+    guint32 next;
+    guint i;
+    gint j;
+
+    //Initializations
+    text = g_string_new (NULL);
+    offsets = g_array_new (FALSE, FALSE, sizeof(glong));
+
+    lw_sidecar_stamp_append (&annotator->stamp, text);
+
+    for (i = 0; i < annotator->nodes->len; i++)
+    {
+      node = &g_array_index (annotator->nodes, LwAnnotatorNode, i);
+      g_string_append_printf (text, "%u %u %u", (guint) node->character, node->child, node->sibling);
+
+      //The postings of a node are linked newest first
+      g_array_set_size (offsets, 0);
+      for (next = node->posting; next != 0; next = posting->next)
+      {
+        posting = &g_array_index (annotator->postings, LwAnnotatorPosting, next - 1);
+        g_array_append_val (offsets, posting->offset);
+      }
+      for (j = offsets->len - 1; j >= 0; j--)
+        g_string_append_printf (text, " %ld", g_array_index (offsets, glong, j));
+
+      g_string_append_c (text, '\n');
+    }
+
+    success = g_file_set_contents (PATH, text->str, text->len, error);
+
+    g_array_free (offsets, TRUE); offsets = NULL;
+    g_string_free (text, TRUE); text = NULL;
+
+    return success;
+}
+
+
+//!
+//! @brief Reads a trie written by lw_annotator_save
+//! @param annotator The LwAnnotator to fill
+//! @param PATH The file to read
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE on success
+//!
+gboolean
+lw_annotator_load (LwAnnotator *annotator, const gchar *PATH, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (annotator != NULL, FALSE);
+    g_return_val_if_fail (PATH != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    LwAnnotatorNode node;
+    LwAnnotatorNode *child;
+    LwAnnotatorPosting posting;
+    LwSidecarStamp stamp;
+    gchar *contents;
+    gchar *line;
+    gchar *end;
+    guint32 position;
+    guint i;
+
+    //Initializations
+    contents = NULL;
+    lw_annotator_clear (annotator);
+    g_array_set_size (annotator->nodes, 0);
+
+    if (!g_file_get_contents (PATH, &contents, NULL, error)) return FALSE;
+
+    if (!lw_sidecar_stamp_parse (&stamp, contents, &end)) goto errored;
+    line = (*end == '\n') ? end : NULL;
+
+    while (line != NULL && *(++line) != '\0')
+    {
+      node.character = (gunichar) strtoul (line, &end, 10);
+      if (end == line || *end != ' ') goto errored;
+      node.child = (guint32) strtoul (end + 1, &end, 10);
+      if (*end != ' ') goto errored;
+      node.sibling = (guint32) strtoul (end + 1, &end, 10);
+      node.posting = 0;
+
+      while (*end == ' ')
+      {
+        line = end + 1;
+        posting.offset = strtol (line, &end, 10);
+        if (end == line) goto errored;
+        posting.next = node.posting;
+        g_array_append_val (annotator->postings, posting);
+        node.posting = annotator->postings->len;
+      }
+
+      g_array_append_val (annotator->nodes, node);
+      line = (*end == '\n') ? end : NULL;
+    }
+
+    if (annotator->nodes->len == 0) goto errored;
+
+    //Children are always added after their parent and siblings before, so
+    //a trie breaking that is damaged and could send a lookup in circles
+    for (i = 0; i < annotator->nodes->len; i++)
+    {
+      child = &g_array_index (annotator->nodes, LwAnnotatorNode, i);
+      if (child->child != 0 && (child->child <= i || child->child >= annotator->nodes->len)) goto errored;
+      if (child->sibling != 0 && child->sibling >= i) goto errored;
+    }
+
+    //The children of the root are looked up through the hash table
+    for (position = g_array_index (annotator->nodes, LwAnnotatorNode, 0).child; position != 0; position = child->sibling)
+    {
+      child = &g_array_index (annotator->nodes, LwAnnotatorNode, position);
+      g_hash_table_insert (annotator->roots, GUINT_TO_POINTER (child->character), GUINT_TO_POINTER (position));
+    }
+
+    annotator->stamp = stamp;
+
+    g_free (contents); contents = NULL;
+
+    return TRUE;
+
+errored:
+    lw_annotator_clear (annotator);
+    g_free (contents); contents = NULL;
+
+    return FALSE;
+}
+
+
+//!
+//! @brief Finds the node of a headword in the trie
+//! @returns The position of the node or 0 if it isn't a headword
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static guint32
+lw_annotator_find (LwAnnotator *annotator, const gchar *WORD, gint length)
+{
+    //Declarations
+    const gchar *ptr;
+    const gchar *end;
+    guint32 position;
+
+    //Initializations
+    if (length < 0) length = strlen (WORD);
+    end = WORD + length;
+    position = 0;
+
+    for (ptr = WORD; ptr < end; ptr = g_utf8_next_char (ptr))
+    {
+      position = lw_annotator_get_child (annotator, position, g_utf8_get_char (ptr));
+      if (position == 0) return 0;
+    }
+
+    if (position == 0 || g_array_index (annotator->nodes, LwAnnotatorNode, position).posting == 0) return 0;
+
+    return position;
+}
+
+
+//!
+//! @brief Checks if a word is a headword of the dictionary
+//! @param annotator The LwAnnotator to look in
+//! @param WORD The word to look for
+//! @param length The length of the word in bytes or -1 if it is NULL terminated
+//! @returns TRUE if the dictionary has lines for the word
+//!
+gboolean
+lw_annotator_lookup (LwAnnotator *annotator, const gchar *WORD, gint length)
+{
+    //Sanity checks
+    g_return_val_if_fail (annotator != NULL, FALSE);
+    g_return_val_if_fail (WORD != NULL, FALSE);
+
+    return (lw_annotator_find (annotator, WORD, length) != 0);
+}
+
+
+//!
+//! @brief Reads the dictionary line of a hit
+//! @param annotator The LwAnnotator the hit was found by
+//! @param offset One of the offsets of the hits passed to an LwAnnotatorFunc
+//! @returns An allocated LwResult that should be freed with lw_result_free or NULL
+//!
+LwResult*
+lw_annotator_get_result (LwAnnotator *annotator, glong offset)
+{
+    //Sanity checks
+    g_return_val_if_fail (annotator != NULL, NULL);
+    g_return_val_if_fail (annotator->file != NULL, NULL);
+
+    //Declarations
+    LwResult *result;
+
+    if (fseek (annotator->file, offset, SEEK_SET) != 0) return NULL;
+
+    result = lw_result_new ();
+    if (!lw_dictionary_parse_result (annotator->dictionary, result, annotator->file))
+    {
+      lw_result_free (result); result = NULL;
+    }
+
+    return result;
+}
+
+
+//!
+//! @brief Passes a token and the lines of its headword to the LwAnnotatorFunc,
+//!        in the order of the dictionary
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static void
+lw_annotator_emit (LwAnnotator *annotator, const gchar *WORD, gint length, const gchar *FORM, guint32 position, LwAnnotatorFunc func, gpointer data)
+{
+    //Declarations
+    LwAnnotatorPosting *posting;
+    guint32 next;
+    gchar *word;
+    glong offset;
+    guint i, j;
+
+    //Initializations
+    word = g_strndup (WORD, length);
+    g_array_set_size (annotator->hits, 0);
+
+    for (next = g_array_index (annotator->nodes, LwAnnotatorNode, position).posting; next != 0; next = posting->next)
+    {
+      posting = &g_array_index (annotator->postings, LwAnnotatorPosting, next - 1);
+      g_array_append_val (annotator->hits, posting->offset);
+    }
+
+    //The postings are linked newest first
+    for (i = 0, j = annotator->hits->len; i + 1 < j; i++, j--)
+    {
+      offset = g_array_index (annotator->hits, glong, i);
+      g_array_index (annotator->hits, glong, i) = g_array_index (annotator->hits, glong, j - 1);
+      g_array_index (annotator->hits, glong, j - 1) = offset;
+    }
+
+    func (annotator, word, (FORM != NULL) ? FORM : word, annotator->hits, data);
+
+    g_free (word); word = NULL;
+}
+
+
+//!
+//! @brief Looks for a conjugated word at the start of the text.  The stem is
+//!        followed by up to LW_ANNOTATOR_MAX_OKURIGANA hiragana and the
+//!        longest run of them with a dictionary form that is a headword wins.
+//! @param START Where the word starts
+//! @param STEM Where the hiragana of the ending could start
+//! @param END The end of the text
+//! @param word_end Set to the end of the conjugated word
+//! @param form Set to an allocated string of the dictionary form
+//! @returns The position of the node of the dictionary form or 0 if none was found
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static guint32
+lw_annotator_deinflect (LwAnnotator *annotator, const gchar *START, const gchar *STEM, const gchar *END, const gchar **word_end, gchar **form)
+{
+    //Declarations
+    LwDeinflector *deinflector;
+    const gchar *ends[LW_ANNOTATOR_MAX_OKURIGANA];
+    const gchar *ptr;
+    gchar *word;
+    gchar **forms;
+    guint32 position;
+    gint total;
+    gint i, j;
+
+    //Initializations
+    deinflector = lw_deinflector_get_default ();
+    position = 0;
+    total = 0;
+
+    for (ptr = STEM; ptr < END && total < LW_ANNOTATOR_MAX_OKURIGANA; ptr = g_utf8_next_char (ptr))
+    {
+      if (g_unichar_get_script (g_utf8_get_char (ptr)) != G_UNICODE_SCRIPT_HIRAGANA) break;
+      ends[total++] = g_utf8_next_char (ptr);
+    }
+
+    for (i = total - 1; i >= 0 && position == 0; i--)
+    {
+      word = g_strndup (START, ends[i] - START);
+      forms = lw_deinflector_deinflect (deinflector, word);
+
+      for (j = 0; forms != NULL && forms[j] != NULL && position == 0; j++)
+      {
+        position = lw_annotator_find (annotator, forms[j], -1);
+        if (position != 0)
+        {
+          *word_end = ends[i];
+          *form = g_strdup (forms[j]);
+        }
+      }
+
+      g_strfreev (forms); forms = NULL;
+      g_free (word); word = NULL;
+    }
+
+    return position;
+}
+
+
+//!
+//! @brief Only kanji and kana start a token
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static gboolean
+lw_annotator_is_word_character (gunichar c)
+{
+    //Declarations
+    GUnicodeScript script;
+
+    //Initializations
+    script = g_unichar_get_script (c);
+
+    return (script == G_UNICODE_SCRIPT_HAN || script == G_UNICODE_SCRIPT_HIRAGANA || script == G_UNICODE_SCRIPT_KATAKANA);
+}
+
+
+//!
+//! @brief Splits text into the longest headwords found at each position.
+//!        When a headword, or a lone kanji that isn't one, is followed by
+//!        hiragana, the conjugations it could be the stem of are tried first.
+//!        Text that doesn't start any headword is skipped.
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static void
+lw_annotator_segment (LwAnnotator *annotator, const gchar *TEXT, gint length, LwAnnotatorFunc func, gpointer data)
+{
+    //Declarations
+    const gchar *ptr;
+    const gchar *end;
+    const gchar *next;
+    const gchar *match;
+    const gchar *word_end;
+    gchar *form;
+    guint32 position;
+    guint32 match_position;
+
+    //Initializations
+    end = TEXT + length;
+    ptr = TEXT;
+
+    while (ptr < end)
+    {
+      if (!lw_annotator_is_word_character (g_utf8_get_char (ptr)))
+      {
+        ptr = g_utf8_next_char (ptr);
+        continue;
+      }
+
+      //The longest headword starting here
+      match = NULL;
+      match_position = 0;
+      position = 0;
+      for (next = ptr; next < end; next = g_utf8_next_char (next))
+      {
+        position = lw_annotator_get_child (annotator, position, g_utf8_get_char (next));
+        if (position == 0) break;
+        if (g_array_index (annotator->nodes, LwAnnotatorNode, position).posting == 0) continue;
+        match = g_utf8_next_char (next);
+        match_position = position;
+      }
+
+      //A conjugation is always longer than the headword of its stem
+      form = NULL;
+      position = lw_annotator_deinflect (annotator, ptr, (match != NULL) ? match : g_utf8_next_char (ptr), end, &word_end, &form);
+      if (position != 0)
+      {
+        lw_annotator_emit (annotator, ptr, word_end - ptr, form, position, func, data);
+        g_free (form); form = NULL;
+        ptr = word_end;
+      }
+      else if (match != NULL)
+      {
+        lw_annotator_emit (annotator, ptr, match - ptr, NULL, match_position, func, data);
+        ptr = match;
+      }
+      else
+      {
+        ptr = g_utf8_next_char (ptr);
+      }
+    }
+}
+
+
+//!
+//! @brief Finds the words of a text and passes each one that has dictionary
+//!        hits to a function, in the order they are written
+//! @param annotator The LwAnnotator to use
+//! @param TEXT The text to annotate, usually a line of a document
+//! @param func The LwAnnotatorFunc called for every word with hits
+//! @param data Data passed to the function
+//!
+void
+lw_annotator_annotate (LwAnnotator *annotator, const gchar *TEXT, LwAnnotatorFunc func, gpointer data)
+{
+    //Sanity checks
+    g_return_if_fail (annotator != NULL);
+    g_return_if_fail (TEXT != NULL);
+    g_return_if_fail (func != NULL);
+
+#ifdef WITH_MECAB
+    //Declarations
+    LwMorphologyEngine *engine;
+    LwMorphology *morphology;
+    GList *morphologylist;
+    GList *link;
+    guint32 position;
+
+    //Initializations
+    engine = lw_morphologyengine_get_default ();
+
+    if (engine != NULL)
+    {
+      morphologylist = lw_morphologyengine_analyze (engine, TEXT);
+
+      for (link = morphologylist; link != NULL; link = link->next)
+      {
+        morphology = LW_MORPHOLOGY (link->data);
+        if (morphology->word == NULL) continue;
+
+        position = 0;
+        if (morphology->base_form != NULL)
+          position = lw_annotator_find (annotator, morphology->base_form, -1);
+        if (position != 0)
+          lw_annotator_emit (annotator, morphology->word, strlen (morphology->word), morphology->base_form, position, func, data);
+        else if ((position = lw_annotator_find (annotator, morphology->word, -1)) != 0)
+          lw_annotator_emit (annotator, morphology->word, strlen (morphology->word), NULL, position, func, data);
+        else
+          lw_annotator_segment (annotator, morphology->word, strlen (morphology->word), func, data);
+      }
+
+      lw_morphologylist_free (morphologylist); morphologylist = NULL;
+
+      return;
+    }
+#endif
+
+    lw_annotator_segment (annotator, TEXT, strlen (TEXT), func, data);
+}
+
+
+//!
+//! @brief Annotates a UTF-8 document a line at a time, so the hits of its
+//!        first words are passed on before the rest of it is read
+//! @param annotator The LwAnnotator to use
+//! @param PATH The path of the document
+//! @param func The LwAnnotatorFunc called for every word with hits
+//! @param data Data passed to the function
+//! @param cancellable A GCancellable to stop annotating or NULL
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE if the whole document was annotated
+//!
+gboolean
+lw_annotator_annotate_file (LwAnnotator *annotator, const gchar *PATH, LwAnnotatorFunc func, gpointer data, GCancellable *cancellable, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (annotator != NULL, FALSE);
+    g_return_val_if_fail (PATH != NULL, FALSE);
+    g_return_val_if_fail (func != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    GIOChannel *channel;
+    GIOStatus status;
+    gchar *line;
+
+    //Initializations
+    channel = g_io_channel_new_file (PATH, "r", error);
+    if (channel == NULL) return FALSE;
+    line = NULL;
+
+    while ((status = g_io_channel_read_line (channel, &line, NULL, NULL, error)) == G_IO_STATUS_NORMAL)
+    {
+      lw_annotator_annotate (annotator, line, func, data);
+      g_free (line); line = NULL;
+      if (cancellable != NULL && g_cancellable_is_cancelled (cancellable)) break;
+    }
+
+    //Cleanup
+    if (line != NULL) g_free (line); line = NULL;
+    g_io_channel_unref (channel); channel = NULL;
+
+    return (status == G_IO_STATUS_EOF);
+}
@@ -0,0 +1,203 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file bench-matcher.c
+//!
+//! @brief Times the patterns of every dictionary type with LwMatcher and
+//!        with a GRegex and GMatchInfo per match, the way results were
+//!        compared before LwMatcher.  It isn't installed or run by make
+//!        check.  Run it as bench-matcher [LINES] from the build folder.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <glib.h>
+#include <glib-object.h>
+
+#include <libwaei/libwaei.h>
+
+
+//The token of a query of each type, in the order of LwQueryType
+static const gchar *_tokens[] = { "本", "日本", "にほん", "japan", NULL };
+
+//Lines in the formats of the dictionaries, repeated to the wanted length
+static const gchar *_lines[] = {
+  "日本 [にほん] /(n) Japan/(P)/",
+  "日本語 [にほんご] /(n) Japanese (language)/(P)/",
+  "本 [ほん] /(n) book/volume/script/(P)/",
+  "食べる [たべる] /(v1,vt) to eat/(P)/",
+  "御日本 [おにほん] /to be in Japan/",
+  "本 ホン もと {book} {present} {main} B4 G1 S5 F10 J4",
+  "A: 私は本を日本で買った。\tI bought the book in Japan.#ID=1",
+  "B: 私(わたし) 本(ほん) を 日本(にほん) で 買う{買った}",
+  NULL
+};
+
+
+//!
+//! @brief Matches every line with a pattern
+//! @returns The number of lines that matched
+//!
+static gint
+bench_matcher_run_matcher (LwMatcher *matcher, gchar **lines, gint total, gdouble *seconds)
+{
+    //Declarations
+    GTimer *timer;
+    gint hits;
+    gint i;
+
+    //Initializations
+    timer = g_timer_new ();
+    hits = 0;
+
+    for (i = 0; i < total; i++)
+    {
+      if (lw_matcher_match (matcher, lines[i])) hits++;
+    }
+
+    *seconds = g_timer_elapsed (timer, NULL);
+    g_timer_destroy (timer); timer = NULL;
+
+    return hits;
+}
+
+
+//!
+//! @brief Matches every line with a GRegex, fetching the GMatchInfo like
+//!        the dictionaries did
+//! @returns The number of lines that matched
+//!
+static gint
+bench_matcher_run_regex (GRegex *regex, gchar **lines, gint total, gdouble *seconds)
+{
+    //Declarations
+    GMatchInfo *match_info;
+    GTimer *timer;
+    gint hits;
+    gint i;
+
+    //Initializations
+    timer = g_timer_new ();
+    hits = 0;
+
+    for (i = 0; i < total; i++)
+    {
+      match_info = NULL;
+      if (g_regex_match (regex, lines[i], 0, &match_info)) hits++;
+      g_match_info_free (match_info); match_info = NULL;
+    }
+
+    *seconds = g_timer_elapsed (timer, NULL);
+    g_timer_destroy (timer); timer = NULL;
+
+    return hits;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+    //Declarations
+    GType types[4];
+    GTypeClass *klass;
+    gchar ***patterns;
+    gchar **lines;
+    gchar *expression;
+    LwMatcher *matcher;
+    GRegex *regex;
+    gdouble matcher_seconds;
+    gdouble regex_seconds;
+    gint matcher_hits;
+    gint regex_hits;
+    gint total;
+    gint failures;
+    gint i;
+    gint type;
+    gint relevance;
+
+    //Initializations
+    g_type_init ();
+    total = (argc > 1) ? atoi (argv[1]) : 100000;
+    if (total < 1) total = 1;
+    failures = 0;
+    types[0] = LW_TYPE_EDICTIONARY;
+    types[1] = LW_TYPE_KANJIDICTIONARY;
+    types[2] = LW_TYPE_EXAMPLEDICTIONARY;
+    types[3] = LW_TYPE_UNKNOWNDICTIONARY;
+
+    lines = g_new0 (gchar*, total + 1);
+    for (i = 0; i < total; i++)
+    {
+      lines[i] = (gchar*) _lines[i % (G_N_ELEMENTS (_lines) - 1)];
+    }
+
+    printf ("%d lines, ms per pass\n", total);
+    printf ("%-24s %-6s %-8s %-52s %8s %8s\n", "dictionary", "type", "level", "pattern", "GRegex", "matcher");
+
+    for (i = 0; i < G_N_ELEMENTS (types); i++)
+    {
+      klass = g_type_class_ref (types[i]);
+      patterns = LW_DICTIONARY_CLASS (klass)->patterns;
+
+      for (type = 0; type < TOTAL_LW_QUERY_TYPES; type++)
+      {
+        for (relevance = 0; relevance < TOTAL_LW_RELEVANCE; relevance++)
+        {
+          if (patterns[type][relevance] == NULL) continue;
+
+          expression = g_strdup_printf (patterns[type][relevance], _tokens[type]);
+          regex = g_regex_new (expression, LW_RE_COMPILE_FLAGS, LW_RE_EXIST_FLAGS, NULL);
+          matcher = lw_matcher_new (expression, NULL);
+
+          if (regex != NULL && matcher != NULL)
+          {
+            regex_hits = bench_matcher_run_regex (regex, lines, total, &regex_seconds);
+            matcher_hits = bench_matcher_run_matcher (matcher, lines, total, &matcher_seconds);
+
+            printf ("%-24s %-6d %-8d %-52s %8.1f %8.1f", g_type_name (types[i]), type, relevance, patterns[type][relevance], regex_seconds * 1000.0, matcher_seconds * 1000.0);
+            if (regex_hits != matcher_hits)
+            {
+              printf ("  hits differ: %d and %d", regex_hits, matcher_hits);
+              failures++;
+            }
+            printf ("\n");
+          }
+
+          if (matcher != NULL) lw_matcher_free (matcher); matcher = NULL;
+          if (regex != NULL) g_regex_unref (regex); regex = NULL;
+          g_free (expression); expression = NULL;
+        }
+      }
+
+      g_type_class_unref (klass); klass = NULL;
+    }
+
+    g_free (lines); lines = NULL;
+
+    return (failures == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
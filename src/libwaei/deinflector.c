@@ -0,0 +1,444 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file deinflector.c
+//!
+//! @brief Works out the dictionary forms a conjugated Japanese verb or
+//!        adjective could come from without MeCab.  Endings are replaced
+//!        using a table of rules, breadth first, so a word like 食べさせられなかった
+//!        is taken apart one conjugation at a time.  The rules only look at
+//!        kana endings, so the forms found are guesses that the dictionary
+//!        search then confirms or not.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+
+#include <libwaei/libwaei.h>
+
+
+#define V1 LW_DEINFLECTION_TYPE_ICHIDAN
+#define V5 LW_DEINFLECTION_TYPE_GODAN
+#define ADJ LW_DEINFLECTION_TYPE_ADJECTIVE
+#define VK LW_DEINFLECTION_TYPE_KURU
+#define VS LW_DEINFLECTION_TYPE_SURU
+#define POLITE LW_DEINFLECTION_TYPE_POLITE
+#define TE LW_DEINFLECTION_TYPE_TE
+#define INFLECTED LW_DEINFLECTION_TYPE_INFLECTED
+
+static const LwDeinflectionRule _rules[] = {
+  //Past
+  { "た", "る", INFLECTED, V1 },
+  { "いた", "く", INFLECTED, V5 },
+  { "いだ", "ぐ", INFLECTED, V5 },
+  { "した", "す", INFLECTED, V5 },
+  { "った", "う", INFLECTED, V5 },
+  { "った", "つ", INFLECTED, V5 },
+  { "った", "る", INFLECTED, V5 },
+  { "んだ", "ぬ", INFLECTED, V5 },
+  { "んだ", "ぶ", INFLECTED, V5 },
+  { "んだ", "む", INFLECTED, V5 },
+  { "いった", "いく", INFLECTED, V5 },
+  { "行った", "行く", INFLECTED, V5 },
+  { "かった", "い", INFLECTED, ADJ },
+  { "きた", "くる", INFLECTED, VK },
+  { "来た", "来る", INFLECTED, VK },
+  { "した", "する", INFLECTED, VS },
+
+  //Te form
+  { "て", "る", TE, V1 },
+  { "いて", "く", TE, V5 },
+  { "いで", "ぐ", TE, V5 },
+  { "して", "す", TE, V5 },
+  { "って", "う", TE, V5 },
+  { "って", "つ", TE, V5 },
+  { "って", "る", TE, V5 },
+  { "んで", "ぬ", TE, V5 },
+  { "んで", "ぶ", TE, V5 },
+  { "んで", "む", TE, V5 },
+  { "いって", "いく", TE, V5 },
+  { "行って", "行く", TE, V5 },
+  { "くて", "い", TE, ADJ },
+  { "きて", "くる", TE, VK },
+  { "来て", "来る", TE, VK },
+  { "して", "する", TE, VS },
+
+  //Verbs that follow the te form
+  { "ている", "て", V1, TE },
+  { "でいる", "で", V1, TE },
+  { "てる", "て", V1, TE },
+  { "でる", "で", V1, TE },
+  { "てしまう", "て", V5, TE },
+  { "でしまう", "で", V5, TE },
+  { "ちゃう", "て", V5, TE },
+  { "じゃう", "で", V5, TE },
+
+  //Negative, which conjugates like an adjective
+  { "ない", "る", ADJ, V1 },
+  { "かない", "く", ADJ, V5 },
+  { "がない", "ぐ", ADJ, V5 },
+  { "さない", "す", ADJ, V5 },
+  { "たない", "つ", ADJ, V5 },
+  { "なない", "ぬ", ADJ, V5 },
+  { "ばない", "ぶ", ADJ, V5 },
+  { "まない", "む", ADJ, V5 },
+  { "らない", "る", ADJ, V5 },
+  { "わない", "う", ADJ, V5 },
+  { "こない", "くる", ADJ, VK },
+  { "来ない", "来る", ADJ, VK },
+  { "しない", "する", ADJ, VS },
+  { "くない", "い", ADJ, ADJ },
+
+  //Desire, which also conjugates like an adjective
+  { "たい", "る", ADJ, V1 },
+  { "いたい", "う", ADJ, V5 },
+  { "きたい", "く", ADJ, V5 },
+  { "ぎたい", "ぐ", ADJ, V5 },
+  { "したい", "す", ADJ, V5 },
+  { "ちたい", "つ", ADJ, V5 },
+  { "にたい", "ぬ", ADJ, V5 },
+  { "びたい", "ぶ", ADJ, V5 },
+  { "みたい", "む", ADJ, V5 },
+  { "りたい", "る", ADJ, V5 },
+  { "きたい", "くる", ADJ, VK },
+  { "したい", "する", ADJ, VS },
+
+  //Polite
+  { "ました", "ます", INFLECTED, POLITE },
+  { "ません", "ます", INFLECTED, POLITE },
+  { "ませんでした", "ます", INFLECTED, POLITE },
+  { "ましょう", "ます", INFLECTED, POLITE },
+  { "まして", "ます", TE, POLITE },
+  { "ます", "る", POLITE, V1 },
+  { "います", "う", POLITE, V5 },
+  { "きます", "く", POLITE, V5 },
+  { "ぎます", "ぐ", POLITE, V5 },
+  { "します", "す", POLITE, V5 },
+  { "ちます", "つ", POLITE, V5 },
+  { "にます", "ぬ", POLITE, V5 },
+  { "びます", "ぶ", POLITE, V5 },
+  { "みます", "む", POLITE, V5 },
+  { "ります", "る", POLITE, V5 },
+  { "きます", "くる", POLITE, VK },
+  { "来ます", "来る", POLITE, VK },
+  { "します", "する", POLITE, VS },
+
+  //Conditional
+  { "れば", "る", INFLECTED, V1 },
+  { "えば", "う", INFLECTED, V5 },
+  { "けば", "く", INFLECTED, V5 },
+  { "げば", "ぐ", INFLECTED, V5 },
+  { "せば", "す", INFLECTED, V5 },
+  { "てば", "つ", INFLECTED, V5 },
+  { "ねば", "ぬ", INFLECTED, V5 },
+  { "べば", "ぶ", INFLECTED, V5 },
+  { "めば", "む", INFLECTED, V5 },
+  { "れば", "る", INFLECTED, V5 },
+  { "ければ", "い", INFLECTED, ADJ },
+  { "くれば", "くる", INFLECTED, VK },
+  { "すれば", "する", INFLECTED, VS },
+
+  //Forms that end in the past
+  { "たら", "た", INFLECTED, INFLECTED },
+  { "だら", "だ", INFLECTED, INFLECTED },
+  { "たり", "た", INFLECTED, INFLECTED },
+  { "だり", "だ", INFLECTED, INFLECTED },
+
+  //Volitional
+  { "よう", "る", INFLECTED, V1 },
+  { "おう", "う", INFLECTED, V5 },
+  { "こう", "く", INFLECTED, V5 },
+  { "ごう", "ぐ", INFLECTED, V5 },
+  { "そう", "す", INFLECTED, V5 },
+  { "とう", "つ", INFLECTED, V5 },
+  { "のう", "ぬ", INFLECTED, V5 },
+  { "ぼう", "ぶ", INFLECTED, V5 },
+  { "もう", "む", INFLECTED, V5 },
+  { "ろう", "る", INFLECTED, V5 },
+  { "こよう", "くる", INFLECTED, VK },
+  { "しよう", "する", INFLECTED, VS },
+
+  //Imperative, leaving out the one kana godan endings that most words have
+  { "ろ", "る", INFLECTED, V1 },
+  { "こい", "くる", INFLECTED, VK },
+  { "しろ", "する", INFLECTED, VS },
+
+  //Potential
+  { "える", "う", V1, V5 },
+  { "ける", "く", V1, V5 },
+  { "げる", "ぐ", V1, V5 },
+  { "せる", "す", V1, V5 },
+  { "てる", "つ", V1, V5 },
+  { "ねる", "ぬ", V1, V5 },
+  { "べる", "ぶ", V1, V5 },
+  { "める", "む", V1, V5 },
+  { "れる", "る", V1, V5 },
+  { "できる", "する", V1, VS },
+
+  //Passive, and the potential of ichidan verbs
+  { "られる", "る", V1, V1 },
+  { "かれる", "く", V1, V5 },
+  { "がれる", "ぐ", V1, V5 },
+  { "される", "す", V1, V5 },
+  { "たれる", "つ", V1, V5 },
+  { "なれる", "ぬ", V1, V5 },
+  { "ばれる", "ぶ", V1, V5 },
+  { "まれる", "む", V1, V5 },
+  { "われる", "う", V1, V5 },
+  { "こられる", "くる", V1, VK },
+  { "される", "する", V1, VS },
+
+  //Causative
+  { "させる", "る", V1, V1 },
+  { "かせる", "く", V1, V5 },
+  { "がせる", "ぐ", V1, V5 },
+  { "させる", "す", V1, V5 },
+  { "たせる", "つ", V1, V5 },
+  { "なせる", "ぬ", V1, V5 },
+  { "ばせる", "ぶ", V1, V5 },
+  { "ませる", "む", V1, V5 },
+  { "らせる", "る", V1, V5 },
+  { "わせる", "う", V1, V5 },
+  { "こさせる", "くる", V1, VK },
+  { "させる", "する", V1, VS },
+
+  { NULL, NULL, 0, 0 }
+};
+
+#undef V1
+#undef V5
+#undef ADJ
+#undef VK
+#undef VS
+#undef POLITE
+#undef TE
+#undef INFLECTED
+
+
+//!
+//! @brief A form of the word found while deinflecting
+//!
+struct _LwDeinflectorForm {
+  gchar *word;
+  guint type;
+};
+typedef struct _LwDeinflectorForm LwDeinflectorForm;
+
+
+static gboolean
+lw_deinflector_has_form (GPtrArray *forms, const gchar *WORD)
+{
+    //Declarations
+    guint i;
+
+    for (i = 0; i < forms->len; i++)
+    {
+      if (strcmp (g_ptr_array_index (forms, i), WORD) == 0) return TRUE;
+    }
+
+    return FALSE;
+}
+
+
+//!
+//! @brief Checks if a rule takes off what follows a te or past form, like
+//!        ている or たら, so the stem left can end in a small tsu as in 言って
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static gboolean
+lw_deinflector_rule_keeps_te (const LwDeinflectionRule *RULE)
+{
+    return (g_str_has_prefix (RULE->to, "て") || g_str_has_prefix (RULE->to, "で") ||
+            g_str_has_prefix (RULE->to, "た") || g_str_has_prefix (RULE->to, "だ"));
+}
+
+
+//!
+//! @brief Creates a new LwDeinflector with the rules indexed by the last
+//!        character of their endings
+//! @returns A new LwDeinflector that should be freed with lw_deinflector_free
+//!
+LwDeinflector*
+lw_deinflector_new ()
+{
+    //Declarations
+    LwDeinflector *deinflector;
+    GPtrArray *rules;
+    gpointer key;
+    const LwDeinflectionRule *rule;
+
+    //Initializations
+    deinflector = g_new0 (LwDeinflector, 1);
+    deinflector->rules = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) g_ptr_array_unref);
+
+    for (rule = _rules; rule->from != NULL; rule++)
+    {
+      key = GUINT_TO_POINTER (g_utf8_get_char (g_utf8_find_prev_char (rule->from, rule->from + strlen (rule->from))));
+      rules = g_hash_table_lookup (deinflector->rules, key);
+      if (rules == NULL)
+      {
+        rules = g_ptr_array_new ();
+        g_hash_table_insert (deinflector->rules, key, rules);
+      }
+      g_ptr_array_add (rules, (gpointer) rule);
+    }
+
+    return deinflector;
+}
+
+
+//!
+//! @brief Gets the LwDeinflector shared by the queries of the process
+//! @returns The LwDeinflector which shouldn't be freed
+//!
+LwDeinflector*
+lw_deinflector_get_default ()
+{
+    static GOnce once = G_ONCE_INIT;
+
+    g_once (&once, (GThreadFunc) lw_deinflector_new, NULL);
+
+    return LW_DEINFLECTOR (once.retval);
+}
+
+
+void
+lw_deinflector_free (LwDeinflector *deinflector)
+{
+    //Sanity checks
+    if (deinflector == NULL) return;
+
+    g_hash_table_unref (deinflector->rules); deinflector->rules = NULL;
+    g_free (deinflector);
+}
+
+
+//!
+//! @brief Finds the dictionary forms a word could be a conjugation of.  The
+//!        word is first taken as any type of word, then every rule whose
+//!        ending matches is applied to every form found so far, until no rule
+//!        applies or LW_DEINFLECTOR_MAX_FORMS forms were found.
+//! @param deinflector The LwDeinflector to use
+//! @param WORD The possibly conjugated word
+//! @returns A NULL terminated array of dictionary forms other than WORD that
+//!          should be freed with g_strfreev.  It is empty if none were found.
+//!
+gchar**
+lw_deinflector_deinflect (LwDeinflector *deinflector, const gchar *WORD)
+{
+    //Sanity checks
+    g_return_val_if_fail (deinflector != NULL, NULL);
+    g_return_val_if_fail (WORD != NULL, NULL);
+
+    //Declarations
+    GArray *forms;
+    GHashTable *seen;
+    GPtrArray *rules;
+    GPtrArray *results;
+    LwDeinflectorForm form;
+    LwDeinflectorForm *current;
+    const LwDeinflectionRule *rule;
+    const gchar *end;
+    gsize length;
+    gsize stem_length;
+    guint types;
+    guint i, j;
+
+    //Initializations
+    forms = g_array_new (FALSE, FALSE, sizeof(LwDeinflectorForm));
+    seen = g_hash_table_new (g_str_hash, g_str_equal);
+    results = g_ptr_array_new ();
+
+    form.word = g_strdup (WORD);
+    form.type = LW_DEINFLECTION_TYPE_ANY;
+    g_array_append_val (forms, form);
+    g_hash_table_insert (seen, form.word, GUINT_TO_POINTER (form.type));
+
+    for (i = 0; i < forms->len && forms->len < LW_DEINFLECTOR_MAX_FORMS; i++)
+    {
+      current = &g_array_index (forms, LwDeinflectorForm, i);
+      length = strlen (current->word);
+      if (length == 0) continue;
+      end = g_utf8_find_prev_char (current->word, current->word + length);
+      if (end == NULL) continue;
+
+      rules = g_hash_table_lookup (deinflector->rules, GUINT_TO_POINTER (g_utf8_get_char (end)));
+      for (j = 0; rules != NULL && j < rules->len && forms->len < LW_DEINFLECTOR_MAX_FORMS; j++)
+      {
+        rule = g_ptr_array_index (rules, j);
+        if ((current->type & rule->type_from) == 0) continue;
+        if (!g_str_has_suffix (current->word, rule->from)) continue;
+        stem_length = length - strlen (rule->from);
+
+        //No conjugation leaves a small tsu in front of the ending but the te and past forms
+        if (!lw_deinflector_rule_keeps_te (rule) && stem_length >= strlen ("っ") &&
+            strncmp (current->word + stem_length - strlen ("っ"), "っ", strlen ("っ")) == 0) continue;
+
+        form.word = g_malloc (stem_length + strlen (rule->to) + 1);
+        memcpy (form.word, current->word, stem_length);
+        strcpy (form.word + stem_length, rule->to);
+        form.type = rule->type_to;
+
+        //A word found again as another type of word is looked at again as that type
+        types = GPOINTER_TO_UINT (g_hash_table_lookup (seen, form.word));
+        if ((types & form.type) == form.type)
+        {
+          g_free (form.word); form.word = NULL;
+          continue;
+        }
+        form.type &= ~types;
+
+        //Appending can move the array so current has to be looked up again
+        g_array_append_val (forms, form);
+        g_hash_table_insert (seen, form.word, GUINT_TO_POINTER (types | form.type));
+        current = &g_array_index (forms, LwDeinflectorForm, i);
+      }
+    }
+
+    for (i = 1; i < forms->len; i++)
+    {
+      current = &g_array_index (forms, LwDeinflectorForm, i);
+      if ((current->type & LW_DEINFLECTION_TYPE_DICTIONARY_FORM) && g_utf8_strlen (current->word, -1) > 1 && !lw_deinflector_has_form (results, current->word))
+      {
+        g_ptr_array_add (results, current->word);
+        current->word = NULL;
+      }
+    }
+    g_ptr_array_add (results, NULL);
+
+    //Cleanup
+    for (i = 0; i < forms->len; i++)
+    {
+      current = &g_array_index (forms, LwDeinflectorForm, i);
+      if (current->word != NULL) g_free (current->word); current->word = NULL;
+    }
+    g_array_free (forms, TRUE); forms = NULL;
+    g_hash_table_unref (seen); seen = NULL;
+
+    return (gchar**) g_ptr_array_free (results, FALSE);
+}
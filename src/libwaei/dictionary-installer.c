@@ -686,6 +686,7 @@ lw_dictionary_installer_install (LwDictionary  *dictionary,
     LwDictionaryPrivate *priv;
     gchar **sourcelist, **sourceiter;
     gchar **targetlist, **targetiter;
+    LwSidecarStamp stamp;
 
     //Initializations
     priv = dictionary->priv;
@@ -704,12 +705,19 @@ lw_dictionary_installer_install (LwDictionary  *dictionary,
       {
         lw_io_copy (*sourceiter, *targetiter, lw_dictionary_sync_progress_cb, dictionary, cancellable, error);
 
+        //The indexes built while postprocessing are stamped with the time of the copied file
+        if (lw_sidecar_stamp_file (&stamp, *sourceiter))
+          lw_sidecar_stamp_touch (&stamp, *targetiter);
+
         sourceiter++;
         targetiter++;
         priv->install->index++;
       }
     }
 
+    //An installed dictionary might have replaced an old copy without the folder changing
+    lw_dictionary_invalidate_manifest ();
+
     if (*error == NULL)
       priv->install->status = LW_DICTIONARY_INSTALLER_STATUS_INSTALLED;
     else
@@ -37,6 +37,7 @@
 #include <stdio.h>
 
 #include <glib.h>
+#include <glib/gstdio.h>
 
 #include <libwaei/gettext.h>
 #include <libwaei/libwaei.h>
@@ -45,6 +46,8 @@
 
 G_DEFINE_ABSTRACT_TYPE (LwDictionary, lw_dictionary, G_TYPE_OBJECT)
 
+static gchar** lw_dictionary_build_sidecar_paths (const gchar*);
+
 typedef enum
 {
   PROP_0,
@@ -314,18 +317,25 @@ lw_dictionary_uninstall (LwDictionary *dictionary, LwIoProgressCallback cb, GErr
 
     //Declarations
     gchar *uri;
+    gchar **sidecars;
+    gint i;
 
     //Initializations
     uri =  lw_dictionary_get_path (dictionary);
+    sidecars = lw_dictionary_build_sidecar_paths (lw_dictionary_get_filename (dictionary));
 
     if (uri != NULL)
     {
       lw_io_remove (uri, NULL, error);
+      for (i = 0; sidecars[i] != NULL; i++) g_remove (sidecars[i]);
       if (cb != NULL) cb (1.0, dictionary);
 
       g_free (uri); uri = NULL;
     }
 
+    g_strfreev (sidecars); sidecars = NULL;
+    lw_dictionary_invalidate_manifest ();
+
     return (*error == NULL);
 }
  
@@ -455,12 +465,18 @@ lw_dictionary_parse_result (LwDictionary *dictionary, LwResult *result, FILE *fd
     g_return_val_if_fail (dictionary != NULL && result != NULL && fd != NULL, FALSE);
 
     LwDictionaryClass *klass;
+    gint bytes_read;
 
     klass = LW_DICTIONARY_CLASS (G_OBJECT_GET_CLASS (dictionary));
 
     g_return_val_if_fail (klass->parse_result != NULL, FALSE);
 
-    return klass->parse_result (dictionary, result, fd);
+    bytes_read = klass->parse_result (dictionary, result, fd);
+
+    //Checked once here instead of by every match of the compare
+    if (bytes_read > 0) lw_result_check_utf8 (result);
+
+    return bytes_read;
 }
 
 
@@ -663,75 +679,342 @@ lw_dictionary_set_selected (LwDictionary *dictionary, gboolean selected)
 }
 
 
-gchar**
-lw_dictionary_get_installed_idlist (GType type_filter)
+static GType*
+lw_dictionary_get_engine_types ()
 {
     //Declarations
-    GType* childlist;
-    GType *childiter;
+    GType *childlist;
 
-    const gchar* filename;
-    gchar *directorypath;
-    GDir *directory;
-
-    gchar **idlist;
-    gchar **iditer;
-
-    gint length;
-
-    childiter = childlist = g_new (GType, 5);
+    childlist = g_new (GType, 5);
     childlist[0] = lw_edictionary_get_type ();
     childlist[1] = lw_kanjidictionary_get_type ();
     childlist[2] = lw_exampledictionary_get_type ();
     childlist[3] = lw_unknowndictionary_get_type ();
     childlist[4] = 0;
 
-    if (childiter == NULL) return NULL;
+    return childlist;
+}
+
+
+static gint64
+lw_dictionary_get_mtime (const gchar *PATH)
+{
+    GStatBuf info;
+
+    if (PATH == NULL || g_stat (PATH, &info) != 0) return -1;
+
+    return (gint64) info.st_mtime;
+}
+
 
+//!
+//! @brief Finds the files that were built from a dictionary, like indexes, and live in the cache folder
+//! @param FILENAME The filename of the dictionary
+//! @returns A NULL terminated list of paths that exist to be freed with g_strfreev
+//!
+static gchar**
+lw_dictionary_build_sidecar_paths (const gchar *FILENAME)
+{
+    //Declarations
+    const gchar *SUFFIXES[] = { LW_RADICALINDEX_SUFFIX, LW_FUZZYINDEX_SUFFIX, LW_KANJIINDEX_SUFFIX, LW_EXAMPLEINDEX_SUFFIX, LW_ANNOTATOR_SUFFIX, NULL };
+    gchar **paths;
+    gchar *path;
+    gint i;
+    gint length;
+
+    //Initializations
+    paths = g_new0 (gchar*, G_N_ELEMENTS (SUFFIXES));
     length = 0;
 
-    //Find out how long the array has to be
-    while (*childiter != 0)
+    for (i = 0; SUFFIXES[i] != NULL; i++)
     {
-      directorypath = lw_dictionary_get_directory (*childiter);
-      directory = g_dir_open (directorypath, 0, NULL);
-      if (directory != NULL)
+      path = lw_sidecar_build_path (FILENAME, SUFFIXES[i]);
+      if (path != NULL && g_file_test (path, G_FILE_TEST_IS_REGULAR))
       {
-        while ((filename = g_dir_read_name (directory)) != NULL)
+        paths[length++] = path; path = NULL;
+      }
+      if (path != NULL) g_free (path); path = NULL;
+    }
+
+    return paths;
+}
+
+
+//!
+//! @brief The manifest starts with the modification times of the engine folders.
+//!        Installing or removing a dictionary changes them, which is how a stale
+//!        manifest is noticed without listing the folders.
+//!
+static gchar*
+lw_dictionary_build_manifest_header (GType *types)
+{
+    //Declarations
+    GString *text;
+    gchar *directorypath;
+    gchar *directoryname;
+    GType *iter;
+
+    //Initializations
+    text = g_string_new (NULL);
+
+    for (iter = types; *iter != 0; iter++)
+    {
+      directorypath = lw_dictionary_get_directory (*iter);
+      directoryname = lw_dictionary_get_directoryname (*iter);
+      g_string_append_printf (text, "D\t%s\t%" G_GINT64_FORMAT "\n", directoryname, lw_dictionary_get_mtime (directorypath));
+      if (directorypath != NULL) g_free (directorypath); directorypath = NULL;
+      if (directoryname != NULL) g_free (directoryname); directoryname = NULL;
+    }
+
+    return g_string_free (text, FALSE);
+}
+
+
+//!
+//! @brief Adds an F line for each dictionary file of an engine folder, stamped
+//!        with its size and modification time the way sidecars are
+//!
+static void
+lw_dictionary_append_manifest_entries (GString *text, GType type)
+{
+    //Declarations
+    LwSidecarStamp stamp;
+    const gchar *FILENAME;
+    gchar *directorypath;
+    gchar *path;
+    gchar *id;
+    GDir *directory;
+
+    //Initializations
+    directorypath = lw_dictionary_get_directory (type);
+    directory = g_dir_open (directorypath, 0, NULL);
+
+    if (directory != NULL)
+    {
+      while ((FILENAME = g_dir_read_name (directory)) != NULL)
+      {
+        path = g_build_filename (directorypath, FILENAME, NULL);
+        if (g_file_test (path, G_FILE_TEST_IS_REGULAR) && lw_sidecar_stamp_file (&stamp, path))
         {
-          length++;
+          id = lw_dictionary_build_id_from_type (type, FILENAME);
+
+          g_string_append_printf (text, "F\t%s\t", id);
+          lw_sidecar_stamp_append (&stamp, text);
+
+          g_free (id); id = NULL;
         }
-        g_dir_close (directory); directory = NULL;
+        g_free (path); path = NULL;
       }
-      g_free (directorypath); directorypath = NULL;
-      childiter++;
+      g_dir_close (directory); directory = NULL;
     }
 
-    iditer = idlist = g_new0 (gchar*, length + 1);
-    childiter = childlist;
+    if (directorypath != NULL) g_free (directorypath); directorypath = NULL;
+}
+
+
+//!
+//! @brief Checks the stamps of the F lines of a manifest against their dictionary
+//!        files, so a dictionary changed in place or removed is noticed
+//! @returns TRUE if every dictionary still has the size and time it was listed with
+//!
+static gboolean
+lw_dictionary_manifest_entries_are_current (gchar **lines)
+{
+    //Declarations
+    LwSidecarStamp stamp;
+    LwSidecarStamp current;
+    gchar **atoms;
+    gchar *path;
+    gboolean is_current;
+    gint i;
+
+    //Initializations
+    is_current = TRUE;
 
-    //Find out how long the array has to be
-    while (*childiter != 0)
+    for (i = 0; is_current && lines[i] != NULL; i++)
     {
-      directorypath = lw_dictionary_get_directory (*childiter);
-      directory = g_dir_open (directorypath, 0, NULL);
-      if (directory != NULL)
+      if (lines[i][0] != 'F') continue;
+
+      atoms = g_strsplit (lines[i], "\t", 3);
+      is_current = (g_strv_length (atoms) == 3 && lw_sidecar_stamp_parse (&stamp, atoms[2], NULL));
+      if (is_current)
       {
-        while ((filename = g_dir_read_name (directory)) != NULL && length > 0)
+        path = lw_util_build_filename (LW_PATH_DICTIONARY, atoms[1]);
+        is_current = (lw_sidecar_stamp_file (&current, path) && lw_sidecar_stamp_equal (&stamp, &current));
+        if (path != NULL) g_free (path); path = NULL;
+      }
+      g_strfreev (atoms); atoms = NULL;
+    }
+
+    return is_current;
+}
+
+
+//!
+//! @brief Gets the manifest of installed dictionaries from the cache folder.  It is
+//!        only rebuilt from the engine folders when one of them or one of the listed
+//!        dictionaries changed, so a start up costs a stat per engine and per
+//!        dictionary instead of listing the folders and opening every file.
+//! @returns A NULL terminated list of lines to be freed with g_strfreev.  Lines starting
+//!          with "F" are installed dictionaries as "F\tid\tsize mtime", stamped like
+//!          the sidecars built from them.
+//!
+gchar**
+lw_dictionary_get_manifest ()
+{
+    //Declarations
+    GType *types;
+    GType *iter;
+    gchar *header;
+    gchar *path;
+    gchar *contents;
+    gchar **lines;
+    GString *text;
+
+    //Initializations
+    types = lw_dictionary_get_engine_types ();
+    header = lw_dictionary_build_manifest_header (types);
+    path = lw_util_build_filename (LW_PATH_CACHE, LW_DICTIONARY_MANIFEST_FILENAME);
+    contents = NULL;
+    lines = NULL;
+
+    if (path != NULL && g_file_get_contents (path, &contents, NULL, NULL) && g_str_has_prefix (contents, header))
+    {
+      lines = g_strsplit (contents, "\n", -1);
+      if (!lw_dictionary_manifest_entries_are_current (lines))
+      {
+        g_strfreev (lines); lines = NULL;
+      }
+    }
+    if (contents != NULL) g_free (contents); contents = NULL;
+
+    if (lines == NULL)
+    {
+      text = g_string_new (header);
+      for (iter = types; *iter != 0; iter++)
+      {
+        lw_dictionary_append_manifest_entries (text, *iter);
+      }
+      if (path != NULL) g_file_set_contents (path, text->str, text->len, NULL);
+      lines = g_strsplit (text->str, "\n", -1);
+      g_string_free (text, TRUE); text = NULL;
+    }
+
+    if (path != NULL) g_free (path); path = NULL;
+    g_free (header); header = NULL;
+    g_free (types); types = NULL;
+
+    return lines;
+}
+
+
+//!
+//! @brief Makes the next lw_dictionary_get_manifest rebuild the manifest.  A dictionary
+//!        installed over an old copy doesn't change the engine folder.
+//!
+void
+lw_dictionary_invalidate_manifest ()
+{
+    //Declarations
+    gchar *path;
+
+    //Initializations
+    path = lw_util_build_filename (LW_PATH_CACHE, LW_DICTIONARY_MANIFEST_FILENAME);
+
+    if (path != NULL)
+    {
+      g_remove (path);
+      g_free (path); path = NULL;
+    }
+}
+
+
+//!
+//! @brief Creates the LwDictionary of a line of the manifest.  The length is
+//!        taken from the stamp of the line so the file doesn't have to be opened.
+//! @param LINE A line from lw_dictionary_get_manifest
+//! @returns A new LwDictionary or NULL if the line isn't a dictionary
+//!
+LwDictionary*
+lw_dictionary_new_from_manifest (const gchar *LINE)
+{
+    //Sanity checks
+    g_return_val_if_fail (LINE != NULL, NULL);
+
+    //Declarations
+    LwDictionary *dictionary;
+    LwSidecarStamp stamp;
+    gchar **atoms;
+    gchar **pair;
+    gchar *typename;
+    GType type;
+
+    //Initializations
+    dictionary = NULL;
+    if (*LINE != 'F') return NULL;
+    atoms = g_strsplit (LINE, "\t", 3);
+
+    if (g_strv_length (atoms) == 3 && lw_sidecar_stamp_parse (&stamp, atoms[2], NULL))
+    {
+      pair = g_strsplit (atoms[1], "/", 2);
+      if (pair[0] != NULL && pair[1] != NULL)
+      {
+        typename = lw_dictionary_directoryname_to_typename (pair[0]);
+        type = (typename != NULL) ? g_type_from_name (typename) : 0;
+        if (type != 0 && g_type_is_a (type, LW_TYPE_DICTIONARY))
         {
-          *iditer = lw_dictionary_build_id_from_type (*childiter, filename);
-          fprintf(stderr, "id: %s\n", *iditer);
-          
-          iditer++;
-          length--;
+          dictionary = LW_DICTIONARY (g_object_new (type, "filename", pair[1], NULL));
+          dictionary->priv->length = stamp.size;
         }
-        g_dir_close (directory); directory = NULL;
+        if (typename != NULL) g_free (typename); typename = NULL;
+      }
+      g_strfreev (pair); pair = NULL;
+    }
+
+    g_strfreev (atoms); atoms = NULL;
+
+    return dictionary;
+}
+
+
+gchar**
+lw_dictionary_get_installed_idlist (GType type_filter)
+{
+    //Declarations
+    gchar **manifest;
+    gchar **atoms;
+    gchar **idlist;
+    gchar *directoryname;
+    gchar *prefix;
+    gint length;
+    gint i;
+
+    //Initializations
+    manifest = lw_dictionary_get_manifest ();
+    idlist = g_new0 (gchar*, g_strv_length (manifest) + 1);
+    length = 0;
+    prefix = NULL;
+
+    if (type_filter != G_TYPE_NONE)
+    {
+      directoryname = lw_dictionary_get_directoryname (type_filter);
+      if (directoryname != NULL) prefix = g_strdup_printf ("%s/", directoryname);
+      if (directoryname != NULL) g_free (directoryname); directoryname = NULL;
+    }
+
+    for (i = 0; manifest[i] != NULL; i++)
+    {
+      if (manifest[i][0] != 'F') continue;
+      atoms = g_strsplit (manifest[i], "\t", 3);
+      if (atoms[0] != NULL && atoms[1] != NULL && (prefix == NULL || g_str_has_prefix (atoms[1], prefix)))
+      {
+        idlist[length++] = g_strdup (atoms[1]);
       }
-      g_free (directorypath); directorypath = NULL;
-      childiter++;
+      g_strfreev (atoms); atoms = NULL;
     }
 
-    if (childlist != NULL) g_free (childlist); childlist = NULL;
+    if (prefix != NULL) g_free (prefix); prefix = NULL;
+    g_strfreev (manifest); manifest = NULL;
 
     return idlist;
 }
@@ -751,7 +1034,7 @@ lw_dictionary_build_regex (LwDictionary *dictionary, LwQuery *query, GError **er
     LwDictionaryClass *klass;
     gchar **tokenlist;
     gchar *supplimentary;
-    GRegex *regex;
+    LwMatcher *matcher;
     LwRelevance relevance;
     gchar **pattern;
     LwQueryType type;
@@ -771,11 +1054,11 @@ lw_dictionary_build_regex (LwDictionary *dictionary, LwQuery *query, GError **er
           {
             supplimentary = lw_query_get_supplimentary (query, relevance, type, tokenlist[i], &new_type);
             pattern = klass->patterns[new_type];
-            if (relevance != LW_RELEVANCE_HIGH && supplimentary != NULL) regex = lw_regex_new (pattern[relevance], supplimentary, error);
-            else regex = lw_regex_new (pattern[relevance], tokenlist[i], error);
-            if (regex != NULL) lw_query_regexgroup_append (query, new_type, relevance, regex);
+            if (relevance != LW_RELEVANCE_HIGH && supplimentary != NULL) matcher = lw_matcher_new_for_pattern (pattern[relevance], supplimentary, error);
+            else matcher = lw_matcher_new_for_pattern (pattern[relevance], tokenlist[i], error);
+            if (matcher != NULL) lw_query_regexgroup_append (query, new_type, relevance, matcher);
             if (supplimentary != NULL) g_free (supplimentary); supplimentary = NULL;
-            regex = NULL; 
+            matcher = NULL; 
           }
         }
       }
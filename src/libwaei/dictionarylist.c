@@ -173,36 +173,23 @@ lw_dictionarylist_load_installed (LwDictionaryList *dictionarylist)
 
     //Declarations
     LwDictionaryListClass *klass;
-    gchar** idlist;
-    gchar **iditer;
-    gchar** pair;
-    gchar *typename;
-    GType type;
+    gchar **manifest;
+    gchar **iter;
     LwDictionary *dictionary;
-    const gchar *FILENAME;
 
     lw_dictionarylist_clear (dictionarylist);
     klass = LW_DICTIONARYLIST_CLASS (G_OBJECT_GET_CLASS (dictionarylist));
 
-    idlist = lw_dictionary_get_installed_idlist (G_TYPE_NONE);
-    if (idlist != NULL)
+    manifest = lw_dictionary_get_manifest ();
+    if (manifest != NULL)
     {
-      for (iditer = idlist; *iditer != NULL; iditer++)
+      for (iter = manifest; *iter != NULL; iter++)
       {
-        pair = g_strsplit_set (*iditer, "/", 2);
-        if (pair != NULL && pair[0] != NULL && pair[1] != NULL) 
-        {
-          typename = lw_dictionary_directoryname_to_typename (pair[0]);
-          type = g_type_from_name (typename);
-          FILENAME = pair[1];
-          dictionary = LW_DICTIONARY (g_object_new (type, "filename", FILENAME, NULL));
-          if (dictionary != NULL && LW_IS_DICTIONARY (dictionary))
-            lw_dictionarylist_append (dictionarylist, dictionary);
-          if (typename != NULL) g_free (typename); typename = NULL;
-        }
-        g_strfreev (pair); pair = NULL;
+        dictionary = lw_dictionary_new_from_manifest (*iter);
+        if (dictionary != NULL)
+          lw_dictionarylist_append (dictionarylist, dictionary);
       }
-      g_strfreev (idlist); idlist = NULL;
+      g_strfreev (manifest); manifest = NULL;
     }
 
     g_signal_emit (dictionarylist, klass->signalid[LW_DICTIONARYLIST_CLASS_SIGNALID_ADDED], 0);
@@ -205,7 +205,6 @@ lw_edictionary_parse_result (LwDictionary *dictionary, LwResult *result, FILE *f
     } while (ptr != NULL && *ptr == '#');
 
     if (ptr == NULL) return bytes_read;
-    bytes_read += strlen(result->text);
 
     //Remove the final line break
     if ((temp = g_utf8_strchr (result->text, -1, '\n')) != NULL)
@@ -305,13 +304,15 @@ lw_edictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult *resu
     g_return_val_if_fail (result != NULL, FALSE);
 
     //Declarations
+    LwMatcherFlags flags;
     gint j;
     gboolean found;
     gboolean checked;
     GList *link;
-    GRegex *regex;
+    LwMatcher *matcher;
 
     //Initializations
+    flags = (result->valid_utf8) ? LW_MATCHER_FLAG_VALID_UTF8 : 0;
     checked = FALSE;
     found = TRUE;
 
@@ -319,11 +320,11 @@ lw_edictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult *resu
     link = lw_query_regexgroup_get (query, LW_QUERY_TYPE_KANJI, RELEVANCE);
     while (link != NULL)
     {
-      regex = link->data;
-      if (regex == NULL || result->kanji_start == NULL)  return FALSE;
+      matcher = link->data;
+      if (matcher == NULL || result->kanji_start == NULL)  return FALSE;
 
       checked = TRUE;
-      found = g_regex_match (regex, result->kanji_start, 0, NULL);
+      found = lw_matcher_match_full (matcher, result->kanji_start, flags);
       if (found == FALSE) return found;
 
       link = link->next;
@@ -338,11 +339,11 @@ lw_edictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult *resu
 
       while (link != NULL && text != NULL)
       {
-        regex = link->data;
-        if (regex == NULL) return FALSE;
+        matcher = link->data;
+        if (matcher == NULL) return FALSE;
 
         checked = TRUE;
-        found = g_regex_match (regex, text, 0, NULL);
+        found = lw_matcher_match_full (matcher, text, flags);
         if (found == FALSE) return found;
 
         link = link->next;
@@ -353,13 +354,13 @@ lw_edictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult *resu
     link = lw_query_regexgroup_get (query, LW_QUERY_TYPE_ROMAJI, RELEVANCE);
     while (link != NULL)
     {
-      regex = link->data;
-      if (regex == NULL) return FALSE;
+      matcher = link->data;
+      if (matcher == NULL) return FALSE;
 
       for (j = 0; result->def_start[j] != NULL; j++)
       {
         checked = TRUE;
-        found = g_regex_match (regex, result->def_start[j], 0, NULL);
+        found = lw_matcher_match_full (matcher, result->def_start[j], flags);
         if (found == TRUE) break;
       }
 
@@ -371,26 +372,26 @@ lw_edictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult *resu
     link = lw_query_regexgroup_get (query, LW_QUERY_TYPE_MIX, RELEVANCE);
     while (link != NULL)
     {
-      regex = link->data;
-      if (regex == NULL || result->text == NULL) return FALSE;
+      matcher = link->data;
+      if (matcher == NULL || result->text == NULL) return FALSE;
       found = FALSE;
 
       if (result->kanji_start != NULL) 
       {
         checked = TRUE;
-        found = g_regex_match (regex, result->kanji_start, 0, NULL);
+        found = lw_matcher_match_full (matcher, result->kanji_start, flags);
       }
       if (result->furigana_start != NULL && !found) 
       {
         checked = TRUE;
-        found = g_regex_match (regex, result->furigana_start, 0, NULL);
+        found = lw_matcher_match_full (matcher, result->furigana_start, flags);
       }
       if (!found)
       {
         checked = TRUE;
         for (j = 0; result->def_start[j] != NULL; j++)
         {
-          found = g_regex_match (regex, result->def_start[j], 0, NULL);
+          found = lw_matcher_match_full (matcher, result->def_start[j], flags);
           if (found == TRUE) break;
         }
       }
@@ -422,6 +423,9 @@ lw_edictionary_installer_postprocess (LwDictionary *dictionary,
     //Declarations
     LwDictionaryPrivate *priv;
     LwDictionaryInstall *install;
+    LwFuzzyIndex *index;
+    LwAnnotator *annotator;
+    gchar *path;
     gint i;
 
     //Initializations
@@ -440,10 +444,31 @@ lw_edictionary_installer_postprocess (LwDictionary *dictionary,
     {
       g_return_val_if_fail (g_strv_length (sourcelist) > 0, FALSE);
       g_return_val_if_fail (g_strv_length (targetlist) > 1, FALSE);
-      return lw_io_split_places_from_names_dictionary (targetlist[0], targetlist[1], sourcelist[0], cb, data, cancellable, error);
+      if (!lw_io_split_places_from_names_dictionary (targetlist[0], targetlist[1], sourcelist[0], cb, data, cancellable, error))
+        return FALSE;
     }
 
-    return FALSE;
+    if (*error != NULL || targetlist[0] == NULL) return FALSE;
+
+    //Index the words now so the first fuzzy search doesn't have to
+    index = lw_fuzzyindex_new ();
+    path = lw_fuzzyindex_build_path (lw_dictionary_get_filename (dictionary));
+    if (path != NULL && lw_fuzzyindex_build (index, targetlist[0], cancellable, NULL))
+      lw_fuzzyindex_save (index, path, NULL);
+
+    if (path != NULL) g_free (path); path = NULL;
+    lw_fuzzyindex_unref (index); index = NULL;
+
+    //Index the headwords now so the first annotation doesn't have to
+    annotator = lw_annotator_new ();
+    path = lw_annotator_build_path (lw_dictionary_get_filename (dictionary));
+    if (path != NULL && lw_annotator_build (annotator, targetlist[0], cancellable, NULL))
+      lw_annotator_save (annotator, path, NULL);
+
+    if (path != NULL) g_free (path); path = NULL;
+    lw_annotator_free (annotator); annotator = NULL;
+
+    return TRUE;
 }
 
 
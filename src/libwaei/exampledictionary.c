@@ -47,6 +47,7 @@ G_DEFINE_TYPE (LwExampleDictionary, lw_exampledictionary, LW_TYPE_DICTIONARY)
 static gboolean lw_exampledictionary_parse_query (LwDictionary*, LwQuery*, const gchar*, GError**);
 static gint lw_exampledictionary_parse_result (LwDictionary*, LwResult*, FILE*);
 static gboolean lw_exampledictionary_compare (LwDictionary*, LwQuery*, LwResult*, const LwRelevance);
+static gboolean lw_exampledictionary_installer_postprocess (LwDictionary*, gchar**, gchar**, LwIoProgressCallback, gpointer, GCancellable*, GError**);
 
 static void lw_exampledictionary_create_primary_tokens (LwDictionary*, LwQuery*);
 static void lw_exampledictionary_add_supplimental_tokens (LwDictionary*, LwQuery*);
@@ -118,6 +119,7 @@ lw_exampledictionary_class_init (LwExampleDictionaryClass *klass)
     dictionary_class->parse_query = lw_exampledictionary_parse_query;
     dictionary_class->parse_result = lw_exampledictionary_parse_result;
     dictionary_class->compare = lw_exampledictionary_compare;
+    dictionary_class->installer_postprocess = lw_exampledictionary_installer_postprocess;
 
     dictionary_class->patterns = g_new0 (gchar**, TOTAL_LW_QUERY_TYPES + 1);
     for (i = 0; i < TOTAL_LW_QUERY_TYPES; i++)
@@ -254,12 +256,14 @@ lw_exampledictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult
     g_return_val_if_fail (result != NULL, FALSE);
 
     //Declarations
+    LwMatcherFlags flags;
     GList *link;
     gboolean found;
     gboolean checked;
-    GRegex *regex;
+    LwMatcher *matcher;
 
     //Initializations
+    flags = (result->valid_utf8) ? LW_MATCHER_FLAG_VALID_UTF8 : 0;
     checked = FALSE;
     found = FALSE;
 
@@ -267,11 +271,11 @@ lw_exampledictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult
     link = lw_query_regexgroup_get (query, LW_QUERY_TYPE_KANJI, RELEVANCE);
     while (link != NULL)
     {
-      regex = link->data;
-      if (regex == NULL || result->kanji_start == NULL) return FALSE;
+      matcher = link->data;
+      if (matcher == NULL || result->kanji_start == NULL) return FALSE;
 
       checked = TRUE;
-      found = g_regex_match (regex, result->kanji_start, 0, NULL);
+      found = lw_matcher_match_full (matcher, result->kanji_start, flags);
       if (found == FALSE) return found;
 
       link = link->next;
@@ -281,11 +285,11 @@ lw_exampledictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult
     link = lw_query_regexgroup_get (query, LW_QUERY_TYPE_FURIGANA, RELEVANCE);
     while (link != NULL)
     {
-      regex = link->data;
-      if (regex == NULL || result->furigana_start == NULL) return FALSE;
+      matcher = link->data;
+      if (matcher == NULL || result->furigana_start == NULL) return FALSE;
 
       checked = TRUE;
-      found = g_regex_match (regex, result->furigana_start, 0, NULL);
+      found = lw_matcher_match_full (matcher, result->furigana_start, flags);
       if (found == FALSE) return found;
 
       link = link->next;
@@ -295,11 +299,11 @@ lw_exampledictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult
     link = lw_query_regexgroup_get (query, LW_QUERY_TYPE_ROMAJI, RELEVANCE);
     while (link != NULL)
     {
-      regex = link->data;
-      if (regex == NULL || result->def_start[0] == NULL) return FALSE;
+      matcher = link->data;
+      if (matcher == NULL || result->def_start[0] == NULL) return FALSE;
 
       checked = TRUE;
-      found = g_regex_match (regex, result->def_start[0], 0, NULL);
+      found = lw_matcher_match_full (matcher, result->def_start[0], flags);
       if (found == FALSE) return found;
 
       link = link->next;
@@ -309,6 +313,47 @@ lw_exampledictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult
 }
 
 
+static gboolean
+lw_exampledictionary_installer_postprocess (LwDictionary *dictionary, 
+                                            gchar **sourcelist, 
+                                            gchar **targetlist, 
+                                            LwIoProgressCallback cb,
+                                            gpointer data,
+                                            GCancellable *cancellable,
+                                            GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, FALSE);
+    g_return_val_if_fail (sourcelist != NULL, FALSE);
+    g_return_val_if_fail (targetlist != NULL, FALSE);
+    if (*error != NULL) return FALSE;
+
+    //Declarations
+    LwExampleIndex *index;
+    gchar *path;
+    gint i;
+
+    for (i = 0; targetlist[i] != NULL && sourcelist[i] != NULL; i++)
+    {
+      if (g_file_test (sourcelist[i], G_FILE_TEST_IS_REGULAR) && *error == NULL)
+        lw_io_copy (sourcelist[i], targetlist[i], cb, data, cancellable, error);
+    }
+
+    if (*error != NULL || targetlist[0] == NULL) return FALSE;
+
+    //Index the words of the sentences now so looking up the examples of a word doesn't read them all
+    index = lw_exampleindex_new ();
+    path = lw_exampleindex_build_path (lw_dictionary_get_filename (dictionary));
+    if (path != NULL && lw_exampleindex_build (index, targetlist[0], cancellable, NULL))
+      lw_exampleindex_save (index, path, NULL);
+
+    if (path != NULL) g_free (path); path = NULL;
+    lw_exampleindex_unref (index); index = NULL;
+
+    return TRUE;
+}
+
+
 static void
 lw_exampledictionary_create_primary_tokens (LwDictionary *dictionary, LwQuery *query)
 {
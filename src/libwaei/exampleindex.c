@@ -0,0 +1,553 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file exampleindex.c
+//!
+//! @brief The sentences of the Examples dictionary each word is used in.
+//!        The B line under every sentence lists its words in their
+//!        dictionary form with their readings, so they are collected into
+//!        a sorted list of words with the offsets of their sentences.
+//!        Looking up the examples of a word is then a binary search instead
+//!        of reading the whole dictionary.  The index is written when the
+//!        dictionary is installed.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include <glib.h>
+
+#include <libwaei/libwaei.h>
+
+
+//!
+//! @brief Creates a new empty LwExampleIndex
+//! @returns An allocated LwExampleIndex that should be freed with lw_exampleindex_unref
+//!
+LwExampleIndex*
+lw_exampleindex_new ()
+{
+    //Declarations
+    LwExampleIndex *index;
+
+    //Initializations
+    index = g_new0 (LwExampleIndex, 1);
+    index->chunk = g_string_chunk_new (4096);
+    index->words = g_ptr_array_new ();
+    index->starts = g_array_new (FALSE, FALSE, sizeof(guint32));
+    index->postings = g_array_new (FALSE, FALSE, sizeof(glong));
+    index->refs = 1;
+
+    return index;
+}
+
+
+static void
+lw_exampleindex_clear (LwExampleIndex *index)
+{
+    g_string_chunk_clear (index->chunk);
+    g_ptr_array_set_size (index->words, 0);
+    g_array_set_size (index->starts, 0);
+    g_array_set_size (index->postings, 0);
+    memset (&index->stamp, 0, sizeof(LwSidecarStamp));
+}
+
+
+LwExampleIndex*
+lw_exampleindex_ref (LwExampleIndex *index)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, NULL);
+
+    g_atomic_int_inc (&index->refs);
+
+    return index;
+}
+
+
+//!
+//! @brief Releases a reference to an LwExampleIndex, freeing it with the last one
+//! @param index The LwExampleIndex to unref
+//!
+void
+lw_exampleindex_unref (LwExampleIndex *index)
+{
+    //Sanity checks
+    if (index == NULL) return;
+
+    if (!g_atomic_int_dec_and_test (&index->refs)) return;
+
+    g_string_chunk_free (index->chunk); index->chunk = NULL;
+    g_ptr_array_free (index->words, TRUE); index->words = NULL;
+    g_array_free (index->starts, TRUE); index->starts = NULL;
+    g_array_free (index->postings, TRUE); index->postings = NULL;
+
+    g_free (index);
+}
+
+
+//!
+//! @brief Gets the word index of an installed Examples dictionary.  The index
+//!        written at install time is used when it still matches the dictionary,
+//!        otherwise it is rebuilt from the dictionary and saved again.
+//! @param dictionary The installed LwDictionary
+//! @param error A GError to place errors into or NULL
+//! @returns An allocated LwExampleIndex or NULL on error
+//!
+LwExampleIndex*
+lw_exampleindex_new_for_dictionary (LwDictionary *dictionary, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+    if (error != NULL && *error != NULL) return NULL;
+
+    //Declarations
+    LwExampleIndex *index;
+
+    //Initializations
+    index = lw_exampleindex_new ();
+
+    if (!lw_sidecar_load_or_build (index, dictionary, LW_EXAMPLEINDEX_SUFFIX, (LwSidecarLoadFunc) lw_exampleindex_load, (LwSidecarBuildFunc) lw_exampleindex_build, (LwSidecarSaveFunc) lw_exampleindex_save, error))
+    {
+      lw_exampleindex_unref (index); index = NULL;
+    }
+
+    return index;
+}
+
+
+//!
+//! @brief Gets the index shared by every search of a dictionary, loading it
+//!        the first time and again when the dictionary was reinstalled.
+//! @param dictionary An Examples LwDictionary
+//! @returns A reference to the LwExampleIndex to be released with
+//!          lw_exampleindex_unref or NULL if the dictionary can't have one
+//!
+LwExampleIndex*
+lw_exampleindex_get_for_dictionary (LwDictionary *dictionary)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+    if (!LW_IS_EXAMPLEDICTIONARY (dictionary)) return NULL;
+
+    return LW_EXAMPLEINDEX (lw_sidecar_get_for_dictionary (dictionary, LW_EXAMPLEINDEX_SUFFIX, (LwSidecarNewFunc) lw_exampleindex_new_for_dictionary, (GBoxedCopyFunc) lw_exampleindex_ref, (GDestroyNotify) lw_exampleindex_unref));
+}
+
+
+//!
+//! @brief Builds the path of the index of a dictionary in the cache folder
+//! @param FILENAME The filename of the dictionary
+//! @returns An allocated path that should be freed with g_free
+//!
+gchar*
+lw_exampleindex_build_path (const gchar *FILENAME)
+{
+    return lw_sidecar_build_path (FILENAME, LW_EXAMPLEINDEX_SUFFIX);
+}
+
+
+//!
+//! @brief Adds a sentence to the postings of a word, once per sentence
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static void
+lw_exampleindex_add_posting (GHashTable *table, const gchar *WORD, gint length, glong offset)
+{
+    //Declarations
+    gchar *word;
+    GArray *postings;
+
+    if (length < 1) return;
+
+    //Initializations
+    word = g_strndup (WORD, length);
+    postings = g_hash_table_lookup (table, word);
+
+    if (postings == NULL)
+    {
+      postings = g_array_new (FALSE, FALSE, sizeof(glong));
+      g_hash_table_insert (table, word, postings);
+    }
+    else
+    {
+      g_free (word); word = NULL;
+    }
+
+    if (postings->len == 0 || g_array_index (postings, glong, postings->len - 1) != offset)
+      g_array_append_val (postings, offset);
+}
+
+
+//!
+//! @brief Adds the words of a B line like "B: 彼(かれ)[01] は 何{何も}~".
+//!        Each word is the dictionary form, followed by its reading in
+//!        parentheses, a sense number in brackets, the form used in the
+//!        sentence in braces and a tilde if it was checked.  The dictionary
+//!        form and the reading are indexed.
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static void
+lw_exampleindex_parse_line (GHashTable *table, const gchar *LINE, glong offset)
+{
+    //Declarations
+    const gchar *ptr;
+    const gchar *word;
+    const gchar *end;
+
+    //Initializations
+    ptr = LINE + 2;
+
+    while (*ptr != '\0')
+    {
+      while (*ptr == ' ' || *ptr == '\t' || *ptr == '\r' || *ptr == '\n') ptr++;
+      if (*ptr == '\0') break;
+
+      //The dictionary form
+      word = ptr;
+      while (*ptr != '\0' && strchr (" \t\r\n([{~|", *ptr) == NULL) ptr++;
+      lw_exampleindex_add_posting (table, word, ptr - word, offset);
+
+      //The reading
+      if (*ptr == '(')
+      {
+        word = ptr + 1;
+        end = strchr (word, ')');
+        if (end != NULL)
+        {
+          lw_exampleindex_add_posting (table, word, end - word, offset);
+          ptr = end + 1;
+        }
+      }
+
+      while (*ptr != '\0' && *ptr != ' ' && *ptr != '\t' && *ptr != '\n') ptr++;
+    }
+}
+
+
+static void
+lw_exampleindex_free_postings (GArray *postings)
+{
+    g_array_free (postings, TRUE);
+}
+
+
+static void
+lw_exampleindex_append_word (gchar *word, GArray *postings, GPtrArray *words)
+{
+    g_ptr_array_add (words, word);
+}
+
+
+static gint
+lw_exampleindex_compare_words (gconstpointer a, gconstpointer b)
+{
+    return strcmp (*((const gchar**) a), *((const gchar**) b));
+}
+
+
+//!
+//! @brief Indexes the words of every sentence of a dictionary file
+//! @param index The LwExampleIndex to fill
+//! @param PATH The path of an Examples dictionary file
+//! @param cancellable A GCancellable to stop the indexing or NULL
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE on success
+//!
+gboolean
+lw_exampleindex_build (LwExampleIndex *index, const gchar *PATH, GCancellable *cancellable, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, FALSE);
+    g_return_val_if_fail (PATH != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    FILE *file;
+    gchar line[LW_IO_MAX_FGETS_LINE];
+    GHashTable *table;
+    GPtrArray *words;
+    GArray *postings;
+    gchar *word;
+    glong offset;
+    glong sentence;
+    guint32 start;
+    guint i;
+    GQuark quark;
+
+    //Initializations
+    file = fopen (PATH, "r");
+    lw_exampleindex_clear (index);
+    offset = 0;
+    sentence = -1;
+
+    if (file == NULL)
+    {
+      quark = g_quark_from_string (LW_IO_ERROR);
+      g_set_error (error, quark, LW_IO_READ_ERROR, "Could not open %s to index its words", PATH);
+      return FALSE;
+    }
+
+    table = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) lw_exampleindex_free_postings);
+
+    while (fgets (line, LW_IO_MAX_FGETS_LINE, file) != NULL)
+    {
+      if (cancellable != NULL && g_cancellable_is_cancelled (cancellable)) break;
+
+      //The B line belongs to the A line right above it
+      if (line[0] == 'A' && line[1] == ':')
+      {
+        sentence = offset;
+      }
+      else if (line[0] == 'B' && line[1] == ':' && sentence >= 0)
+      {
+        lw_exampleindex_parse_line (table, line, sentence);
+        sentence = -1;
+      }
+
+      offset += strlen (line);
+    }
+
+    fclose (file); file = NULL;
+
+    //Lay the postings out one word after the other in the order of the words
+    words = g_ptr_array_sized_new (g_hash_table_size (table));
+    g_hash_table_foreach (table, (GHFunc) lw_exampleindex_append_word, words);
+    g_ptr_array_sort (words, lw_exampleindex_compare_words);
+
+    for (i = 0; i < words->len; i++)
+    {
+      word = g_ptr_array_index (words, i);
+      postings = g_hash_table_lookup (table, word);
+      start = index->postings->len;
+      g_ptr_array_add (index->words, g_string_chunk_insert (index->chunk, word));
+      g_array_append_val (index->starts, start);
+      g_array_append_vals (index->postings, postings->data, postings->len);
+    }
+    start = index->postings->len;
+    g_array_append_val (index->starts, start);
+
+    g_ptr_array_free (words, TRUE); words = NULL;
+    g_hash_table_unref (table); table = NULL;
+
+    lw_sidecar_stamp_file (&index->stamp, PATH);
+
+    return (cancellable == NULL || !g_cancellable_is_cancelled (cancellable));
+}
+
+
+//!
+//! @brief Writes the index so it doesn't have to be rebuilt from the dictionary.
+//!        The first line is the LwSidecarStamp of the dictionary and each
+//!        following line is a word, a tab and the offsets of its
+//!        sentences separated by spaces.
+//! @param index The LwExampleIndex to save
+//! @param PATH The file to write to
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE on success
+//!
+gboolean
+lw_exampleindex_save (LwExampleIndex *index, const gchar *PATH, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, FALSE);
+    g_return_val_if_fail (PATH != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    GString *text;
+    gboolean success;
+    guint32 start;
+    guint32 end;
+    guint i;
+
+    //Initializations
+    text = g_string_new (NULL);
+
+    lw_sidecar_stamp_append (&index->stamp, text);
+
+    for (i = 0; i < index->words->len; i++)
+    {
+      start = g_array_index (index->starts, guint32, i);
+      end = g_array_index (index->starts, guint32, i + 1);
+
+      g_string_append (text, g_ptr_array_index (index->words, i));
+      g_string_append_c (text, '\t');
+      for (; start < end; start++)
+      {
+        g_string_append_printf (text, "%ld", g_array_index (index->postings, glong, start));
+        g_string_append_c (text, (start + 1 < end) ? ' ' : '\n');
+      }
+    }
+
+    success = g_file_set_contents (PATH, text->str, text->len, error);
+
+    g_string_free (text, TRUE); text = NULL;
+
+    return success;
+}
+
+
+//!
+//! @brief Reads an index written by lw_exampleindex_save
+//! @param index The LwExampleIndex to fill
+//! @param PATH The file to read
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE on success
+//!
+gboolean
+lw_exampleindex_load (LwExampleIndex *index, const gchar *PATH, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, FALSE);
+    g_return_val_if_fail (PATH != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    gchar *contents;
+    gchar *line;
+    gchar *end;
+    gchar *tab;
+    gchar *word;
+    const gchar *previous;
+    glong offset;
+    guint32 start;
+    LwSidecarStamp stamp;
+
+    //Initializations
+    contents = NULL;
+    previous = NULL;
+    lw_exampleindex_clear (index);
+
+    if (!g_file_get_contents (PATH, &contents, NULL, error)) return FALSE;
+
+    if (!lw_sidecar_stamp_parse (&stamp, contents, &end)) goto errored;
+    line = (*end == '\n') ? end : NULL;
+
+    while (line != NULL && *(++line) != '\0')
+    {
+      tab = strchr (line, '\t');
+      if (tab == NULL) goto errored;
+      *tab = '\0';
+
+      //Lookups are binary searches so the words have to stay in order
+      if (previous != NULL && strcmp (previous, line) >= 0) goto errored;
+      previous = word = g_string_chunk_insert (index->chunk, line);
+
+      start = index->postings->len;
+      g_ptr_array_add (index->words, word);
+      g_array_append_val (index->starts, start);
+
+      end = tab;
+      do {
+        line = end + 1;
+        offset = strtol (line, &end, 10);
+        if (end == line) goto errored;
+        g_array_append_val (index->postings, offset);
+      } while (*end == ' ');
+
+      line = (*end == '\n') ? end : NULL;
+    }
+
+    start = index->postings->len;
+    g_array_append_val (index->starts, start);
+    index->stamp = stamp;
+
+    g_free (contents); contents = NULL;
+
+    return TRUE;
+
+errored:
+    lw_exampleindex_clear (index);
+    g_free (contents); contents = NULL;
+
+    return FALSE;
+}
+
+
+gint
+lw_exampleindex_length (LwExampleIndex *index)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, 0);
+
+    return index->words->len;
+}
+
+
+//!
+//! @brief Finds the sentences a word is used in
+//! @param index The LwExampleIndex to look through
+//! @param WORD A word in its dictionary form or its reading
+//! @returns An allocated GArray of the glong offsets of the A lines of the
+//!          sentences in dictionary order, or NULL if the word isn't used
+//!
+GArray*
+lw_exampleindex_lookup (LwExampleIndex *index, const gchar *WORD)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, NULL);
+    g_return_val_if_fail (WORD != NULL, NULL);
+
+    //Declarations
+    GArray *offsets;
+    guint32 start;
+    guint32 end;
+    guint lower;
+    guint higher;
+    guint middle;
+    gint difference;
+
+    //Initializations
+    lower = 0;
+    higher = index->words->len;
+
+    while (lower < higher)
+    {
+      middle = lower + (higher - lower) / 2;
+      difference = strcmp (g_ptr_array_index (index->words, middle), WORD);
+      if (difference == 0)
+      {
+        start = g_array_index (index->starts, guint32, middle);
+        end = g_array_index (index->starts, guint32, middle + 1);
+        offsets = g_array_sized_new (FALSE, FALSE, sizeof(glong), end - start);
+        g_array_append_vals (offsets, &g_array_index (index->postings, glong, start), end - start);
+        return offsets;
+      }
+      else if (difference < 0)
+      {
+        lower = middle + 1;
+      }
+      else
+      {
+        higher = middle;
+      }
+    }
+
+    return NULL;
+}
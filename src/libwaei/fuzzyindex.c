@@ -0,0 +1,644 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file fuzzyindex.c
+//!
+//! @brief The English words and romanized readings of an EDICT style
+//!        dictionary kept in a BK-tree, so the words within an edit distance
+//!        or two of a mistyped query can be found without comparing against
+//!        every word.  The index is written when the dictionary is installed.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <glib.h>
+
+#include <libwaei/libwaei.h>
+
+
+//!
+//! @brief Creates a new empty LwFuzzyIndex
+//! @returns An allocated LwFuzzyIndex that should be freed with lw_fuzzyindex_unref
+//!
+LwFuzzyIndex*
+lw_fuzzyindex_new ()
+{
+    LwFuzzyIndex *index;
+
+    index = g_new0 (LwFuzzyIndex, 1);
+    index->chunk = g_string_chunk_new (4096);
+    index->tokens = g_ptr_array_new ();
+    index->nodes = g_array_new (FALSE, FALSE, sizeof(LwFuzzyIndexNode));
+    index->refs = 1;
+
+    return index;
+}
+
+
+static void
+lw_fuzzyindex_clear (LwFuzzyIndex *index)
+{
+    g_string_chunk_clear (index->chunk);
+    g_ptr_array_set_size (index->tokens, 0);
+    g_array_set_size (index->nodes, 0);
+    memset (&index->stamp, 0, sizeof(LwSidecarStamp));
+}
+
+
+LwFuzzyIndex*
+lw_fuzzyindex_ref (LwFuzzyIndex *index)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, NULL);
+
+    g_atomic_int_inc (&index->refs);
+
+    return index;
+}
+
+
+//!
+//! @brief Releases a reference to an LwFuzzyIndex, freeing it with the last one
+//! @param index The LwFuzzyIndex to unref
+//!
+void
+lw_fuzzyindex_unref (LwFuzzyIndex *index)
+{
+    //Sanity checks
+    if (index == NULL) return;
+
+    if (!g_atomic_int_dec_and_test (&index->refs)) return;
+
+    g_string_chunk_free (index->chunk); index->chunk = NULL;
+    g_ptr_array_free (index->tokens, TRUE); index->tokens = NULL;
+    g_array_free (index->nodes, TRUE); index->nodes = NULL;
+
+    g_free (index);
+}
+
+
+//!
+//! @brief Gets the fuzzy index of an installed dictionary.  The index
+//!        written at install time is used when it still matches the dictionary,
+//!        otherwise it is rebuilt from the dictionary and saved again.
+//! @param dictionary The installed LwDictionary
+//! @param error A GError to place errors into or NULL
+//! @returns An allocated LwFuzzyIndex or NULL on error
+//!
+LwFuzzyIndex*
+lw_fuzzyindex_new_for_dictionary (LwDictionary *dictionary, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+    if (error != NULL && *error != NULL) return NULL;
+
+    //Declarations
+    LwFuzzyIndex *index;
+
+    //Initializations
+    index = lw_fuzzyindex_new ();
+
+    if (!lw_sidecar_load_or_build (index, dictionary, LW_FUZZYINDEX_SUFFIX, (LwSidecarLoadFunc) lw_fuzzyindex_load, (LwSidecarBuildFunc) lw_fuzzyindex_build, (LwSidecarSaveFunc) lw_fuzzyindex_save, error))
+    {
+      lw_fuzzyindex_unref (index); index = NULL;
+    }
+
+    return index;
+}
+
+
+//!
+//! @brief Gets the index shared by every search of a dictionary, loading it
+//!        the first time and again when the dictionary was reinstalled.
+//! @param dictionary An EDICT style LwDictionary
+//! @returns A reference to the LwFuzzyIndex to be released with
+//!          lw_fuzzyindex_unref or NULL if the dictionary can't have one
+//!
+LwFuzzyIndex*
+lw_fuzzyindex_get_for_dictionary (LwDictionary *dictionary)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+    if (!LW_IS_EDICTIONARY (dictionary)) return NULL;
+
+    return LW_FUZZYINDEX (lw_sidecar_get_for_dictionary (dictionary, LW_FUZZYINDEX_SUFFIX, (LwSidecarNewFunc) lw_fuzzyindex_new_for_dictionary, (GBoxedCopyFunc) lw_fuzzyindex_ref, (GDestroyNotify) lw_fuzzyindex_unref));
+}
+
+
+//!
+//! @brief Gets the index shared by every search of a dictionary without
+//!        waiting for it to be loaded or built.  Until it is ready, it is
+//!        loaded in the background and NULL is returned.
+//! @param dictionary An EDICT style LwDictionary
+//! @returns A reference to the LwFuzzyIndex to be released with
+//!          lw_fuzzyindex_unref or NULL if it isn't ready
+//!
+LwFuzzyIndex*
+lw_fuzzyindex_peek_for_dictionary (LwDictionary *dictionary)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+    if (!LW_IS_EDICTIONARY (dictionary)) return NULL;
+
+    return LW_FUZZYINDEX (lw_sidecar_peek_for_dictionary (dictionary, LW_FUZZYINDEX_SUFFIX, (LwSidecarNewFunc) lw_fuzzyindex_new_for_dictionary, (GBoxedCopyFunc) lw_fuzzyindex_ref, (GDestroyNotify) lw_fuzzyindex_unref));
+}
+
+
+//!
+//! @brief Builds the path of the index of a dictionary in the cache folder
+//! @param FILENAME The filename of the dictionary
+//! @returns An allocated path that should be freed with g_free
+//!
+gchar*
+lw_fuzzyindex_build_path (const gchar *FILENAME)
+{
+    return lw_sidecar_build_path (FILENAME, LW_FUZZYINDEX_SUFFIX);
+}
+
+
+//!
+//! @brief The Levenshtein distance between two tokens, counting inserted,
+//!        removed and substituted bytes.  Tokens are plain ASCII.
+//! @returns The edit distance or G_MAXINT if a token is too long to compare
+//!
+gint
+lw_fuzzyindex_distance (const gchar *A, const gchar *B)
+{
+    //Declarations
+    gint rows[2][LW_FUZZYINDEX_MAX_LENGTH + 1];
+    gint *previous, *current, *temp;
+    gint length_a, length_b;
+    gint cost;
+    gint i, j;
+
+    //Initializations
+    length_a = strlen (A);
+    length_b = strlen (B);
+    if (length_a > LW_FUZZYINDEX_MAX_LENGTH || length_b > LW_FUZZYINDEX_MAX_LENGTH) return G_MAXINT;
+    previous = rows[0];
+    current = rows[1];
+
+    for (j = 0; j <= length_b; j++) previous[j] = j;
+
+    for (i = 1; i <= length_a; i++)
+    {
+      current[0] = i;
+      for (j = 1; j <= length_b; j++)
+      {
+        cost = (A[i - 1] == B[j - 1]) ? 0 : 1;
+        current[j] = MIN (MIN (previous[j] + 1, current[j - 1] + 1), previous[j - 1] + cost);
+      }
+      temp = previous; previous = current; current = temp;
+    }
+
+    return previous[length_b];
+}
+
+
+//!
+//! @brief Links a node to its parent in the BK-tree
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static void
+lw_fuzzyindex_append_node (LwFuzzyIndex *index, const gchar *TOKEN, guint32 parent, guint32 distance)
+{
+    //Declarations
+    LwFuzzyIndexNode node;
+    LwFuzzyIndexNode *parentnode;
+    guint32 position;
+
+    //Initializations
+    position = index->nodes->len;
+    node.parent = parent;
+    node.child = 0;
+    node.sibling = 0;
+    node.distance = distance;
+
+    g_ptr_array_add (index->tokens, (gpointer) TOKEN);
+    g_array_append_val (index->nodes, node);
+
+    if (position == 0) return;
+
+    parentnode = &g_array_index (index->nodes, LwFuzzyIndexNode, parent);
+    g_array_index (index->nodes, LwFuzzyIndexNode, position).sibling = parentnode->child;
+    parentnode->child = position;
+}
+
+
+//!
+//! @brief Adds a token to the BK-tree under the child with the same distance
+//!        at each level, unless the token is already in it
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static void
+lw_fuzzyindex_insert (LwFuzzyIndex *index, const gchar *TOKEN)
+{
+    //Declarations
+    LwFuzzyIndexNode *node;
+    guint32 position;
+    guint32 child;
+    gint distance;
+
+    if (index->nodes->len == 0)
+    {
+      lw_fuzzyindex_append_node (index, TOKEN, 0, 0);
+      return;
+    }
+
+    position = 0;
+
+    while (TRUE)
+    {
+      distance = lw_fuzzyindex_distance (TOKEN, g_ptr_array_index (index->tokens, position));
+      if (distance == 0) return;
+
+      node = &g_array_index (index->nodes, LwFuzzyIndexNode, position);
+      for (child = node->child; child != 0; child = g_array_index (index->nodes, LwFuzzyIndexNode, child).sibling)
+      {
+        if (g_array_index (index->nodes, LwFuzzyIndexNode, child).distance == distance) break;
+      }
+      if (child == 0)
+      {
+        lw_fuzzyindex_append_node (index, TOKEN, position, distance);
+        return;
+      }
+
+      position = child;
+    }
+}
+
+
+//!
+//! @brief Adds a word to the index once, lowercased
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static void
+lw_fuzzyindex_add_token (LwFuzzyIndex *index, GHashTable *seen, const gchar *TOKEN, gint length)
+{
+    //Declarations
+    gchar buffer[LW_FUZZYINDEX_MAX_LENGTH + 1];
+    gchar *token;
+    gint i;
+
+    if (length < LW_FUZZYINDEX_MIN_LENGTH || length > LW_FUZZYINDEX_MAX_LENGTH) return;
+
+    for (i = 0; i < length; i++) buffer[i] = g_ascii_tolower (TOKEN[i]);
+    buffer[length] = '\0';
+
+    if (g_hash_table_lookup (seen, buffer) != NULL) return;
+
+    token = g_string_chunk_insert (index->chunk, buffer);
+    g_hash_table_insert (seen, token, token);
+    lw_fuzzyindex_insert (index, token);
+}
+
+
+//!
+//! @brief Adds the romanized reading and the English words of an EDICT line.
+//!        The reading is the part in brackets, or the word itself when it is
+//!        written in kana.  Anything in parenthesis, like the part of speech
+//!        tags, is skipped.
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static void
+lw_fuzzyindex_parse_line (LwFuzzyIndex *index, GHashTable *seen, const gchar *LINE)
+{
+    //Declarations
+    const gchar *reading;
+    const gchar *ptr;
+    const gchar *start;
+    gchar kana[LW_IO_MAX_FGETS_LINE];
+    gchar romaji[LW_FUZZYINDEX_MAX_LENGTH * 2];
+    gint length;
+    gint depth;
+
+    //Initializations
+    ptr = strchr (LINE, ' ');
+    if (ptr == NULL) return;
+    reading = (ptr[1] == '[') ? ptr + 2 : LINE;
+
+    //The first reading when there are alternatives
+    length = strcspn (reading, ";( ]");
+    if (length > 0 && length < sizeof(kana))
+    {
+      strncpy (kana, reading, length);
+      kana[length] = '\0';
+      if (lw_util_is_furigana_str (kana) && lw_util_str_kana_to_roma (kana, romaji, sizeof(romaji)))
+        lw_fuzzyindex_add_token (index, seen, romaji, strlen (romaji));
+    }
+
+    ptr = strchr (ptr, '/');
+    if (ptr == NULL) return;
+    depth = 0;
+
+    while (*ptr != '\0' && *ptr != '\n')
+    {
+      if (*ptr == '/' && strncmp (ptr + 1, "EntL", 4) == 0) break;
+      else if (*ptr == '(') depth++;
+      else if (*ptr == ')' && depth > 0) depth--;
+      else if (depth == 0 && g_ascii_isalpha (*ptr))
+      {
+        start = ptr;
+        while (g_ascii_isalpha (*ptr)) ptr++;
+        lw_fuzzyindex_add_token (index, seen, start, ptr - start);
+        continue;
+      }
+      ptr++;
+    }
+}
+
+
+//!
+//! @brief Indexes the words of a dictionary file
+//! @param index The LwFuzzyIndex to fill
+//! @param PATH The path of an EDICT style dictionary file
+//! @param cancellable A GCancellable to stop the indexing or NULL
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE on success
+//!
+gboolean
+lw_fuzzyindex_build (LwFuzzyIndex *index, const gchar *PATH, GCancellable *cancellable, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, FALSE);
+    g_return_val_if_fail (PATH != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    FILE *file;
+    gchar line[LW_IO_MAX_FGETS_LINE];
+    GHashTable *seen;
+    GQuark quark;
+
+    //Initializations
+    file = fopen (PATH, "r");
+    lw_fuzzyindex_clear (index);
+
+    if (file == NULL)
+    {
+      quark = g_quark_from_string (LW_IO_ERROR);
+      g_set_error (error, quark, LW_IO_READ_ERROR, "Could not open %s to index its words", PATH);
+      return FALSE;
+    }
+
+    seen = g_hash_table_new (g_str_hash, g_str_equal);
+
+    while (fgets (line, LW_IO_MAX_FGETS_LINE, file) != NULL)
+    {
+      if (cancellable != NULL && g_cancellable_is_cancelled (cancellable)) break;
+      if (line[0] == '#') continue;
+      lw_fuzzyindex_parse_line (index, seen, line);
+    }
+
+    fclose (file); file = NULL;
+    g_hash_table_unref (seen); seen = NULL;
+
+    lw_sidecar_stamp_file (&index->stamp, PATH);
+
+    return (cancellable == NULL || !g_cancellable_is_cancelled (cancellable));
+}
+
+
+//!
+//! @brief Writes the index so it doesn't have to be rebuilt from the dictionary.
+//!        The first line is the LwSidecarStamp of the dictionary and each
+//!        following line is a token, the line of its parent and its distance
+//!        to the parent separated by tabs, in the order the tokens were added
+//!        to the tree.
+//! @param index The LwFuzzyIndex to save
+//! @param PATH The file to write to
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE on success
+//!
+gboolean
+lw_fuzzyindex_save (LwFuzzyIndex *index, const gchar *PATH, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, FALSE);
+    g_return_val_if_fail (PATH != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    GString *text;
+    LwFuzzyIndexNode *node;
+    gboolean success;
+    guint i;
+
+    //Initializations
+    text = g_string_new (NULL);
+
+    lw_sidecar_stamp_append (&index->stamp, text);
+
+    for (i = 0; i < index->nodes->len; i++)
+    {
+      node = &g_array_index (index->nodes, LwFuzzyIndexNode, i);
+      g_string_append_printf (text, "%s\t%u\t%u\n", (gchar*) g_ptr_array_index (index->tokens, i), node->parent, node->distance);
+    }
+
+    success = g_file_set_contents (PATH, text->str, text->len, error);
+
+    g_string_free (text, TRUE); text = NULL;
+
+    return success;
+}
+
+
+//!
+//! @brief Loads an index written by lw_fuzzyindex_save
+//! @param index The LwFuzzyIndex to fill
+//! @param PATH The file to read
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE on success
+//!
+gboolean
+lw_fuzzyindex_load (LwFuzzyIndex *index, const gchar *PATH, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, FALSE);
+    g_return_val_if_fail (PATH != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    gchar *contents;
+    gchar *line;
+    gchar *end;
+    gchar *parent;
+    gchar *distance;
+    gchar *token;
+    LwSidecarStamp stamp;
+    guint32 position;
+
+    //Initializations
+    contents = NULL;
+    lw_fuzzyindex_clear (index);
+
+    if (!g_file_get_contents (PATH, &contents, NULL, error)) return FALSE;
+
+    if (!lw_sidecar_stamp_parse (&stamp, contents, &end)) goto errored;
+    line = (*end == '\n') ? end : NULL;
+
+    while (line != NULL && *(++line) != '\0')
+    {
+      end = strchr (line, '\n');
+      if (end != NULL) *end = '\0';
+
+      parent = strchr (line, '\t');
+      distance = (parent != NULL) ? strchr (parent + 1, '\t') : NULL;
+      if (distance == NULL) goto errored;
+      *parent = '\0';
+
+      position = (guint32) strtoul (parent + 1, NULL, 10);
+      if (index->nodes->len > 0 && position >= index->nodes->len) goto errored;
+
+      token = g_string_chunk_insert (index->chunk, line);
+      lw_fuzzyindex_append_node (index, token, position, (guint32) strtoul (distance + 1, NULL, 10));
+
+      line = end;
+    }
+
+    index->stamp = stamp;
+
+    g_free (contents); contents = NULL;
+
+    return TRUE;
+
+errored:
+    lw_fuzzyindex_clear (index);
+    g_free (contents); contents = NULL;
+
+    return FALSE;
+}
+
+
+static gint
+lw_fuzzyindex_compare_matches (gconstpointer a, gconstpointer b)
+{
+    //Declarations
+    const guint32 *A;
+    const guint32 *B;
+
+    //Initializations
+    A = a;
+    B = b;
+
+    if (A[1] != B[1]) return (A[1] < B[1]) ? -1 : 1;
+    if (A[0] != B[0]) return (A[0] < B[0]) ? -1 : 1;
+    return 0;
+}
+
+
+//!
+//! @brief Finds the words of the index a mistyped word could have been meant
+//!        to be.  Words of up to five letters are allowed one edit, longer
+//!        ones two.  Only the children whose distance to their parent is
+//!        within that many edits of the parent's distance to the word can
+//!        hold a match, so most of the tree is never looked at.
+//! @param index The LwFuzzyIndex to search
+//! @param TOKEN The word to correct
+//! @returns A NULL terminated array of the closest words to be freed with
+//!          g_strfreev.  It is empty when the word is in the index itself.
+//!
+gchar**
+lw_fuzzyindex_correct (LwFuzzyIndex *index, const gchar *TOKEN)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, NULL);
+    g_return_val_if_fail (TOKEN != NULL, NULL);
+
+    //Declarations
+    gchar *token;
+    gchar **corrections;
+    GArray *stack;
+    GArray *matches;
+    LwFuzzyIndexNode *node;
+    guint32 position;
+    guint32 match[2];
+    gint length;
+    gint limit;
+    gint distance;
+    gint i;
+
+    //Initializations
+    token = g_ascii_strdown (TOKEN, -1);
+    length = strlen (token);
+    limit = (length > 5) ? 2 : 1;
+    stack = g_array_new (FALSE, FALSE, sizeof(guint32));
+    matches = g_array_new (FALSE, FALSE, sizeof(guint32) * 2);
+
+    if (length < LW_FUZZYINDEX_MIN_LENGTH || length > LW_FUZZYINDEX_MAX_LENGTH || index->nodes->len == 0) goto finished;
+
+    position = 0;
+    g_array_append_val (stack, position);
+
+    while (stack->len > 0)
+    {
+      position = g_array_index (stack, guint32, stack->len - 1);
+      g_array_set_size (stack, stack->len - 1);
+
+      distance = lw_fuzzyindex_distance (token, g_ptr_array_index (index->tokens, position));
+      if (distance == 0)
+      {
+        g_array_set_size (matches, 0);
+        break;
+      }
+      if (distance <= limit)
+      {
+        match[0] = position;
+        match[1] = distance;
+        g_array_append_val (matches, match);
+      }
+
+      node = &g_array_index (index->nodes, LwFuzzyIndexNode, position);
+      for (position = node->child; position != 0; position = node->sibling)
+      {
+        node = &g_array_index (index->nodes, LwFuzzyIndexNode, position);
+        if (ABS ((gint) node->distance - distance) <= limit)
+          g_array_append_val (stack, position);
+      }
+    }
+
+finished:
+    g_array_sort (matches, lw_fuzzyindex_compare_matches);
+
+    length = MIN (matches->len, LW_FUZZYINDEX_MAX_CORRECTIONS);
+    corrections = g_new0 (gchar*, length + 1);
+    for (i = 0; i < length; i++)
+    {
+      position = ((guint32*) matches->data)[i * 2];
+      corrections[i] = g_strdup (g_ptr_array_index (index->tokens, position));
+    }
+
+    g_array_free (stack, TRUE); stack = NULL;
+    g_array_free (matches, TRUE); matches = NULL;
+    g_free (token); token = NULL;
+
+    return corrections;
+}
@@ -502,3 +502,174 @@ lw_history_has_relevance (LwHistory *history, LwSearch *search, gboolean check_t
 }
 
 
+
+//!
+//! @brief Writes one list of the history as lines of the history file
+//!
+static void
+lw_history_append_list (GString *text, gchar type, GList *list)
+{
+    //Declarations
+    LwSearch *search;
+    const gchar *query;
+    gchar *id;
+    gchar *snapshot;
+    GList *link;
+
+    for (link = list; link != NULL; link = link->next)
+    {
+      search = LW_SEARCH (link->data);
+      if (search == NULL || search->dictionary == NULL) continue;
+      query = lw_query_get_text (search->query);
+      if (query == NULL || strchr (query, '\n') != NULL) continue;
+
+      id = lw_dictionary_build_id (search->dictionary);
+      snapshot = lw_search_snapshot_to_string (search);
+
+      if (id != NULL)
+      {
+        g_string_append_printf (text, "%c\t%s\t%d\t%s\t%s\n", 
+          type, id, (gint) lw_search_get_flags (search), (snapshot != NULL) ? snapshot : "", query
+        );
+      }
+
+      if (id != NULL) g_free (id); id = NULL;
+      if (snapshot != NULL) g_free (snapshot); snapshot = NULL;
+    }
+}
+
+
+//!
+//! @brief Saves the history to disk along with snapshots of the results of
+//!        each search so they can be shown again without a rescan
+//! @param history The LwHistory to save
+//! @param FILENAME The file to write to or NULL for the default location
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE on success
+//!
+gboolean
+lw_history_save (LwHistory *history, const gchar *FILENAME, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (history != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    LwHistoryPrivate *priv;
+    GString *text;
+    gchar *path;
+    gboolean success;
+
+    //Initializations
+    priv = history->priv;
+    text = g_string_new (NULL);
+    success = FALSE;
+
+    if (FILENAME != NULL) path = g_strdup (FILENAME);
+    else path = lw_util_build_filename (LW_PATH_CACHE, LW_HISTORY_FILENAME);
+
+    lw_history_append_list (text, 'B', priv->back);
+    lw_history_append_list (text, 'F', priv->forward);
+
+    if (path != NULL)
+    {
+      success = g_file_set_contents (path, text->str, text->len, error);
+      g_free (path); path = NULL;
+    }
+
+    g_string_free (text, TRUE); text = NULL;
+
+    return success;
+}
+
+
+//!
+//! @brief Replaces the history with the one saved by lw_history_save.
+//!        Searches of dictionaries that aren't installed anymore are dropped.
+//! @param history The LwHistory to load into
+//! @param dictionarylist The installed dictionaries to look the searches up in
+//! @param FILENAME The file to read from or NULL for the default location
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE on success
+//!
+gboolean
+lw_history_load (LwHistory *history, LwDictionaryList *dictionarylist, const gchar *FILENAME, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (history != NULL, FALSE);
+    g_return_val_if_fail (dictionarylist != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    LwHistoryPrivate *priv;
+    LwHistoryClass *klass;
+    LwDictionary *dictionary;
+    LwSearch *search;
+    gchar *path;
+    gchar *contents;
+    gchar **lines;
+    gchar **atoms;
+    gint i;
+    gint total;
+
+    //Initializations
+    priv = history->priv;
+    klass = LW_HISTORY_CLASS (G_OBJECT_GET_CLASS (history));
+    contents = NULL;
+    lines = NULL;
+    total = 0;
+
+    if (FILENAME != NULL) path = g_strdup (FILENAME);
+    else path = lw_util_build_filename (LW_PATH_CACHE, LW_HISTORY_FILENAME);
+    if (path == NULL) return FALSE;
+
+    //A missing history isn't an error
+    if (!g_file_test (path, G_FILE_TEST_EXISTS)) goto finished;
+    if (!g_file_get_contents (path, &contents, NULL, error)) goto finished;
+
+    lw_history_clear_forward_list (history);
+    lw_history_clear_back_list (history);
+
+    lines = g_strsplit (contents, "\n", -1);
+    for (i = 0; lines[i] != NULL; i++)
+    {
+      atoms = g_strsplit (lines[i], "\t", 5);
+      if (g_strv_length (atoms) == 5 && (atoms[0][0] == 'B' || atoms[0][0] == 'F'))
+      {
+        dictionary = lw_dictionarylist_get_dictionary_by_id (dictionarylist, atoms[1]);
+        search = NULL;
+
+        if (dictionary != NULL && (priv->max < 0 || total < priv->max))
+        {
+          search = lw_search_new (dictionary, atoms[4], (LwSearchFlags) g_ascii_strtoll (atoms[2], NULL, 10), NULL);
+        }
+
+        if (search != NULL)
+        {
+          if (*atoms[3] != '\0') lw_search_set_snapshot_from_string (search, atoms[3]);
+
+          if (atoms[0][0] == 'B')
+            priv->back = g_list_prepend (priv->back, search);
+          else
+            priv->forward = g_list_prepend (priv->forward, search);
+          total++;
+        }
+      }
+      g_strfreev (atoms); atoms = NULL;
+    }
+
+    priv->back = g_list_reverse (priv->back);
+    priv->forward = g_list_reverse (priv->forward);
+
+    g_signal_emit (history,
+      klass->signalid[LW_HISTORY_CLASS_SIGNALID_CHANGED],
+      0
+    );
+
+finished:
+    if (lines != NULL) g_strfreev (lines); lines = NULL;
+    if (contents != NULL) g_free (contents); contents = NULL;
+    g_free (path); path = NULL;
+
+    return (error == NULL || *error == NULL);
+}
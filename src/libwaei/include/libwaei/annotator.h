@@ -0,0 +1,67 @@
+#ifndef LW_ANNOTATOR_INCLUDED
+#define LW_ANNOTATOR_INCLUDED
+
+#include <libwaei/dictionary.h>
+#include <libwaei/sidecar.h>
+
+G_BEGIN_DECLS
+
+#define LW_ANNOTATOR_SUFFIX ".headwords"
+#define LW_ANNOTATOR_MAX_OKURIGANA 6  //Most hiragana after a headword tried as the ending of a conjugation
+
+struct _LwAnnotatorNode {
+  gunichar character;  //Last character of the headword prefix the node stands for
+  guint32 child;       //First child of the node or 0 if there are none
+  guint32 sibling;     //Next child of the same parent or 0 if there are none
+  guint32 posting;     //Newest posting of the lines with the headword plus one or 0 if it isn't one
+};
+typedef struct _LwAnnotatorNode LwAnnotatorNode;
+
+struct _LwAnnotatorPosting {
+  glong offset;  //Offset of the dictionary line in the file
+  guint32 next;  //Next posting of the same headword plus one or 0 for the last
+};
+typedef struct _LwAnnotatorPosting LwAnnotatorPosting;
+
+struct _LwAnnotator {
+  LwDictionary *dictionary;  //The EDICT style dictionary the headwords are from
+  GArray *nodes;             //LwAnnotatorNodes of the headword trie with the root first
+  GHashTable *roots;         //First characters of the headwords to their nodes
+  GArray *postings;          //LwAnnotatorPostings of every node
+  GArray *hits;              //Offsets of the lines of the token being annotated
+  FILE *file;                //The dictionary file the results are read from
+  LwSidecarStamp stamp;      //The dictionary file the trie was built from
+};
+typedef struct _LwAnnotator LwAnnotator;
+
+#define LW_ANNOTATOR(object) (LwAnnotator*) object
+
+//!
+//! @brief Called for every token of a text that has dictionary hits
+//! @param annotator The LwAnnotator that found the token
+//! @param WORD The token as it is written in the text
+//! @param FORM The headword the token was found as, like the dictionary form of a conjugation
+//! @param hits The glong offsets of the dictionary lines of the headword
+//! @param data The data passed when annotating
+//!
+typedef void (*LwAnnotatorFunc) (LwAnnotator *annotator, const gchar *WORD, const gchar *FORM, GArray *hits, gpointer data);
+#define LW_ANNOTATOR_FUNC(object) (LwAnnotatorFunc) object
+
+LwAnnotator* lw_annotator_new (void);
+LwAnnotator* lw_annotator_new_for_dictionary (LwDictionary*, GError**);
+void lw_annotator_free (LwAnnotator*);
+
+gboolean lw_annotator_build (LwAnnotator*, const gchar*, GCancellable*, GError**);
+gboolean lw_annotator_load (LwAnnotator*, const gchar*, GError**);
+gboolean lw_annotator_save (LwAnnotator*, const gchar*, GError**);
+gchar* lw_annotator_build_path (const gchar*);
+
+gboolean lw_annotator_lookup (LwAnnotator*, const gchar*, gint);
+LwResult* lw_annotator_get_result (LwAnnotator*, glong);
+
+void lw_annotator_annotate (LwAnnotator*, const gchar*, LwAnnotatorFunc, gpointer);
+gboolean lw_annotator_annotate_file (LwAnnotator*, const gchar*, LwAnnotatorFunc, gpointer, GCancellable*, GError**);
+
+G_END_DECLS
+
+#endif
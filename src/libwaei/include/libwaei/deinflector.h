@@ -0,0 +1,46 @@
+#ifndef LW_DEINFLECTOR_INCLUDED
+#define LW_DEINFLECTOR_INCLUDED
+
+G_BEGIN_DECLS
+
+#define LW_DEINFLECTOR_MAX_FORMS 48
+
+//What a word can be taken as when looking for rules to apply to it
+typedef enum {
+  LW_DEINFLECTION_TYPE_ICHIDAN = (1 << 0),
+  LW_DEINFLECTION_TYPE_GODAN = (1 << 1),
+  LW_DEINFLECTION_TYPE_ADJECTIVE = (1 << 2),
+  LW_DEINFLECTION_TYPE_KURU = (1 << 3),
+  LW_DEINFLECTION_TYPE_SURU = (1 << 4),
+  LW_DEINFLECTION_TYPE_POLITE = (1 << 5),   //A stem followed by ます
+  LW_DEINFLECTION_TYPE_TE = (1 << 6),       //The て or で form
+  LW_DEINFLECTION_TYPE_INFLECTED = (1 << 7) //A form that can only be how the word ends, like the past
+} LwDeinflectionType;
+
+#define LW_DEINFLECTION_TYPE_DICTIONARY_FORM (LW_DEINFLECTION_TYPE_ICHIDAN | LW_DEINFLECTION_TYPE_GODAN | LW_DEINFLECTION_TYPE_ADJECTIVE | LW_DEINFLECTION_TYPE_KURU | LW_DEINFLECTION_TYPE_SURU)
+#define LW_DEINFLECTION_TYPE_ANY (0xff)
+
+struct _LwDeinflectionRule {
+  const gchar *from;  //Ending of the inflected word
+  const gchar *to;    //What the ending is replaced with
+  guint type_from;    //LwDeinflectionTypes the word has to be for the rule to apply
+  guint type_to;      //LwDeinflectionTypes of the word once the rule was applied
+};
+typedef struct _LwDeinflectionRule LwDeinflectionRule;
+
+struct _LwDeinflector {
+  GHashTable *rules;  //Last character of an ending to a GPtrArray of the rules with that ending
+};
+typedef struct _LwDeinflector LwDeinflector;
+
+#define LW_DEINFLECTOR(object) (LwDeinflector*) object
+
+LwDeinflector* lw_deinflector_new (void);
+LwDeinflector* lw_deinflector_get_default (void);
+void lw_deinflector_free (LwDeinflector*);
+
+gchar** lw_deinflector_deinflect (LwDeinflector*, const gchar*);
+
+G_END_DECLS
+
+#endif
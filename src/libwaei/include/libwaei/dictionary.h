@@ -7,6 +7,8 @@
 
 G_BEGIN_DECLS
 
+#define LW_DICTIONARY_MANIFEST_FILENAME "dictionaries"
+
 typedef enum {
   LW_DICTIONARY_CLASS_SIGNALID_PROGRESS_CHANGED,
   TOTAL_LW_DICTIONARY_CLASS_SIGNALIDS
@@ -72,6 +74,9 @@ gchar* lw_dictionary_directoryname_to_typename (const gchar*);
 gchar* lw_dictionary_get_directoryname (GType);
 
 gchar** lw_dictionary_get_installed_idlist (GType);
+gchar** lw_dictionary_get_manifest (void);
+void lw_dictionary_invalidate_manifest (void);
+LwDictionary* lw_dictionary_new_from_manifest (const gchar*);
 
 void lw_dictionary_build_regex (LwDictionary*, LwQuery*, GError**);
 
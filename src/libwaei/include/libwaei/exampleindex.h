@@ -0,0 +1,39 @@
+#ifndef LW_EXAMPLEINDEX_INCLUDED
+#define LW_EXAMPLEINDEX_INCLUDED
+
+#include <libwaei/dictionary.h>
+#include <libwaei/sidecar.h>
+
+G_BEGIN_DECLS
+
+#define LW_EXAMPLEINDEX_SUFFIX ".words"
+
+struct _LwExampleIndex {
+  GStringChunk *chunk;  //Storage of the word strings
+  GPtrArray *words;     //Dictionary forms and readings from the B lines in strcmp order
+  GArray *starts;       //guint32 position in postings of the first sentence of each word, plus the end
+  GArray *postings;     //glong offsets of the A lines of the sentences of every word in file order
+  LwSidecarStamp stamp;  //The dictionary file the index was built from
+  gint refs;
+};
+typedef struct _LwExampleIndex LwExampleIndex;
+
+#define LW_EXAMPLEINDEX(object) (LwExampleIndex*) object
+
+LwExampleIndex* lw_exampleindex_new (void);
+LwExampleIndex* lw_exampleindex_new_for_dictionary (LwDictionary*, GError**);
+LwExampleIndex* lw_exampleindex_get_for_dictionary (LwDictionary*);
+LwExampleIndex* lw_exampleindex_ref (LwExampleIndex*);
+void lw_exampleindex_unref (LwExampleIndex*);
+
+gboolean lw_exampleindex_build (LwExampleIndex*, const gchar*, GCancellable*, GError**);
+gboolean lw_exampleindex_load (LwExampleIndex*, const gchar*, GError**);
+gboolean lw_exampleindex_save (LwExampleIndex*, const gchar*, GError**);
+gchar* lw_exampleindex_build_path (const gchar*);
+
+gint lw_exampleindex_length (LwExampleIndex*);
+GArray* lw_exampleindex_lookup (LwExampleIndex*, const gchar*);
+
+G_END_DECLS
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef LW_FUZZYINDEX_INCLUDED
+#define LW_FUZZYINDEX_INCLUDED
+
+#include <libwaei/dictionary.h>
+#include <libwaei/sidecar.h>
+
+G_BEGIN_DECLS
+
+#define LW_FUZZYINDEX_SUFFIX ".tokens"
+#define LW_FUZZYINDEX_MIN_LENGTH 3        //Shorter words are too close to too many others to be corrected
+#define LW_FUZZYINDEX_MAX_LENGTH 32
+#define LW_FUZZYINDEX_MAX_CORRECTIONS 5
+
+struct _LwFuzzyIndexNode {
+  guint32 parent;    //Node the token was added under
+  guint32 child;     //First child of the node or 0 if there are none
+  guint32 sibling;   //Next child of the same parent or 0 if there are none
+  guint32 distance;  //Edit distance to the token of the parent
+};
+typedef struct _LwFuzzyIndexNode LwFuzzyIndexNode;
+
+struct _LwFuzzyIndex {
+  GStringChunk *chunk;  //Storage of the token strings
+  GPtrArray *tokens;    //Token of each node
+  GArray *nodes;        //LwFuzzyIndexNodes of the BK-tree with the root first
+  LwSidecarStamp stamp;  //The dictionary file the index was built from
+  gint refs;
+};
+typedef struct _LwFuzzyIndex LwFuzzyIndex;
+
+#define LW_FUZZYINDEX(object) (LwFuzzyIndex*) object
+
+LwFuzzyIndex* lw_fuzzyindex_new (void);
+LwFuzzyIndex* lw_fuzzyindex_new_for_dictionary (LwDictionary*, GError**);
+LwFuzzyIndex* lw_fuzzyindex_get_for_dictionary (LwDictionary*);
+LwFuzzyIndex* lw_fuzzyindex_peek_for_dictionary (LwDictionary*);
+LwFuzzyIndex* lw_fuzzyindex_ref (LwFuzzyIndex*);
+void lw_fuzzyindex_unref (LwFuzzyIndex*);
+
+gboolean lw_fuzzyindex_build (LwFuzzyIndex*, const gchar*, GCancellable*, GError**);
+gboolean lw_fuzzyindex_load (LwFuzzyIndex*, const gchar*, GError**);
+gboolean lw_fuzzyindex_save (LwFuzzyIndex*, const gchar*, GError**);
+gchar* lw_fuzzyindex_build_path (const gchar*);
+
+gint lw_fuzzyindex_distance (const gchar*, const gchar*);
+gchar** lw_fuzzyindex_correct (LwFuzzyIndex*, const gchar*);
+
+G_END_DECLS
+
+#endif
@@ -2,9 +2,12 @@
 #define LW_HISTORY_INCLUDED 
 
 #include <libwaei/search.h>
+#include <libwaei/dictionarylist.h>
 
 G_BEGIN_DECLS
 
+#define LW_HISTORY_FILENAME "history"
+
 typedef enum {
   LW_HISTORY_CLASS_SIGNALID_CHANGED,
   LW_HISTORY_CLASS_SIGNALID_BACK,
@@ -63,6 +66,9 @@ LwSearch* lw_history_go_forward (LwHistory*, LwSearch*);
 
 gboolean lw_history_has_relevance (LwHistory*, LwSearch*, gboolean);
 
+gboolean lw_history_save (LwHistory*, const gchar*, GError**);
+gboolean lw_history_load (LwHistory*, LwDictionaryList*, const gchar*, GError**);
+
 G_END_DECLS
 
 #endif
@@ -0,0 +1,38 @@
+#ifndef LW_KANJIINDEX_INCLUDED
+#define LW_KANJIINDEX_INCLUDED
+
+#include <libwaei/dictionary.h>
+#include <libwaei/sidecar.h>
+
+G_BEGIN_DECLS
+
+#define LW_KANJIINDEX_SUFFIX ".numbers"
+#define LW_KANJIINDEX_UNKNOWN G_MAXUINT16  //Value of a number the line of a kanji doesn't have
+
+struct _LwKanjiIndex {
+  GArray *offsets;                              //glong offset of the line of each kanji in dictionary order
+  GArray *columns[TOTAL_LW_QUERY_RANGE_TYPES];  //guint16 stroke count, grade, JLPT level and frequency of each kanji
+  LwSidecarStamp stamp;  //The dictionary file the index was built from
+  gint refs;
+};
+typedef struct _LwKanjiIndex LwKanjiIndex;
+
+#define LW_KANJIINDEX(object) (LwKanjiIndex*) object
+
+LwKanjiIndex* lw_kanjiindex_new (void);
+LwKanjiIndex* lw_kanjiindex_new_for_dictionary (LwDictionary*, GError**);
+LwKanjiIndex* lw_kanjiindex_peek_for_dictionary (LwDictionary*);
+LwKanjiIndex* lw_kanjiindex_ref (LwKanjiIndex*);
+void lw_kanjiindex_unref (LwKanjiIndex*);
+
+gboolean lw_kanjiindex_build (LwKanjiIndex*, const gchar*, GCancellable*, GError**);
+gboolean lw_kanjiindex_load (LwKanjiIndex*, const gchar*, GError**);
+gboolean lw_kanjiindex_save (LwKanjiIndex*, const gchar*, GError**);
+gchar* lw_kanjiindex_build_path (const gchar*);
+
+gint lw_kanjiindex_length (LwKanjiIndex*);
+GArray* lw_kanjiindex_filter (LwKanjiIndex*, LwQuery*);
+
+G_END_DECLS
+
+#endif
@@ -2,20 +2,31 @@
 #define LW_LIBWAEI_INCLUDED
 
 #include <libwaei/definitions.h>
+#include <libwaei/matcher.h>
 #include <libwaei/regex.h>
 #include <libwaei/utilities.h>
 #include <libwaei/io.h>
 #include <libwaei/preferences.h>
 #include <libwaei/vocabulary.h>
+#include <libwaei/scheduler.h>
 #include <libwaei/dictionary.h>
+#include <libwaei/sidecar.h>
 #include <libwaei/edictionary.h>
 #include <libwaei/kanjidictionary.h>
+#include <libwaei/radicalindex.h>
+#include <libwaei/kanjiindex.h>
+#include <libwaei/fuzzyindex.h>
 #include <libwaei/exampledictionary.h>
+#include <libwaei/exampleindex.h>
 #include <libwaei/unknowndictionary.h>
 #include <libwaei/dictionarylist.h>
 #include <libwaei/result.h>
+#include <libwaei/deinflector.h>
 #include <libwaei/query.h>
 #include <libwaei/search.h>
+#include <libwaei/searchpool.h>
+#include <libwaei/searchbatch.h>
+#include <libwaei/annotator.h>
 #include <libwaei/history.h>
 
 #ifdef WITH_MECAB
@@ -0,0 +1,36 @@
+#ifndef LW_MATCHER_INCLUDED
+#define LW_MATCHER_INCLUDED
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+//!
+//! @brief A compiled caseless pattern.  It is a PCRE2 pattern compiled with
+//!        the JIT when libwaei is built with PCRE2, and a GRegex otherwise or
+//!        when PCRE2 can't compile the pattern.
+//!
+struct _LwMatcher {
+  gpointer code;  //The pcre2_code of the pattern or NULL
+  GRegex *regex;  //The GRegex of the pattern when code is NULL
+};
+typedef struct _LwMatcher LwMatcher;
+
+#define LW_MATCHER(object) (LwMatcher*) object
+
+typedef enum {
+  LW_MATCHER_FLAG_VALID_UTF8 = (1 << 0)  //!< The text was already checked to be valid UTF-8
+} LwMatcherFlags;
+
+LwMatcher* lw_matcher_new (const gchar*, GError**);
+LwMatcher* lw_matcher_new_for_pattern (const gchar*, const gchar*, GError**);
+void lw_matcher_free (LwMatcher*);
+
+gboolean lw_matcher_match (LwMatcher*, const gchar*);
+gboolean lw_matcher_match_full (LwMatcher*, const gchar*, LwMatcherFlags);
+gboolean lw_matcher_find (LwMatcher*, const gchar*, gint, gint*, gint*);
+gboolean lw_matcher_find_full (LwMatcher*, const gchar*, gint, LwMatcherFlags, gint*, gint*);
+
+G_END_DECLS
+
+#endif
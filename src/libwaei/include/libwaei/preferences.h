@@ -69,18 +69,28 @@ G_BEGIN_DECLS
 
 #define LW_PREFMANAGER(object) (LwPreferences*) object
 
+//Decoded copies of the preferences read on every search
+struct _LwPreferencesSnapshot {
+  gboolean query_katakana_to_hiragana;
+  gboolean query_hiragana_to_katakana;
+  gint query_romaji_to_kana;
+  gboolean want_romaji_to_kana;  //query_romaji_to_kana resolved against the locale
+};
+typedef struct _LwPreferencesSnapshot LwPreferencesSnapshot;
+
 struct _LwPreferences {
   GList *settingslist;
+  GHashTable *settingstable;  //Schema names to the GSettings in settingslist
   GMutex mutex;
   GSettingsBackend *backend;
 
+  LwPreferencesSnapshot snapshot;
+  gboolean snapshot_loaded;
+  gboolean is_japanese_locale;
+  gulong snapshot_handler_id;
+
   gboolean toolbar_show; 
   gboolean statusbar_show;
-  gboolean query_katakana_to_hiragana;
-  gboolean query_hiragana_to_katakana;
-  gint query_romaji_to_kana;
-  gboolean query_spellcheck;
-  gboolean search_as_you_type;
   gchar* window_positions;
 
   gchar *dictionary_load_order;
@@ -113,6 +123,8 @@ void lw_preferences_free_settings (LwPreferences*);
 gboolean lw_preferences_schema_is_installed (const char*);
 GSettings* lw_preferences_get_settings_object (LwPreferences*, const char*);
 
+void lw_preferences_get_snapshot (LwPreferences*, LwPreferencesSnapshot*);
+
 void lw_preferences_reset_value (GSettings*, const char*);
 void lw_preferences_reset_value_by_schema (LwPreferences*, const char*, const char*);
 
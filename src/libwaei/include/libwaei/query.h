@@ -2,6 +2,7 @@
 #define LW_QUERYLINE_INCLUDED
 
 #include <libwaei/range.h>
+#include <libwaei/matcher.h>
 
 G_BEGIN_DECLS
 
@@ -17,7 +18,8 @@ typedef enum {
   LW_QUERY_FLAG_ROMAJI_TO_FURIGANA = (1 << 2),
   LW_QUERY_FLAG_HIRAGANA_TO_KATAKANA = (1 << 3),
   LW_QUERY_FLAG_KATAKANA_TO_HIRAGANA = (1 << 4),
-  LW_QUERY_FLAG_ROOT_WORD = (1 << 5)
+  LW_QUERY_FLAG_ROOT_WORD = (1 << 5),
+  LW_QUERY_FLAG_FUZZY = (1 << 7)
 } LwQueryFlags;
 
 typedef enum {
@@ -43,6 +45,9 @@ struct _LwQuery {
     LwRange **rangelist;
     gboolean parsed;
     LwQueryFlags flags;
+    GHashTable *deinflections;  //Tokens to the dictionary forms they could be conjugations of
+    struct _LwFuzzyIndex *fuzzyindex;  //Words of the dictionary to correct mistyped tokens with
+    GHashTable *corrections;    //Tokens to the words of the fuzzyindex they may have been meant to be
 #ifdef WITH_MECAB
     gchar *morphology;
 #endif
@@ -73,7 +78,7 @@ void lw_query_rangelist_set (LwQuery*, LwQueryRangeType, LwRange*);
 LwRange* lw_query_rangelist_get (LwQuery*, LwQueryRangeType);
 
 GList* lw_query_regexgroup_get (LwQuery*, LwQueryType, LwRelevance);
-void lw_query_regexgroup_append (LwQuery*, LwQueryType, LwRelevance, GRegex*);
+void lw_query_regexgroup_append (LwQuery*, LwQueryType, LwRelevance, LwMatcher*);
 
 G_END_DECLS
 
@@ -0,0 +1,45 @@
+#ifndef LW_RADICALINDEX_INCLUDED
+#define LW_RADICALINDEX_INCLUDED
+
+#include <libwaei/dictionary.h>
+#include <libwaei/sidecar.h>
+
+G_BEGIN_DECLS
+
+#define LW_RADICALINDEX_SUFFIX ".radicals"
+
+struct _LwRadicalIndex {
+  GArray *kanji;         //gunichar of each kanji in dictionary order
+  GArray *strokes;       //guint8 stroke count of each kanji or 0 if unknown
+  GArray *radicals;      //gunichar of each radical in order of appearance
+  GHashTable *positions; //Radical characters to their position in radicals plus one
+
+  guint64 *bitsets;      //For each radical, a bitset of the kanji that contain it
+  guint64 *masks;        //For each kanji, a bitset of the radicals it contains
+  gint kanji_words;      //Number of guint64s in a bitset of kanji
+  gint radical_words;    //Number of guint64s in a bitset of radicals
+
+  GArray *pairs;         //Kanji and radical positions waiting to be put into the bitsets
+  LwSidecarStamp stamp;  //The dictionary file the index was built from
+  gint refs;
+};
+typedef struct _LwRadicalIndex LwRadicalIndex;
+
+#define LW_RADICALINDEX(object) (LwRadicalIndex*) object
+
+LwRadicalIndex* lw_radicalindex_new (void);
+LwRadicalIndex* lw_radicalindex_new_for_dictionary (LwDictionary*, GError**);
+LwRadicalIndex* lw_radicalindex_peek_for_dictionary (LwDictionary*);
+LwRadicalIndex* lw_radicalindex_ref (LwRadicalIndex*);
+void lw_radicalindex_unref (LwRadicalIndex*);
+
+gboolean lw_radicalindex_build (LwRadicalIndex*, const gchar*, GCancellable*, GError**);
+gboolean lw_radicalindex_load (LwRadicalIndex*, const gchar*, GError**);
+gboolean lw_radicalindex_save (LwRadicalIndex*, const gchar*, GError**);
+gchar* lw_radicalindex_build_path (const gchar*);
+
+gchar* lw_radicalindex_strdup_possible_radicals (LwRadicalIndex*, const gchar*, gint);
+
+G_END_DECLS
+
+#endif
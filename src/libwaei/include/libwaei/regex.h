@@ -3,6 +3,7 @@
 
 #include <glib.h>
 #include <libwaei/utilities.h>
+#include <libwaei/matcher.h>
 
 G_BEGIN_DECLS
 
@@ -22,7 +23,7 @@ typedef enum {
   LW_RE_TOTAL
 } LwRegexDataIndex;
 
-extern GRegex *lw_re[LW_RE_TOTAL + 1];
+extern LwMatcher *lw_re[LW_RE_TOTAL + 1];
 
 G_END_DECLS
 
@@ -6,6 +6,18 @@
 G_BEGIN_DECLS
 
 #define LW_RESULT(object) (LwResult*) object
+#define LW_RESULTVARIANT(object) (LwResultVariant*) object
+
+//!
+//! @brief Another headword of a result that has the same definitions
+//!
+struct _LwResultVariant {
+    gchar *kanji_start;
+    gchar *furigana_start;
+    gchar *classification_start;
+    gboolean important;
+};
+typedef struct _LwResultVariant LwResultVariant;
 
 //!
 //! @brief Primitive for storing lists of dictionaries
@@ -13,6 +25,7 @@ G_BEGIN_DECLS
 
 struct _LwResult {
     gchar text[LW_IO_MAX_FGETS_LINE];     //!< Character array holding the result line for the pointers to reference
+    gboolean valid_utf8;                  //!< The text was checked to be valid UTF-8 when it was read
 
     //General result things
     LwRelevance relevance;
@@ -35,6 +48,8 @@ struct _LwResult {
 
     gboolean important; //!< Weather a word/phrase has a high frequency of usage.
 
+    GList *variants;    //!< LwResultVariants of entries grouped under this one
+
 };
 typedef struct _LwResult LwResult;
 
@@ -46,6 +61,11 @@ void lw_result_deinit (LwResult*);
 
 gboolean lw_result_is_similar (LwResult*, LwResult*);
 void lw_result_clear (LwResult*);
+void lw_result_check_utf8 (LwResult*);
+
+void lw_result_add_variant (LwResult*, LwResult*);
+void lw_result_free_variants (LwResult*);
+gchar* lw_result_get_definitions_key (LwResult*);
 
 G_END_DECLS
 
@@ -0,0 +1,51 @@
+#ifndef LW_SCHEDULER_INCLUDED
+#define LW_SCHEDULER_INCLUDED
+
+#include <libwaei/vocabulary.h>
+
+G_BEGIN_DECLS
+
+#define LW_SCHEDULER_MAX_INTERVAL 36500
+
+//Grades of an answer on the SM-2 quality scale
+typedef enum {
+  LW_SCHEDULER_GRADE_AGAIN = 1,
+  LW_SCHEDULER_GRADE_HARD = 3,
+  LW_SCHEDULER_GRADE_GOOD = 4,
+  LW_SCHEDULER_GRADE_EASY = 5
+} LwSchedulerGrade;
+
+struct _LwSchedulerCard {
+  guint32 due; //Hours since the epoch
+  guint order; //Keeps cards that are due at the same time in the order they were added
+  gpointer data;
+};
+typedef struct _LwSchedulerCard LwSchedulerCard;
+
+struct _LwScheduler {
+  GArray *cards; //Binary min-heap of LwSchedulerCards keyed by due time
+  guint added;
+};
+typedef struct _LwScheduler LwScheduler;
+
+#define LW_SCHEDULER(object) (LwScheduler*) object
+
+LwScheduler* lw_scheduler_new (void);
+void lw_scheduler_free (LwScheduler*);
+
+void lw_scheduler_add (LwScheduler*, guint32, gpointer);
+void lw_scheduler_add_many (LwScheduler*, const guint32*, gpointer*, guint);
+void lw_scheduler_add_word (LwScheduler*, LwWord*);
+void lw_scheduler_add_vocabulary (LwScheduler*, LwVocabulary*);
+
+gint lw_scheduler_length (LwScheduler*);
+gpointer lw_scheduler_peek (LwScheduler*, guint32*);
+gpointer lw_scheduler_pop (LwScheduler*, guint32*);
+GList* lw_scheduler_pop_due (LwScheduler*, guint32, gint);
+
+guint32 lw_scheduler_get_hours (void);
+void lw_scheduler_review_word (LwWord*, LwSchedulerGrade, guint32);
+
+G_END_DECLS
+
+#endif
@@ -33,12 +33,58 @@ typedef enum
   LW_SEARCH_FLAG_HIRAGANA_TO_KATAKANA = (1 << 3),
   LW_SEARCH_FLAG_KATAKANA_TO_HIRAGANA = (1 << 4),
   LW_SEARCH_FLAG_ROOT_WORD = (1 << 5),
+  LW_SEARCH_FLAG_FUZZY = (1 << 7),
   //Last 16 bits are specific to LwSearchFlags
-  LW_SEARCH_FLAG_EXACT = (1 << 6)
+  LW_SEARCH_FLAG_EXACT = (1 << 6),
+  LW_SEARCH_FLAG_WORD = (1 << 16)     //!< List the example sentences the word is used in
 } LwSearchFlags;
 
+//!
+//! @brief Where the lines a search goes through are read from
+//!
+typedef enum
+{
+  LW_SEARCH_STREAM_DICTIONARY,
+  LW_SEARCH_STREAM_SNAPSHOT,
+  LW_SEARCH_STREAM_CANDIDATES,
+  LW_SEARCH_STREAM_POSTINGS
+} LwSearchStream;
+
+//!
+//! @brief How much a search is preferred by the LwSearchPool over the others
+//!        running at the same time
+//!
+typedef enum
+{
+  LW_SEARCH_PRIORITY_INTERACTIVE,
+  LW_SEARCH_PRIORITY_TOOLTIP,
+  LW_SEARCH_PRIORITY_BACKGROUND,
+  TOTAL_LW_SEARCH_PRIORITIES
+} LwSearchPriority;
+
 typedef void(*LwSearchDataFreeFunc)(gpointer);
 
+//!
+//! @brief Where a result of a finished search was found in the dictionary file
+//!
+struct _LwSearchSnapshotEntry {
+    glong offset;                           //!< Byte offset of the line of the result
+    LwRelevance relevance;
+};
+typedef struct _LwSearchSnapshotEntry LwSearchSnapshotEntry;
+
+//!
+//! @brief The results of the last complete run of a search, so it can be
+//!        repeated by seeking straight to them instead of rescanning
+//!
+struct _LwSearchSnapshot {
+    GArray *entries;                        //!< LwSearchSnapshotEntrys in file order
+    goffset size;                           //!< Size of the dictionary file the snapshot was taken from
+    gint64 mtime;                           //!< Modification time of the dictionary file in seconds
+    gboolean complete;                      //!< FALSE while the search is running or if it was canceled
+};
+typedef struct _LwSearchSnapshot LwSearchSnapshot;
+
 //!
 //! @brief Primitive for storing search item information
 //!
@@ -48,7 +94,12 @@ struct _LwSearch {
     LwDictionary* dictionary;                 //!< Pointer to the dictionary used
 
     FILE* fd;                               //!< File descriptor for file search position
-    GThread *thread;                        //!< Thread the search is processed in
+    LwSearchStream stream;                  //!< Where the lines of the search are read from
+    guint position;                         //!< Next snapshot or candidate entry to read
+    LwSearchPriority priority;
+    gboolean queued;                        //!< Waiting in the LwSearchPool, guarded by its mutex
+    gboolean running;                       //!< Being streamed by a thread of the LwSearchPool
+    gboolean orphaned;                      //!< Freed by the LwSearchPool once its thread lets go of it
     GMutex mutex;                          //!< Mutext to help ensure threadsafe operation
 
     LwSearchStatus status;                  //!< Used to test if a search is in progress.
@@ -63,6 +114,8 @@ struct _LwSearch {
     gboolean cancel;
 
     GList *results[TOTAL_LW_RELEVANCE];
+    GHashTable *groups;                     //!< Definitions of the waiting results to the LwResult others are grouped under
+    GHashTable *seen;                       //!< Every headword and definitions found so duplicates can be dropped
 
     LwResult* result;               //!< Result line to store parsed result
 
@@ -71,6 +124,10 @@ struct _LwSearch {
     gint64 timestamp;
 
     LwSearchDataFreeFunc free_data_func;
+
+    LwSearchSnapshot snapshot;
+    LwSearchSnapshot matches;               //!< Every line that matched at low relevance, even past max, for searches refining this one
+    LwSearchSnapshot candidates;            //!< The only lines that can match, taken from the search this one refines
 };
 typedef struct _LwSearch LwSearch;
 
@@ -110,6 +167,21 @@ gint lw_search_get_total_results (LwSearch*);
 gint lw_search_get_total_relevant_results (LwSearch*);
 gint lw_search_get_total_irrelevant_results (LwSearch*);
 
+gboolean lw_search_has_snapshot (LwSearch*);
+void lw_search_clear_snapshot (LwSearch*);
+gchar* lw_search_snapshot_to_string (LwSearch*);
+gboolean lw_search_set_snapshot_from_string (LwSearch*, const gchar*);
+LwSearch* lw_search_new_from_snapshot (LwSearch*);
+
+gboolean lw_search_is_refinement_of (LwSearch*, LwSearch*);
+gboolean lw_search_set_parent (LwSearch*, LwSearch*);
+gboolean lw_search_has_candidates (LwSearch*);
+void lw_search_clear_candidates (LwSearch*);
+gchar** lw_search_get_required_literals (LwSearch*);
+
+gboolean lw_search_stream (LwSearch*, gint64);
+void lw_search_set_priority (LwSearch*, LwSearchPriority);
+
 void lw_search_set_flags (LwSearch*, LwSearchFlags);
 LwSearchFlags lw_search_get_flags (LwSearch*);
 LwSearchFlags lw_search_get_flags_from_preferences (LwPreferences*);
@@ -0,0 +1,27 @@
+#ifndef LW_SEARCHBATCH_INCLUDED
+#define LW_SEARCHBATCH_INCLUDED
+
+#include <libwaei/search.h>
+
+G_BEGIN_DECLS
+
+struct _LwSearchBatch {
+  LwDictionary *dictionary;  //The dictionary every search of the batch is for
+  GPtrArray *searches;       //LwSearches in the order they were added, which the batch doesn't own
+};
+typedef struct _LwSearchBatch LwSearchBatch;
+
+#define LW_SEARCHBATCH(object) (LwSearchBatch*) object
+
+LwSearchBatch* lw_searchbatch_new (LwDictionary*);
+void lw_searchbatch_free (LwSearchBatch*);
+
+void lw_searchbatch_add (LwSearchBatch*, LwSearch*);
+guint lw_searchbatch_length (LwSearchBatch*);
+LwSearch* lw_searchbatch_get (LwSearchBatch*, guint);
+
+void lw_searchbatch_start (LwSearchBatch*, gboolean);
+
+G_END_DECLS
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef LW_SEARCHPOOL_INCLUDED
+#define LW_SEARCHPOOL_INCLUDED
+
+#include <libwaei/search.h>
+
+G_BEGIN_DECLS
+
+#define LW_SEARCHPOOL_MAX_THREADS 2
+#define LW_SEARCHPOOL_SLICE 20000 //Microseconds a search runs before the next one gets a turn
+
+struct _LwSearchPool {
+  GMutex mutex;
+  GCond cond;                                     //Signaled when a search is queued or a thread lets go of one
+  GQueue queues[TOTAL_LW_SEARCH_PRIORITIES];      //Searches waiting for a turn, one queue for each LwSearchPriority
+  GThread *threads[LW_SEARCHPOOL_MAX_THREADS];
+  gint total_threads;
+};
+typedef struct _LwSearchPool LwSearchPool;
+
+#define LW_SEARCHPOOL(object) (LwSearchPool*) object
+
+LwSearchPool* lw_searchpool_get_default (void);
+
+gboolean lw_searchpool_push (LwSearchPool*, LwSearch*);
+void lw_searchpool_remove (LwSearchPool*, LwSearch*);
+gboolean lw_searchpool_cancel (LwSearchPool*, LwSearch*);
+gboolean lw_searchpool_orphan (LwSearchPool*, LwSearch*);
+void lw_searchpool_set_priority (LwSearchPool*, LwSearch*, LwSearchPriority);
+
+G_END_DECLS
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef LW_SIDECAR_INCLUDED
+#define LW_SIDECAR_INCLUDED
+
+#include <libwaei/dictionary.h>
+
+G_BEGIN_DECLS
+
+//The dictionary file a sidecar was built from, written as its first line
+struct _LwSidecarStamp {
+  gsize size;
+  gint64 mtime;
+};
+typedef struct _LwSidecarStamp LwSidecarStamp;
+
+typedef gpointer (*LwSidecarNewFunc) (LwDictionary*, GError**);
+typedef gboolean (*LwSidecarBuildFunc) (gpointer, const gchar*, GCancellable*, GError**);
+typedef gboolean (*LwSidecarLoadFunc) (gpointer, const gchar*, GError**);
+typedef gboolean (*LwSidecarSaveFunc) (gpointer, const gchar*, GError**);
+
+gchar* lw_sidecar_build_path (const gchar*, const gchar*);
+
+gboolean lw_sidecar_stamp_file (LwSidecarStamp*, const gchar*);
+gboolean lw_sidecar_stamp_touch (const LwSidecarStamp*, const gchar*);
+gboolean lw_sidecar_stamp_equal (const LwSidecarStamp*, const LwSidecarStamp*);
+void lw_sidecar_stamp_append (const LwSidecarStamp*, GString*);
+gboolean lw_sidecar_stamp_parse (LwSidecarStamp*, const gchar*, gchar**);
+
+gboolean lw_sidecar_load_or_build (gpointer, LwDictionary*, const gchar*, LwSidecarLoadFunc, LwSidecarBuildFunc, LwSidecarSaveFunc, GError**);
+gpointer lw_sidecar_get_for_dictionary (LwDictionary*, const gchar*, LwSidecarNewFunc, GBoxedCopyFunc, GDestroyNotify);
+gpointer lw_sidecar_peek_for_dictionary (LwDictionary*, const gchar*, LwSidecarNewFunc, GBoxedCopyFunc, GDestroyNotify);
+
+G_END_DECLS
+
+#endif
@@ -24,6 +24,12 @@ typedef enum {
   LW_COMPRESSION_TOTAL
 } LwCompression;
 
+typedef enum {
+  LW_KANA_TYPE_HIRAGANA,
+  LW_KANA_TYPE_KATAKANA,
+  TOTAL_LW_KANA_TYPES
+} LwKanaType;
+
 typedef enum {
   LW_ENCODING_UTF8,
   LW_ENCODING_EUC_JP,
@@ -37,9 +43,10 @@ const char* lw_util_get_compressionname (const LwCompression);
 const char* lw_util_get_encodingname (const LwEncoding);
 
 
-const char* lw_util_next_hira_char_from_roma (const char*);
-char* lw_util_roma_to_hira (const char*, char*);
+gboolean lw_util_str_roma_to_kana (const char*, char*, int, LwKanaType);
 gboolean lw_util_str_roma_to_hira (const char*, char*, int);
+gboolean lw_util_str_roma_to_kata (const char*, char*, int);
+gboolean lw_util_str_kana_to_roma (const char*, char*, int);
 
 gboolean lw_util_is_hiragana_str (const char*);
 gboolean lw_util_is_util_kanji_str (const char*);
@@ -74,8 +81,6 @@ gchar* lw_util_delimit_script_changes (const gchar*, const gchar*, gboolean);
 gchar* lw_util_delimit_whitespace (const gchar*, const gchar*);
 gchar* lw_util_delimit_radicals (const gchar*, const gchar*);
 
-GRegex* lw_regex_new (const gchar*, const gchar*, GError**);
-
 G_END_DECLS
 
 #endif
@@ -5,11 +5,26 @@
 
 G_BEGIN_DECLS
 
+#define LW_VOCABULARY_JOURNAL_SUFFIX ".journal"
+#define LW_VOCABULARY_SNAPSHOT_SUFFIX ".new"
+#define LW_VOCABULARY_MIN_JOURNAL_LENGTH 256
+
+typedef enum {
+  LW_VOCABULARY_RECORD_GUESSES = 'G',
+  LW_VOCABULARY_RECORD_WORD = 'W',
+  LW_VOCABULARY_RECORD_INSERT = 'I',
+  LW_VOCABULARY_RECORD_REMOVE = 'R'
+} LwVocabularyRecord;
+
 struct _LwVocabulary {
   gchar *name;
-  GList *items;
+  GPtrArray *items; //The LwWords of the list in order
+  GSList *arenas; //Memory the words loaded in bulk point into
   gboolean changed;
   gdouble progress;
+  gchar *checksum; //Checksum of the last snapshot, which the journal applies to
+  FILE *journal;
+  gint journal_length;
 };
 
 typedef struct _LwVocabulary LwVocabulary;
@@ -23,6 +38,12 @@ void lw_vocabulary_free (LwVocabulary*);
 void lw_vocabulary_save (LwVocabulary*, const gchar*, LwIoProgressCallback);
 void lw_vocabulary_load (LwVocabulary*, const gchar*, LwIoProgressCallback);
 
+gboolean lw_vocabulary_journal (LwVocabulary*, LwVocabularyRecord, gint, LwWord*, GError**);
+gboolean lw_vocabulary_journal_is_full (LwVocabulary*);
+
+gboolean lw_vocabulary_is_list_filename (const gchar*);
+gchar* lw_vocabulary_filename_to_name (const gchar*);
+
 G_END_DECLS
 
 #endif
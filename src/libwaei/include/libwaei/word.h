@@ -10,10 +10,18 @@ typedef enum {
   LW_WORD_FIELD_CORRECT_GUESSES,
   LW_WORD_FIELD_INCORRECT_GUESSES,
   LW_WORD_FIELD_TIMESTAMP,
+  LW_WORD_FIELD_EASE,
+  LW_WORD_FIELD_INTERVAL,
   TOTAL_LW_WORD_FIELDS
 } LwWordField;
 
 
+#define LW_WORD_BORROWED_FIELD(field) (1 << (field))
+#define LW_WORD_BORROWED_RECORD (1 << TOTAL_LW_WORD_FIELDS)
+
+#define LW_WORD_DEFAULT_EASE 2500
+#define LW_WORD_MIN_EASE 1300
+
 struct _LwWord {
   gchar *fields[TOTAL_LW_WORD_FIELDS];
   gchar *score;
@@ -21,6 +29,9 @@ struct _LwWord {
   gint correct_guesses;
   gint incorrect_guesses;
   gint32 timestamp;
+  gint ease; //Ease factor in thousandths, 0 until the word is first reviewed
+  gint interval; //Days between the last review and the next one
+  guint borrowed; //Flags of the memory owned by a vocabulary list instead of the word
 };
 
 typedef struct _LwWord LwWord;
@@ -29,6 +40,7 @@ typedef struct _LwWord LwWord;
 
 LwWord* lw_word_new (void);
 LwWord* lw_word_new_from_string (const gchar*);
+void lw_word_parse_in_place (LwWord*, gchar*);
 void lw_word_free (LwWord*);
 
 void lw_word_set_kanji (LwWord*, const gchar*);
@@ -56,6 +68,14 @@ void lw_word_set_hours (LwWord*, guint32);
 guint32 lw_word_get_hours (LwWord*);
 const gchar* lw_word_get_timestamp_as_string (LwWord*);
 
+gint lw_word_get_ease (LwWord*);
+void lw_word_set_ease (LwWord*, gint);
+
+gint lw_word_get_interval (LwWord*);
+void lw_word_set_interval (LwWord*, gint);
+
+guint32 lw_word_get_due_hours (LwWord*);
+
 gchar* lw_word_to_string (LwWord*);
 void lw_word_update_timestamp (LwWord*);
 gint64 lw_word_get_timestamp (LwWord*);
@@ -586,12 +586,12 @@ lw_io_split_places_from_names_dictionary (const gchar           *OUTPUT_NAMES_PA
     gboolean is_cancelled;
 
     FILE *placesf;
-    GRegex *re_place;
+    LwMatcher *re_place;
     const gchar *place_pattern = "([\\(,])((p)|(st))([\\),])";
     int  place_write_error;
 
     FILE *namesf;
-    GRegex *re_name;
+    LwMatcher *re_name;
     const gchar *name_pattern = "([\\(,])((s)|(u)|(g)|(f)|(m)|(h)|(pr)|(co))([\\),])";
     int  name_write_error;
 
@@ -601,11 +601,11 @@ lw_io_split_places_from_names_dictionary (const gchar           *OUTPUT_NAMES_PA
     end = lw_io_get_filesize (INPUT_NAMES_PLACES_PATH);
     fraction = 0.0;
 
-    re_place = g_regex_new (place_pattern,  LW_RE_COMPILE_FLAGS, LW_RE_LOCATE_FLAGS, error);
+    re_place = lw_matcher_new (place_pattern, error);
     placesf = fopen(OUTPUT_PLACES_PATH, "w");
     place_write_error = 0;
 
-    re_name = g_regex_new (name_pattern,  LW_RE_COMPILE_FLAGS, LW_RE_LOCATE_FLAGS, error);
+    re_name = lw_matcher_new (name_pattern, error);
     namesf = fopen(OUTPUT_NAMES_PATH, "w");
     name_write_error  = 0;
 
@@ -622,9 +622,9 @@ lw_io_split_places_from_names_dictionary (const gchar           *OUTPUT_NAMES_PA
       fraction = ((double) curpos) / ((double) end);
       if (cb != NULL) cb (fraction, data);
 
-      if (placesf != NULL && g_regex_match (re_place, buffer, 0, NULL))
+      if (placesf != NULL && lw_matcher_match (re_place, buffer))
         place_write_error = fputs(buffer, placesf);
-      if (namesf != NULL && g_regex_match(re_name, buffer, 0, NULL))
+      if (namesf != NULL && lw_matcher_match (re_name, buffer))
         name_write_error =  fputs(buffer, namesf);
       curpos += strlen(buffer);
     }
@@ -635,8 +635,8 @@ lw_io_split_places_from_names_dictionary (const gchar           *OUTPUT_NAMES_PA
     fclose(inputf);
     fclose(placesf);
     fclose(namesf);
-    g_regex_unref (re_place);
-    g_regex_unref (re_name);
+    lw_matcher_free (re_place);
+    lw_matcher_free (re_name);
 
     return (place_write_error != EOF && name_write_error != EOF);
 }
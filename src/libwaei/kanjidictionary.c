@@ -173,10 +173,10 @@ static gint
 lw_kanjidictionary_parse_result (LwDictionary *dictionary, LwResult *result, FILE *fd)
 {
     //Declarations
-    GMatchInfo* match_info;
     gint start[LW_RE_TOTAL];
     gint end[LW_RE_TOTAL];
     GUnicodeScript script;
+    LwMatcherFlags flags;
     gchar *ptr = result->text;
     gint bytes_read = 0;
 
@@ -189,51 +189,41 @@ lw_kanjidictionary_parse_result (LwDictionary *dictionary, LwResult *result, FIL
     } while (ptr != NULL && *ptr == '#');
 
     if (ptr == NULL) return bytes_read;
-    bytes_read += strlen(result->text);
 
 
+    //The line is checked for UTF-8 once instead of by each of the matches
+    flags = (g_utf8_validate (ptr, -1, NULL)) ? LW_MATCHER_FLAG_VALID_UTF8 : 0;
+
     //First generate the grade, stroke, frequency, and jlpt fields
 
     //Get strokes
     result->strokes = NULL;
-    g_regex_match (lw_re[LW_RE_STROKES], ptr, 0, &match_info);
-    if (g_match_info_matches (match_info))
+    if (lw_matcher_find_full (lw_re[LW_RE_STROKES], ptr, 0, flags, &start[LW_RE_STROKES], &end[LW_RE_STROKES]))
     {
-      g_match_info_fetch_pos (match_info, 0, &start[LW_RE_STROKES], &end[LW_RE_STROKES]);
       result->strokes = ptr + start[LW_RE_STROKES] + 1;
     }
-    g_match_info_free (match_info);
 
     //Get frequency
     result->frequency = NULL;
-    g_regex_match (lw_re[LW_RE_FREQUENCY], ptr, 0, &match_info);
-    if (g_match_info_matches (match_info))
+    if (lw_matcher_find_full (lw_re[LW_RE_FREQUENCY], ptr, 0, flags, &start[LW_RE_FREQUENCY], &end[LW_RE_FREQUENCY]))
     {
-      g_match_info_fetch_pos (match_info, 0, &start[LW_RE_FREQUENCY], &end[LW_RE_FREQUENCY]);
       result->frequency = ptr + start[LW_RE_FREQUENCY] + 1;
     }
-    g_match_info_free (match_info);
 
 
     //Get grade level
     result->grade = NULL;
-    g_regex_match (lw_re[LW_RE_GRADE], ptr, 0, &match_info);
-    if (g_match_info_matches (match_info))
+    if (lw_matcher_find_full (lw_re[LW_RE_GRADE], ptr, 0, flags, &start[LW_RE_GRADE], &end[LW_RE_GRADE]))
     {
-      g_match_info_fetch_pos (match_info, 0, &start[LW_RE_GRADE], &end[LW_RE_GRADE]);
       result->grade = ptr + start[LW_RE_GRADE] + 1;
     }
-    g_match_info_free (match_info);
 
     //Get JLPT level
     result->jlpt = NULL;
-    g_regex_match (lw_re[LW_RE_JLPT], ptr, 0, &match_info);
-    if (g_match_info_matches (match_info))
+    if (lw_matcher_find_full (lw_re[LW_RE_JLPT], ptr, 0, flags, &start[LW_RE_JLPT], &end[LW_RE_JLPT]))
     {
-      g_match_info_fetch_pos (match_info, 0, &start[LW_RE_JLPT], &end[LW_RE_JLPT]);
       result->jlpt = ptr + start[LW_RE_JLPT] + 1;
     }
-    g_match_info_free (match_info);
 
 
     //Get the kanji character
@@ -319,14 +309,16 @@ static gboolean
 lw_kanjidictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult *result, const LwRelevance RELEVANCE)
 {
     //Declarations
+    LwMatcherFlags flags;
     GList *link;
     gboolean found;
     gboolean checked;
     LwRange *range;
-    GRegex *regex;
+    LwMatcher *matcher;
     gint i;
 
     //Initializations
+    flags = (result->valid_utf8) ? LW_MATCHER_FLAG_VALID_UTF8 : 0;
     found = FALSE;
     checked = FALSE;
 
@@ -370,11 +362,11 @@ lw_kanjidictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult *
     link = lw_query_regexgroup_get (query, LW_QUERY_TYPE_ROMAJI, RELEVANCE);
     while (link != NULL)
     {
-      regex = link->data;
-      if (regex == NULL && result->meanings == NULL) return FALSE;
+      matcher = link->data;
+      if (matcher == NULL && result->meanings == NULL) return FALSE;
 
       checked = TRUE;
-      found = g_regex_match (regex, result->meanings, 0, NULL);
+      found = lw_matcher_match_full (matcher, result->meanings, flags);
       if (found == FALSE) return found;
 
       link = link->next;
@@ -384,13 +376,13 @@ lw_kanjidictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult *
     link = lw_query_regexgroup_get (query, LW_QUERY_TYPE_FURIGANA, RELEVANCE);
     while (link != NULL)
     {
-      regex = link->data;
-      if (regex == NULL) return FALSE;
+      matcher = link->data;
+      if (matcher == NULL) return FALSE;
       checked = TRUE;
 
       for (i = 0; i < 3 && result->readings[i] != NULL; i++)
       {
-        found = g_regex_match (regex, result->readings[i], 0, NULL);
+        found = lw_matcher_match_full (matcher, result->readings[i], flags);
         if (found == TRUE) break;
       }
 
@@ -402,12 +394,12 @@ lw_kanjidictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult *
     link = lw_query_regexgroup_get (query, LW_QUERY_TYPE_KANJI, RELEVANCE);
     while (link != NULL)
     {
-      regex = link->data;
-      if (regex == NULL || result->kanji == NULL) return FALSE;
+      matcher = link->data;
+      if (matcher == NULL || result->kanji == NULL) return FALSE;
       checked = TRUE;
 
-      found = g_regex_match (regex, result->kanji, 0, NULL);
-      if (found == FALSE) found = g_regex_match (regex, result->radicals, 0, NULL);
+      found = lw_matcher_match_full (matcher, result->kanji, flags);
+      if (found == FALSE) found = lw_matcher_match_full (matcher, result->radicals, flags);
       if (found == FALSE) return FALSE;
 
       link = link->next;
@@ -431,7 +423,33 @@ lw_kanjidictionary_installer_postprocess (LwDictionary *dictionary,
     g_return_val_if_fail (g_strv_length (sourcelist) > 1, FALSE);
     g_return_val_if_fail (g_strv_length (targetlist) > 0, FALSE);
 
-    return lw_io_create_mix_dictionary (targetlist[0], sourcelist[0], sourcelist[1], cb, data, cancellable, error);
+    //Declarations
+    LwRadicalIndex *index;
+    LwKanjiIndex *numbers;
+    gchar *path;
+
+    if (!lw_io_create_mix_dictionary (targetlist[0], sourcelist[0], sourcelist[1], cb, data, cancellable, error))
+      return FALSE;
+
+    //Index the radicals now so the radicals window doesn't have to search for them
+    index = lw_radicalindex_new ();
+    path = lw_radicalindex_build_path (lw_dictionary_get_filename (dictionary));
+    if (path != NULL && lw_radicalindex_build (index, targetlist[0], cancellable, NULL))
+      lw_radicalindex_save (index, path, NULL);
+
+    if (path != NULL) g_free (path); path = NULL;
+    lw_radicalindex_unref (index); index = NULL;
+
+    //Index the stroke counts, grades, JLPT levels and frequencies for range searches
+    numbers = lw_kanjiindex_new ();
+    path = lw_kanjiindex_build_path (lw_dictionary_get_filename (dictionary));
+    if (path != NULL && lw_kanjiindex_build (numbers, targetlist[0], cancellable, NULL))
+      lw_kanjiindex_save (numbers, path, NULL);
+
+    if (path != NULL) g_free (path); path = NULL;
+    lw_kanjiindex_unref (numbers); numbers = NULL;
+
+    return TRUE;
 }
 
 
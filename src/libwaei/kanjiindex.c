@@ -0,0 +1,465 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file kanjiindex.c
+//!
+//! @brief The stroke count, grade, JLPT level and frequency of every kanji
+//!        of the Kanji dictionary, kept as one array of numbers per field.
+//!        Queries like "S5-7 G2" are narrowed down by comparing the arrays
+//!        instead of reading every line of the dictionary.  The index is
+//!        written when the dictionary is installed.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <glib.h>
+
+#include <libwaei/libwaei.h>
+
+
+//The patterns lw_kanjidictionary_parse_result finds each field with
+static const LwRegexDataIndex _patterns[TOTAL_LW_QUERY_RANGE_TYPES] = {
+  LW_RE_STROKES,   //LW_QUERY_RANGE_TYPE_STROKES
+  LW_RE_GRADE,     //LW_QUERY_RANGE_TYPE_GRADE
+  LW_RE_JLPT,      //LW_QUERY_RANGE_TYPE_JLPT
+  LW_RE_FREQUENCY  //LW_QUERY_RANGE_TYPE_FREQUENCY
+};
+
+
+//!
+//! @brief Creates a new empty LwKanjiIndex
+//! @returns An allocated LwKanjiIndex that should be freed with lw_kanjiindex_unref
+//!
+LwKanjiIndex*
+lw_kanjiindex_new ()
+{
+    //Declarations
+    LwKanjiIndex *index;
+    gint i;
+
+    //Initializations
+    index = g_new0 (LwKanjiIndex, 1);
+    index->offsets = g_array_new (FALSE, FALSE, sizeof(glong));
+    for (i = 0; i < TOTAL_LW_QUERY_RANGE_TYPES; i++)
+      index->columns[i] = g_array_new (FALSE, FALSE, sizeof(guint16));
+    index->refs = 1;
+
+    return index;
+}
+
+
+static void
+lw_kanjiindex_clear (LwKanjiIndex *index)
+{
+    //Declarations
+    gint i;
+
+    g_array_set_size (index->offsets, 0);
+    for (i = 0; i < TOTAL_LW_QUERY_RANGE_TYPES; i++)
+      g_array_set_size (index->columns[i], 0);
+    memset (&index->stamp, 0, sizeof(LwSidecarStamp));
+}
+
+
+LwKanjiIndex*
+lw_kanjiindex_ref (LwKanjiIndex *index)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, NULL);
+
+    g_atomic_int_inc (&index->refs);
+
+    return index;
+}
+
+
+//!
+//! @brief Releases a reference to an LwKanjiIndex, freeing it with the last one
+//! @param index The LwKanjiIndex to unref
+//!
+void
+lw_kanjiindex_unref (LwKanjiIndex *index)
+{
+    //Sanity checks
+    if (index == NULL) return;
+
+    //Declarations
+    gint i;
+
+    if (!g_atomic_int_dec_and_test (&index->refs)) return;
+
+    g_array_free (index->offsets, TRUE); index->offsets = NULL;
+    for (i = 0; i < TOTAL_LW_QUERY_RANGE_TYPES; i++)
+    {
+      g_array_free (index->columns[i], TRUE); index->columns[i] = NULL;
+    }
+
+    g_free (index);
+}
+
+
+//!
+//! @brief Gets the number index of an installed Kanji dictionary.  The index
+//!        written at install time is used when it still matches the dictionary,
+//!        otherwise it is rebuilt from the dictionary and saved again.
+//! @param dictionary The installed LwDictionary
+//! @param error A GError to place errors into or NULL
+//! @returns An allocated LwKanjiIndex or NULL on error
+//!
+LwKanjiIndex*
+lw_kanjiindex_new_for_dictionary (LwDictionary *dictionary, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+    if (error != NULL && *error != NULL) return NULL;
+
+    //Declarations
+    LwKanjiIndex *index;
+
+    //Initializations
+    index = lw_kanjiindex_new ();
+
+    if (!lw_sidecar_load_or_build (index, dictionary, LW_KANJIINDEX_SUFFIX, (LwSidecarLoadFunc) lw_kanjiindex_load, (LwSidecarBuildFunc) lw_kanjiindex_build, (LwSidecarSaveFunc) lw_kanjiindex_save, error))
+    {
+      lw_kanjiindex_unref (index); index = NULL;
+    }
+
+    return index;
+}
+
+
+//!
+//! @brief Gets the index shared by every search of a dictionary without
+//!        waiting for it.  It is loaded in another thread the first time and
+//!        again when the dictionary was reinstalled, and NULL is returned
+//!        until it is ready.
+//! @param dictionary A Kanji LwDictionary
+//! @returns A reference to the LwKanjiIndex to be released with
+//!          lw_kanjiindex_unref or NULL if it isn't loaded yet
+//!
+LwKanjiIndex*
+lw_kanjiindex_peek_for_dictionary (LwDictionary *dictionary)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+    if (!LW_IS_KANJIDICTIONARY (dictionary)) return NULL;
+
+    return LW_KANJIINDEX (lw_sidecar_peek_for_dictionary (dictionary, LW_KANJIINDEX_SUFFIX, (LwSidecarNewFunc) lw_kanjiindex_new_for_dictionary, (GBoxedCopyFunc) lw_kanjiindex_ref, (GDestroyNotify) lw_kanjiindex_unref));
+}
+
+
+//!
+//! @brief Builds the path of the index of a dictionary in the cache folder
+//! @param FILENAME The filename of the dictionary
+//! @returns An allocated path that should be freed with g_free
+//!
+gchar*
+lw_kanjiindex_build_path (const gchar *FILENAME)
+{
+    return lw_sidecar_build_path (FILENAME, LW_KANJIINDEX_SUFFIX);
+}
+
+
+//!
+//! @brief Adds the numbers of a kanji.  They are found with the same
+//!        patterns as when the line is parsed so a kanji is kept by the
+//!        index whenever it could be matched.
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static void
+lw_kanjiindex_parse_line (LwKanjiIndex *index, const gchar *LINE, glong offset)
+{
+    //Declarations
+    LwMatcherFlags flags;
+    guint16 number;
+    gint start;
+    gint end;
+    gint type;
+    gint i;
+
+    //Initializations
+    flags = (g_utf8_validate (LINE, -1, NULL)) ? LW_MATCHER_FLAG_VALID_UTF8 : 0;
+
+    g_array_append_val (index->offsets, offset);
+
+    for (type = 0; type < TOTAL_LW_QUERY_RANGE_TYPES; type++)
+    {
+      number = LW_KANJIINDEX_UNKNOWN;
+      if (lw_matcher_find_full (lw_re[_patterns[type]], LINE, 0, flags, &start, &end))
+      {
+        //The letter in front of the number isn't part of it
+        number = 0;
+        for (i = start + 1; i < end; i++) number = number * 10 + (LINE[i] - '0');
+      }
+      g_array_append_val (index->columns[type], number);
+    }
+}
+
+
+//!
+//! @brief Indexes the numbers of every kanji of a dictionary file
+//! @param index The LwKanjiIndex to fill
+//! @param PATH The path of a Kanji dictionary file
+//! @param cancellable A GCancellable to stop the indexing or NULL
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE on success
+//!
+gboolean
+lw_kanjiindex_build (LwKanjiIndex *index, const gchar *PATH, GCancellable *cancellable, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, FALSE);
+    g_return_val_if_fail (PATH != NULL, FALSE);
+    g_return_val_if_fail (lw_re[LW_RE_STROKES] != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    FILE *file;
+    gchar line[LW_IO_MAX_FGETS_LINE];
+    glong offset;
+    GQuark quark;
+
+    //Initializations
+    file = fopen (PATH, "r");
+    lw_kanjiindex_clear (index);
+    offset = 0;
+
+    if (file == NULL)
+    {
+      quark = g_quark_from_string (LW_IO_ERROR);
+      g_set_error (error, quark, LW_IO_READ_ERROR, "Could not open %s to index its kanji", PATH);
+      return FALSE;
+    }
+
+    while (fgets (line, LW_IO_MAX_FGETS_LINE, file) != NULL)
+    {
+      if (cancellable != NULL && g_cancellable_is_cancelled (cancellable)) break;
+      if (line[0] != '#') lw_kanjiindex_parse_line (index, line, offset);
+      offset += strlen (line);
+    }
+
+    fclose (file); file = NULL;
+
+    lw_sidecar_stamp_file (&index->stamp, PATH);
+
+    return (cancellable == NULL || !g_cancellable_is_cancelled (cancellable));
+}
+
+
+//!
+//! @brief Writes the index so it doesn't have to be rebuilt from the dictionary.
+//!        The first line is the LwSidecarStamp of the dictionary and each
+//!        following line is the offset of a kanji and its numbers separated by
+//!        tabs, with -1 for the numbers it doesn't have.
+//! @param index The LwKanjiIndex to save
+//! @param PATH The file to write to
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE on success
+//!
+gboolean
+lw_kanjiindex_save (LwKanjiIndex *index, const gchar *PATH, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, FALSE);
+    g_return_val_if_fail (PATH != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    GString *text;
+    guint16 number;
+    gboolean success;
+    guint i;
+    gint type;
+
+    //Initializations
+    text = g_string_new (NULL);
+
+    lw_sidecar_stamp_append (&index->stamp, text);
+
+    for (i = 0; i < index->offsets->len; i++)
+    {
+      g_string_append_printf (text, "%ld", g_array_index (index->offsets, glong, i));
+      for (type = 0; type < TOTAL_LW_QUERY_RANGE_TYPES; type++)
+      {
+        number = g_array_index (index->columns[type], guint16, i);
+        g_string_append_printf (text, "\t%d", (number == LW_KANJIINDEX_UNKNOWN) ? -1 : (gint) number);
+      }
+      g_string_append_c (text, '\n');
+    }
+
+    success = g_file_set_contents (PATH, text->str, text->len, error);
+
+    g_string_free (text, TRUE); text = NULL;
+
+    return success;
+}
+
+
+//!
+//! @brief Reads an index written by lw_kanjiindex_save
+//! @param index The LwKanjiIndex to fill
+//! @param PATH The file to read
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE on success
+//!
+gboolean
+lw_kanjiindex_load (LwKanjiIndex *index, const gchar *PATH, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, FALSE);
+    g_return_val_if_fail (PATH != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    gchar *contents;
+    gchar *line;
+    gchar *end;
+    glong offset;
+    guint16 number;
+    gint value;
+    LwSidecarStamp stamp;
+    gint type;
+
+    //Initializations
+    contents = NULL;
+    lw_kanjiindex_clear (index);
+
+    if (!g_file_get_contents (PATH, &contents, NULL, error)) return FALSE;
+
+    if (!lw_sidecar_stamp_parse (&stamp, contents, &end)) goto errored;
+    line = (*end == '\n') ? end : NULL;
+
+    while (line != NULL && *(++line) != '\0')
+    {
+      offset = strtol (line, &end, 10);
+      if (end == line) goto errored;
+      g_array_append_val (index->offsets, offset);
+
+      for (type = 0; type < TOTAL_LW_QUERY_RANGE_TYPES; type++)
+      {
+        if (*end != '\t') goto errored;
+        line = end + 1;
+        value = (gint) strtol (line, &end, 10);
+        if (end == line) goto errored;
+        number = (value < 0 || value >= LW_KANJIINDEX_UNKNOWN) ? LW_KANJIINDEX_UNKNOWN : (guint16) value;
+        g_array_append_val (index->columns[type], number);
+      }
+
+      line = strchr (end, '\n');
+    }
+
+    index->stamp = stamp;
+
+    g_free (contents); contents = NULL;
+
+    return TRUE;
+
+errored:
+    lw_kanjiindex_clear (index);
+    g_free (contents); contents = NULL;
+
+    return FALSE;
+}
+
+
+gint
+lw_kanjiindex_length (LwKanjiIndex *index)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, 0);
+
+    return index->offsets->len;
+}
+
+
+//!
+//! @brief Finds the kanji the ranges of a query could match.  A kanji is
+//!        ruled out when one of its numbers is out of its range, and kept
+//!        when it doesn't have the number, since the dictionary only checks
+//!        the numbers a kanji has.  Each range is a pass over the array of
+//!        its field, which the compiler can vectorize.
+//! @param index The LwKanjiIndex to look through
+//! @param query An LwQuery parsed by a Kanji dictionary
+//! @returns An allocated GArray of the glong offsets of the kanji in
+//!          dictionary order, or NULL if the query has no ranges
+//!
+GArray*
+lw_kanjiindex_filter (LwKanjiIndex *index, LwQuery *query)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, NULL);
+    g_return_val_if_fail (query != NULL, NULL);
+    if (query->rangelist == NULL) return NULL;
+
+    //Declarations
+    GArray *offsets;
+    LwRange *range;
+    const guint16 *column;
+    guint8 *keep;
+    guint16 lower;
+    guint16 higher;
+    gboolean filtered;
+    guint length;
+    guint i;
+    gint type;
+
+    //Initializations
+    length = index->offsets->len;
+    keep = g_malloc (length + 1);
+    memset (keep, 1, length + 1);
+    filtered = FALSE;
+
+    for (type = 0; type < TOTAL_LW_QUERY_RANGE_TYPES; type++)
+    {
+      range = query->rangelist[type];
+      if (range == NULL) continue;
+      if (index->columns[type]->len != length) continue;
+
+      filtered = TRUE;
+      column = (const guint16*) index->columns[type]->data;
+      lower = CLAMP (range->lower, 0, LW_KANJIINDEX_UNKNOWN - 1);
+      higher = CLAMP (range->higher, 0, LW_KANJIINDEX_UNKNOWN - 1);
+
+      for (i = 0; i < length; i++)
+        keep[i] &= (column[i] == LW_KANJIINDEX_UNKNOWN) | (column[i] >= lower && column[i] <= higher);
+    }
+
+    offsets = NULL;
+    if (filtered)
+    {
+      offsets = g_array_new (FALSE, FALSE, sizeof(glong));
+      for (i = 0; i < length; i++)
+      {
+        if (keep[i]) g_array_append_val (offsets, g_array_index (index->offsets, glong, i));
+      }
+    }
+
+    g_free (keep); keep = NULL;
+
+    return offsets;
+}
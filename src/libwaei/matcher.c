@@ -0,0 +1,304 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file matcher.c
+//!
+//! @brief The patterns the dictionaries compare results with.  With PCRE2
+//!        the patterns are compiled to machine code by its JIT, and each
+//!        thread reuses one match data block instead of allocating a
+//!        GMatchInfo for every match.  GRegex is used otherwise, with the
+//!        same caseless, Unicode aware matching.  PCRE2 checks that the
+//!        whole text is valid UTF-8 on every match, so callers matching the
+//!        same text many times check it once and pass
+//!        LW_MATCHER_FLAG_VALID_UTF8 to the _full functions.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+
+#include <glib.h>
+
+#ifdef WITH_PCRE2
+#define PCRE2_CODE_UNIT_WIDTH 8
+#include <pcre2.h>
+#endif
+
+#include <libwaei/libwaei.h>
+
+
+#ifdef WITH_PCRE2
+static GPrivate _match_data = G_PRIVATE_INIT ((GDestroyNotify) pcre2_match_data_free);
+
+
+//!
+//! @brief Gets the match data of the calling thread, which only holds the
+//!        position of the whole match
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static pcre2_match_data*
+lw_matcher_get_match_data ()
+{
+    //Declarations
+    pcre2_match_data *match_data;
+
+    //Initializations
+    match_data = g_private_get (&_match_data);
+
+    if (match_data == NULL)
+    {
+      match_data = pcre2_match_data_create (1, NULL);
+      g_private_set (&_match_data, match_data);
+    }
+
+    return match_data;
+}
+
+
+//!
+//! @brief Compiles a pattern with PCRE2 using the options GRegex would have.
+//!        The JIT failing, like on an unsupported CPU, leaves the pattern to
+//!        the PCRE2 interpreter.
+//! @returns The pcre2_code or NULL if PCRE2 can't compile the pattern
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static pcre2_code*
+lw_matcher_compile (const gchar *EXPRESSION)
+{
+    //Declarations
+    pcre2_code *code;
+    PCRE2_SIZE erroroffset;
+    int errorcode;
+
+    //Initializations
+    code = pcre2_compile ((PCRE2_SPTR) EXPRESSION, PCRE2_ZERO_TERMINATED, PCRE2_CASELESS | PCRE2_UTF | PCRE2_UCP, &errorcode, &erroroffset, NULL);
+
+    if (code != NULL) pcre2_jit_compile (code, PCRE2_JIT_COMPLETE);
+
+    return code;
+}
+
+
+//!
+//! @brief Converts LwMatcherFlags to the options of pcre2_match
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static uint32_t
+lw_matcher_get_match_options (LwMatcherFlags flags)
+{
+    return ((flags & LW_MATCHER_FLAG_VALID_UTF8) ? PCRE2_NO_UTF_CHECK : 0);
+}
+#endif
+
+
+//!
+//! @brief Compiles a caseless pattern
+//! @param EXPRESSION A Perl compatible regular expression
+//! @param error A GError to place errors into or NULL
+//! @returns An allocated LwMatcher that should be freed with lw_matcher_free or NULL on error
+//!
+LwMatcher*
+lw_matcher_new (const gchar *EXPRESSION, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (EXPRESSION != NULL, NULL);
+    if (error != NULL && *error != NULL) return NULL;
+
+    //Declarations
+    LwMatcher *matcher;
+
+    //Initializations
+    matcher = g_new0 (LwMatcher, 1);
+
+#ifdef WITH_PCRE2
+    matcher->code = lw_matcher_compile (EXPRESSION);
+    if (matcher->code != NULL) return matcher;
+#endif
+
+    //GRegex also gives the error when the pattern is invalid
+    matcher->regex = g_regex_new (EXPRESSION, LW_RE_COMPILE_FLAGS, LW_RE_EXIST_FLAGS, error);
+    if (matcher->regex == NULL)
+    {
+      lw_matcher_free (matcher); matcher = NULL;
+    }
+
+    return matcher;
+}
+
+
+//!
+//! @brief Compiles one of the patterns of a dictionary class for a query token
+//! @param PATTERN A printf format with a %s for the token, like "(%s)"
+//! @param TOKEN The token of the query
+//! @param error A GError to place errors into or NULL
+//! @returns An allocated LwMatcher that should be freed with lw_matcher_free or NULL on error
+//!
+LwMatcher*
+lw_matcher_new_for_pattern (const gchar *PATTERN, const gchar *TOKEN, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (PATTERN != NULL, NULL);
+    g_return_val_if_fail (TOKEN != NULL, NULL);
+
+    //Declarations
+    LwMatcher *matcher;
+    gchar *expression;
+
+    //Initializations
+    expression = g_strdup_printf (PATTERN, TOKEN);
+    matcher = NULL;
+
+    if (expression != NULL)
+    {
+      matcher = lw_matcher_new (expression, error);
+      g_free (expression); expression = NULL;
+    }
+
+    return matcher;
+}
+
+
+void
+lw_matcher_free (LwMatcher *matcher)
+{
+    //Sanity checks
+    if (matcher == NULL) return;
+
+#ifdef WITH_PCRE2
+    if (matcher->code != NULL) pcre2_code_free (matcher->code); matcher->code = NULL;
+#endif
+    if (matcher->regex != NULL) g_regex_unref (matcher->regex); matcher->regex = NULL;
+
+    g_free (matcher);
+}
+
+
+//!
+//! @brief Checks if the pattern matches anywhere in a text
+//! @param matcher The LwMatcher to use
+//! @param TEXT A UTF-8 string
+//! @returns TRUE if there is a match
+//!
+gboolean
+lw_matcher_match (LwMatcher *matcher, const gchar *TEXT)
+{
+    return lw_matcher_match_full (matcher, TEXT, 0);
+}
+
+
+//!
+//! @brief Checks if the pattern matches anywhere in a text
+//! @param matcher The LwMatcher to use
+//! @param TEXT A UTF-8 string
+//! @param flags LW_MATCHER_FLAG_VALID_UTF8 when TEXT is known to be valid
+//!              UTF-8.  Invalid UTF-8 passed with it is undefined behavior.
+//! @returns TRUE if there is a match
+//!
+gboolean
+lw_matcher_match_full (LwMatcher *matcher, const gchar *TEXT, LwMatcherFlags flags)
+{
+    //Sanity checks
+    g_return_val_if_fail (matcher != NULL, FALSE);
+    g_return_val_if_fail (TEXT != NULL, FALSE);
+
+#ifdef WITH_PCRE2
+    if (matcher->code != NULL)
+      return (pcre2_match (matcher->code, (PCRE2_SPTR) TEXT, PCRE2_ZERO_TERMINATED, 0, lw_matcher_get_match_options (flags), lw_matcher_get_match_data (), NULL) >= 0);
+#endif
+
+    return g_regex_match (matcher->regex, TEXT, 0, NULL);
+}
+
+
+//!
+//! @brief Finds the next match of the pattern in a text.  The text before
+//!        the offset is still looked at by lookbehinds and \\b.
+//! @param matcher The LwMatcher to use
+//! @param TEXT A UTF-8 string
+//! @param offset The byte offset to start looking from
+//! @param start Set to the byte offset of the start of the match
+//! @param end Set to the byte offset after the end of the match
+//! @returns TRUE if a match was found
+//!
+gboolean
+lw_matcher_find (LwMatcher *matcher, const gchar *TEXT, gint offset, gint *start, gint *end)
+{
+    return lw_matcher_find_full (matcher, TEXT, offset, 0, start, end);
+}
+
+
+//!
+//! @brief Finds the next match of the pattern in a text, like lw_matcher_find
+//! @param matcher The LwMatcher to use
+//! @param TEXT A UTF-8 string
+//! @param offset The byte offset to start looking from
+//! @param flags LW_MATCHER_FLAG_VALID_UTF8 when TEXT is known to be valid
+//!              UTF-8.  Invalid UTF-8 passed with it is undefined behavior.
+//! @param start Set to the byte offset of the start of the match
+//! @param end Set to the byte offset after the end of the match
+//! @returns TRUE if a match was found
+//!
+gboolean
+lw_matcher_find_full (LwMatcher *matcher, const gchar *TEXT, gint offset, LwMatcherFlags flags, gint *start, gint *end)
+{
+    //Sanity checks
+    g_return_val_if_fail (matcher != NULL, FALSE);
+    g_return_val_if_fail (TEXT != NULL, FALSE);
+    g_return_val_if_fail (start != NULL && end != NULL, FALSE);
+
+    //Declarations
+    GMatchInfo *match_info;
+    gboolean found;
+
+#ifdef WITH_PCRE2
+    if (matcher->code != NULL)
+    {
+      pcre2_match_data *match_data;
+      PCRE2_SIZE *ovector;
+
+      match_data = lw_matcher_get_match_data ();
+      if (pcre2_match (matcher->code, (PCRE2_SPTR) TEXT, PCRE2_ZERO_TERMINATED, offset, lw_matcher_get_match_options (flags), match_data, NULL) < 0) return FALSE;
+
+      ovector = pcre2_get_ovector_pointer (match_data);
+      *start = ovector[0];
+      *end = ovector[1];
+
+      return TRUE;
+    }
+#endif
+
+    //Initializations
+    match_info = NULL;
+
+    found = g_regex_match_full (matcher->regex, TEXT, -1, offset, 0, &match_info, NULL);
+    if (found) g_match_info_fetch_pos (match_info, 0, start, end);
+
+    g_match_info_free (match_info); match_info = NULL;
+
+    return found;
+}
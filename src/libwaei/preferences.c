@@ -79,8 +79,14 @@ void
 lw_preferences_init (LwPreferences *preferences, GSettingsBackend *backend)
 {
     preferences->settingslist = NULL;
+    preferences->settingstable = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
     preferences->backend = backend;
     g_mutex_init (&preferences->mutex);
+
+    memset(&preferences->snapshot, 0, sizeof(LwPreferencesSnapshot));
+    preferences->snapshot_loaded = FALSE;
+    preferences->is_japanese_locale = FALSE;
+    preferences->snapshot_handler_id = 0;
 }
 
 
@@ -94,6 +100,7 @@ void
 lw_preferences_deinit (LwPreferences *preferences)
 {
     lw_preferences_free_settings (preferences);
+    if (preferences->settingstable != NULL) g_hash_table_unref (preferences->settingstable); preferences->settingstable = NULL;
     g_mutex_clear (&preferences->mutex); 
     if (preferences->backend != NULL) g_object_unref (preferences->backend); preferences->backend = NULL;
 }
@@ -109,6 +116,15 @@ lw_preferences_free_settings (LwPreferences *preferences)
     GList *iter;
     GSettings *settings;
 
+    if (preferences->snapshot_handler_id != 0)
+    {
+      settings = g_hash_table_lookup (preferences->settingstable, LW_SCHEMA_BASE);
+      if (settings != NULL) lw_preferences_remove_change_listener (settings, preferences->snapshot_handler_id);
+      preferences->snapshot_handler_id = 0;
+    }
+    preferences->snapshot_loaded = FALSE;
+    if (preferences->settingstable != NULL) g_hash_table_remove_all (preferences->settingstable);
+
     for (iter = preferences->settingslist; iter != NULL; iter = iter->next)
     {
       settings = (GSettings*) iter->data;
@@ -162,31 +178,10 @@ GSettings*
 lw_preferences_get_settings_object (LwPreferences *preferences, const char *SCHEMA)
 {
     //Declarations
-    GList *iter;
-    char *schema;
     GSettings *settings;
 
-    //Initializations
-    settings = NULL;
-
     //Look for an already created gsetting object
-    for (iter = preferences->settingslist; iter != NULL; iter = iter->next)
-    {
-      settings = (GSettings*) iter->data;
-      g_object_get (G_OBJECT (settings), "schema", &schema, NULL);
-      if (schema != NULL && strcmp(schema, SCHEMA) == 0)
-        break;
-      if (schema != NULL)
-        g_free (schema);
-      settings = NULL;
-    }
-    if (settings != NULL) 
-    {
-      g_free (schema);
-    }
-    else
-    {
-    }
+    settings = (GSettings*) g_hash_table_lookup (preferences->settingstable, SCHEMA);
 
     //If not found, create our own and add it to the list
     if (settings == NULL)
@@ -200,6 +195,7 @@ lw_preferences_get_settings_object (LwPreferences *preferences, const char *SCHE
       if (settings != NULL)
       {
         preferences->settingslist = g_list_append (preferences->settingslist, settings);
+        g_hash_table_insert (preferences->settingstable, g_strdup (SCHEMA), settings);
       }
     }
 
@@ -207,6 +203,92 @@ lw_preferences_get_settings_object (LwPreferences *preferences, const char *SCHE
 }
 
 
+//!
+//! @brief Decodes a key of the base schema into the snapshot.  The caller
+//!        should hold the mutex of the LwPreferences.
+//!
+static void
+lw_preferences_snapshot_update (LwPreferences *preferences, GSettings *settings, const gchar *KEY)
+{
+    //Declarations
+    LwPreferencesSnapshot *snapshot;
+    gboolean all;
+
+    //Initializations
+    snapshot = &preferences->snapshot;
+    all = (KEY == NULL);
+
+    if (all || strcmp(KEY, LW_KEY_HIRA_KATA) == 0)
+      snapshot->query_hiragana_to_katakana = g_settings_get_boolean (settings, LW_KEY_HIRA_KATA);
+    if (all || strcmp(KEY, LW_KEY_KATA_HIRA) == 0)
+      snapshot->query_katakana_to_hiragana = g_settings_get_boolean (settings, LW_KEY_KATA_HIRA);
+    if (all || strcmp(KEY, LW_KEY_ROMAN_KANA) == 0)
+    {
+      snapshot->query_romaji_to_kana = g_settings_get_int (settings, LW_KEY_ROMAN_KANA);
+      snapshot->want_romaji_to_kana = (
+        snapshot->query_romaji_to_kana == 0 || 
+        (snapshot->query_romaji_to_kana == 2 && !preferences->is_japanese_locale)
+      );
+    }
+}
+
+
+static void
+lw_preferences_snapshot_changed_cb (GSettings *settings, gchar *key, gpointer data)
+{
+    //Declarations
+    LwPreferences *preferences;
+
+    //Initializations
+    preferences = LW_PREFMANAGER (data);
+
+    g_mutex_lock (&preferences->mutex);
+    lw_preferences_snapshot_update (preferences, settings, key);
+    g_mutex_unlock (&preferences->mutex);
+}
+
+
+//!
+//! @brief Copies out the decoded preferences that are needed on every search.
+//!        The values are read from GSettings once and then kept up to date by
+//!        a change listener, so this doesn't touch GSettings again.  The first
+//!        call should be made from the main thread.
+//! @param preferences The LwPreferences to read from
+//! @param snapshot The LwPreferencesSnapshot to copy the values into
+//!
+void
+lw_preferences_get_snapshot (LwPreferences *preferences, LwPreferencesSnapshot *snapshot)
+{
+    //Sanity checks
+    g_return_if_fail (preferences != NULL);
+    g_return_if_fail (snapshot != NULL);
+
+    //Declarations
+    GSettings *settings;
+
+    g_mutex_lock (&preferences->mutex);
+    if (!preferences->snapshot_loaded)
+    {
+      settings = lw_preferences_get_settings_object (preferences, LW_SCHEMA_BASE);
+      if (settings != NULL)
+      {
+        preferences->is_japanese_locale = lw_util_is_japanese_locale ();
+        //Listening first means a change made between the two can't be missed
+        preferences->snapshot_handler_id = g_signal_connect (
+          G_OBJECT (settings), 
+          "changed", 
+          G_CALLBACK (lw_preferences_snapshot_changed_cb), 
+          preferences
+        );
+        lw_preferences_snapshot_update (preferences, settings, NULL);
+        preferences->snapshot_loaded = TRUE;
+      }
+    }
+    *snapshot = preferences->snapshot;
+    g_mutex_unlock (&preferences->mutex);
+}
+
+
 //!
 //! @brief Resets a value in a key
 //! @param settings The GSettings object to act on You will have to get it yourself using lw_preferences_get_settings_object
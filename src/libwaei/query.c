@@ -58,6 +58,7 @@ lw_query_free (LwQuery* query)
 
     lw_query_clear (query);
     if (query->text != NULL) g_free (query->text); query->text = NULL;
+    if (query->fuzzyindex != NULL) lw_fuzzyindex_unref (query->fuzzyindex); query->fuzzyindex = NULL;
 
     g_free (query);
 }
@@ -122,7 +123,7 @@ lw_query_clear_regexgroup (LwQuery *query)
         for (j = 0; j < TOTAL_LW_RELEVANCE; j++)
         {
           if (query->regexgroup[i][j] == NULL) continue;
-          g_list_foreach (query->regexgroup[i][j], (GFunc) g_regex_unref, NULL);
+          g_list_foreach (query->regexgroup[i][j], (GFunc) lw_matcher_free, NULL);
           query->regexgroup[i][j] = NULL;
         }
         g_free (query->regexgroup[i]); query->regexgroup[i] = NULL;
@@ -168,6 +169,8 @@ lw_query_clear (LwQuery* query)
     lw_query_clear_tokens (query);
     lw_query_clear_regexgroup (query);
     lw_query_clear_rangelist (query);
+    if (query->deinflections != NULL) g_hash_table_unref (query->deinflections); query->deinflections = NULL;
+    if (query->corrections != NULL) g_hash_table_unref (query->corrections); query->corrections = NULL;
 
     query->parsed = FALSE;
 }
@@ -250,6 +253,101 @@ lw_query_tokenlist_append_primary (LwQuery     *query,
 }
 
 
+//!
+//! @brief Adds the dictionary forms a token could be a conjugation of to its
+//!        supplimentary tokens when root words are searched for.  The forms
+//!        are only worked out once for each token of the query.
+//! @param query The LwQuery the token is from
+//! @param TOKEN The token to deinflect
+//! @param supplimentary The supplimentary tokens to add to
+//!
+static void
+lw_query_append_deinflections (LwQuery *query, const gchar *TOKEN, gchar **supplimentary)
+{
+    //Declarations
+    gchar **forms;
+    gchar **alternatives;
+    gchar *temp;
+    gboolean found;
+    gint i, j;
+
+    if (!(query->flags & LW_QUERY_FLAG_ROOT_WORD)) return;
+
+    if (query->deinflections == NULL)
+      query->deinflections = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_strfreev);
+
+    forms = (gchar**) g_hash_table_lookup (query->deinflections, TOKEN);
+    if (forms == NULL)
+    {
+      forms = lw_deinflector_deinflect (lw_deinflector_get_default (), TOKEN);
+      if (forms == NULL) return;
+      g_hash_table_insert (query->deinflections, g_strdup (TOKEN), forms);
+    }
+
+    alternatives = g_strsplit (*supplimentary, LW_QUERY_DELIMITOR_SUPPLIMENTARY_STRING, -1);
+    for (i = 0; forms[i] != NULL; i++)
+    {
+      found = FALSE;
+      for (j = 0; alternatives[j] != NULL && !found; j++)
+      {
+        found = (strcmp (alternatives[j], forms[i]) == 0);
+      }
+      if (!found)
+      {
+        temp = g_strjoin (LW_QUERY_DELIMITOR_SUPPLIMENTARY_STRING, *supplimentary, forms[i], NULL);
+        g_free (*supplimentary); *supplimentary = temp; temp = NULL;
+      }
+    }
+    g_strfreev (alternatives); alternatives = NULL;
+}
+
+
+//!
+//! @brief Adds the words a mistyped romaji or English token may have been
+//!        meant to be to its supplimentary tokens when fuzzy searching.
+//!        Nothing is added for tokens that are words of the dictionary.
+//! @param query The LwQuery the token is from
+//! @param TOKEN The token to correct
+//! @param supplimentary The supplimentary tokens to add to
+//! @param with_kana Also add the corrections converted to hiragana
+//!
+static void
+lw_query_append_corrections (LwQuery *query, const gchar *TOKEN, gchar **supplimentary, gboolean with_kana)
+{
+    //Declarations
+    gchar **corrections;
+    gchar *temp;
+    const gint LENGTH = 100;
+    gchar buffer[LENGTH];
+    gint i;
+
+    if (!(query->flags & LW_QUERY_FLAG_FUZZY) || query->fuzzyindex == NULL) return;
+
+    if (query->corrections == NULL)
+      query->corrections = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_strfreev);
+
+    corrections = (gchar**) g_hash_table_lookup (query->corrections, TOKEN);
+    if (corrections == NULL)
+    {
+      corrections = lw_fuzzyindex_correct (query->fuzzyindex, TOKEN);
+      if (corrections == NULL) return;
+      g_hash_table_insert (query->corrections, g_strdup (TOKEN), corrections);
+    }
+
+    for (i = 0; corrections[i] != NULL; i++)
+    {
+      temp = g_strjoin (LW_QUERY_DELIMITOR_SUPPLIMENTARY_STRING, *supplimentary, corrections[i], NULL);
+      g_free (*supplimentary); *supplimentary = temp; temp = NULL;
+
+      if (with_kana && lw_util_str_roma_to_hira (corrections[i], buffer, LENGTH))
+      {
+        temp = g_strjoin (LW_QUERY_DELIMITOR_SUPPLIMENTARY_STRING, *supplimentary, buffer, NULL);
+        g_free (*supplimentary); *supplimentary = temp; temp = NULL;
+      }
+    }
+}
+
+
 static gchar* 
 lw_query_tokenlist_build_kanji_supplimentary (LwQuery      *query,
                                               LwRelevance   relevance,
@@ -294,6 +392,8 @@ lw_query_tokenlist_build_kanji_supplimentary (LwQuery      *query,
     }
 #endif
 
+    if (relevance == LW_RELEVANCE_LOW) lw_query_append_deinflections (query, TOKEN, &supplimentary);
+
     return supplimentary;
 }
 
@@ -353,6 +453,8 @@ lw_query_tokenlist_build_furigana_supplimentary (LwQuery      *query,
     }
 #endif
 
+    if (relevance == LW_RELEVANCE_LOW) lw_query_append_deinflections (query, TOKEN, &supplimentary);
+
     if (hiragana_to_katakana && is_hiragana)
     {
       strcpy (buffer, TOKEN);
@@ -434,17 +536,23 @@ lw_query_tokenlist_build_romaji_supplimentary (LwQuery      *query,
         if (resultlist != NULL) lw_morphologylist_free (resultlist); resultlist = NULL;
       }
 #endif
+
+      //The conjugation is in the kana the romaji was turned into
+      lw_query_append_deinflections (query, buffer, &supplimentary);
     }
     else
     {
       buffer[0] = '\0';
     }
-    if (hiragana_to_katakana && buffer[0] != '\0' && lw_util_is_hiragana_str (buffer))
+    if (hiragana_to_katakana && buffer[0] != '\0' && lw_util_str_roma_to_kata (TOKEN, buffer, LENGTH))
     {
-      lw_util_str_shift_hira_to_kata (buffer);
       temp = g_strjoin (LW_QUERY_DELIMITOR_SUPPLIMENTARY_STRING, supplimentary, buffer, NULL);
       g_free (supplimentary); supplimentary = temp; temp = NULL;
     }
+    if (is_romaji && relevance == LW_RELEVANCE_LOW)
+    {
+      lw_query_append_corrections (query, TOKEN, &supplimentary, (*new_type == LW_QUERY_TYPE_MIX));
+    }
 
     return supplimentary;
 }
@@ -547,16 +655,16 @@ void
 lw_query_regexgroup_append (LwQuery     *query, 
                             LwQueryType  type,
                             LwRelevance  relevance, 
-                            GRegex      *regex)
+                            LwMatcher   *matcher)
 {
     //Sanity checks
     g_return_if_fail (query != NULL);
-    g_return_if_fail (regex != NULL);
+    g_return_if_fail (matcher != NULL);
 
     if (query->regexgroup == NULL) query->regexgroup = g_new0 (GList**, TOTAL_LW_QUERY_TYPES);
     if (query->regexgroup[type] == NULL) query->regexgroup[type] = g_new0 (GList*, TOTAL_LW_RELEVANCE);
 
-    query->regexgroup[type][relevance] = g_list_append (query->regexgroup[type][relevance], regex);
+    query->regexgroup[type][relevance] = g_list_append (query->regexgroup[type][relevance], matcher);
 }
 
 
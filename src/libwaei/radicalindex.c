@@ -0,0 +1,573 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file radicalindex.c
+//!
+//! @brief Which kanji contain which radicals, kept as bitsets.  The index is
+//!        written when the Kanji dictionary is installed so the radicals
+//!        window can grey out the radicals that can't be added anymore by
+//!        intersecting bitsets instead of waiting for the search results.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <glib.h>
+
+#include <libwaei/libwaei.h>
+
+
+//!
+//! @brief Creates a new empty LwRadicalIndex
+//! @returns An allocated LwRadicalIndex that should be freed with lw_radicalindex_unref
+//!
+LwRadicalIndex*
+lw_radicalindex_new ()
+{
+    LwRadicalIndex *index;
+
+    index = g_new0 (LwRadicalIndex, 1);
+    index->kanji = g_array_new (FALSE, FALSE, sizeof(gunichar));
+    index->strokes = g_array_new (FALSE, FALSE, sizeof(guint8));
+    index->radicals = g_array_new (FALSE, FALSE, sizeof(gunichar));
+    index->positions = g_hash_table_new (g_direct_hash, g_direct_equal);
+    index->pairs = g_array_new (FALSE, FALSE, sizeof(guint32));
+    index->refs = 1;
+
+    return index;
+}
+
+
+//!
+//! @brief Gets the radical index of an installed Kanji dictionary.  The index
+//!        written at install time is used when it still matches the dictionary,
+//!        otherwise it is rebuilt from the dictionary and saved again.
+//! @param dictionary The installed Kanji LwDictionary
+//! @param error A GError to place errors into or NULL
+//! @returns An allocated LwRadicalIndex or NULL on error
+//!
+LwRadicalIndex*
+lw_radicalindex_new_for_dictionary (LwDictionary *dictionary, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+    if (error != NULL && *error != NULL) return NULL;
+
+    //Declarations
+    LwRadicalIndex *index;
+
+    //Initializations
+    index = lw_radicalindex_new ();
+
+    if (!lw_sidecar_load_or_build (index, dictionary, LW_RADICALINDEX_SUFFIX, (LwSidecarLoadFunc) lw_radicalindex_load, (LwSidecarBuildFunc) lw_radicalindex_build, (LwSidecarSaveFunc) lw_radicalindex_save, error))
+    {
+      lw_radicalindex_unref (index); index = NULL;
+    }
+
+    return index;
+}
+
+
+//!
+//! @brief Gets the index shared by every user of a dictionary without
+//!        waiting for it.  It is loaded in another thread the first time and
+//!        again when the dictionary was reinstalled, and NULL is returned
+//!        until it is ready.
+//! @param dictionary A Kanji LwDictionary
+//! @returns A reference to the LwRadicalIndex to be released with
+//!          lw_radicalindex_unref or NULL if it isn't loaded yet
+//!
+LwRadicalIndex*
+lw_radicalindex_peek_for_dictionary (LwDictionary *dictionary)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+    if (!LW_IS_KANJIDICTIONARY (dictionary)) return NULL;
+
+    return LW_RADICALINDEX (lw_sidecar_peek_for_dictionary (dictionary, LW_RADICALINDEX_SUFFIX, (LwSidecarNewFunc) lw_radicalindex_new_for_dictionary, (GBoxedCopyFunc) lw_radicalindex_ref, (GDestroyNotify) lw_radicalindex_unref));
+}
+
+
+static void
+lw_radicalindex_clear (LwRadicalIndex *index)
+{
+    g_array_set_size (index->kanji, 0);
+    g_array_set_size (index->strokes, 0);
+    g_array_set_size (index->radicals, 0);
+    g_array_set_size (index->pairs, 0);
+    g_hash_table_remove_all (index->positions);
+
+    if (index->bitsets != NULL) g_free (index->bitsets); index->bitsets = NULL;
+    if (index->masks != NULL) g_free (index->masks); index->masks = NULL;
+    index->kanji_words = 0;
+    index->radical_words = 0;
+    memset (&index->stamp, 0, sizeof(LwSidecarStamp));
+}
+
+
+LwRadicalIndex*
+lw_radicalindex_ref (LwRadicalIndex *index)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, NULL);
+
+    g_atomic_int_inc (&index->refs);
+
+    return index;
+}
+
+
+//!
+//! @brief Releases a reference to an LwRadicalIndex, freeing it with the last one
+//! @param index The LwRadicalIndex to unref
+//!
+void
+lw_radicalindex_unref (LwRadicalIndex *index)
+{
+    //Sanity checks
+    if (index == NULL) return;
+
+    if (!g_atomic_int_dec_and_test (&index->refs)) return;
+
+    lw_radicalindex_clear (index);
+
+    g_array_free (index->kanji, TRUE); index->kanji = NULL;
+    g_array_free (index->strokes, TRUE); index->strokes = NULL;
+    g_array_free (index->radicals, TRUE); index->radicals = NULL;
+    g_array_free (index->pairs, TRUE); index->pairs = NULL;
+    g_hash_table_unref (index->positions); index->positions = NULL;
+
+    g_free (index);
+}
+
+
+//!
+//! @brief Builds the path of the index of a dictionary in the cache folder
+//! @param FILENAME The filename of the dictionary
+//! @returns An allocated path that should be freed with g_free
+//!
+gchar*
+lw_radicalindex_build_path (const gchar *FILENAME)
+{
+    return lw_sidecar_build_path (FILENAME, LW_RADICALINDEX_SUFFIX);
+}
+
+
+static gint
+lw_radicalindex_get_position (LwRadicalIndex *index, gunichar radical)
+{
+    return GPOINTER_TO_INT (g_hash_table_lookup (index->positions, GUINT_TO_POINTER (radical))) - 1;
+}
+
+
+//!
+//! @brief Adds a kanji to the index.  The bitsets aren't updated until
+//!        lw_radicalindex_finish is called.
+//! @param kanji The kanji character
+//! @param strokes The stroke count of the kanji or 0 if unknown
+//! @param RADICALS The radicals of the kanji, optionally separated by spaces
+//!
+static void
+lw_radicalindex_add_kanji (LwRadicalIndex *index, gunichar kanji, gint strokes, const gchar *RADICALS)
+{
+    //Declarations
+    const gchar *ptr;
+    gunichar radical;
+    guint8 stroke_count;
+    guint32 pair[2];
+    gint position;
+
+    //Initializations
+    stroke_count = (guint8) CLAMP (strokes, 0, G_MAXUINT8);
+    pair[0] = index->kanji->len;
+
+    g_array_append_val (index->kanji, kanji);
+    g_array_append_val (index->strokes, stroke_count);
+
+    for (ptr = RADICALS; *ptr != '\0'; ptr = g_utf8_next_char (ptr))
+    {
+      radical = g_utf8_get_char (ptr);
+      if (g_unichar_isspace (radical)) continue;
+
+      position = lw_radicalindex_get_position (index, radical);
+      if (position < 0)
+      {
+        position = index->radicals->len;
+        g_array_append_val (index->radicals, radical);
+        g_hash_table_insert (index->positions, GUINT_TO_POINTER (radical), GINT_TO_POINTER (position + 1));
+      }
+
+      pair[1] = position;
+      g_array_append_vals (index->pairs, pair, 2);
+    }
+}
+
+
+//!
+//! @brief Turns the kanji added with lw_radicalindex_add_kanji into the bitsets
+//!
+static void
+lw_radicalindex_finish (LwRadicalIndex *index)
+{
+    //Declarations
+    guint32 *pairs;
+    guint32 kanji;
+    guint32 radical;
+    guint i;
+
+    //Initializations
+    pairs = (guint32*) index->pairs->data;
+    index->kanji_words = (index->kanji->len + 63) / 64;
+    index->radical_words = (index->radicals->len + 63) / 64;
+
+    if (index->bitsets != NULL) g_free (index->bitsets);
+    if (index->masks != NULL) g_free (index->masks);
+    index->bitsets = g_new0 (guint64, index->radicals->len * index->kanji_words + 1);
+    index->masks = g_new0 (guint64, index->kanji->len * index->radical_words + 1);
+
+    for (i = 0; i + 1 < index->pairs->len; i += 2)
+    {
+      kanji = pairs[i];
+      radical = pairs[i + 1];
+      index->bitsets[radical * index->kanji_words + kanji / 64] |= G_GUINT64_CONSTANT (1) << (kanji % 64);
+      index->masks[kanji * index->radical_words + radical / 64] |= G_GUINT64_CONSTANT (1) << (radical % 64);
+    }
+
+    g_array_set_size (index->pairs, 0);
+}
+
+
+//!
+//! @brief Reads a line of the Kanji dictionary as written by lw_io_create_mix_dictionary.
+//!        The kanji comes first, followed by its radicals and then the kanjidic fields.
+//!
+static void
+lw_radicalindex_parse_line (LwRadicalIndex *index, gchar *line)
+{
+    //Declarations
+    gunichar kanji;
+    gchar *ptr;
+    gchar *radicals;
+    gchar c;
+    gint strokes;
+
+    //Initializations
+    ptr = line;
+    strokes = 0;
+
+    kanji = g_utf8_get_char_validated (ptr, -1);
+    if (kanji == (gunichar) -1 || kanji == (gunichar) -2 || kanji < 0x80) return;
+    ptr = g_utf8_next_char (ptr);
+
+    //The radicals are the non-ascii characters before the JIS code
+    radicals = ptr;
+    while (*ptr == ' ' || ((guchar) *ptr) >= 0x80) ptr++;
+    c = *ptr;
+    *ptr = '\0';
+    lw_radicalindex_add_kanji (index, kanji, 0, radicals);
+    *ptr = c;
+
+    //The first stroke count field before the meanings is the real one
+    while (*ptr != '\0' && *ptr != '{')
+    {
+      if (*ptr == 'S' && *(ptr - 1) == ' ' && g_ascii_isdigit (*(ptr + 1)))
+      {
+        strokes = atoi (ptr + 1);
+        break;
+      }
+      ptr++;
+    }
+
+    g_array_index (index->strokes, guint8, index->strokes->len - 1) = (guint8) CLAMP (strokes, 0, G_MAXUINT8);
+}
+
+
+//!
+//! @brief Builds the index from a Kanji dictionary that has the radicals mixed in
+//! @param index The LwRadicalIndex to fill
+//! @param PATH The path of the Kanji dictionary
+//! @param cancellable A GCancellable to stop building or NULL
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE on success
+//!
+gboolean
+lw_radicalindex_build (LwRadicalIndex *index, const gchar *PATH, GCancellable *cancellable, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, FALSE);
+    g_return_val_if_fail (PATH != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    FILE *file;
+    gchar line[LW_IO_MAX_FGETS_LINE];
+    GQuark quark;
+
+    //Initializations
+    file = fopen (PATH, "r");
+    lw_radicalindex_clear (index);
+
+    if (file == NULL)
+    {
+      quark = g_quark_from_string (LW_IO_ERROR);
+      g_set_error (error, quark, LW_IO_READ_ERROR, "Could not open %s to index its radicals", PATH);
+      return FALSE;
+    }
+
+    while (fgets (line, LW_IO_MAX_FGETS_LINE, file) != NULL)
+    {
+      if (cancellable != NULL && g_cancellable_is_cancelled (cancellable)) break;
+      if (line[0] == '#') continue;
+      lw_radicalindex_parse_line (index, line);
+    }
+
+    fclose (file); file = NULL;
+
+    lw_radicalindex_finish (index);
+    lw_sidecar_stamp_file (&index->stamp, PATH);
+
+    return (cancellable == NULL || !g_cancellable_is_cancelled (cancellable));
+}
+
+
+//!
+//! @brief Writes the index so it doesn't have to be rebuilt from the dictionary.
+//!        The first line is the LwSidecarStamp of the dictionary and each
+//!        following line is a kanji, its stroke count and its radicals
+//!        separated by tabs.
+//! @param index The LwRadicalIndex to save
+//! @param PATH The file to write to
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE on success
+//!
+gboolean
+lw_radicalindex_save (LwRadicalIndex *index, const gchar *PATH, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, FALSE);
+    g_return_val_if_fail (PATH != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    GString *text;
+    guint64 *mask;
+    gboolean success;
+    guint i;
+    guint j;
+
+    //Initializations
+    text = g_string_new (NULL);
+
+    lw_sidecar_stamp_append (&index->stamp, text);
+
+    for (i = 0; i < index->kanji->len; i++)
+    {
+      g_string_append_unichar (text, g_array_index (index->kanji, gunichar, i));
+      g_string_append_printf (text, "\t%d\t", (gint) g_array_index (index->strokes, guint8, i));
+
+      mask = index->masks + i * index->radical_words;
+      for (j = 0; j < index->radicals->len; j++)
+      {
+        if (mask[j / 64] & (G_GUINT64_CONSTANT (1) << (j % 64)))
+          g_string_append_unichar (text, g_array_index (index->radicals, gunichar, j));
+      }
+      g_string_append_c (text, '\n');
+    }
+
+    success = g_file_set_contents (PATH, text->str, text->len, error);
+
+    g_string_free (text, TRUE); text = NULL;
+
+    return success;
+}
+
+
+//!
+//! @brief Loads an index written by lw_radicalindex_save
+//! @param index The LwRadicalIndex to fill
+//! @param PATH The file to read
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE on success
+//!
+gboolean
+lw_radicalindex_load (LwRadicalIndex *index, const gchar *PATH, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, FALSE);
+    g_return_val_if_fail (PATH != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    gchar *contents;
+    gchar **lines;
+    gchar **atoms;
+    LwSidecarStamp stamp;
+    gint i;
+
+    //Initializations
+    contents = NULL;
+    lw_radicalindex_clear (index);
+
+    if (!g_file_get_contents (PATH, &contents, NULL, error)) return FALSE;
+
+    lines = g_strsplit (contents, "\n", -1);
+    if (lines[0] == NULL || !lw_sidecar_stamp_parse (&stamp, lines[0], NULL))
+    {
+      g_strfreev (lines); lines = NULL;
+      g_free (contents); contents = NULL;
+      return FALSE;
+    }
+
+    for (i = 1; lines[i] != NULL; i++)
+    {
+      atoms = g_strsplit (lines[i], "\t", 3);
+      if (g_strv_length (atoms) == 3 && *atoms[0] != '\0')
+      {
+        lw_radicalindex_add_kanji (index, g_utf8_get_char (atoms[0]), atoi (atoms[1]), atoms[2]);
+      }
+      g_strfreev (atoms); atoms = NULL;
+    }
+
+    lw_radicalindex_finish (index);
+    index->stamp = stamp;
+
+    g_strfreev (lines); lines = NULL;
+    g_free (contents); contents = NULL;
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Intersects the bitsets of the radicals and filters by stroke count
+//! @returns A bitset of the matching kanji to be freed with g_free
+//!
+static guint64*
+lw_radicalindex_match (LwRadicalIndex *index, const gchar *RADICALS, gint strokes)
+{
+    //Declarations
+    guint64 *matches;
+    guint64 *bitset;
+    const gchar *ptr;
+    gunichar radical;
+    gint position;
+    guint64 word;
+    gint i;
+    gint j;
+
+    //Initializations
+    matches = g_new (guint64, index->kanji_words + 1);
+
+    for (i = 0; i < index->kanji_words; i++) matches[i] = G_MAXUINT64;
+    if (index->kanji->len % 64 != 0)
+      matches[index->kanji_words - 1] = (G_GUINT64_CONSTANT (1) << (index->kanji->len % 64)) - 1;
+
+    for (ptr = RADICALS; ptr != NULL && *ptr != '\0'; ptr = g_utf8_next_char (ptr))
+    {
+      radical = g_utf8_get_char (ptr);
+      if (g_unichar_isspace (radical)) continue;
+
+      position = lw_radicalindex_get_position (index, radical);
+      if (position < 0)
+      {
+        memset (matches, 0, sizeof(guint64) * index->kanji_words);
+        break;
+      }
+
+      bitset = index->bitsets + position * index->kanji_words;
+      for (i = 0; i < index->kanji_words; i++) matches[i] &= bitset[i];
+    }
+
+    if (strokes > 0)
+    {
+      for (i = 0; i < index->kanji_words; i++)
+      {
+        word = matches[i];
+        for (j = 0; word != 0; j++, word >>= 1)
+        {
+          if ((word & 1) && g_array_index (index->strokes, guint8, i * 64 + j) != strokes)
+            matches[i] &= ~(G_GUINT64_CONSTANT (1) << j);
+        }
+      }
+    }
+
+    return matches;
+}
+
+
+//!
+//! @brief Finds the radicals that appear in the kanji that contain all of the
+//!        radicals, that is the radicals that can still be added to the
+//!        selection without running out of kanji.
+//! @param index The LwRadicalIndex to look in
+//! @param RADICALS The radicals that are already selected
+//! @param strokes The stroke count the kanji need to have or 0 for any
+//! @returns An allocated string of radicals to be freed with g_free
+//!
+gchar*
+lw_radicalindex_strdup_possible_radicals (LwRadicalIndex *index, const gchar *RADICALS, gint strokes)
+{
+    //Sanity checks
+    g_return_val_if_fail (index != NULL, NULL);
+
+    //Declarations
+    GString *text;
+    guint64 *matches;
+    guint64 *possible;
+    guint64 *mask;
+    guint64 word;
+    gint i;
+    gint j;
+    gint k;
+
+    //Initializations
+    text = g_string_new (NULL);
+    matches = lw_radicalindex_match (index, RADICALS, strokes);
+    possible = g_new0 (guint64, index->radical_words + 1);
+
+    for (i = 0; i < index->kanji_words; i++)
+    {
+      word = matches[i];
+      for (j = 0; word != 0; j++, word >>= 1)
+      {
+        if ((word & 1) == 0) continue;
+        mask = index->masks + (i * 64 + j) * index->radical_words;
+        for (k = 0; k < index->radical_words; k++) possible[k] |= mask[k];
+      }
+    }
+
+    for (k = 0; k < (gint) index->radicals->len; k++)
+    {
+      if (possible[k / 64] & (G_GUINT64_CONSTANT (1) << (k % 64)))
+        g_string_append_unichar (text, g_array_index (index->radicals, gunichar, k));
+    }
+
+    g_free (matches); matches = NULL;
+    g_free (possible); possible = NULL;
+
+    return g_string_free (text, FALSE);
+}
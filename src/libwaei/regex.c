@@ -38,7 +38,7 @@
 
 
 static int _regex_expressions_reference_count = 0; //!< Internal reference count for the regexes
-GRegex *lw_re[LW_RE_TOTAL + 1]; //!< Globally accessable pre-compiled regexes
+LwMatcher *lw_re[LW_RE_TOTAL + 1]; //!< Globally accessable pre-compiled regexes
 
 //!
 //! @brief Initializes often used prebuilt regex expressions
@@ -62,19 +62,19 @@ lw_regex_initialize ()
       switch (i)
       {
         case LW_RE_NUMBER:
-          lw_re[i] = g_regex_new ("[a-zA-Z][0-9]{1,4}",  LW_RE_COMPILE_FLAGS, LW_RE_LOCATE_FLAGS, &error);
+          lw_re[i] = lw_matcher_new ("[a-zA-Z][0-9]{1,4}", &error);
           break;
         case LW_RE_STROKES:
-          lw_re[i] = g_regex_new ("S[0-9]{1,2}",  LW_RE_COMPILE_FLAGS, LW_RE_LOCATE_FLAGS, &error);
+          lw_re[i] = lw_matcher_new ("S[0-9]{1,2}", &error);
           break;
         case LW_RE_GRADE:
-          lw_re[i] = g_regex_new ("G[0-9]{1,2}",  LW_RE_COMPILE_FLAGS, LW_RE_LOCATE_FLAGS, &error);
+          lw_re[i] = lw_matcher_new ("G[0-9]{1,2}", &error);
           break;
         case LW_RE_FREQUENCY:
-          lw_re[i] = g_regex_new ("F[0-9]{1,4}",  LW_RE_COMPILE_FLAGS, LW_RE_LOCATE_FLAGS, &error);
+          lw_re[i] = lw_matcher_new ("F[0-9]{1,4}", &error);
           break;
         case LW_RE_JLPT:
-          lw_re[i] = g_regex_new ("J[0-4]{1,1}",  LW_RE_COMPILE_FLAGS, LW_RE_LOCATE_FLAGS, &error);
+          lw_re[i] = lw_matcher_new ("J[0-4]{1,1}", &error);
           break;
         default:
           g_assert_not_reached();
@@ -105,7 +105,7 @@ lw_regex_free ()
     //Setup the built in regexes
     for (i = 0; i < LW_RE_TOTAL; i++)
     {
-      g_regex_unref (lw_re[i]);
+      lw_matcher_free (lw_re[i]);
       lw_re[i] = NULL;
     }
 }
@@ -78,6 +78,7 @@ lw_result_free (LwResult *result)
 void 
 lw_result_init (LwResult *result)
 {
+    result->variants = NULL;
     lw_result_clear (result);
 }
 
@@ -91,13 +92,55 @@ lw_result_init (LwResult *result)
 void 
 lw_result_deinit (LwResult *result)
 {
+    lw_result_free_variants (result);
 }
 
+//!
+//! @brief Checks that the parsed fields of a result are valid UTF-8 and
+//!        sets valid_utf8, so the compare can match the fields without
+//!        each match checking them again
+//! @param result A LwResult a dictionary has parsed
+//!
+void
+lw_result_check_utf8 (LwResult *result)
+{
+    //Declarations
+    const gchar *fields[8];
+    gboolean valid;
+    gint i;
+
+    //Initializations
+    fields[0] = result->kanji_start;
+    fields[1] = result->furigana_start;
+    fields[2] = result->meanings;
+    fields[3] = result->readings[0];
+    fields[4] = result->readings[1];
+    fields[5] = result->readings[2];
+    fields[6] = result->kanji;
+    fields[7] = result->radicals;
+    valid = g_utf8_validate (result->text, -1, NULL);
+
+    for (i = 0; valid && i < G_N_ELEMENTS (fields); i++)
+    {
+      if (fields[i] != NULL) valid = g_utf8_validate (fields[i], -1, NULL);
+    }
+
+    //Only the Examples dictionary leaves def_total unset, using one definition
+    for (i = 0; valid && i < MAX (result->def_total, 1) && result->def_start[i] != NULL; i++)
+    {
+      valid = g_utf8_validate (result->def_start[i], -1, NULL);
+    }
+
+    result->valid_utf8 = valid;
+}
+
+
 void 
 lw_result_clear (LwResult *result)
 {
     //A place for a copy of the raw string
     result->text[0] = '\0';
+    result->valid_utf8 = FALSE;
 
     result->relevance = LW_RELEVANCE_UNSET;
     
@@ -120,6 +163,8 @@ lw_result_clear (LwResult *result)
     result->jlpt = NULL;
     result->kanji = NULL;
     result->radicals = NULL;
+
+    lw_result_free_variants (result);
 }
 
 
@@ -138,3 +183,77 @@ lw_result_is_similar (LwResult *result1, LwResult *result2)
     return (same_first_def && same_def_totals);
 }
 
+
+//!
+//! @brief Groups another result with the same definitions under this one.
+//!        Only the headword of the other result is copied.
+//! @param result The LwResult to add the variant to
+//! @param other The LwResult to take the headword from
+//!
+void
+lw_result_add_variant (LwResult *result, LwResult *other)
+{
+    //Sanity checks
+    g_return_if_fail (result != NULL);
+    g_return_if_fail (other != NULL);
+
+    //Declarations
+    LwResultVariant *variant;
+
+    //Initializations
+    variant = g_new (LwResultVariant, 1);
+    variant->kanji_start = g_strdup (other->kanji_start);
+    variant->furigana_start = g_strdup (other->furigana_start);
+    variant->classification_start = g_strdup (other->classification_start);
+    variant->important = other->important;
+
+    result->variants = g_list_append (result->variants, variant);
+}
+
+
+static void
+lw_resultvariant_free (LwResultVariant *variant)
+{
+    g_free (variant->kanji_start);
+    g_free (variant->furigana_start);
+    g_free (variant->classification_start);
+    g_free (variant);
+}
+
+
+void
+lw_result_free_variants (LwResult *result)
+{
+    g_list_free_full (result->variants, (GDestroyNotify) lw_resultvariant_free);
+    result->variants = NULL;
+}
+
+
+//!
+//! @brief Gets a key that is the same for results with the same definitions
+//! @param result The LwResult to get the key of
+//! @returns An allocated string that should be freed with g_free or NULL if
+//!          the result has no definitions
+//!
+gchar*
+lw_result_get_definitions_key (LwResult *result)
+{
+    //Sanity checks
+    g_return_val_if_fail (result != NULL, NULL);
+    if (result->def_total < 1 || result->def_start[0] == NULL) return NULL;
+
+    //Declarations
+    GString *key;
+    gint i;
+
+    //Initializations
+    key = g_string_new (NULL);
+
+    for (i = 0; i < result->def_total && result->def_start[i] != NULL; i++)
+    {
+      if (i > 0) g_string_append_c (key, '\t');
+      g_string_append (key, result->def_start[i]);
+    }
+
+    return g_string_free (key, FALSE);
+}
@@ -0,0 +1,405 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file scheduler.c
+//!
+//! @brief Spaced repetition for vocabulary words.  Reviews follow the SM-2
+//!        model, with the ease and interval kept in the LwWord, and the
+//!        cards waiting for review sit in a min-heap keyed by due time so a
+//!        study session of k cards only costs O(k log n) to pull out of
+//!        a list of n words.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+
+#include <libwaei/libwaei.h>
+
+
+//!
+//! @brief Creates a new empty LwScheduler
+//! @returns An allocated LwScheduler that should be freed with lw_scheduler_free
+//!
+LwScheduler*
+lw_scheduler_new ()
+{
+    LwScheduler *scheduler;
+
+    scheduler = g_new0 (LwScheduler, 1);
+    scheduler->cards = g_array_new (FALSE, FALSE, sizeof(LwSchedulerCard));
+
+    return scheduler;
+}
+
+
+//!
+//! @brief Frees an LwScheduler.  The data of the cards isn't touched.
+//! @param scheduler The LwScheduler to free
+//!
+void
+lw_scheduler_free (LwScheduler *scheduler)
+{
+    //Sanity checks
+    if (scheduler == NULL) return;
+
+    g_array_free (scheduler->cards, TRUE); scheduler->cards = NULL;
+    g_free (scheduler);
+}
+
+
+static gboolean
+lw_scheduler_card_is_before (LwSchedulerCard *card1, LwSchedulerCard *card2)
+{
+    if (card1->due != card2->due) return (card1->due < card2->due);
+    return (card1->order < card2->order);
+}
+
+
+static void
+lw_scheduler_sift_up (LwScheduler *scheduler, guint position)
+{
+    //Declarations
+    LwSchedulerCard *cards;
+    LwSchedulerCard card;
+    guint parent;
+
+    //Initializations
+    cards = (LwSchedulerCard*) scheduler->cards->data;
+    card = cards[position];
+
+    while (position > 0)
+    {
+      parent = (position - 1) / 2;
+      if (!lw_scheduler_card_is_before (&card, &cards[parent])) break;
+      cards[position] = cards[parent];
+      position = parent;
+    }
+    cards[position] = card;
+}
+
+
+static void
+lw_scheduler_sift_down (LwScheduler *scheduler, guint position)
+{
+    //Declarations
+    LwSchedulerCard *cards;
+    LwSchedulerCard card;
+    guint length;
+    guint child;
+
+    //Initializations
+    cards = (LwSchedulerCard*) scheduler->cards->data;
+    length = scheduler->cards->len;
+    card = cards[position];
+
+    while ((child = position * 2 + 1) < length)
+    {
+      if (child + 1 < length && lw_scheduler_card_is_before (&cards[child + 1], &cards[child])) child++;
+      if (!lw_scheduler_card_is_before (&cards[child], &card)) break;
+      cards[position] = cards[child];
+      position = child;
+    }
+    cards[position] = card;
+}
+
+
+//!
+//! @brief Restores the heap after cards were appended without sifting them
+//!        up.  Going bottom up is linear in the number of cards.
+//!
+static void
+lw_scheduler_heapify (LwScheduler *scheduler)
+{
+    //Declarations
+    guint i;
+
+    //Initializations
+    i = scheduler->cards->len / 2;
+
+    while (i-- > 0)
+    {
+      lw_scheduler_sift_down (scheduler, i);
+    }
+}
+
+
+//!
+//! @brief Adds a card to the scheduler
+//! @param scheduler The LwScheduler to add to
+//! @param due The hour since the epoch the card is due at
+//! @param data The card, which is handed back when it is popped
+//!
+void
+lw_scheduler_add (LwScheduler *scheduler, guint32 due, gpointer data)
+{
+    //Sanity checks
+    g_return_if_fail (scheduler != NULL);
+
+    //Declarations
+    LwSchedulerCard card;
+
+    //Initializations
+    card.due = due;
+    card.order = scheduler->added++;
+    card.data = data;
+
+    g_array_append_val (scheduler->cards, card);
+    lw_scheduler_sift_up (scheduler, scheduler->cards->len - 1);
+}
+
+
+//!
+//! @brief Adds a batch of cards at once.  The heap is rebuilt once
+//!        afterwards instead of sifting up every card.
+//! @param scheduler The LwScheduler to add to
+//! @param DUE The hours since the epoch each card is due at
+//! @param data The cards, which are handed back when they are popped
+//! @param length The number of cards in DUE and data
+//!
+void
+lw_scheduler_add_many (LwScheduler *scheduler, const guint32 *DUE, gpointer *data, guint length)
+{
+    //Sanity checks
+    g_return_if_fail (scheduler != NULL);
+    if (length == 0) return;
+    g_return_if_fail (DUE != NULL && data != NULL);
+
+    //Declarations
+    LwSchedulerCard card;
+    guint i;
+
+    for (i = 0; i < length; i++)
+    {
+      card.due = DUE[i];
+      card.order = scheduler->added++;
+      card.data = data[i];
+      g_array_append_val (scheduler->cards, card);
+    }
+
+    lw_scheduler_heapify (scheduler);
+}
+
+
+//!
+//! @brief Adds a word to the scheduler for the time it is next due
+//! @param scheduler The LwScheduler to add to
+//! @param word The LwWord to add
+//!
+void
+lw_scheduler_add_word (LwScheduler *scheduler, LwWord *word)
+{
+    lw_scheduler_add (scheduler, lw_word_get_due_hours (word), word);
+}
+
+
+//!
+//! @brief Adds every word of a vocabulary list to the scheduler.  The heap is
+//!        rebuilt bottom up afterwards which is linear in the size of the list.
+//! @param scheduler The LwScheduler to add to
+//! @param vocabulary The LwVocabulary whose words to add
+//!
+void
+lw_scheduler_add_vocabulary (LwScheduler *scheduler, LwVocabulary *vocabulary)
+{
+    //Sanity checks
+    g_return_if_fail (scheduler != NULL);
+    g_return_if_fail (vocabulary != NULL);
+
+    //Declarations
+    GPtrArray *items;
+    LwSchedulerCard card;
+    LwWord *word;
+    guint i;
+
+    //Initializations
+    items = vocabulary->items;
+    if (items == NULL || items->len == 0) return;
+
+    for (i = 0; i < items->len; i++)
+    {
+      word = LW_WORD (g_ptr_array_index (items, i));
+      card.due = lw_word_get_due_hours (word);
+      card.order = scheduler->added++;
+      card.data = word;
+      g_array_append_val (scheduler->cards, card);
+    }
+
+    lw_scheduler_heapify (scheduler);
+}
+
+
+gint
+lw_scheduler_length (LwScheduler *scheduler)
+{
+    return scheduler->cards->len;
+}
+
+
+//!
+//! @brief Gets the card that is due first without removing it
+//! @param scheduler The LwScheduler to look in
+//! @param due Set to the due time of the card if not NULL
+//! @returns The data of the card or NULL if the scheduler is empty
+//!
+gpointer
+lw_scheduler_peek (LwScheduler *scheduler, guint32 *due)
+{
+    //Declarations
+    LwSchedulerCard *card;
+
+    if (scheduler->cards->len == 0) return NULL;
+
+    card = &g_array_index (scheduler->cards, LwSchedulerCard, 0);
+    if (due != NULL) *due = card->due;
+
+    return card->data;
+}
+
+
+//!
+//! @brief Removes the card that is due first from the scheduler
+//! @param scheduler The LwScheduler to take from
+//! @param due Set to the due time of the card if not NULL
+//! @returns The data of the card or NULL if the scheduler is empty
+//!
+gpointer
+lw_scheduler_pop (LwScheduler *scheduler, guint32 *due)
+{
+    //Declarations
+    LwSchedulerCard *cards;
+    gpointer data;
+    guint last;
+
+    if (scheduler->cards->len == 0) return NULL;
+
+    //Initializations
+    cards = (LwSchedulerCard*) scheduler->cards->data;
+    last = scheduler->cards->len - 1;
+    data = cards[0].data;
+    if (due != NULL) *due = cards[0].due;
+
+    cards[0] = cards[last];
+    g_array_set_size (scheduler->cards, last);
+    if (last > 0) lw_scheduler_sift_down (scheduler, 0);
+
+    return data;
+}
+
+
+//!
+//! @brief Takes the cards that are due out of the scheduler, most overdue first
+//! @param scheduler The LwScheduler to take from
+//! @param hours The current time as given by lw_scheduler_get_hours
+//! @param max The most cards to take or -1 for all that are due
+//! @returns A GList of the card data that should be freed with g_list_free
+//!
+GList*
+lw_scheduler_pop_due (LwScheduler *scheduler, guint32 hours, gint max)
+{
+    //Sanity checks
+    g_return_val_if_fail (scheduler != NULL, NULL);
+
+    //Declarations
+    GList *list;
+    guint32 due;
+
+    //Initializations
+    list = NULL;
+
+    while (max != 0 && lw_scheduler_peek (scheduler, &due) != NULL && due <= hours)
+    {
+      list = g_list_prepend (list, lw_scheduler_pop (scheduler, NULL));
+      if (max > 0) max--;
+    }
+
+    return g_list_reverse (list);
+}
+
+
+//!
+//! @brief Gets the current time in the hours used for due times
+//!
+guint32
+lw_scheduler_get_hours ()
+{
+    return lw_word_timestamp_to_hours (g_get_real_time ());
+}
+
+
+//!
+//! @brief Reschedules a word after it was answered using SM-2.  A failed
+//!        word starts over and is due again right away with its ease kept,
+//!        and a passed one waits one day, then six, then grows by its ease.
+//! @param word The LwWord that was reviewed
+//! @param grade How well the word was remembered
+//! @param hours The time of the review as given by lw_scheduler_get_hours
+//!
+void
+lw_scheduler_review_word (LwWord *word, LwSchedulerGrade grade, guint32 hours)
+{
+    //Sanity checks
+    g_return_if_fail (word != NULL);
+
+    //Declarations
+    gint quality;
+    gint ease;
+    gint interval;
+    gint64 next;
+
+    //Initializations
+    quality = CLAMP ((gint) grade, 0, 5);
+    ease = lw_word_get_ease (word);
+    interval = lw_word_get_interval (word);
+
+    if (quality < LW_SCHEDULER_GRADE_HARD)
+    {
+      //A lapse restarts the repetitions but leaves the ease as it was
+      interval = 0;
+    }
+    else
+    {
+      //EF' = EF + (0.1 - (5 - q) * (0.08 + (5 - q) * 0.02)) in thousandths
+      ease += 100 - (5 - quality) * (80 + (5 - quality) * 20);
+      if (ease < LW_WORD_MIN_EASE) ease = LW_WORD_MIN_EASE;
+
+      if (interval == 0)
+      {
+        interval = 1;
+      }
+      else if (interval == 1)
+      {
+        interval = 6;
+      }
+      else
+      {
+        next = ((gint64) interval * ease + 500) / 1000;
+        interval = (gint) MIN (next, LW_SCHEDULER_MAX_INTERVAL);
+      }
+    }
+
+    lw_word_set_ease (word, ease);
+    lw_word_set_interval (word, interval);
+    lw_word_set_hours (word, hours);
+}
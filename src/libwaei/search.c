@@ -32,6 +32,7 @@
 #include <string.h>
 
 #include <glib.h>
+#include <glib/gstdio.h>
 
 #include <libwaei/libwaei.h>
 #include <libwaei/gettext.h>
@@ -79,6 +80,9 @@ lw_search_new (LwDictionary* dictionary, const gchar* QUERY, LwSearchFlags flags
 //! All of the various interally allocated memory in the LwSearch is freed.
 //! The file descriptiors and such are made sure to also be closed.
 //!
+//! If a thread of the LwSearchPool is still in the middle of the search, it
+//! is only canceled here and the thread frees it when it lets go of it.
+//!
 //! @param search The LwSearch to have it's memory freed.
 //!
 void 
@@ -87,6 +91,14 @@ lw_search_free (LwSearch* search)
     //Sanity check
     g_return_if_fail (search != NULL);
 
+    lw_search_cancel (search);
+
+    //The data belongs to the caller's side so it goes now
+    if (lw_search_has_data (search))
+      lw_search_free_data (search);
+
+    if (lw_searchpool_orphan (lw_searchpool_get_default (), search)) return;
+
     lw_search_deinit (search);
 
     free (search);
@@ -106,14 +118,46 @@ lw_search_free (LwSearch* search)
 static void
 lw_search_init (LwSearch *search, LwDictionary* dictionary, const gchar* TEXT, LwSearchFlags flags, GError **error)
 {
+    //Declarations
+    LwExampleIndex *index;
+    GQuark quark;
+
     g_mutex_init (&search->mutex);
     search->status = LW_SEARCHSTATUS_IDLE;
     search->dictionary = dictionary;
     search->query = lw_query_new ();
     search->flags = flags;
     search->max = 500;
+    search->snapshot.entries = g_array_new (FALSE, FALSE, sizeof(LwSearchSnapshotEntry));
+    search->matches.entries = g_array_new (FALSE, FALSE, sizeof(LwSearchSnapshotEntry));
+    search->candidates.entries = g_array_new (FALSE, FALSE, sizeof(LwSearchSnapshotEntry));
+    search->groups = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+    search->seen = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
 
     lw_search_set_flags (search, flags);
+    //Searches are made on the main thread so they go without corrections
+    //until the index is loaded instead of waiting for it
+    if (flags & LW_SEARCH_FLAG_FUZZY)
+      search->query->fuzzyindex = lw_fuzzyindex_peek_for_dictionary (dictionary);
+
+    //A word search is only answered from the example index, so it is loaded
+    //or built here, waiting for it, instead of scanning for the text later
+    if (flags & LW_SEARCH_FLAG_WORD)
+    {
+      quark = g_quark_from_string (LW_IO_ERROR);
+      if (!LW_IS_EXAMPLEDICTIONARY (dictionary))
+      {
+        g_set_error (error, quark, LW_IO_READ_ERROR, "Only the sentences of an Examples dictionary can be looked up by word");
+        return;
+      }
+      index = lw_exampleindex_get_for_dictionary (dictionary);
+      if (index == NULL)
+      {
+        g_set_error (error, quark, LW_IO_READ_ERROR, "The word index of the %s dictionary could not be built", lw_dictionary_get_name (dictionary));
+        return;
+      }
+      lw_exampleindex_unref (index); index = NULL;
+    }
 
     lw_dictionary_parse_query (search->dictionary, search->query, TEXT, error);
 }
@@ -128,12 +172,16 @@ lw_search_init (LwSearch *search, LwDictionary* dictionary, const gchar* TEXT, L
 static void 
 lw_search_deinit (LwSearch *search)
 {
-    lw_search_cancel (search);
     lw_search_clear_results (search);
     lw_search_cleanup_search (search);
     lw_query_free (search->query);
     if (lw_search_has_data (search))
       lw_search_free_data (search);
+    g_array_free (search->snapshot.entries, TRUE); search->snapshot.entries = NULL;
+    g_array_free (search->matches.entries, TRUE); search->matches.entries = NULL;
+    g_array_free (search->candidates.entries, TRUE); search->candidates.entries = NULL;
+    g_hash_table_unref (search->groups); search->groups = NULL;
+    g_hash_table_unref (search->seen); search->seen = NULL;
 
     g_mutex_clear (&search->mutex);
 }
@@ -149,6 +197,8 @@ lw_search_clear_results (LwSearch *search)
     gint i;
 
     memset(search->total_results, 0, sizeof(gint) * TOTAL_LW_RELEVANCE);
+    g_hash_table_remove_all (search->groups);
+    g_hash_table_remove_all (search->seen);
 
     for (i = 0; i < TOTAL_LW_RELEVANCE; i++)
     {
@@ -189,7 +239,6 @@ lw_search_prepare_search (LwSearch* search)
     search->result = lw_result_new ();
     search->current = 0L;
     memset(search->total_results, 0, sizeof(gint) * TOTAL_LW_RELEVANCE);
-    search->thread = NULL;
     search->fd = lw_dictionary_open (LW_DICTIONARY (search->dictionary));
     search->status = LW_SEARCHSTATUS_SEARCHING;
     search->timestamp = g_get_monotonic_time ();
@@ -225,6 +274,10 @@ lw_search_cleanup_search (LwSearch* search)
       search->result = NULL;
     }
 
+    //Nothing else can be grouped once the scan is over
+    g_hash_table_remove_all (search->groups);
+    g_hash_table_remove_all (search->seen);
+
     search->status = LW_SEARCHSTATUS_FINISHING;
 }
 
@@ -447,35 +500,581 @@ lw_search_get_relevance (LwSearch *search) {
 
 
 //!
-//! @brief Preforms the brute work of the search
+//! @brief Gets the size and modification time of the dictionary file of a search
+//! @param search The LwSearch to check the dictionary of
+//! @param size Set to the size of the file or -1 if it can't be read
+//! @param mtime Set to the modification time of the file in seconds
+//!
+static void
+lw_search_stat_dictionary (LwSearch *search, goffset *size, gint64 *mtime)
+{
+    //Declarations
+    GStatBuf info;
+    gchar *path;
+
+    //Initializations
+    path = lw_dictionary_get_path (search->dictionary);
+    *size = -1;
+    *mtime = 0;
+
+    if (path != NULL && g_stat (path, &info) == 0)
+    {
+      *size = (goffset) info.st_size;
+      *mtime = (gint64) info.st_mtime;
+    }
+
+    if (path != NULL) g_free (path); path = NULL;
+}
+
+
+static void
+lw_search_snapshot_clear (LwSearchSnapshot *snapshot)
+{
+    g_array_set_size (snapshot->entries, 0);
+    snapshot->size = -1;
+    snapshot->mtime = 0;
+    snapshot->complete = FALSE;
+}
+
+
+//!
+//! @brief Checks that a snapshot is complete and was taken from the
+//!        dictionary file as it is now
+//!
+static gboolean
+lw_search_snapshot_is_current (LwSearch *search, LwSearchSnapshot *snapshot)
+{
+    //Declarations
+    goffset size;
+    gint64 mtime;
+
+    if (!snapshot->complete) return FALSE;
+
+    lw_search_stat_dictionary (search, &size, &mtime);
+
+    return (size >= 0 && size == snapshot->size && mtime == snapshot->mtime);
+}
+
+
+//!
+//! @brief Checks if a search can be repeated from its snapshot.  The
+//!        dictionary file has to be the same one the snapshot was taken from.
+//! @param search The LwSearch to check
+//! @returns TRUE if the snapshot is complete and still matches the dictionary
+//!
+gboolean
+lw_search_has_snapshot (LwSearch *search)
+{
+    //Sanity checks
+    g_return_val_if_fail (search != NULL, FALSE);
+
+    return lw_search_snapshot_is_current (search, &search->snapshot);
+}
+
+
+void
+lw_search_clear_snapshot (LwSearch *search)
+{
+    //Sanity checks
+    g_return_if_fail (search != NULL);
+
+    lw_search_snapshot_clear (&search->snapshot);
+    lw_search_snapshot_clear (&search->matches);
+}
+
+
+//!
+//! @brief Writes the snapshot of a search as a single line of text in the
+//!        form "size;mtime;offset:relevance,offset:relevance..."
+//! @param search The LwSearch to get the snapshot of
+//! @returns An allocated string that should be freed with g_free or NULL
+//!          if the search has no complete snapshot
+//!
+gchar*
+lw_search_snapshot_to_string (LwSearch *search)
+{
+    //Sanity checks
+    g_return_val_if_fail (search != NULL, NULL);
+    if (!search->snapshot.complete) return NULL;
+
+    //Declarations
+    GString *text;
+    LwSearchSnapshotEntry *entry;
+    guint i;
+
+    //Initializations
+    text = g_string_new (NULL);
+
+    g_string_append_printf (text, "%" G_GINT64_FORMAT ";%" G_GINT64_FORMAT ";", (gint64) search->snapshot.size, search->snapshot.mtime);
+    for (i = 0; i < search->snapshot.entries->len; i++)
+    {
+      entry = &g_array_index (search->snapshot.entries, LwSearchSnapshotEntry, i);
+      if (i > 0) g_string_append_c (text, ',');
+      g_string_append_printf (text, "%ld:%d", entry->offset, entry->relevance);
+    }
+
+    return g_string_free (text, FALSE);
+}
+
+
+//!
+//! @brief Restores a snapshot written by lw_search_snapshot_to_string
+//! @param search The LwSearch to set the snapshot of
+//! @param TEXT The snapshot text
+//! @returns FALSE if the text couldn't be understood, in which case the
+//!          search is left without a snapshot
+//!
+gboolean
+lw_search_set_snapshot_from_string (LwSearch *search, const gchar *TEXT)
+{
+    //Sanity checks
+    g_return_val_if_fail (search != NULL, FALSE);
+    g_return_val_if_fail (TEXT != NULL, FALSE);
+
+    //Declarations
+    LwSearchSnapshotEntry entry;
+    gchar *ptr;
+    gchar *endptr;
+    gint64 number;
+
+    //Initializations
+    lw_search_clear_snapshot (search);
+    ptr = (gchar*) TEXT;
+
+    number = g_ascii_strtoll (ptr, &endptr, 10);
+    if (endptr == ptr || *endptr != ';') goto errored;
+    search->snapshot.size = (goffset) number;
+    ptr = endptr + 1;
+
+    number = g_ascii_strtoll (ptr, &endptr, 10);
+    if (endptr == ptr || *endptr != ';') goto errored;
+    search->snapshot.mtime = number;
+    ptr = endptr + 1;
+
+    while (*ptr != '\0')
+    {
+      number = g_ascii_strtoll (ptr, &endptr, 10);
+      if (endptr == ptr || *endptr != ':' || number < 0) goto errored;
+      entry.offset = (glong) number;
+      ptr = endptr + 1;
+
+      number = g_ascii_strtoll (ptr, &endptr, 10);
+      if (endptr == ptr || number < 0 || number >= TOTAL_LW_RELEVANCE) goto errored;
+      entry.relevance = (LwRelevance) number;
+      ptr = endptr;
+
+      g_array_append_val (search->snapshot.entries, entry);
+
+      if (*ptr == ',') ptr++;
+      else if (*ptr != '\0') goto errored;
+    }
+
+    search->snapshot.complete = TRUE;
+
+    return TRUE;
+
+errored:
+    lw_search_clear_snapshot (search);
+    return FALSE;
+}
+
+
+//!
+//! @brief Makes a new search that only reads back the lines another search
+//!        found so far.  Started with lw_search_start, it drops the same
+//!        duplicates and groups the same variants as the other search did.
+//!        Used to print what a search window shows while the search goes on.
+//! @param search The LwSearch to copy the snapshot of
+//! @returns A new LwSearch that should be freed with lw_search_free or NULL
+//!          if the query couldn't be parsed again
+//!
+LwSearch*
+lw_search_new_from_snapshot (LwSearch *search)
+{
+    //Sanity checks
+    g_return_val_if_fail (search != NULL, NULL);
+
+    //Declarations
+    LwSearch *copy;
+    GError *error;
+
+    //Initializations
+    error = NULL;
+    copy = lw_search_new (search->dictionary, lw_query_get_text (search->query), search->flags, &error);
+    if (error != NULL) g_error_free (error); error = NULL;
+    if (copy == NULL) return NULL;
+
+    lw_search_lock (search);
+    g_array_append_vals (copy->snapshot.entries, search->snapshot.entries->data, search->snapshot.entries->len);
+    copy->snapshot.size = search->snapshot.size;
+    copy->snapshot.mtime = search->snapshot.mtime;
+    copy->max = search->max;
+    lw_search_unlock (search);
+
+    //The lines found so far are all there is to the copy
+    copy->snapshot.complete = TRUE;
+
+    return copy;
+}
+
+
+//!
+//! @brief Adds the current result of a search to its results.  An entry that
+//!        was already found is dropped, and an edict style entry with the same
+//!        definitions as one still waiting in the results is grouped under it
+//!        as a variant.  Neither uses up one of the max results.
+//!
+//! THIS IS A PRIVATE FUNCTION. The search should be locked.
+//!
+//! @param search The LwSearch whose current result to add
+//! @param relevance The relevance of the current result
+//! @returns TRUE if the result was added as a new result
+//!
+static gboolean
+lw_search_add_result (LwSearch *search, LwRelevance relevance)
+{
+    //Declarations
+    LwResult *result;
+    LwResult *group;
+    gchar *key;
+    gchar *entry;
+
+    //Initializations
+    result = search->result;
+    result->relevance = relevance;
+    key = NULL;
+
+    if (g_type_is_a (G_OBJECT_TYPE (search->dictionary), LW_TYPE_EDICTIONARY))
+      key = lw_result_get_definitions_key (result);
+
+    if (key != NULL)
+    {
+      entry = g_strdup_printf ("%s\t%s\t%s", 
+        (result->kanji_start != NULL) ? result->kanji_start : "",
+        (result->furigana_start != NULL) ? result->furigana_start : "",
+        key
+      );
+      if (g_hash_table_lookup (search->seen, entry) != NULL)
+      {
+        g_free (entry); entry = NULL;
+        g_free (key); key = NULL;
+        return FALSE;
+      }
+      g_hash_table_insert (search->seen, entry, GINT_TO_POINTER (TRUE));
+
+      group = LW_RESULT (g_hash_table_lookup (search->groups, key));
+      if (group != NULL)
+      {
+        lw_result_add_variant (group, result);
+
+        //A more relevant variant moves the whole group up
+        if (relevance > group->relevance)
+        {
+          search->results[group->relevance] = g_list_remove (search->results[group->relevance], group);
+          search->total_results[group->relevance]--;
+          group->relevance = relevance;
+          search->results[relevance] = g_list_append (search->results[relevance], group);
+          search->total_results[relevance]++;
+        }
+
+        g_free (key); key = NULL;
+        return FALSE;
+      }
+      g_hash_table_insert (search->groups, key, result);
+    }
+
+    search->total_results[relevance]++;
+    search->results[relevance] = g_list_append (search->results[relevance], result);
+    search->result = lw_result_new ();
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Reads the next line of the dictionary file
+//!
+//! THIS IS A PRIVATE FUNCTION. Every line is compared with the query and
+//! the matching ones are added to the results until the max is reached.  All
+//! of the matches are remembered for searches that refine this one.
+//!
+//! @param search A LwSearch to search with
+//! @return Returns FALSE when the end of the file is reached
+//!
+static gboolean
+lw_search_stream_dictionary_step (LwSearch *search)
+{
+    //Declarations
+    LwSearchSnapshotEntry entry;
+    gboolean exact;
+    gint relevance;
+
+    //Initializations
+    exact = search->flags & LW_SEARCH_FLAG_EXACT;
+    entry.offset = search->current;
+
+    if (!lw_search_parse_result (search)) return FALSE;
+
+    //Results match, add to the text buffer
+    if (lw_search_compare (search, LW_RELEVANCE_LOW))
+    {
+      relevance = lw_search_get_relevance (search);
+      entry.relevance = relevance;
+      g_array_append_val (search->matches.entries, entry);
+      if (search->total_results[relevance] < search->max)
+      {
+        if (!exact || (relevance == LW_RELEVANCE_HIGH && exact))
+        {
+          //Variants are kept in the snapshot too so a repeat groups them the same way
+          g_array_append_val (search->snapshot.entries, entry);
+          lw_search_add_result (search, relevance);
+        }
+      }
+    }
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Reads the next line of the snapshot
+//!
+//! THIS IS A PRIVATE FUNCTION. Instead of scanning the whole dictionary, only
+//! the lines the last complete run of the search matched are read again.
+//!
+//! @param search A LwSearch with a valid snapshot
+//! @return Returns FALSE when every line of the snapshot was read
+//!
+static gboolean
+lw_search_stream_snapshot_step (LwSearch *search)
+{
+    //Declarations
+    LwSearchSnapshotEntry *entry;
+
+    if (search->position >= search->snapshot.entries->len) return FALSE;
+
+    entry = &g_array_index (search->snapshot.entries, LwSearchSnapshotEntry, search->position);
+    if (fseek (search->fd, entry->offset, SEEK_SET) != 0) return FALSE;
+    search->current = entry->offset;
+    if (!lw_search_parse_result (search)) return FALSE;
+
+    lw_search_add_result (search, entry->relevance);
+    search->position++;
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Reads the next of the lines a parent search matched
 //!
-//! THIS IS A PRIVATE FUNCTION. This function returns true until it finishes
-//! searching the whole file.  It works in specified chunks before going back to
-//! the thread to help improve speed.  
+//! THIS IS A PRIVATE FUNCTION. Works like lw_search_stream_dictionary_step but
+//! seeks to each of the candidate lines instead of reading the whole file.
 //!
-//! @param data A LwSearch to search with
-//! @return Returns true when the search isn't finished yet.
+//! @param search A LwSearch with candidates set by lw_search_set_parent
+//! @return Returns FALSE when every candidate was read
 //!
-static gpointer 
-lw_search_stream_results_thread (gpointer data)
+static gboolean
+lw_search_stream_candidates_step (LwSearch *search)
 {
     //Declarations
-    LwSearch *search;
+    LwSearchSnapshotEntry *candidate;
+    LwSearchSnapshotEntry entry;
     gboolean exact;
     gint relevance;
 
+    if (search->position >= search->candidates.entries->len) return FALSE;
+
     //Initializations
-    search = LW_SEARCH (data);
-    g_return_val_if_fail (search != NULL && search->fd != NULL, NULL);
     exact = search->flags & LW_SEARCH_FLAG_EXACT;
+    candidate = &g_array_index (search->candidates.entries, LwSearchSnapshotEntry, search->position);
+
+    if (fseek (search->fd, candidate->offset, SEEK_SET) != 0) return FALSE;
+    search->current = candidate->offset;
+    if (!lw_search_parse_result (search)) return FALSE;
+
+    if (lw_search_compare (search, LW_RELEVANCE_LOW))
+    {
+      relevance = lw_search_get_relevance (search);
+      entry.offset = candidate->offset;
+      entry.relevance = relevance;
+      g_array_append_val (search->matches.entries, entry);
+      if (search->total_results[relevance] < search->max && (!exact || relevance == LW_RELEVANCE_HIGH))
+      {
+        g_array_append_val (search->snapshot.entries, entry);
+        lw_search_add_result (search, relevance);
+      }
+    }
+    search->position++;
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Reads the next of the sentences the word of the search is used in
+//!
+//! THIS IS A PRIVATE FUNCTION. The example index already matched the word
+//! with the dictionary forms of the sentence, which the sentence itself may
+//! only have conjugated, so the lines aren't compared again.
+//!
+//! @param search A LwSearch with candidates set from the example index
+//! @return Returns FALSE when every sentence was read
+//!
+static gboolean
+lw_search_stream_postings_step (LwSearch *search)
+{
+    //Declarations
+    LwSearchSnapshotEntry *candidate;
+    LwSearchSnapshotEntry entry;
+
+    if (search->position >= search->candidates.entries->len) return FALSE;
 
+    //Initializations
+    candidate = &g_array_index (search->candidates.entries, LwSearchSnapshotEntry, search->position);
+
+    if (fseek (search->fd, candidate->offset, SEEK_SET) != 0) return FALSE;
+    search->current = candidate->offset;
+    if (!lw_search_parse_result (search)) return FALSE;
+
+    entry = *candidate;
+    g_array_append_val (search->matches.entries, entry);
+    if (search->total_results[entry.relevance] < search->max)
+    {
+      g_array_append_val (search->snapshot.entries, entry);
+      lw_search_add_result (search, entry.relevance);
+    }
+    search->position++;
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Gets a search ready to be streamed from the source lw_search_start picked
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static void
+lw_search_stream_begin (LwSearch *search)
+{
     lw_search_lock (search);
+
     search->status = LW_SEARCHSTATUS_SEARCHING;
+    search->position = 0;
+
+    switch (search->stream)
+    {
+      case LW_SEARCH_STREAM_DICTIONARY:
+        lw_search_clear_snapshot (search);
+        lw_search_stat_dictionary (search, &search->snapshot.size, &search->snapshot.mtime);
+        search->matches.size = search->snapshot.size;
+        search->matches.mtime = search->snapshot.mtime;
+        break;
+      case LW_SEARCH_STREAM_CANDIDATES:
+      case LW_SEARCH_STREAM_POSTINGS:
+        lw_search_clear_snapshot (search);
+        search->snapshot.size = search->matches.size = search->candidates.size;
+        search->snapshot.mtime = search->matches.mtime = search->candidates.mtime;
+        break;
+      default:
+        break;
+    }
+
+    lw_search_unlock (search);
+}
+
+
+//!
+//! @brief Marks what a search found as complete if it wasn't stopped early
+//!        and closes the dictionary file.  A canceled search goes back to
+//!        idle.  The search lock should be held.
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static void
+lw_search_stream_finish (LwSearch *search)
+{
+    //Declarations
+    gboolean complete;
+    gboolean canceled;
 
-    //We loop, processing lines of the file until the max chunk size has been
-    //reached or we reach the end of the file or a cancel request is recieved.
-    while (lw_search_parse_result (search))
+    //Initializations
+    complete = (search->status == LW_SEARCHSTATUS_SEARCHING);
+    canceled = (search->status == LW_SEARCHSTATUS_CANCELING);
+
+    switch (search->stream)
+    {
+      case LW_SEARCH_STREAM_DICTIONARY:
+        //Only a search that went through the whole file can stand in for it
+        search->snapshot.complete = search->matches.complete = complete;
+        break;
+      case LW_SEARCH_STREAM_CANDIDATES:
+      case LW_SEARCH_STREAM_POSTINGS:
+        //Checking every candidate is as good as going through the whole file
+        complete = complete && (search->position == search->candidates.entries->len);
+        search->snapshot.complete = search->matches.complete = complete;
+        break;
+      default:
+        break;
+    }
+
+    lw_search_cleanup_search (search);
+
+    if (canceled)
+    {
+      search->cancel = FALSE;
+      search->status = LW_SEARCHSTATUS_IDLE;
+    }
+}
+
+
+//!
+//! @brief Preforms the brute work of the search for a slice of time
+//!
+//! Lines are read until the slice is used up, the search is canceled, or
+//! there is nothing left to read.  The lock is let go of between lines so
+//! results can be taken out while the search runs.  Once the search stops
+//! for good the dictionary file is closed.
+//!
+//! @param search A LwSearch that was started with lw_search_start
+//! @param slice Microseconds to run for or -1 to run until the search is done
+//! @return Returns TRUE when the search isn't finished yet
+//!
+gboolean
+lw_search_stream (LwSearch *search, gint64 slice)
+{
+    //Sanity checks
+    g_return_val_if_fail (search != NULL, FALSE);
+
+    //Declarations
+    gint64 deadline;
+    gboolean more;
+
+    //Initializations
+    deadline = (slice < 0) ? -1 : g_get_monotonic_time () + slice;
+
+    lw_search_lock (search);
+    more = (search->status == LW_SEARCHSTATUS_SEARCHING && search->fd != NULL);
+
+    while (more)
     {
+      switch (search->stream)
+      {
+        case LW_SEARCH_STREAM_SNAPSHOT:
+          more = lw_search_stream_snapshot_step (search);
+          break;
+        case LW_SEARCH_STREAM_CANDIDATES:
+          more = lw_search_stream_candidates_step (search);
+          break;
+        case LW_SEARCH_STREAM_POSTINGS:
+          more = lw_search_stream_postings_step (search);
+          break;
+        default:
+          more = lw_search_stream_dictionary_step (search);
+          break;
+      }
+
       //Give a chance for something else to run
       lw_search_unlock (search);
       if (search->status == LW_SEARCHSTATUS_SEARCHING)
@@ -483,70 +1082,508 @@ lw_search_stream_results_thread (gpointer data)
         g_thread_yield ();
       }
       lw_search_lock (search);
-      //Results match, add to the text buffer
-      if (lw_search_compare (search, LW_RELEVANCE_LOW))
+
+      if (more && search->status != LW_SEARCHSTATUS_SEARCHING) more = FALSE;
+      if (more && deadline >= 0 && g_get_monotonic_time () >= deadline) break;
+    }
+
+    if (!more && (search->status == LW_SEARCHSTATUS_SEARCHING || search->status == LW_SEARCHSTATUS_CANCELING))
+    {
+      lw_search_stream_finish (search);
+    }
+
+    lw_search_unlock (search);
+
+    return more;
+}
+
+
+//!
+//! @brief Gets the low relevance tokens of a query that are matched with the
+//!        regexes of a query type.  Each token is a list of alternatives
+//!        of which one has to be found.
+//! @returns A GPtrArray of casefolded string arrays or NULL if any of the
+//!          tokens isn't plain text
+//!
+static GPtrArray*
+lw_search_get_literal_tokens (LwSearch *search, LwQueryType type)
+{
+    //Declarations
+    GPtrArray *tokens;
+    LwQueryType primary_type;
+    LwQueryType new_type;
+    gchar **tokenlist;
+    gchar *supplimentary;
+    gchar **alternatives;
+    gchar *temp;
+    gboolean literal;
+    gint i, j;
+
+    //Initializations
+    tokens = g_ptr_array_new_with_free_func ((GDestroyNotify) g_strfreev);
+    literal = TRUE;
+
+    for (primary_type = 0; primary_type < TOTAL_LW_QUERY_TYPES && literal; primary_type++)
+    {
+      tokenlist = lw_query_tokenlist_get (search->query, primary_type);
+      for (i = 0; tokenlist != NULL && tokenlist[i] != NULL && literal; i++)
       {
-        relevance = lw_search_get_relevance (search);
-        if (search->total_results[relevance] < search->max)
+        supplimentary = lw_query_get_supplimentary (search->query, LW_RELEVANCE_LOW, primary_type, tokenlist[i], &new_type);
+        if (supplimentary == NULL) supplimentary = g_strdup (tokenlist[i]);
+        if (new_type == type)
         {
-          if (!exact || (relevance == LW_RELEVANCE_HIGH && exact))
+          alternatives = g_strsplit (supplimentary, LW_QUERY_DELIMITOR_SUPPLIMENTARY_STRING, -1);
+          for (j = 0; alternatives[j] != NULL; j++)
           {
-            search->total_results[relevance]++;
-            search->result->relevance = relevance;
-            search->results[relevance] = g_list_append (search->results[relevance], search->result);
-            search->result = lw_result_new ();
+            if (*alternatives[j] == '\0' || strpbrk (alternatives[j], "\\^$.|?*+()[]{}") != NULL) literal = FALSE;
+            temp = g_utf8_casefold (alternatives[j], -1);
+            g_free (alternatives[j]); alternatives[j] = temp; temp = NULL;
           }
+          g_ptr_array_add (tokens, alternatives);
         }
+        g_free (supplimentary); supplimentary = NULL;
       }
     }
 
-    lw_search_cleanup_search (search);
+    if (!literal)
+    {
+      g_ptr_array_free (tokens, TRUE);
+      tokens = NULL;
+    }
 
-    lw_search_unlock (search);
+    return tokens;
+}
+
+
+//!
+//! @brief Checks that every line matching a token has to match another one.
+//!        That holds when each alternative of the narrow token contains one of
+//!        the alternatives of the wide token.
+//!
+static gboolean
+lw_search_token_implies (gchar **narrow, gchar **wide)
+{
+    //Declarations
+    gboolean found;
+    gint i, j;
+
+    for (i = 0; narrow[i] != NULL; i++)
+    {
+      found = FALSE;
+      for (j = 0; wide[j] != NULL && !found; j++)
+      {
+        found = (strstr (narrow[i], wide[j]) != NULL);
+      }
+      if (!found) return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Checks if the lines a search can match are provably a subset of
+//!        the lines a finished parent search matched.  That is the case when
+//!        both use plain text tokens with the same flags, neither is exact,
+//!        and every token of the parent is implied by a token of the search,
+//!        like when the search only makes a literal token of the parent
+//!        longer.  Anything less certain returns FALSE.
+//! @param search The new LwSearch
+//! @param parent A LwSearch that isn't running anymore
+//! @returns TRUE if search only has to look at the lines parent matched
+//!
+gboolean
+lw_search_is_refinement_of (LwSearch *search, LwSearch *parent)
+{
+    //Sanity checks
+    g_return_val_if_fail (search != NULL, FALSE);
+    if (parent == NULL || parent == search) return FALSE;
+
+    //Declarations
+    LwDictionaryClass *klass;
+    GPtrArray *narrow;
+    GPtrArray *wide;
+    LwQueryType type;
+    gboolean implied;
+    guint i, j;
+
+    if (search->dictionary != parent->dictionary) return FALSE;
+    if (search->flags != parent->flags) return FALSE;
+    //Exact searches always scan the whole dictionary, they aren't narrowed while typing
+    if (search->flags & LW_SEARCH_FLAG_EXACT) return FALSE;
+    //The corrections of a longer word have nothing to do with the ones of a shorter one
+    if (search->flags & LW_SEARCH_FLAG_FUZZY) return FALSE;
+    //The sentences of a longer word aren't among the ones of a shorter one
+    if (search->flags & LW_SEARCH_FLAG_WORD) return FALSE;
+    if (!lw_search_snapshot_is_current (parent, &parent->matches)) return FALSE;
+
+    //Ranges only exist on the parent side of the comparison if at all
+    if (parent->query->rangelist != NULL)
+    {
+      for (i = 0; i < TOTAL_LW_QUERY_RANGE_TYPES; i++)
+      {
+        if (parent->query->rangelist[i] != NULL) return FALSE;
+      }
+    }
+
+    //Initializations
+    klass = LW_DICTIONARY_CLASS (G_OBJECT_GET_CLASS (search->dictionary));
+    implied = TRUE;
+
+    for (type = 0; type < TOTAL_LW_QUERY_TYPES && implied; type++)
+    {
+      wide = lw_search_get_literal_tokens (parent, type);
+      narrow = lw_search_get_literal_tokens (search, type);
+
+      if (wide == NULL || narrow == NULL)
+      {
+        implied = FALSE;
+      }
+      else if (wide->len > 0)
+      {
+        //Only a plain substring match keeps a longer token inside the shorter one's matches
+        if (klass->patterns[type][LW_RELEVANCE_LOW] == NULL || strcmp(klass->patterns[type][LW_RELEVANCE_LOW], "(%s)") != 0)
+        {
+          implied = FALSE;
+        }
+        for (i = 0; i < wide->len && implied; i++)
+        {
+          implied = FALSE;
+          for (j = 0; j < narrow->len && !implied; j++)
+          {
+            implied = lw_search_token_implies (g_ptr_array_index (narrow, j), g_ptr_array_index (wide, i));
+          }
+        }
+      }
+
+      if (wide != NULL) g_ptr_array_free (wide, TRUE); wide = NULL;
+      if (narrow != NULL) g_ptr_array_free (narrow, TRUE); narrow = NULL;
+    }
+
+    return implied;
+}
+
+
+//!
+//! @brief Lets a search only go through the lines a parent search matched
+//!        instead of the whole dictionary if lw_search_is_refinement_of
+//!        allows it.  Otherwise the search will scan the dictionary as usual.
+//! @param search The LwSearch that hasn't been started yet
+//! @param parent The LwSearch it refines
+//! @returns TRUE if the search will use the lines of the parent
+//!
+gboolean
+lw_search_set_parent (LwSearch *search, LwSearch *parent)
+{
+    //Sanity checks
+    g_return_val_if_fail (search != NULL, FALSE);
+
+    //Declarations
+    gboolean refines;
+
+    //Initializations
+    lw_search_snapshot_clear (&search->candidates);
+    if (parent == NULL || parent == search) return FALSE;
+
+    lw_search_lock (parent);
+    refines = lw_search_is_refinement_of (search, parent);
+    if (refines)
+    {
+      g_array_append_vals (search->candidates.entries, parent->matches.entries->data, parent->matches.entries->len);
+      search->candidates.size = parent->matches.size;
+      search->candidates.mtime = parent->matches.mtime;
+      search->candidates.complete = TRUE;
+    }
+    lw_search_unlock (parent);
+
+    return refines;
+}
+
+
+//!
+//! @brief Checks if a search will only go through the lines of its parent
+//! @param search The LwSearch to check
+//! @returns TRUE if the candidates are set and still match the dictionary
+//!
+gboolean
+lw_search_has_candidates (LwSearch *search)
+{
+    //Sanity checks
+    g_return_val_if_fail (search != NULL, FALSE);
+
+    return lw_search_snapshot_is_current (search, &search->candidates);
+}
+
+
+//!
+//! @brief Forgets the candidates of a search so it goes through the whole
+//!        dictionary unless it finds others when it starts
+//! @param search The LwSearch to clear the candidates of
+//!
+void
+lw_search_clear_candidates (LwSearch *search)
+{
+    //Sanity checks
+    g_return_if_fail (search != NULL);
+
+    lw_search_snapshot_clear (&search->candidates);
+}
+
+
+//!
+//! @brief Gets the kanji the ranges of a search could match from the number
+//!        index of the dictionary, so the search only reads their lines
+//!
+//! THIS IS A PRIVATE FUNCTION. The index isn't waited for, so searches go
+//! through the whole dictionary while it is loaded in another thread.
+//!
+//! @param search A LwSearch of a Kanji dictionary
+//! @returns TRUE if the candidates were set from the index
+//!
+static gboolean
+lw_search_set_candidates_from_index (LwSearch *search)
+{
+    //Declarations
+    LwKanjiIndex *index;
+    LwSearchSnapshotEntry entry;
+    GArray *offsets;
+    goffset size;
+    gint64 mtime;
+    guint i;
+
+    //Initializations
+    if (search->query == NULL || search->query->rangelist == NULL) return FALSE;
+    if (!LW_IS_KANJIDICTIONARY (search->dictionary)) return FALSE;
+    index = lw_kanjiindex_peek_for_dictionary (search->dictionary);
+    if (index == NULL) return FALSE;
+    offsets = NULL;
+
+    lw_search_stat_dictionary (search, &size, &mtime);
+    if (size >= 0 && (gsize) size == index->stamp.size && mtime == index->stamp.mtime)
+      offsets = lw_kanjiindex_filter (index, search->query);
+
+    if (offsets != NULL)
+    {
+      lw_search_snapshot_clear (&search->candidates);
+      entry.relevance = LW_RELEVANCE_LOW;
+      for (i = 0; i < offsets->len; i++)
+      {
+        entry.offset = g_array_index (offsets, glong, i);
+        g_array_append_val (search->candidates.entries, entry);
+      }
+      search->candidates.size = size;
+      search->candidates.mtime = mtime;
+      search->candidates.complete = TRUE;
+      g_array_free (offsets, TRUE); offsets = NULL;
+    }
+
+    lw_kanjiindex_unref (index); index = NULL;
+
+    return lw_search_has_candidates (search);
+}
+
+
+//!
+//! @brief Gets the sentences the word of a search is used in from the
+//!        example index of the dictionary
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+//! @param search A LwSearch of an Examples dictionary with LW_SEARCH_FLAG_WORD
+//! @returns TRUE if the candidates were set from the index
+//!
+static gboolean
+lw_search_set_candidates_from_postings (LwSearch *search)
+{
+    //Declarations
+    LwExampleIndex *index;
+    LwSearchSnapshotEntry entry;
+    GArray *offsets;
+    gchar *word;
+    goffset size;
+    gint64 mtime;
+    guint i;
+
+    //Initializations
+    if (search->query == NULL || lw_query_get_text (search->query) == NULL) return FALSE;
+    index = lw_exampleindex_get_for_dictionary (search->dictionary);
+    if (index == NULL) return FALSE;
+    word = g_strstrip (g_strdup (lw_query_get_text (search->query)));
+    offsets = NULL;
+
+    lw_search_stat_dictionary (search, &size, &mtime);
+    if (size < 0 || (gsize) size != index->stamp.size || mtime != index->stamp.mtime) goto errored;
+
+    //A word used nowhere has no sentences rather than needing a full search
+    offsets = lw_exampleindex_lookup (index, word);
+
+    lw_search_snapshot_clear (&search->candidates);
+    entry.relevance = LW_RELEVANCE_HIGH;
+    for (i = 0; offsets != NULL && i < offsets->len; i++)
+    {
+      entry.offset = g_array_index (offsets, glong, i);
+      g_array_append_val (search->candidates.entries, entry);
+    }
+    search->candidates.size = size;
+    search->candidates.mtime = mtime;
+    search->candidates.complete = TRUE;
+
+    if (offsets != NULL) g_array_free (offsets, TRUE); offsets = NULL;
+    g_free (word); word = NULL;
+    lw_exampleindex_unref (index); index = NULL;
+
+    return TRUE;
+
+errored:
+    g_free (word); word = NULL;
+    lw_exampleindex_unref (index); index = NULL;
+
+    return FALSE;
+}
+
+
+//!
+//! @brief Checks if a casefolded literal has letters other than ASCII
+//!        ones that have a case, which a bytewise comparison would miss
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static gboolean
+lw_search_literal_has_unicode_case (const gchar *LITERAL)
+{
+    //Declarations
+    const gchar *ptr;
+    gunichar c;
+
+    for (ptr = LITERAL; *ptr != '\0'; ptr = g_utf8_next_char (ptr))
+    {
+      c = g_utf8_get_char (ptr);
+      if (c > 0x7f && (g_unichar_islower (c) || g_unichar_isupper (c) || g_unichar_istitle (c))) return TRUE;
+    }
+
+    return FALSE;
+}
+
+
+//!
+//! @brief Gets the alternatives of one of the tokens of a search.  Every line
+//!        the search can match contains one of them, so lines without any of
+//!        them don't need to be compared.  The token whose shortest
+//!        alternative is the longest is picked since it rules out the most.
+//! @param search The LwSearch to get the literals of
+//! @returns A casefolded NULL terminated array to be freed with g_strfreev or
+//!          NULL if no token of the search is plain text ASCII or kana/kanji
+//!
+gchar**
+lw_search_get_required_literals (LwSearch *search)
+{
+    //Sanity checks
+    g_return_val_if_fail (search != NULL, NULL);
 
-    return NULL;
+    //Declarations
+    LwDictionaryClass *klass;
+    GPtrArray *tokens;
+    gchar **alternatives;
+    gchar **literals;
+    LwQueryType type;
+    gint literals_length;
+    gint length;
+    guint i;
+    gint j;
+
+    //Initializations
+    klass = LW_DICTIONARY_CLASS (G_OBJECT_GET_CLASS (search->dictionary));
+    literals = NULL;
+    literals_length = 0;
+
+    for (type = 0; type < TOTAL_LW_QUERY_TYPES; type++)
+    {
+      //Other patterns could match the tokens in a way that isn't a plain substring
+      if (klass->patterns[type][LW_RELEVANCE_LOW] == NULL || strcmp(klass->patterns[type][LW_RELEVANCE_LOW], "(%s)") != 0) continue;
+
+      tokens = lw_search_get_literal_tokens (search, type);
+      for (i = 0; tokens != NULL && i < tokens->len; i++)
+      {
+        alternatives = g_ptr_array_index (tokens, i);
+        length = G_MAXINT;
+        for (j = 0; alternatives[j] != NULL && length > 0; j++)
+        {
+          if (lw_search_literal_has_unicode_case (alternatives[j])) length = 0;
+          else length = MIN (length, strlen (alternatives[j]));
+        }
+        if (length > literals_length)
+        {
+          if (literals != NULL) g_strfreev (literals);
+          literals = g_strdupv (alternatives);
+          literals_length = length;
+        }
+      }
+      if (tokens != NULL) g_ptr_array_free (tokens, TRUE); tokens = NULL;
+    }
+
+    return literals;
 }
 
 
 //!
 //! @brief Start a dictionary search
 //! @param search a LwSearch argument to calculate results
-//! @param create_thread Whether the search should run in a new thread.
+//! @param create_thread Whether the search should run in the LwSearchPool
+//!                      instead of before this function returns
 //! @param exact Whether to show only exact matches for this search
 //!
 void 
 lw_search_start (LwSearch *search, gboolean create_thread)
 {
-    GError *error;
-
-    error = NULL;
+    //Sanity checks
+    g_return_if_fail (search != NULL);
 
-    lw_search_prepare_search (search);
-    if (create_thread)
+    //Declarations
+    LwSearchPool *pool;
+
+    //A search started again while it is still in the pool is canceled
+    //there instead of being run to the end first
+    lw_searchpool_remove (lw_searchpool_get_default (), search);
+
+    //Searches from the history don't need to go through the dictionary again
+    if (lw_search_has_snapshot (search))
+      search->stream = LW_SEARCH_STREAM_SNAPSHOT;
+    //The examples of a word are looked up instead of searched for.  Scanning
+    //for the text would find other sentences, so if the index went missing
+    //since lw_search_new checked for it, the search finds nothing.
+    else if (search->flags & LW_SEARCH_FLAG_WORD)
     {
-      search->thread = g_thread_try_new (
-        "libwaei-search",
-        (GThreadFunc) lw_search_stream_results_thread, 
-        (gpointer) search, 
-        &error
-      );
-      if (search->thread == NULL)
-      {
-        g_warning ("Thread Creation Error: %s\n", error->message);
-        g_error_free (error);
-        error = NULL;
-      }
+      if (!lw_search_set_candidates_from_postings (search))
+        lw_search_clear_candidates (search);
+      search->stream = LW_SEARCH_STREAM_POSTINGS;
     }
+    //Refinements of a finished search only go through the lines it matched
+    else if (lw_search_has_candidates (search))
+      search->stream = LW_SEARCH_STREAM_CANDIDATES;
+    //Kanji ranges like "S5-7 G2" only go through the kanji the index kept
+    else if (lw_search_set_candidates_from_index (search))
+      search->stream = LW_SEARCH_STREAM_CANDIDATES;
     else
+      search->stream = LW_SEARCH_STREAM_DICTIONARY;
+
+    lw_search_prepare_search (search);
+    lw_search_stream_begin (search);
+
+    //Searches share the threads of the pool instead of getting their own
+    pool = (create_thread) ? lw_searchpool_get_default () : NULL;
+    if (pool == NULL || !lw_searchpool_push (pool, search))
     {
-      search->thread = NULL;
-      lw_search_stream_results_thread ((gpointer) search);
+      while (lw_search_stream (search, -1));
     }
 }
 
 
 //!
-//! @brief Uses a searchitem to cancel a window
+//! @brief Cancels a search without waiting for it.  The search stops at the
+//!        next line it reads, and goes back to idle once the thread of the
+//!        LwSearchPool running it lets go of it.  Searches that aren't
+//!        running are stopped right away.  A search that already finished
+//!        is only taken out of the pool so its snapshot stays complete.
 //!
 //! @param search A LwSearch to gleam information from
 //!
@@ -555,17 +1592,40 @@ lw_search_cancel (LwSearch *search)
 {
     if (search == NULL) return;
 
-    search->cancel = TRUE;
-    lw_search_set_status (search, LW_SEARCHSTATUS_CANCELING);
+    //Declarations
+    gboolean searching;
+
+    lw_search_lock (search);
+    searching = (search->status == LW_SEARCHSTATUS_SEARCHING && search->fd != NULL);
+    if (searching)
+    {
+      search->cancel = TRUE;
+      search->status = LW_SEARCHSTATUS_CANCELING;
+    }
+    lw_search_unlock (search);
 
-    if (search->thread != NULL)
+    //The search reads the status after every line, so a running one stops by itself
+    if (!lw_searchpool_cancel (lw_searchpool_get_default (), search) && searching)
     {
-      g_thread_join (search->thread);
-      search->thread = NULL;
+      while (lw_search_stream (search, -1));
     }
+}
 
-    search->cancel = FALSE;
-    lw_search_set_status (search, LW_SEARCHSTATUS_IDLE);
+
+//!
+//! @brief Sets how much the search is preferred over others that are
+//!        running at the same time.  Searches start out as interactive.
+//! @param search The LwSearch to set the priority of
+//! @param priority The new LwSearchPriority
+//!
+void
+lw_search_set_priority (LwSearch *search, LwSearchPriority priority)
+{
+    //Sanity checks
+    g_return_if_fail (search != NULL);
+    g_return_if_fail (priority < TOTAL_LW_SEARCH_PRIORITIES);
+
+    lw_searchpool_set_priority (lw_searchpool_get_default (), search, priority);
 }
 
 
@@ -583,6 +1643,7 @@ lw_search_get_result (LwSearch *search)
     LwResult *result;
     gint relevance;
     gint stop;
+    gchar *key;
 
     //Initializations
     result = NULL; 
@@ -601,6 +1662,15 @@ lw_search_get_result (LwSearch *search)
       }
     }
 
+    //Entries found after this one is taken can't be grouped under it anymore
+    if (result != NULL && g_hash_table_size (search->groups) > 0)
+    {
+      key = lw_result_get_definitions_key (result);
+      if (key != NULL && g_hash_table_lookup (search->groups, key) == result)
+        g_hash_table_remove (search->groups, key);
+      if (key != NULL) g_free (key); key = NULL;
+    }
+
     if (result == NULL && search->status == LW_SEARCHSTATUS_FINISHING) search->status = LW_SEARCHSTATUS_IDLE;
 
     lw_search_unlock (search);
@@ -726,9 +1796,9 @@ lw_search_get_flags_from_preferences (LwPreferences *preferences)
     g_return_val_if_fail (preferences != NULL, 0);
 
     //Declarations
+    LwPreferencesSnapshot snapshot;
     gboolean hiragana_to_katakana;
     gboolean katakana_to_hiragana;
-    gint romaji_to_furigana;
     gboolean want_romaji_to_furigana_conv;
     gboolean delimit_whitespace;
     gboolean delimit_morphology;
@@ -736,10 +1806,10 @@ lw_search_get_flags_from_preferences (LwPreferences *preferences)
     gint32 flags;
 
     //Initializations
-    hiragana_to_katakana = lw_preferences_get_boolean_by_schema (preferences, LW_SCHEMA_BASE, LW_KEY_HIRA_KATA);
-    katakana_to_hiragana = lw_preferences_get_boolean_by_schema (preferences, LW_SCHEMA_BASE, LW_KEY_KATA_HIRA);
-    romaji_to_furigana = lw_preferences_get_int_by_schema (preferences, LW_SCHEMA_BASE, LW_KEY_ROMAN_KANA);
-    want_romaji_to_furigana_conv = (romaji_to_furigana == 0 || (romaji_to_furigana == 2 && !lw_util_is_japanese_locale()));
+    lw_preferences_get_snapshot (preferences, &snapshot);
+    hiragana_to_katakana = snapshot.query_hiragana_to_katakana;
+    katakana_to_hiragana = snapshot.query_katakana_to_hiragana;
+    want_romaji_to_furigana_conv = snapshot.want_romaji_to_kana;
     delimit_whitespace = LW_QUERY_FLAG_DELIMIT_WHITESPACE;
     delimit_morphology = LW_QUERY_FLAG_DELIMIT_MORPHOLOGY;
     root_word = LW_QUERY_FLAG_ROOT_WORD;
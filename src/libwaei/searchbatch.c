@@ -0,0 +1,470 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file searchbatch.c
+//!
+//! @brief Runs many searches of a dictionary with a single pass over the
+//!        file.  The literals every match of each search has to contain are
+//!        put in an Aho-Corasick automaton, so one read of a line tells which
+//!        searches could match it.  Each search then only compares the lines
+//!        it was handed, the same way a refinement only goes through the
+//!        lines of its parent.  waei --batch looks up word lists with it.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <libwaei/libwaei.h>
+
+
+//!
+//! @brief A state of the automaton, which is a node of the trie of literals
+//!
+struct _LwSearchBatchState {
+  guint32 child;    //First state one byte further or 0 if there are none
+  guint32 sibling;  //Next child of the same parent or 0 if there are none
+  guint32 fail;     //State of the longest proper suffix of this one that is in the trie
+  guint32 output;   //Nearest state along the fail links where a literal ends or 0
+  guint32 route;    //First LwSearchBatchRoute of the literals ending here or 0
+  guchar c;         //Byte leading to the state from its parent
+};
+typedef struct _LwSearchBatchState LwSearchBatchState;
+
+//!
+//! @brief A search a literal ending in a state belongs to
+//!
+struct _LwSearchBatchRoute {
+  guint32 search;   //Position of the search in the batch
+  guint32 next;     //Next route of the same state or 0
+};
+typedef struct _LwSearchBatchRoute LwSearchBatchRoute;
+
+struct _LwSearchBatchAutomaton {
+  GArray *states;   //LwSearchBatchStates with the root first
+  GArray *routes;   //LwSearchBatchRoutes with an unused one first so 0 can mean none
+  guint32 root[256];  //The state each byte leads to from the root
+};
+typedef struct _LwSearchBatchAutomaton LwSearchBatchAutomaton;
+
+#define LW_SEARCHBATCH_STATE(automaton, i) (&g_array_index ((automaton)->states, LwSearchBatchState, (i)))
+#define LW_SEARCHBATCH_ROUTE(automaton, i) (&g_array_index ((automaton)->routes, LwSearchBatchRoute, (i)))
+
+
+//!
+//! @brief Creates a new LwSearchBatch
+//! @param dictionary The LwDictionary the searches will be for
+//! @returns An allocated LwSearchBatch to be freed with lw_searchbatch_free
+//!
+LwSearchBatch*
+lw_searchbatch_new (LwDictionary *dictionary)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+
+    //Declarations
+    LwSearchBatch *batch;
+
+    //Initializations
+    batch = g_new0 (LwSearchBatch, 1);
+    batch->dictionary = dictionary;
+    batch->searches = g_ptr_array_new ();
+
+    return batch;
+}
+
+
+//!
+//! @brief Frees an LwSearchBatch.  The searches that were added aren't freed.
+//! @param batch The LwSearchBatch to free
+//!
+void
+lw_searchbatch_free (LwSearchBatch *batch)
+{
+    //Sanity checks
+    if (batch == NULL) return;
+
+    g_ptr_array_free (batch->searches, TRUE); batch->searches = NULL;
+
+    g_free (batch);
+}
+
+
+//!
+//! @brief Adds a search that wasn't started yet to a batch
+//! @param batch The LwSearchBatch to add to
+//! @param search An LwSearch for the dictionary of the batch
+//!
+void
+lw_searchbatch_add (LwSearchBatch *batch, LwSearch *search)
+{
+    //Sanity checks
+    g_return_if_fail (batch != NULL);
+    g_return_if_fail (search != NULL);
+    g_return_if_fail (search->dictionary == batch->dictionary);
+
+    g_ptr_array_add (batch->searches, search);
+}
+
+
+guint
+lw_searchbatch_length (LwSearchBatch *batch)
+{
+    //Sanity checks
+    g_return_val_if_fail (batch != NULL, 0);
+
+    return batch->searches->len;
+}
+
+
+LwSearch*
+lw_searchbatch_get (LwSearchBatch *batch, guint i)
+{
+    //Sanity checks
+    g_return_val_if_fail (batch != NULL, NULL);
+    g_return_val_if_fail (i < batch->searches->len, NULL);
+
+    return LW_SEARCH (g_ptr_array_index (batch->searches, i));
+}
+
+
+static LwSearchBatchAutomaton*
+lw_searchbatch_automaton_new ()
+{
+    //Declarations
+    LwSearchBatchAutomaton *automaton;
+    LwSearchBatchState root;
+    LwSearchBatchRoute none;
+
+    //Initializations
+    automaton = g_new0 (LwSearchBatchAutomaton, 1);
+    automaton->states = g_array_new (FALSE, TRUE, sizeof(LwSearchBatchState));
+    automaton->routes = g_array_new (FALSE, TRUE, sizeof(LwSearchBatchRoute));
+    memset(&root, 0, sizeof(LwSearchBatchState));
+    memset(&none, 0, sizeof(LwSearchBatchRoute));
+
+    g_array_append_val (automaton->states, root);
+    g_array_append_val (automaton->routes, none);
+
+    return automaton;
+}
+
+
+static void
+lw_searchbatch_automaton_free (LwSearchBatchAutomaton *automaton)
+{
+    g_array_free (automaton->states, TRUE); automaton->states = NULL;
+    g_array_free (automaton->routes, TRUE); automaton->routes = NULL;
+
+    g_free (automaton);
+}
+
+
+static guint32
+lw_searchbatch_automaton_get_child (LwSearchBatchAutomaton *automaton, guint32 state, guchar c)
+{
+    //Declarations
+    guint32 child;
+
+    for (child = LW_SEARCHBATCH_STATE (automaton, state)->child; child != 0; child = LW_SEARCHBATCH_STATE (automaton, child)->sibling)
+    {
+      if (LW_SEARCHBATCH_STATE (automaton, child)->c == c) break;
+    }
+
+    return child;
+}
+
+
+//!
+//! @brief Adds a literal to the trie of the automaton
+//!
+//! THIS IS A PRIVATE FUNCTION. lw_searchbatch_automaton_link has to be called
+//! once every literal was added.
+//!
+//! @param automaton The LwSearchBatchAutomaton to add to
+//! @param LITERAL A casefolded literal
+//! @param search The position of the search the literal belongs to
+//!
+static void
+lw_searchbatch_automaton_add (LwSearchBatchAutomaton *automaton, const gchar *LITERAL, guint32 search)
+{
+    //Declarations
+    LwSearchBatchState state;
+    LwSearchBatchRoute route;
+    const gchar *ptr;
+    guint32 position;
+    guint32 child;
+
+    //Initializations
+    position = 0;
+
+    for (ptr = LITERAL; *ptr != '\0'; ptr++)
+    {
+      child = lw_searchbatch_automaton_get_child (automaton, position, (guchar) *ptr);
+      if (child == 0)
+      {
+        memset(&state, 0, sizeof(LwSearchBatchState));
+        state.c = (guchar) *ptr;
+        state.sibling = LW_SEARCHBATCH_STATE (automaton, position)->child;
+        child = automaton->states->len;
+        g_array_append_val (automaton->states, state);
+        LW_SEARCHBATCH_STATE (automaton, position)->child = child;
+      }
+      position = child;
+    }
+
+    route.search = search;
+    route.next = LW_SEARCHBATCH_STATE (automaton, position)->route;
+    LW_SEARCHBATCH_STATE (automaton, position)->route = automaton->routes->len;
+    g_array_append_val (automaton->routes, route);
+}
+
+
+//!
+//! @brief Follows a byte from a state, falling back along the fail links
+//!        until a state has a child for it
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static guint32
+lw_searchbatch_automaton_next (LwSearchBatchAutomaton *automaton, guint32 state, guchar c)
+{
+    //Declarations
+    guint32 child;
+
+    while (state != 0)
+    {
+      child = lw_searchbatch_automaton_get_child (automaton, state, c);
+      if (child != 0) return child;
+      state = LW_SEARCHBATCH_STATE (automaton, state)->fail;
+    }
+
+    return automaton->root[c];
+}
+
+
+//!
+//! @brief Sets the fail and output links of the states, going through the
+//!        trie breadth first so the links of shorter states are always set
+//!        before they are needed
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+static void
+lw_searchbatch_automaton_link (LwSearchBatchAutomaton *automaton)
+{
+    //Declarations
+    LwSearchBatchState *state;
+    LwSearchBatchState *fail;
+    GArray *queue;
+    guint32 position;
+    guint32 child;
+    guint head;
+
+    //Initializations
+    queue = g_array_new (FALSE, FALSE, sizeof(guint32));
+    memset(automaton->root, 0, sizeof(automaton->root));
+
+    for (child = LW_SEARCHBATCH_STATE (automaton, 0)->child; child != 0; child = LW_SEARCHBATCH_STATE (automaton, child)->sibling)
+    {
+      automaton->root[LW_SEARCHBATCH_STATE (automaton, child)->c] = child;
+      g_array_append_val (queue, child);
+    }
+
+    for (head = 0; head < queue->len; head++)
+    {
+      position = g_array_index (queue, guint32, head);
+
+      for (child = LW_SEARCHBATCH_STATE (automaton, position)->child; child != 0; child = LW_SEARCHBATCH_STATE (automaton, child)->sibling)
+      {
+        state = LW_SEARCHBATCH_STATE (automaton, child);
+        state->fail = lw_searchbatch_automaton_next (automaton, LW_SEARCHBATCH_STATE (automaton, position)->fail, state->c);
+        fail = LW_SEARCHBATCH_STATE (automaton, state->fail);
+        state->output = (fail->route != 0) ? state->fail : fail->output;
+        g_array_append_val (queue, child);
+      }
+    }
+
+    g_array_free (queue, TRUE); queue = NULL;
+}
+
+
+//!
+//! @brief Reads the dictionary once and hands each search the offsets of the
+//!        lines that contain one of its literals
+//!
+//! THIS IS A PRIVATE FUNCTION.
+//!
+//! @param batch The LwSearchBatch whose searches to route lines to
+//! @param automaton An automaton of the literals of the routed searches
+//! @returns TRUE if the whole file was read
+//!
+static gboolean
+lw_searchbatch_route (LwSearchBatch *batch, LwSearchBatchAutomaton *automaton)
+{
+    //Declarations
+    LwSearchSnapshotEntry entry;
+    LwSearchBatchRoute *route;
+    LwSearch *search;
+    FILE *file;
+    gchar line[LW_IO_MAX_FGETS_LINE];
+    guint32 *stamps;
+    guint32 stamp;
+    guint32 state;
+    guint32 match;
+    guint32 i;
+    const gchar *ptr;
+    gchar *path;
+    gboolean complete;
+
+    //Initializations
+    path = lw_dictionary_get_path (batch->dictionary);
+    file = (path != NULL) ? fopen (path, "r") : NULL;
+    stamps = g_new0 (guint32, batch->searches->len);
+    stamp = 0;
+    complete = FALSE;
+    entry.offset = 0;
+    entry.relevance = LW_RELEVANCE_LOW;
+
+    if (file == NULL) goto errored;
+
+    //Lines are read the same way the dictionary parses them so the offsets match
+    while (fgets (line, LW_IO_MAX_FGETS_LINE, file) != NULL)
+    {
+      stamp++;
+      state = 0;
+      if (line[0] == '#') ptr = "";
+      else ptr = line;
+
+      for (; *ptr != '\0'; ptr++)
+      {
+        state = lw_searchbatch_automaton_next (automaton, state, (guchar) g_ascii_tolower (*ptr));
+
+        match = (LW_SEARCHBATCH_STATE (automaton, state)->route != 0) ? state : LW_SEARCHBATCH_STATE (automaton, state)->output;
+        for (; match != 0; match = LW_SEARCHBATCH_STATE (automaton, match)->output)
+        {
+          for (i = LW_SEARCHBATCH_STATE (automaton, match)->route; i != 0; i = route->next)
+          {
+            route = LW_SEARCHBATCH_ROUTE (automaton, i);
+            if (stamps[route->search] == stamp) continue;
+            stamps[route->search] = stamp;
+            search = LW_SEARCH (g_ptr_array_index (batch->searches, route->search));
+            g_array_append_val (search->candidates.entries, entry);
+          }
+        }
+      }
+
+      entry.offset += strlen (line);
+    }
+
+    complete = !ferror (file);
+    fclose (file); file = NULL;
+
+errored:
+    if (path != NULL) g_free (path); path = NULL;
+    g_free (stamps); stamps = NULL;
+
+    return complete;
+}
+
+
+//!
+//! @brief Starts every search of a batch after a single pass over the
+//!        dictionary.  Searches with a plain text token only compare the
+//!        lines that contain it.  The others, like searches with regular
+//!        expressions, go through the whole dictionary as usual.
+//! @param batch The LwSearchBatch to start the searches of
+//! @param create_thread Whether the searches should run in the LwSearchPool
+//!                      instead of before this function returns
+//!
+void
+lw_searchbatch_start (LwSearchBatch *batch, gboolean create_thread)
+{
+    //Sanity checks
+    g_return_if_fail (batch != NULL);
+
+    //Declarations
+    LwSearchBatchAutomaton *automaton;
+    LwSearch *search;
+    GStatBuf info;
+    gboolean *routed;
+    gboolean complete;
+    gchar **literals;
+    gchar *path;
+    guint i;
+    gint j;
+
+    //Initializations
+    automaton = lw_searchbatch_automaton_new ();
+    routed = g_new0 (gboolean, batch->searches->len + 1);
+    complete = FALSE;
+    path = lw_dictionary_get_path (batch->dictionary);
+
+    for (i = 0; i < batch->searches->len; i++)
+    {
+      search = LW_SEARCH (g_ptr_array_index (batch->searches, i));
+      lw_search_clear_candidates (search);
+
+      //A result of the examples dictionary spans more than one line
+      if (LW_IS_EXAMPLEDICTIONARY (batch->dictionary)) continue;
+
+      literals = lw_search_get_required_literals (search);
+      for (j = 0; literals != NULL && literals[j] != NULL; j++)
+      {
+        lw_searchbatch_automaton_add (automaton, literals[j], i);
+        routed[i] = TRUE;
+      }
+      if (literals != NULL) g_strfreev (literals); literals = NULL;
+    }
+
+    if (automaton->routes->len > 1 && path != NULL && g_stat (path, &info) == 0)
+    {
+      lw_searchbatch_automaton_link (automaton);
+      complete = lw_searchbatch_route (batch, automaton);
+    }
+
+    for (i = 0; i < batch->searches->len; i++)
+    {
+      search = LW_SEARCH (g_ptr_array_index (batch->searches, i));
+      if (routed[i] && complete)
+      {
+        search->candidates.size = (goffset) info.st_size;
+        search->candidates.mtime = (gint64) info.st_mtime;
+        search->candidates.complete = TRUE;
+      }
+      else
+      {
+        lw_search_clear_candidates (search);
+      }
+      lw_search_start (search, create_thread);
+    }
+
+    if (path != NULL) g_free (path); path = NULL;
+    g_free (routed); routed = NULL;
+    lw_searchbatch_automaton_free (automaton); automaton = NULL;
+}
@@ -0,0 +1,342 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file searchpool.c
+//!
+//! @brief A fixed set of threads shared by every search of the process.
+//!        Searches take turns in slices of time, and a thread always picks
+//!        the waiting search with the best LwSearchPriority, so the search
+//!        the user is looking at isn't slowed down by tooltips or by the
+//!        searches of hidden tabs.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <glib.h>
+
+#include <libwaei/libwaei.h>
+
+
+//!
+//! @brief Takes the search that should run next out of the queues
+//!
+//! THIS IS A PRIVATE FUNCTION. The pool mutex should be held.
+//!
+static LwSearch*
+lw_searchpool_pop (LwSearchPool *pool)
+{
+    //Declarations
+    LwSearch *search;
+    gint i;
+
+    //Initializations
+    search = NULL;
+
+    for (i = 0; i < TOTAL_LW_SEARCH_PRIORITIES && search == NULL; i++)
+    {
+      search = LW_SEARCH (g_queue_pop_head (&pool->queues[i]));
+    }
+
+    return search;
+}
+
+
+//!
+//! @brief Runs the searches of the pool one slice at a time
+//!
+//! THIS IS A PRIVATE FUNCTION. A search that isn't done after its slice
+//! goes to the back of its queue so the others get a turn.  A search that
+//! was canceled stops within its slice, and is freed here if
+//! lw_search_free was called on it in the meantime.
+//!
+static gpointer
+lw_searchpool_thread (gpointer data)
+{
+    //Declarations
+    LwSearchPool *pool;
+    LwSearch *search;
+    gboolean more;
+
+    //Initializations
+    pool = LW_SEARCHPOOL (data);
+
+    g_mutex_lock (&pool->mutex);
+
+    while (TRUE)
+    {
+      search = lw_searchpool_pop (pool);
+      if (search == NULL)
+      {
+        g_cond_wait (&pool->cond, &pool->mutex);
+        continue;
+      }
+
+      search->queued = FALSE;
+      search->running = TRUE;
+      g_mutex_unlock (&pool->mutex);
+
+      more = lw_search_stream (search, LW_SEARCHPOOL_SLICE);
+
+      g_mutex_lock (&pool->mutex);
+      search->running = FALSE;
+      if (more)
+      {
+        search->queued = TRUE;
+        g_queue_push_tail (&pool->queues[search->priority], search);
+      }
+      g_cond_broadcast (&pool->cond);
+
+      //Searches freed while they were running are freed here instead
+      if (!more && search->orphaned)
+      {
+        search->orphaned = FALSE;
+        g_mutex_unlock (&pool->mutex);
+        lw_search_free (search);
+        g_mutex_lock (&pool->mutex);
+      }
+    }
+
+    g_mutex_unlock (&pool->mutex);
+
+    return NULL;
+}
+
+
+static gpointer
+lw_searchpool_create (gpointer data)
+{
+    //Declarations
+    LwSearchPool *pool;
+    GError *error;
+    gint i;
+
+    //Initializations
+    pool = g_new0 (LwSearchPool, 1);
+    error = NULL;
+
+    g_mutex_init (&pool->mutex);
+    g_cond_init (&pool->cond);
+    for (i = 0; i < TOTAL_LW_SEARCH_PRIORITIES; i++)
+    {
+      g_queue_init (&pool->queues[i]);
+    }
+
+    for (i = 0; i < LW_SEARCHPOOL_MAX_THREADS; i++)
+    {
+      pool->threads[pool->total_threads] = g_thread_try_new ("libwaei-search", lw_searchpool_thread, pool, &error);
+      if (pool->threads[pool->total_threads] == NULL)
+      {
+        g_warning ("Thread Creation Error: %s\n", error->message);
+        g_error_free (error);
+        error = NULL;
+      }
+      else
+      {
+        pool->total_threads++;
+      }
+    }
+
+    return pool;
+}
+
+
+//!
+//! @brief Gets the pool every search of the process runs in.  The threads
+//!        are started the first time this is called and live as long as
+//!        the process.
+//! @returns The LwSearchPool which shouldn't be freed
+//!
+LwSearchPool*
+lw_searchpool_get_default ()
+{
+    static GOnce once = G_ONCE_INIT;
+
+    g_once (&once, lw_searchpool_create, NULL);
+
+    return LW_SEARCHPOOL (once.retval);
+}
+
+
+//!
+//! @brief Queues a search that was readied by lw_search_start to be run
+//! @param pool The LwSearchPool to run the search in
+//! @param search The LwSearch to run
+//! @returns FALSE if the pool has no threads and the search has to be
+//!          run by the caller
+//!
+gboolean
+lw_searchpool_push (LwSearchPool *pool, LwSearch *search)
+{
+    //Sanity checks
+    g_return_val_if_fail (pool != NULL, FALSE);
+    g_return_val_if_fail (search != NULL, FALSE);
+
+    if (pool->total_threads == 0) return FALSE;
+
+    g_mutex_lock (&pool->mutex);
+
+    search->queued = TRUE;
+    g_queue_push_tail (&pool->queues[search->priority], search);
+    g_cond_signal (&pool->cond);
+
+    g_mutex_unlock (&pool->mutex);
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Takes a search out of the pool so it can be started again.  The
+//!        search is canceled first, so a thread running it stops at the
+//!        next line and this only waits for that.  A search that was still
+//!        waiting for a turn is dropped and closed without reading any more
+//!        of it.
+//! @param pool The LwSearchPool the search was pushed to
+//! @param search The LwSearch to take out
+//!
+void
+lw_searchpool_remove (LwSearchPool *pool, LwSearch *search)
+{
+    //Sanity checks
+    g_return_if_fail (pool != NULL);
+    g_return_if_fail (search != NULL);
+
+    //Declarations
+    gboolean waiting;
+
+    lw_search_lock (search);
+    if (search->status == LW_SEARCHSTATUS_SEARCHING && search->fd != NULL)
+    {
+      search->cancel = TRUE;
+      search->status = LW_SEARCHSTATUS_CANCELING;
+    }
+    lw_search_unlock (search);
+
+    g_mutex_lock (&pool->mutex);
+
+    waiting = search->queued;
+    if (waiting)
+    {
+      g_queue_remove (&pool->queues[search->priority], search);
+      search->queued = FALSE;
+    }
+
+    //A canceled search isn't queued again when its slice ends
+    while (search->running)
+    {
+      g_cond_wait (&pool->cond, &pool->mutex);
+    }
+
+    g_mutex_unlock (&pool->mutex);
+
+    //Only closes the file since the search was canceled
+    if (waiting) lw_search_stream (search, -1);
+}
+
+
+//!
+//! @brief Takes a canceled search out of the pool without waiting for it
+//! @param pool The LwSearchPool the search may be in
+//! @param search The LwSearch that was canceled
+//! @returns TRUE if a thread is running the search and will finish it or
+//!          FALSE if the caller has to finish it
+//!
+gboolean
+lw_searchpool_cancel (LwSearchPool *pool, LwSearch *search)
+{
+    //Sanity checks
+    g_return_val_if_fail (pool != NULL, FALSE);
+    g_return_val_if_fail (search != NULL, FALSE);
+
+    //Declarations
+    gboolean running;
+
+    g_mutex_lock (&pool->mutex);
+
+    if (search->queued)
+    {
+      g_queue_remove (&pool->queues[search->priority], search);
+      search->queued = FALSE;
+    }
+    running = search->running;
+
+    g_mutex_unlock (&pool->mutex);
+
+    return running;
+}
+
+
+//!
+//! @brief Hands a canceled search over to the pool to be freed if a thread
+//!        is still running it
+//! @param pool The LwSearchPool the search may be in
+//! @param search The LwSearch being freed
+//! @returns TRUE if the pool will free the search
+//!
+gboolean
+lw_searchpool_orphan (LwSearchPool *pool, LwSearch *search)
+{
+    //Sanity checks
+    g_return_val_if_fail (pool != NULL, FALSE);
+    g_return_val_if_fail (search != NULL, FALSE);
+
+    //Declarations
+    gboolean held;
+
+    g_mutex_lock (&pool->mutex);
+
+    held = (search->running || search->queued);
+    if (held) search->orphaned = TRUE;
+
+    g_mutex_unlock (&pool->mutex);
+
+    return held;
+}
+
+
+//!
+//! @brief Changes the priority of a search, moving it to the back of the
+//!        matching queue if it is waiting for a turn
+//! @param pool The LwSearchPool the search may be waiting in
+//! @param search The LwSearch to change the priority of
+//! @param priority The new LwSearchPriority
+//!
+void
+lw_searchpool_set_priority (LwSearchPool *pool, LwSearch *search, LwSearchPriority priority)
+{
+    //Sanity checks
+    g_return_if_fail (pool != NULL);
+    g_return_if_fail (search != NULL);
+
+    g_mutex_lock (&pool->mutex);
+
+    if (search->queued && search->priority != priority)
+    {
+      g_queue_remove (&pool->queues[search->priority], search);
+      g_queue_push_tail (&pool->queues[priority], search);
+    }
+    search->priority = priority;
+
+    g_mutex_unlock (&pool->mutex);
+}
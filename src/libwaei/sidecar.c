@@ -0,0 +1,514 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file sidecar.c
+//!
+//! @brief Files built from a dictionary and kept next to it in the cache
+//!        folder, like the indexes.  Each one starts with the size and
+//!        modification time of the dictionary it was built from so a stale
+//!        one is rebuilt, and the loaded copies are shared by every user of
+//!        a dictionary.
+//!
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <utime.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <libwaei/libwaei.h>
+
+
+struct _LwSidecarEntry {
+  gpointer data;         //The loaded sidecar or NULL
+  LwSidecarStamp stamp;  //The dictionary file data was loaded for
+  GDestroyNotify unref;
+  gboolean loading;      //Another thread is loading data without the mutex
+};
+typedef struct _LwSidecarEntry LwSidecarEntry;
+
+//A sidecar being loaded in its own thread by lw_sidecar_peek_for_dictionary
+struct _LwSidecarJob {
+  LwSidecarEntry *entry;
+  LwDictionary *dictionary;
+  LwSidecarStamp stamp;
+  LwSidecarNewFunc new_for_dictionary;
+};
+typedef struct _LwSidecarJob LwSidecarJob;
+
+static GMutex _mutex;
+static GCond _cond;
+static GHashTable *_sidecars = NULL;  //Sidecar filenames to their LwSidecarEntry
+
+
+//!
+//! @brief Builds the path of a sidecar of a dictionary in the cache folder
+//! @param FILENAME The filename of the dictionary
+//! @param SUFFIX The suffix of the kind of sidecar, like LW_FUZZYINDEX_SUFFIX
+//! @returns An allocated path that should be freed with g_free
+//!
+gchar*
+lw_sidecar_build_path (const gchar *FILENAME, const gchar *SUFFIX)
+{
+    //Sanity checks
+    g_return_val_if_fail (FILENAME != NULL, NULL);
+    g_return_val_if_fail (SUFFIX != NULL, NULL);
+
+    //Declarations
+    gchar *filename;
+    gchar *path;
+
+    //Initializations
+    filename = g_strjoin ("", FILENAME, SUFFIX, NULL);
+    path = lw_util_build_filename (LW_PATH_CACHE, filename);
+
+    g_free (filename); filename = NULL;
+
+    return path;
+}
+
+
+//!
+//! @brief Reads the size and modification time of a dictionary file
+//! @param stamp The LwSidecarStamp to fill
+//! @param PATH The path of the dictionary file
+//! @returns FALSE if the file couldn't be read
+//!
+gboolean
+lw_sidecar_stamp_file (LwSidecarStamp *stamp, const gchar *PATH)
+{
+    //Sanity checks
+    g_return_val_if_fail (stamp != NULL, FALSE);
+
+    //Declarations
+    GStatBuf info;
+
+    if (PATH == NULL || g_stat (PATH, &info) != 0) return FALSE;
+
+    stamp->size = (gsize) info.st_size;
+    stamp->mtime = (gint64) info.st_mtime;
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Gives a copy of a dictionary file the modification time of the
+//!        original so the sidecars built from the original still match it
+//! @param STAMP The LwSidecarStamp of the original
+//! @param PATH The path of the copy
+//! @returns FALSE if the time couldn't be set
+//!
+gboolean
+lw_sidecar_stamp_touch (const LwSidecarStamp *STAMP, const gchar *PATH)
+{
+    //Sanity checks
+    g_return_val_if_fail (STAMP != NULL, FALSE);
+    g_return_val_if_fail (PATH != NULL, FALSE);
+
+    //Declarations
+    struct utimbuf times;
+
+    //Initializations
+    times.actime = (time_t) STAMP->mtime;
+    times.modtime = (time_t) STAMP->mtime;
+
+    return (g_utime (PATH, &times) == 0);
+}
+
+
+gboolean
+lw_sidecar_stamp_equal (const LwSidecarStamp *A, const LwSidecarStamp *B)
+{
+    //Sanity checks
+    g_return_val_if_fail (A != NULL && B != NULL, FALSE);
+
+    return (A->size == B->size && A->mtime == B->mtime);
+}
+
+
+//!
+//! @brief Writes a stamp as the first line of a sidecar
+//! @param STAMP The LwSidecarStamp of the dictionary the sidecar was built from
+//! @param text The GString the sidecar is written into
+//!
+void
+lw_sidecar_stamp_append (const LwSidecarStamp *STAMP, GString *text)
+{
+    //Sanity checks
+    g_return_if_fail (STAMP != NULL);
+    g_return_if_fail (text != NULL);
+
+    g_string_append_printf (text, "%" G_GSIZE_FORMAT " %" G_GINT64_FORMAT "\n", STAMP->size, STAMP->mtime);
+}
+
+
+//!
+//! @brief Reads the stamp written by lw_sidecar_stamp_append
+//! @param stamp The LwSidecarStamp to fill
+//! @param TEXT The start of the sidecar
+//! @param end Set to the end of the first line if not NULL
+//! @returns FALSE if the first line isn't a stamp
+//!
+gboolean
+lw_sidecar_stamp_parse (LwSidecarStamp *stamp, const gchar *TEXT, gchar **end)
+{
+    //Sanity checks
+    g_return_val_if_fail (stamp != NULL, FALSE);
+    g_return_val_if_fail (TEXT != NULL, FALSE);
+
+    //Declarations
+    const gchar *ptr;
+    gchar *next;
+    gsize size;
+    gint64 mtime;
+
+    //Initializations
+    ptr = TEXT;
+
+    size = (gsize) g_ascii_strtoull (ptr, &next, 10);
+    if (next == ptr || *next != ' ') return FALSE;
+    ptr = next + 1;
+
+    mtime = g_ascii_strtoll (ptr, &next, 10);
+    if (next == ptr || (*next != '\n' && *next != '\0')) return FALSE;
+
+    stamp->size = size;
+    stamp->mtime = mtime;
+    if (end != NULL) *end = next;
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Reads only the stamp of a sidecar so a stale one isn't loaded
+//!
+static gboolean
+lw_sidecar_stamp_read (LwSidecarStamp *stamp, const gchar *PATH)
+{
+    //Declarations
+    FILE *file;
+    gchar line[64];
+    gboolean success;
+
+    //Initializations
+    file = g_fopen (PATH, "r");
+    success = FALSE;
+
+    if (file == NULL) return FALSE;
+
+    if (fgets (line, sizeof(line), file) != NULL)
+      success = lw_sidecar_stamp_parse (stamp, line, NULL);
+
+    fclose (file); file = NULL;
+
+    return success;
+}
+
+
+//!
+//! @brief Fills a sidecar from the cache folder if it still matches its
+//!        dictionary, otherwise builds it from the dictionary and saves it
+//! @param data The empty sidecar to fill
+//! @param dictionary The installed LwDictionary it belongs to
+//! @param SUFFIX The suffix of the kind of sidecar
+//! @param load Reads a saved sidecar into data
+//! @param build Builds data from the dictionary file
+//! @param save Writes data to the cache folder
+//! @param error A GError to place errors into or NULL
+//! @returns TRUE if data was filled
+//!
+gboolean
+lw_sidecar_load_or_build (gpointer data, LwDictionary *dictionary, const gchar *SUFFIX, LwSidecarLoadFunc load, LwSidecarBuildFunc build, LwSidecarSaveFunc save, GError **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (data != NULL, FALSE);
+    g_return_val_if_fail (dictionary != NULL, FALSE);
+    g_return_val_if_fail (SUFFIX != NULL, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    LwSidecarStamp stamp;
+    LwSidecarStamp saved;
+    const gchar *FILENAME;
+    gchar *path;
+    gchar *sidecarpath;
+    gboolean success;
+
+    //Initializations
+    FILENAME = lw_dictionary_get_filename (dictionary);
+    path = lw_dictionary_get_path (dictionary);
+    sidecarpath = (FILENAME != NULL) ? lw_sidecar_build_path (FILENAME, SUFFIX) : NULL;
+    success = FALSE;
+
+    if (path == NULL || sidecarpath == NULL) goto finished;
+
+    if (lw_sidecar_stamp_file (&stamp, path) &&
+        lw_sidecar_stamp_read (&saved, sidecarpath) &&
+        lw_sidecar_stamp_equal (&stamp, &saved) &&
+        load (data, sidecarpath, NULL))
+    {
+      success = TRUE;
+      goto finished;
+    }
+
+    success = build (data, path, NULL, error);
+
+    //A sidecar that can't be written is only built again the next time
+    if (success) save (data, sidecarpath, NULL);
+
+finished:
+    if (path != NULL) g_free (path); path = NULL;
+    if (sidecarpath != NULL) g_free (sidecarpath); sidecarpath = NULL;
+
+    return success;
+}
+
+
+static LwSidecarEntry*
+lw_sidecar_entry_new (GDestroyNotify unref)
+{
+    //Declarations
+    LwSidecarEntry *entry;
+
+    //Initializations
+    entry = g_new0 (LwSidecarEntry, 1);
+    entry->unref = unref;
+
+    return entry;
+}
+
+
+static void
+lw_sidecar_entry_free (LwSidecarEntry *entry)
+{
+    if (entry->data != NULL) entry->unref (entry->data); entry->data = NULL;
+
+    g_free (entry);
+}
+
+
+//!
+//! @brief Finds the entry of a sidecar, adding an empty one the first time.
+//!        Entries are never removed so they stay valid while the mutex is
+//!        let go.  The mutex must be held.
+//!
+static LwSidecarEntry*
+lw_sidecar_lookup_entry (LwDictionary *dictionary, const gchar *SUFFIX, GDestroyNotify unref)
+{
+    //Declarations
+    LwSidecarEntry *entry;
+    gchar *key;
+
+    //Initializations
+    key = g_strjoin ("", lw_dictionary_get_filename (dictionary), SUFFIX, NULL);
+
+    if (_sidecars == NULL)
+      _sidecars = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, (GDestroyNotify) lw_sidecar_entry_free);
+
+    entry = g_hash_table_lookup (_sidecars, key);
+    if (entry == NULL)
+    {
+      entry = lw_sidecar_entry_new (unref);
+      g_hash_table_insert (_sidecars, key, entry); key = NULL;
+    }
+
+    if (key != NULL) g_free (key); key = NULL;
+
+    return entry;
+}
+
+
+//!
+//! @brief Loads the sidecar of an entry marked as loading and wakes up the
+//!        threads waiting for it.  The mutex must not be held.
+//!
+static void
+lw_sidecar_entry_fill (LwSidecarEntry *entry, LwDictionary *dictionary, const LwSidecarStamp *STAMP, LwSidecarNewFunc new_for_dictionary)
+{
+    //Declarations
+    gpointer data;
+
+    //Initializations
+    data = new_for_dictionary (dictionary, NULL);
+
+    g_mutex_lock (&_mutex);
+    if (entry->data != NULL) entry->unref (entry->data);
+    entry->data = data;
+    entry->stamp = *STAMP;
+    entry->loading = FALSE;
+    g_cond_broadcast (&_cond);
+    g_mutex_unlock (&_mutex);
+}
+
+
+static gpointer
+lw_sidecar_fill_thread (gpointer data)
+{
+    //Declarations
+    LwSidecarJob *job;
+
+    //Initializations
+    job = (LwSidecarJob*) data;
+
+    lw_sidecar_entry_fill (job->entry, job->dictionary, &job->stamp, job->new_for_dictionary);
+
+    g_object_unref (job->dictionary); job->dictionary = NULL;
+    g_free (job); job = NULL;
+
+    return NULL;
+}
+
+
+//!
+//! @brief Gets the sidecar of a dictionary shared by all of its users.  It is
+//!        loaded the first time and again when the dictionary was reinstalled.
+//!        The loading is done without holding the lock of the other sidecars,
+//!        and other threads asking for the same one wait for it.
+//! @param dictionary The installed LwDictionary
+//! @param SUFFIX The suffix of the kind of sidecar
+//! @param new_for_dictionary Loads or builds the sidecar of a dictionary
+//! @param ref Adds a reference to a sidecar
+//! @param unref Releases a reference to a sidecar
+//! @returns A reference to the sidecar to be released with unref or NULL
+//!
+gpointer
+lw_sidecar_get_for_dictionary (LwDictionary *dictionary, const gchar *SUFFIX, LwSidecarNewFunc new_for_dictionary, GBoxedCopyFunc ref, GDestroyNotify unref)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+    g_return_val_if_fail (SUFFIX != NULL, NULL);
+
+    //Declarations
+    LwSidecarEntry *entry;
+    LwSidecarStamp stamp;
+    gpointer data;
+    gchar *path;
+
+    //Initializations
+    path = lw_dictionary_get_path (dictionary);
+    data = NULL;
+
+    if (lw_dictionary_get_filename (dictionary) == NULL || !lw_sidecar_stamp_file (&stamp, path)) goto finished;
+
+    g_mutex_lock (&_mutex);
+
+    entry = lw_sidecar_lookup_entry (dictionary, SUFFIX, unref);
+    while (entry->loading) g_cond_wait (&_cond, &_mutex);
+
+    if (entry->data == NULL || !lw_sidecar_stamp_equal (&entry->stamp, &stamp))
+    {
+      entry->loading = TRUE;
+      g_mutex_unlock (&_mutex);
+      lw_sidecar_entry_fill (entry, dictionary, &stamp, new_for_dictionary);
+      g_mutex_lock (&_mutex);
+    }
+
+    data = (entry->data != NULL) ? ref (entry->data) : NULL;
+
+    g_mutex_unlock (&_mutex);
+
+finished:
+    if (path != NULL) g_free (path); path = NULL;
+
+    return data;
+}
+
+
+//!
+//! @brief Gets the sidecar of a dictionary like lw_sidecar_get_for_dictionary
+//!        but never waits for it.  A sidecar that isn't loaded yet, or is
+//!        from before the dictionary was reinstalled, is loaded in another
+//!        thread and NULL is returned until it is ready.  One that couldn't
+//!        be loaded isn't tried again until the dictionary file changes, so
+//!        callers can keep asking for it.
+//! @param dictionary The installed LwDictionary
+//! @param SUFFIX The suffix of the kind of sidecar
+//! @param new_for_dictionary Loads or builds the sidecar of a dictionary
+//! @param ref Adds a reference to a sidecar
+//! @param unref Releases a reference to a sidecar
+//! @returns A reference to the sidecar to be released with unref or NULL
+//!
+gpointer
+lw_sidecar_peek_for_dictionary (LwDictionary *dictionary, const gchar *SUFFIX, LwSidecarNewFunc new_for_dictionary, GBoxedCopyFunc ref, GDestroyNotify unref)
+{
+    //Sanity checks
+    g_return_val_if_fail (dictionary != NULL, NULL);
+    g_return_val_if_fail (SUFFIX != NULL, NULL);
+
+    //Declarations
+    LwSidecarEntry *entry;
+    LwSidecarStamp stamp;
+    LwSidecarJob *job;
+    GThread *thread;
+    gpointer data;
+    gchar *path;
+
+    //Initializations
+    path = lw_dictionary_get_path (dictionary);
+    data = NULL;
+
+    if (lw_dictionary_get_filename (dictionary) == NULL || !lw_sidecar_stamp_file (&stamp, path)) goto finished;
+
+    g_mutex_lock (&_mutex);
+
+    entry = lw_sidecar_lookup_entry (dictionary, SUFFIX, unref);
+
+    if (!entry->loading && entry->data != NULL && lw_sidecar_stamp_equal (&entry->stamp, &stamp))
+    {
+      data = ref (entry->data);
+    }
+    else if (!entry->loading && (entry->data != NULL || !lw_sidecar_stamp_equal (&entry->stamp, &stamp)))
+    {
+      job = g_new0 (LwSidecarJob, 1);
+      job->entry = entry;
+      job->dictionary = g_object_ref (dictionary);
+      job->stamp = stamp;
+      job->new_for_dictionary = new_for_dictionary;
+
+      thread = g_thread_try_new ("libwaei-sidecar", lw_sidecar_fill_thread, job, NULL);
+      if (thread != NULL)
+      {
+        entry->loading = TRUE;
+        g_thread_unref (thread); thread = NULL;
+      }
+      else
+      {
+        g_object_unref (job->dictionary); job->dictionary = NULL;
+        g_free (job); job = NULL;
+      }
+    }
+
+    g_mutex_unlock (&_mutex);
+
+finished:
+    if (path != NULL) g_free (path); path = NULL;
+
+    return data;
+}
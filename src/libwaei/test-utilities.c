@@ -0,0 +1,2251 @@
+/******************************************************************************
+    AUTHOR:
+    File written and Copyrighted by Zachary Dovel. All Rights Reserved.
+
+    LICENSE:
+    This file is part of gWaei.
+
+    gWaei is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    gWaei is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with gWaei.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+
+//!
+//! @file test-utilities.c
+//!
+//! @brief Checks for the string helpers of utilities.c and the other parts
+//!        of libwaei that work without a window or a dictionary download.
+//!        utilities.c is included whole so its private fast paths can be
+//!        checked against the plain versions they replace, searchpool.c
+//!        so the order its threads take searches in can be checked without
+//!        the threads, and annotator.c so its trie can be checked without
+//!        MeCab.
+//!
+
+#include "utilities.c"
+#include "searchpool.c"
+#include "annotator.c"
+
+
+//!
+//! @brief A romaji string and what it converts to, or NULL if it can't be
+//!        converted
+//!
+struct _LwRomajiCase {
+  const gchar *romaji;
+  const gchar *hiragana;
+  const gchar *katakana;
+};
+typedef struct _LwRomajiCase LwRomajiCase;
+
+//What the strcmp chain the transducer replaced gave for each of these
+static const LwRomajiCase _romaji_cases[] = {
+  { "nihon",       "にほん",       "ニホン"       },
+  { "nihongo",     "にほんご",     "ニホンゴ"     },
+  { "taberu",      "たべる",       "タベル"       },
+  { "kitte",       "きって",       "キッテ"       },
+  { "gakkou",      "がっこう",     "ガッコウ"     },
+  { "toukyou",     "とうきょう",   "トウキョウ"   },
+  { "kyou",        "きょう",       "キョウ"       },
+  { "ja",          "じゃ",         "ジャ"         },
+  { "shinbun",     "しんぶん",     "シンブン"     },
+  { "ryokou",      "りょこう",     "リョコウ"     },
+  { "zasshi",      "ざっし",       "ザッシ"       },
+  { "tsukue",      "つくえ",       "ツクエ"       },
+  { "chotto",      "ちょっと",     "チョット"     },
+  { "fujisan",     "ふじさん",     "フジサン"     },
+  { "hon",         "ほん",         "ホン"         },
+  { "n",           "ん",           "ン"           },
+  { "ra-men",      "らーめん",     "ラーメン"     },
+  { "konnnichiha", "こんにちは",   "コンニチハ"   },
+  { "xyz",         NULL,           NULL           },
+  { "sh",          NULL,           NULL           },
+  { NULL,          NULL,           NULL           }
+};
+
+//Where the transducer meant to differ from the strcmp chain
+static const LwRomajiCase _romaji_changes[] = {
+  { "konnichiha",  "こんにちは",   "コンニチハ"   },  //nn before a vowel was ん plus the bare vowel
+  { "onna",        "おんな",       "オンナ"       },
+  { "kan'i",       "かんい",       "カンイ"       },  //n' wasn't understood
+  { "matcha",      "まっちゃ",     "マッチャ"     },  //Neither was tch
+  { "vi",          "ゔぃ",         "ヴィ"         },  //v was う with a detached dakuten
+  { "ka-",         "かー",         "カー"         },  //A trailing long vowel mark was refused
+  { NULL,          NULL,           NULL           }
+};
+
+
+static void
+lw_test_romaji_cases (const LwRomajiCase *CASES)
+{
+    //Declarations
+    gchar output[100];
+    gboolean converted;
+    gint i;
+
+    for (i = 0; CASES[i].romaji != NULL; i++)
+    {
+      converted = lw_util_str_roma_to_hira (CASES[i].romaji, output, sizeof(output));
+      g_assert_cmpint (converted, ==, (CASES[i].hiragana != NULL));
+      if (converted) g_assert_cmpstr (output, ==, CASES[i].hiragana);
+
+      converted = lw_util_str_roma_to_kata (CASES[i].romaji, output, sizeof(output));
+      g_assert_cmpint (converted, ==, (CASES[i].katakana != NULL));
+      if (converted) g_assert_cmpstr (output, ==, CASES[i].katakana);
+    }
+}
+
+
+static void
+lw_test_romaji_to_kana ()
+{
+    lw_test_romaji_cases (_romaji_cases);
+    lw_test_romaji_cases (_romaji_changes);
+}
+
+
+static void
+lw_test_romaji_buffer_size ()
+{
+    //Declarations
+    gchar output[100];
+
+    //にほん is 9 bytes so it needs 10 with the terminator
+    g_assert (!lw_util_str_roma_to_hira ("nihon", output, 9));
+    g_assert (lw_util_str_roma_to_hira ("nihon", output, 10));
+    g_assert_cmpstr (output, ==, "にほん");
+}
+
+
+//!
+//! @brief The script checks of the baseline, a g_unichar_get_script () call
+//!        for every character
+//!
+static gboolean
+lw_test_str_has_only_scripts (const gchar *TEXT, const GUnicodeScript *SCRIPTS, gint total)
+{
+    //Declarations
+    const gchar *ptr;
+    GUnicodeScript script;
+    gboolean is_consistant;
+    gint i;
+
+    for (ptr = TEXT; *ptr != '\0'; ptr = g_utf8_next_char (ptr))
+    {
+      script = g_unichar_get_script (g_utf8_get_char (ptr));
+      is_consistant = (script == G_UNICODE_SCRIPT_COMMON);
+      for (i = 0; i < total && !is_consistant; i++) if (script == SCRIPTS[i]) is_consistant = TRUE;
+      if (!is_consistant) return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Fills a buffer with a character repeated so the 48 byte SSE2 blocks
+//!        get used, followed by a different character at position stop
+//!
+static gsize
+lw_test_fill (gchar *buffer, gunichar character, gint count, gunichar stop, gint position)
+{
+    //Declarations
+    gchar *ptr;
+    gint i;
+
+    //Initializations
+    ptr = buffer;
+
+    for (i = 0; i < count; i++)
+    {
+      if (i == position) ptr += g_unichar_to_utf8 (stop, ptr);
+      else ptr += g_unichar_to_utf8 (character, ptr);
+    }
+    *ptr = '\0';
+
+    return ptr - buffer;
+}
+
+
+static gboolean
+lw_test_is_valid_unichar (gunichar character)
+{
+    return (character != 0 && (character < 0xD800 || character > 0xDFFF));
+}
+
+
+static void
+lw_test_unichar_get_script ()
+{
+    //Declarations
+    gunichar character;
+
+    for (character = 0; character <= 0x10FFFF; character++)
+    {
+      if (!lw_test_is_valid_unichar (character)) continue;
+      g_assert_cmpint (lw_util_unichar_get_script (character), ==, g_unichar_get_script (character));
+    }
+}
+
+
+static void
+lw_test_span_range ()
+{
+    //Declarations
+    const GUnicodeScript SCRIPTS[] = { G_UNICODE_SCRIPT_HIRAGANA, G_UNICODE_SCRIPT_KATAKANA, G_UNICODE_SCRIPT_HAN };
+    const LwUtf8Range *range;
+    gchar buffer[200];
+    gunichar character;
+    gunichar lower;
+    gunichar upper;
+    gboolean in_range;
+    gsize length;
+    gint position;
+    gint i;
+
+    for (i = 0; i < G_N_ELEMENTS (SCRIPTS); i++)
+    {
+      range = lw_util_get_utf8_range (SCRIPTS[i]);
+      lower = g_utf8_get_char ((const gchar*) range->lower);
+      upper = g_utf8_get_char ((const gchar*) range->upper);
+
+      //Every 3 byte character is spanned only if it is in the range, and the
+      //range never takes in a character of another script
+      for (character = 0x800; character <= 0xFFFF; character++)
+      {
+        if (!lw_test_is_valid_unichar (character)) continue;
+        in_range = (character >= lower && character <= upper);
+        if (in_range) g_assert_cmpint (g_unichar_get_script (character), ==, SCRIPTS[i]);
+
+        length = lw_test_fill (buffer, character, 17, character, -1);
+        g_assert_cmpuint (lw_util_utf8_span_range (buffer, length, range), ==, (in_range) ? length : 0);
+      }
+
+      //A block stops at the first character outside of the range wherever it is
+      for (position = 0; position <= 17; position++)
+      {
+        length = lw_test_fill (buffer, lower, 17, 'a', position);
+        g_assert_cmpuint (lw_util_utf8_span_range (buffer, length, range), ==, MIN (position, 17) * 3);
+        length = lw_test_fill (buffer, upper, 17, upper + 1, position);
+        g_assert_cmpuint (lw_util_utf8_span_range (buffer, length, range), ==, MIN (position, 17) * 3);
+        length = lw_test_fill (buffer, lower, 17, lower - 1, position);
+        g_assert_cmpuint (lw_util_utf8_span_range (buffer, length, range), ==, MIN (position, 17) * 3);
+      }
+    }
+}
+
+
+static void
+lw_test_span_ascii ()
+{
+    //Declarations
+    gchar buffer[200];
+    gunichar character;
+    gsize length;
+    gint position;
+
+    for (character = 1; character < 0x80; character++)
+    {
+      length = lw_test_fill (buffer, character, 40, character, -1);
+      g_assert_cmpuint (lw_util_utf8_span_ascii (buffer, length, TRUE), ==, length);
+      g_assert_cmpuint (lw_util_utf8_span_ascii (buffer, length, FALSE), ==, (g_ascii_isalpha (character)) ? 0 : length);
+    }
+
+    for (position = 0; position <= 40; position++)
+    {
+      length = lw_test_fill (buffer, '1', 40, 'k', position);
+      g_assert_cmpuint (lw_util_utf8_span_ascii (buffer, length, FALSE), ==, MIN (position, 40));
+      length = lw_test_fill (buffer, 'k', 40, 0x3042, position);
+      g_assert_cmpuint (lw_util_utf8_span_ascii (buffer, length, TRUE), ==, MIN (position, 40));
+    }
+}
+
+
+static void
+lw_test_script_predicates ()
+{
+    //Declarations
+    const GUnicodeScript HIRAGANA[] = { G_UNICODE_SCRIPT_HIRAGANA };
+    const GUnicodeScript KATAKANA[] = { G_UNICODE_SCRIPT_KATAKANA };
+    const GUnicodeScript KANJI[] = { G_UNICODE_SCRIPT_HAN };
+    const GUnicodeScript KANJI_ISH[] = { G_UNICODE_SCRIPT_HAN, G_UNICODE_SCRIPT_HIRAGANA, G_UNICODE_SCRIPT_KATAKANA };
+    const GUnicodeScript ROMAJI[] = { G_UNICODE_SCRIPT_LATIN };
+    gchar buffer[200];
+    gunichar character;
+    gunichar others[] = { 'a', '1', 0x3042, 0x30A2, 0x4E00 };
+    gint i;
+
+    //Only a sample of the planes past the BMP since nothing there has a fast path
+    for (character = 1; character <= 0x10FFFF; character += (character < 0x10000) ? 1 : 0x3F)
+    {
+      if (!lw_test_is_valid_unichar (character)) continue;
+
+      for (i = 0; i < G_N_ELEMENTS (others); i++)
+      {
+        lw_test_fill (buffer, others[i], 20, character, 17);
+        g_assert_cmpint (lw_util_is_hiragana_str (buffer), ==, lw_test_str_has_only_scripts (buffer, HIRAGANA, 1));
+        g_assert_cmpint (lw_util_is_katakana_str (buffer), ==, lw_test_str_has_only_scripts (buffer, KATAKANA, 1));
+        g_assert_cmpint (lw_util_is_kanji_str (buffer), ==, lw_test_str_has_only_scripts (buffer, KANJI, 1));
+        g_assert_cmpint (lw_util_is_kanji_ish_str (buffer), ==, lw_test_str_has_only_scripts (buffer, KANJI_ISH, 3));
+        g_assert_cmpint (lw_util_is_romaji_str (buffer), ==, lw_test_str_has_only_scripts (buffer, ROMAJI, 1));
+      }
+    }
+}
+
+
+//!
+//! @brief Checks the SSE2 kana shifting against shifting a character at a time
+//!
+static void
+lw_test_shift_kana ()
+{
+    //Declarations
+    const gint SHIFTS[] = { L'ア' - L'あ', L'あ' - L'ア', 1, -1 };
+    gchar buffer[200];
+    gchar expected[200];
+    gunichar character;
+    gunichar shifted;
+    gunichar kana;
+    gint position;
+    gint i;
+
+    for (i = 0; i < G_N_ELEMENTS (SHIFTS); i++)
+    {
+      kana = MAX (0x3041, 0x3041 - SHIFTS[i]) + 1;
+      for (character = 0x3000; character <= 0x3100; character++)
+      {
+        for (position = 0; position < 20; position += 7)
+        {
+          lw_test_fill (buffer, kana, 20, character, position);
+          shifted = character;
+          if (character >= MAX (0x3041, 0x3041 - SHIFTS[i]) && character <= MIN (0x30ff, 0x30ff - SHIFTS[i]) && character != L'ー')
+            shifted = character + SHIFTS[i];
+          lw_test_fill (expected, kana + SHIFTS[i], 20, shifted, position);
+
+          lw_util_shift_kana_chars_in_str_by (buffer, SHIFTS[i]);
+          g_assert_cmpstr (buffer, ==, expected);
+        }
+      }
+    }
+}
+
+
+//!
+//! @brief A conjugated word and a dictionary form it has to be found as
+//!
+struct _LwDeinflectionCase {
+  const gchar *word;
+  const gchar *form;
+};
+typedef struct _LwDeinflectionCase LwDeinflectionCase;
+
+static const LwDeinflectionCase _deinflection_cases[] = {
+  { "食べた",             "食べる" },
+  { "書いた",             "書く"   },
+  { "泳いだ",             "泳ぐ"   },
+  { "読んだ",             "読む"   },
+  { "行かない",           "行く"   },
+  { "高かった",           "高い"   },
+  { "食べました",         "食べる" },
+  { "食べさせられなかった", "食べる" },
+  { "言っている",         "言う"   },  //Te forms of godan verbs in う, つ and る end in って
+  { "待ってる",           "待つ"   },
+  { "買ってしまう",       "買う"   },
+  { "言っちゃう",         "言う"   },
+  { "読んでいる",         "読む"   },
+  { "言ったら",           "言う"   },
+  { "待ったり",           "待つ"   },
+  { "切った",             "切る"   },
+  { NULL,                 NULL     }
+};
+
+
+static gboolean
+lw_test_deinflects_to (LwDeinflector *deinflector, const gchar *WORD, const gchar *FORM)
+{
+    //Declarations
+    gchar **forms;
+    gboolean found;
+    gint i;
+
+    //Initializations
+    forms = lw_deinflector_deinflect (deinflector, WORD);
+    found = FALSE;
+
+    for (i = 0; forms[i] != NULL; i++)
+    {
+      if (strcmp (forms[i], FORM) == 0) found = TRUE;
+    }
+
+    g_strfreev (forms); forms = NULL;
+
+    return found;
+}
+
+
+static void
+lw_test_deinflect ()
+{
+    //Declarations
+    LwDeinflector *deinflector;
+    gint i;
+
+    //Initializations
+    deinflector = lw_deinflector_new ();
+
+    for (i = 0; _deinflection_cases[i].word != NULL; i++)
+    {
+      if (!lw_test_deinflects_to (deinflector, _deinflection_cases[i].word, _deinflection_cases[i].form))
+        g_error ("%s wasn't deinflected to %s", _deinflection_cases[i].word, _deinflection_cases[i].form);
+    }
+
+    //Only the te and past forms leave a small tsu before what was taken off
+    g_assert (!lw_test_deinflects_to (deinflector, "切った", "切っる"));
+    g_assert (!lw_test_deinflects_to (deinflector, "言っている", "言っる"));
+
+    lw_deinflector_free (deinflector); deinflector = NULL;
+}
+
+
+//!
+//! @brief Writes a dictionary file to the folder of its type and makes a
+//!        dictionary for it.  The checks each use a filename of their own
+//!        since the sidecar files only look at the size and mtime.
+//!
+static LwDictionary*
+lw_test_dictionary_new (GType type, const gchar *FILENAME, const gchar *CONTENTS)
+{
+    //Declarations
+    LwDictionary *dictionary;
+    gchar *path;
+
+    //Initializations
+    dictionary = LW_DICTIONARY (g_object_new (type, "filename", FILENAME, NULL));
+    path = lw_dictionary_get_path (dictionary);
+
+    g_assert (g_file_set_contents (path, CONTENTS, -1, NULL));
+
+    g_free (path); path = NULL;
+
+    return dictionary;
+}
+
+
+//!
+//! @brief Writes what a finished search found as lines of
+//!        "kanji [furigana] / variant [furigana]" so runs can be compared
+//!
+static gchar*
+lw_test_search_read (LwSearch *search)
+{
+    //Declarations
+    GString *text;
+    LwResult *result;
+    LwResultVariant *variant;
+    GList *link;
+
+    //Initializations
+    text = g_string_new (NULL);
+
+    while ((result = lw_search_get_result (search)) != NULL)
+    {
+      g_string_append_printf (text, "%s [%s]", result->kanji_start, result->furigana_start);
+      for (link = result->variants; link != NULL; link = link->next)
+      {
+        variant = LW_RESULTVARIANT (link->data);
+        g_string_append_printf (text, " / %s [%s]", variant->kanji_start, variant->furigana_start);
+      }
+      g_string_append_c (text, '\n');
+      lw_result_free (result); result = NULL;
+    }
+
+    return g_string_free (text, FALSE);
+}
+
+
+//!
+//! @brief Runs a search to the end and writes what it found
+//!
+static gchar*
+lw_test_search_collect (LwSearch *search)
+{
+    lw_search_start (search, FALSE);
+
+    return lw_test_search_read (search);
+}
+
+
+//!
+//! @brief Removes the folder the checks wrote their dictionaries to
+//!
+static void
+lw_test_remove_directory (const gchar *PATH)
+{
+    //Declarations
+    GDir *dir;
+    const gchar *name;
+    gchar *path;
+
+    //Initializations
+    dir = g_dir_open (PATH, 0, NULL);
+
+    if (dir != NULL)
+    {
+      while ((name = g_dir_read_name (dir)) != NULL)
+      {
+        path = g_build_filename (PATH, name, NULL);
+        if (g_file_test (path, G_FILE_TEST_IS_DIR)) lw_test_remove_directory (path);
+        else g_remove (path);
+        g_free (path); path = NULL;
+      }
+      g_dir_close (dir); dir = NULL;
+    }
+
+    g_rmdir (PATH);
+}
+
+
+static void
+lw_test_search_dedup ()
+{
+    //Declarations
+    LwDictionary *dictionary;
+    LwSearch *search;
+    LwSearch *restored;
+    LwSearch *copy;
+    LwSearch *parent;
+    LwSearch *refinement;
+    GError *error;
+    gchar *snapshot;
+    gchar *expected;
+    gchar *text;
+
+    //Initializations
+    error = NULL;
+    dictionary = lw_test_dictionary_new (LW_TYPE_EDICTIONARY, "Dedup",
+      "日本 [にほん] /(n) Japan/\n"
+      "日本 [にほん] /(n) Japan/\n"
+      "日本 [にっぽん] /(n) Japan/\n"
+      "二本 [にほん] /(n) two long things/\n"
+    );
+
+    //The repeated line is dropped and the other reading is grouped under the first
+    search = lw_search_new (dictionary, "日本", 0, &error);
+    g_assert_no_error (error);
+    expected = lw_test_search_collect (search);
+    g_assert_cmpstr (expected, ==, "日本 [にほん] / 日本 [にっぽん]\n");
+
+    //A search restored from the history replays its snapshot
+    snapshot = lw_search_snapshot_to_string (search);
+    g_assert (snapshot != NULL);
+    restored = lw_search_new (dictionary, "日本", 0, &error);
+    g_assert_no_error (error);
+    g_assert (lw_search_set_snapshot_from_string (restored, snapshot));
+    text = lw_test_search_collect (restored);
+    g_assert_cmpint (restored->stream, ==, LW_SEARCH_STREAM_SNAPSHOT);
+    g_assert_cmpstr (text, ==, expected);
+    g_free (text); text = NULL;
+
+    //Printing replays a copy of the snapshot
+    copy = lw_search_new_from_snapshot (search);
+    g_assert (copy != NULL);
+    text = lw_test_search_collect (copy);
+    g_assert_cmpint (copy->stream, ==, LW_SEARCH_STREAM_SNAPSHOT);
+    g_assert_cmpstr (text, ==, expected);
+    g_free (text); text = NULL;
+
+    //A refinement only reads the lines its parent matched
+    parent = lw_search_new (dictionary, "日", 0, &error);
+    g_assert_no_error (error);
+    g_free (lw_test_search_collect (parent));
+    refinement = lw_search_new (dictionary, "日本", 0, &error);
+    g_assert_no_error (error);
+    g_assert (lw_search_set_parent (refinement, parent));
+    text = lw_test_search_collect (refinement);
+    g_assert_cmpint (refinement->stream, ==, LW_SEARCH_STREAM_CANDIDATES);
+    g_assert_cmpstr (text, ==, expected);
+    g_free (text); text = NULL;
+    lw_search_free (refinement); refinement = NULL;
+    lw_search_free (parent); parent = NULL;
+
+    //Exact searches always read the whole dictionary
+    parent = lw_search_new (dictionary, "日", LW_SEARCH_FLAG_EXACT, &error);
+    g_assert_no_error (error);
+    g_free (lw_test_search_collect (parent));
+    refinement = lw_search_new (dictionary, "日本", LW_SEARCH_FLAG_EXACT, &error);
+    g_assert_no_error (error);
+    g_assert (!lw_search_is_refinement_of (refinement, parent));
+    g_assert (!lw_search_set_parent (refinement, parent));
+    text = lw_test_search_collect (refinement);
+    g_assert_cmpint (refinement->stream, ==, LW_SEARCH_STREAM_DICTIONARY);
+    g_assert_cmpstr (text, ==, expected);
+    g_free (text); text = NULL;
+
+    lw_search_free (refinement); refinement = NULL;
+    lw_search_free (parent); parent = NULL;
+    lw_search_free (copy); copy = NULL;
+    lw_search_free (restored); restored = NULL;
+    lw_search_free (search); search = NULL;
+    g_free (snapshot); snapshot = NULL;
+    g_free (expected); expected = NULL;
+    g_object_unref (dictionary); dictionary = NULL;
+}
+
+
+static void
+lw_test_search_snapshot_string ()
+{
+    //Declarations
+    LwDictionary *dictionary;
+    LwSearch *search;
+    LwSearch *restored;
+    LwSearchSnapshotEntry *entry;
+    GError *error;
+    gchar *text;
+    gchar *saved;
+    gchar *expected;
+    gint i;
+
+    //Strings a snapshot can't be read back from
+    static const gchar *MALFORMED[] = {
+      "",
+      "12",
+      "12;34",
+      "x;34;",
+      "12;34;5",
+      "12;34;5:",
+      "12;34;-5:1",
+      "12;34;5:3",
+      "12;34;5:1;6:0",
+      "12;34;5:1,x:0",
+      NULL
+    };
+
+    //Initializations
+    error = NULL;
+    dictionary = lw_test_dictionary_new (LW_TYPE_EDICTIONARY, "Snapshot",
+      "日本 [にほん] /(n) Japan/\n"
+      "二本 [にほん] /(n) two long things/\n"
+      "日本語 [にほんご] /(n) Japanese (language)/\n"
+    );
+    search = lw_search_new (dictionary, "日本", 0, &error);
+    restored = lw_search_new (dictionary, "日本", 0, &error);
+    g_assert_no_error (error);
+
+    //Only a finished search has a snapshot to write
+    g_assert (lw_search_snapshot_to_string (search) == NULL);
+
+    //The size, time and the offset and relevance of each kept line
+    g_assert (lw_search_set_snapshot_from_string (restored, "120;1700000000;0:2,58:1"));
+    g_assert (restored->snapshot.complete);
+    g_assert_cmpint (restored->snapshot.size, ==, 120);
+    g_assert_cmpint (restored->snapshot.mtime, ==, 1700000000);
+    g_assert_cmpuint (restored->snapshot.entries->len, ==, 2);
+    entry = &g_array_index (restored->snapshot.entries, LwSearchSnapshotEntry, 1);
+    g_assert_cmpint (entry->offset, ==, 58);
+    g_assert_cmpint (entry->relevance, ==, LW_RELEVANCE_MEDIUM);
+    text = lw_search_snapshot_to_string (restored);
+    g_assert_cmpstr (text, ==, "120;1700000000;0:2,58:1");
+    g_free (text); text = NULL;
+
+    //A search without results still has a snapshot
+    g_assert (lw_search_set_snapshot_from_string (restored, "120;1700000000;"));
+    g_assert (restored->snapshot.complete);
+    g_assert_cmpuint (restored->snapshot.entries->len, ==, 0);
+
+    //Anything else leaves no snapshot at all
+    for (i = 0; MALFORMED[i] != NULL; i++)
+    {
+      g_assert (!lw_search_set_snapshot_from_string (restored, MALFORMED[i]));
+      g_assert (!restored->snapshot.complete);
+      g_assert_cmpuint (restored->snapshot.entries->len, ==, 0);
+    }
+
+    //A finished search round trips and is replayed while the file is unchanged
+    expected = lw_test_search_collect (search);
+    saved = lw_search_snapshot_to_string (search);
+    g_assert (saved != NULL);
+    g_assert (lw_search_set_snapshot_from_string (restored, saved));
+    text = lw_search_snapshot_to_string (restored);
+    g_assert_cmpstr (text, ==, saved);
+    g_free (text); text = lw_test_search_collect (restored);
+    g_assert_cmpint (restored->stream, ==, LW_SEARCH_STREAM_SNAPSHOT);
+    g_assert_cmpstr (text, ==, expected);
+    g_free (text); text = NULL;
+    lw_search_free (restored); restored = NULL;
+
+    //A snapshot of another version of the file is scanned past
+    restored = lw_search_new (dictionary, "日本", 0, &error);
+    g_assert_no_error (error);
+    g_assert (lw_search_set_snapshot_from_string (restored, "1;0;0:2"));
+    text = lw_test_search_collect (restored);
+    g_assert_cmpint (restored->stream, ==, LW_SEARCH_STREAM_DICTIONARY);
+    g_assert_cmpstr (text, ==, expected);
+    g_free (text); text = NULL;
+
+    lw_search_free (restored); restored = NULL;
+    lw_search_free (search); search = NULL;
+    g_free (saved); saved = NULL;
+    g_free (expected); expected = NULL;
+    g_object_unref (dictionary); dictionary = NULL;
+}
+
+
+static void
+lw_test_scheduler_order ()
+{
+    //Declarations
+    LwScheduler *scheduler;
+    LwScheduler *batched;
+    LwVocabulary *vocabulary;
+    LwWord *word;
+    GList *list;
+    GList *link;
+    const guint32 DUE[] = { 50, 10, 30, 10, 40, 20, 10 };
+    gpointer data[G_N_ELEMENTS (DUE)];
+    guint32 due;
+    guint32 last;
+    guint i;
+
+    //Initializations
+    scheduler = lw_scheduler_new ();
+    batched = lw_scheduler_new ();
+    for (i = 0; i < G_N_ELEMENTS (DUE); i++)
+    {
+      data[i] = GUINT_TO_POINTER (i);
+      lw_scheduler_add (scheduler, DUE[i], data[i]);
+    }
+    lw_scheduler_add_many (batched, DUE, data, G_N_ELEMENTS (DUE));
+    g_assert_cmpint (lw_scheduler_length (batched), ==, G_N_ELEMENTS (DUE));
+
+    //Adding one at a time or in a batch gives the same order, with cards due
+    //at the same time coming out in the order they were added
+    g_assert (lw_scheduler_peek (scheduler, &due) == GUINT_TO_POINTER (1));
+    g_assert_cmpuint (due, ==, 10);
+    g_assert (lw_scheduler_pop (scheduler, NULL) == lw_scheduler_pop (batched, NULL));
+    g_assert (lw_scheduler_pop (scheduler, NULL) == GUINT_TO_POINTER (3));
+    g_assert (lw_scheduler_pop (batched, NULL) == GUINT_TO_POINTER (3));
+    g_assert (lw_scheduler_pop (scheduler, NULL) == GUINT_TO_POINTER (6));
+    g_assert (lw_scheduler_pop (batched, NULL) == GUINT_TO_POINTER (6));
+    last = 10;
+    while (lw_scheduler_length (scheduler) > 0)
+    {
+      g_assert (lw_scheduler_peek (batched, NULL) == lw_scheduler_peek (scheduler, NULL));
+      lw_scheduler_pop (scheduler, &due);
+      lw_scheduler_pop (batched, NULL);
+      g_assert_cmpuint (due, >=, last);
+      last = due;
+    }
+    g_assert (lw_scheduler_pop (scheduler, NULL) == NULL);
+    g_assert (lw_scheduler_pop (batched, NULL) == NULL);
+
+    //Only the cards due by the given hour come out, most overdue first
+    lw_scheduler_add_many (scheduler, DUE, data, G_N_ELEMENTS (DUE));
+    list = lw_scheduler_pop_due (scheduler, 30, -1);
+    g_assert_cmpuint (g_list_length (list), ==, 5);
+    g_assert (g_list_nth_data (list, 3) == GUINT_TO_POINTER (5));
+    g_assert (g_list_nth_data (list, 4) == GUINT_TO_POINTER (2));
+    g_list_free (list); list = NULL;
+    list = lw_scheduler_pop_due (scheduler, 100, 1);
+    g_assert_cmpuint (g_list_length (list), ==, 1);
+    g_assert (list->data == GUINT_TO_POINTER (4));
+    g_list_free (list); list = NULL;
+    g_assert_cmpint (lw_scheduler_length (scheduler), ==, 1);
+
+    //A vocabulary list goes in by the time each word is due
+    vocabulary = lw_vocabulary_new ("test");
+    for (i = 0; i < G_N_ELEMENTS (DUE); i++)
+    {
+      word = lw_word_new ();
+      lw_word_set_hours (word, DUE[i]);
+      lw_word_set_interval (word, i % 2);
+      g_ptr_array_add (vocabulary->items, word);
+    }
+    lw_scheduler_add_vocabulary (batched, vocabulary);
+    list = lw_scheduler_pop_due (batched, G_MAXUINT32, -1);
+    g_assert_cmpuint (g_list_length (list), ==, G_N_ELEMENTS (DUE));
+    last = 0;
+    for (link = list; link != NULL; link = link->next)
+    {
+      due = lw_word_get_due_hours (LW_WORD (link->data));
+      g_assert_cmpuint (due, >=, last);
+      last = due;
+    }
+    g_list_free (list); list = NULL;
+
+    lw_vocabulary_free (vocabulary); vocabulary = NULL;
+    lw_scheduler_free (batched); batched = NULL;
+    lw_scheduler_free (scheduler); scheduler = NULL;
+}
+
+
+static void
+lw_test_scheduler_review ()
+{
+    //Declarations
+    LwWord *word;
+    const guint32 HOURS = 400000;
+
+    //Initializations
+    word = lw_word_new ();
+
+    //A new word is due right away and starts at the default ease
+    g_assert_cmpuint (lw_word_get_due_hours (word), ==, 0);
+    g_assert_cmpint (lw_word_get_ease (word), ==, LW_WORD_DEFAULT_EASE);
+
+    //Passing waits a day, then six, then grows by the ease
+    lw_scheduler_review_word (word, LW_SCHEDULER_GRADE_GOOD, HOURS);
+    g_assert_cmpint (lw_word_get_interval (word), ==, 1);
+    g_assert_cmpint (lw_word_get_ease (word), ==, 2500);
+    g_assert_cmpuint (lw_word_get_due_hours (word), ==, HOURS + 24);
+    lw_scheduler_review_word (word, LW_SCHEDULER_GRADE_GOOD, HOURS);
+    g_assert_cmpint (lw_word_get_interval (word), ==, 6);
+    lw_scheduler_review_word (word, LW_SCHEDULER_GRADE_GOOD, HOURS);
+    g_assert_cmpint (lw_word_get_interval (word), ==, 15);
+
+    //Easy answers raise the ease and hard ones lower it
+    lw_scheduler_review_word (word, LW_SCHEDULER_GRADE_EASY, HOURS);
+    g_assert_cmpint (lw_word_get_ease (word), ==, 2600);
+    g_assert_cmpint (lw_word_get_interval (word), ==, 39);
+    lw_scheduler_review_word (word, LW_SCHEDULER_GRADE_HARD, HOURS);
+    g_assert_cmpint (lw_word_get_ease (word), ==, 2460);
+
+    //A lapse starts the repetitions over but keeps the ease
+    lw_scheduler_review_word (word, LW_SCHEDULER_GRADE_AGAIN, HOURS);
+    g_assert_cmpint (lw_word_get_interval (word), ==, 0);
+    g_assert_cmpint (lw_word_get_ease (word), ==, 2460);
+    g_assert_cmpuint (lw_word_get_due_hours (word), ==, HOURS);
+    lw_scheduler_review_word (word, LW_SCHEDULER_GRADE_GOOD, HOURS);
+    g_assert_cmpint (lw_word_get_interval (word), ==, 1);
+
+    //The ease never drops below the floor
+    lw_word_set_ease (word, LW_WORD_MIN_EASE);
+    lw_scheduler_review_word (word, LW_SCHEDULER_GRADE_HARD, HOURS);
+    g_assert_cmpint (lw_word_get_ease (word), ==, LW_WORD_MIN_EASE);
+
+    lw_word_free (word); word = NULL;
+}
+
+
+//!
+//! @brief Writes a Kanji dictionary with the radicals mixed in like
+//!        lw_io_create_mix_dictionary does.  There are more than 64 kanji so
+//!        the bitsets take more than one word.  Every kanji has 一, the even
+//!        ones have 口, every tenth has 木 and only the 65th has 水.
+//!
+static gchar*
+lw_test_write_radicals_dictionary ()
+{
+    //Declarations
+    GString *text;
+    gchar *path;
+    gint i;
+
+    //Initializations
+    text = g_string_new ("# A comment line\n");
+    path = g_build_filename (g_get_user_config_dir (), "radicals-dictionary", NULL);
+
+    for (i = 0; i < 70; i++)
+    {
+      g_string_append_unichar (text, 0x4e00 + i);
+      g_string_append (text, " 一");
+      if (i % 2 == 0) g_string_append (text, " 口");
+      if (i % 10 == 0) g_string_append (text, " 木");
+      if (i == 65) g_string_append (text, " 水");
+      g_string_append_printf (text, " 3021 U%x B1 S%d {meaning}\n", 0x4e00 + i, i % 5 + 1);
+    }
+
+    g_assert (g_file_set_contents (path, text->str, text->len, NULL));
+
+    g_string_free (text, TRUE); text = NULL;
+
+    return path;
+}
+
+
+static void
+lw_test_radicalindex_check (LwRadicalIndex *index)
+{
+    //Declarations
+    gchar *possible;
+    gint i;
+
+    g_assert_cmpuint (index->kanji->len, ==, 70);
+    g_assert_cmpuint (index->radicals->len, ==, 4);
+    g_assert_cmpint (index->kanji_words, ==, 2);
+    g_assert_cmpint (index->radical_words, ==, 1);
+    for (i = 0; i < 70; i++)
+    {
+      g_assert_cmpuint (g_array_index (index->kanji, gunichar, i), ==, 0x4e00 + i);
+      g_assert_cmpuint (g_array_index (index->strokes, guint8, i), ==, i % 5 + 1);
+    }
+
+    //水 is only in the 65th kanji, which is in the second word of its bitset
+    g_assert (index->bitsets[3 * index->kanji_words] == 0);
+    g_assert (index->bitsets[3 * index->kanji_words + 1] == (G_GUINT64_CONSTANT (1) << 1));
+    g_assert (index->masks[65 * index->radical_words] == ((G_GUINT64_CONSTANT (1) << 0) | (G_GUINT64_CONSTANT (1) << 3)));
+
+    possible = lw_radicalindex_strdup_possible_radicals (index, "", 0);
+    g_assert_cmpstr (possible, ==, "一口木水");
+    g_free (possible); possible = NULL;
+
+    possible = lw_radicalindex_strdup_possible_radicals (index, "口", 0);
+    g_assert_cmpstr (possible, ==, "一口木");
+    g_free (possible); possible = NULL;
+
+    possible = lw_radicalindex_strdup_possible_radicals (index, "水", 0);
+    g_assert_cmpstr (possible, ==, "一水");
+    g_free (possible); possible = NULL;
+
+    possible = lw_radicalindex_strdup_possible_radicals (index, "口 水", 0);
+    g_assert_cmpstr (possible, ==, "");
+    g_free (possible); possible = NULL;
+
+    //The stroke count narrows the kanji down further
+    possible = lw_radicalindex_strdup_possible_radicals (index, "水", 1);
+    g_assert_cmpstr (possible, ==, "一水");
+    g_free (possible); possible = NULL;
+
+    possible = lw_radicalindex_strdup_possible_radicals (index, "水", 2);
+    g_assert_cmpstr (possible, ==, "");
+    g_free (possible); possible = NULL;
+
+    possible = lw_radicalindex_strdup_possible_radicals (index, "", 2);
+    g_assert_cmpstr (possible, ==, "一口");
+    g_free (possible); possible = NULL;
+
+    //A radical no kanji has leaves nothing
+    possible = lw_radicalindex_strdup_possible_radicals (index, "火", 0);
+    g_assert_cmpstr (possible, ==, "");
+    g_free (possible); possible = NULL;
+}
+
+
+static void
+lw_test_radicalindex ()
+{
+    //Declarations
+    LwRadicalIndex *index;
+    LwRadicalIndex *loaded;
+    GError *error;
+    gchar *path;
+    gchar *saved;
+
+    //Initializations
+    error = NULL;
+    path = lw_test_write_radicals_dictionary ();
+    saved = g_strjoin ("", path, LW_RADICALINDEX_SUFFIX, NULL);
+    index = lw_radicalindex_new ();
+    loaded = lw_radicalindex_new ();
+
+    g_assert (lw_radicalindex_build (index, path, NULL, &error));
+    g_assert_no_error (error);
+    lw_test_radicalindex_check (index);
+
+    //What is saved loads back the same, stamp included
+    g_assert (lw_radicalindex_save (index, saved, &error));
+    g_assert_no_error (error);
+    g_assert (lw_radicalindex_load (loaded, saved, &error));
+    g_assert_no_error (error);
+    g_assert (lw_sidecar_stamp_equal (&index->stamp, &loaded->stamp));
+    lw_test_radicalindex_check (loaded);
+
+    lw_radicalindex_unref (loaded); loaded = NULL;
+    lw_radicalindex_unref (index); index = NULL;
+    g_remove (saved);
+    g_remove (path);
+    g_free (saved); saved = NULL;
+    g_free (path); path = NULL;
+}
+
+
+//!
+//! @brief Sets up a pool without threads, so the searches pushed to it stay
+//!        where the checks can see them and the checks play the thread
+//!
+static void
+lw_test_searchpool_init (LwSearchPool *pool)
+{
+    //Declarations
+    gint i;
+
+    memset (pool, 0, sizeof(LwSearchPool));
+    g_mutex_init (&pool->mutex);
+    g_cond_init (&pool->cond);
+    for (i = 0; i < TOTAL_LW_SEARCH_PRIORITIES; i++)
+    {
+      g_queue_init (&pool->queues[i]);
+    }
+
+    //Pushes are refused by a pool that has no threads at all
+    pool->total_threads = 1;
+}
+
+
+static void
+lw_test_searchpool_clear (LwSearchPool *pool)
+{
+    g_mutex_clear (&pool->mutex);
+    g_cond_clear (&pool->cond);
+}
+
+
+//!
+//! @brief Makes a stand-in search with nothing to read, which is all the
+//!        queues of the pool look at
+//!
+static LwSearch*
+lw_test_search_mock_new (LwSearchPriority priority)
+{
+    //Declarations
+    LwSearch *search;
+
+    //Initializations
+    search = g_new0 (LwSearch, 1);
+    g_mutex_init (&search->mutex);
+    search->priority = priority;
+
+    return search;
+}
+
+
+static void
+lw_test_search_mock_free (LwSearch *search)
+{
+    g_mutex_clear (&search->mutex);
+    g_free (search);
+}
+
+
+static void
+lw_test_searchpool_priority ()
+{
+    //Declarations
+    LwSearchPool pool;
+    LwSearch *background;
+    LwSearch *tooltip;
+    LwSearch *interactive;
+    LwSearch *raised;
+
+    //Initializations
+    lw_test_searchpool_init (&pool);
+    background = lw_test_search_mock_new (LW_SEARCH_PRIORITY_BACKGROUND);
+    tooltip = lw_test_search_mock_new (LW_SEARCH_PRIORITY_TOOLTIP);
+    interactive = lw_test_search_mock_new (LW_SEARCH_PRIORITY_INTERACTIVE);
+    raised = lw_test_search_mock_new (LW_SEARCH_PRIORITY_BACKGROUND);
+
+    g_assert (lw_searchpool_push (&pool, background));
+    g_assert (lw_searchpool_push (&pool, tooltip));
+    g_assert (lw_searchpool_push (&pool, raised));
+    g_assert (lw_searchpool_push (&pool, interactive));
+    g_assert (background->queued && tooltip->queued && interactive->queued && raised->queued);
+
+    //A search raised while it waits goes behind the ones already there
+    lw_searchpool_set_priority (&pool, raised, LW_SEARCH_PRIORITY_INTERACTIVE);
+    g_assert_cmpint (raised->priority, ==, LW_SEARCH_PRIORITY_INTERACTIVE);
+
+    g_assert (lw_searchpool_pop (&pool) == interactive);
+    g_assert (lw_searchpool_pop (&pool) == raised);
+    g_assert (lw_searchpool_pop (&pool) == tooltip);
+    g_assert (lw_searchpool_pop (&pool) == background);
+    g_assert (lw_searchpool_pop (&pool) == NULL);
+
+    lw_test_search_mock_free (raised);
+    lw_test_search_mock_free (interactive);
+    lw_test_search_mock_free (tooltip);
+    lw_test_search_mock_free (background);
+    lw_test_searchpool_clear (&pool);
+}
+
+
+static void
+lw_test_searchpool_orphan ()
+{
+    //Declarations
+    LwSearchPool pool;
+    LwSearch *search;
+
+    //Initializations
+    lw_test_searchpool_init (&pool);
+    search = lw_test_search_mock_new (LW_SEARCH_PRIORITY_INTERACTIVE);
+
+    //A search the pool doesn't hold is freed by the caller
+    g_assert (!lw_searchpool_orphan (&pool, search));
+    g_assert (!search->orphaned);
+
+    //A waiting search is handed over to the pool
+    g_assert (lw_searchpool_push (&pool, search));
+    g_assert (lw_searchpool_orphan (&pool, search));
+    g_assert (search->orphaned);
+
+    //Canceling it takes it out of the queue for the caller to finish
+    search->orphaned = FALSE;
+    g_assert (!lw_searchpool_cancel (&pool, search));
+    g_assert (!search->queued);
+    g_assert_cmpint (g_queue_get_length (&pool.queues[LW_SEARCH_PRIORITY_INTERACTIVE]), ==, 0);
+
+    //A running search is left to the thread running it
+    search->running = TRUE;
+    g_assert (lw_searchpool_cancel (&pool, search));
+    g_assert (lw_searchpool_orphan (&pool, search));
+    g_assert (search->orphaned);
+
+    lw_test_search_mock_free (search);
+    lw_test_searchpool_clear (&pool);
+}
+
+
+struct _LwTestRemoval {
+  LwSearchPool *pool;
+  LwSearch *search;
+  gint done;
+};
+typedef struct _LwTestRemoval LwTestRemoval;
+
+
+static gpointer
+lw_test_searchpool_remove_thread (gpointer data)
+{
+    //Declarations
+    LwTestRemoval *removal;
+
+    //Initializations
+    removal = (LwTestRemoval*) data;
+
+    lw_searchpool_remove (removal->pool, removal->search);
+    g_atomic_int_set (&removal->done, 1);
+
+    return NULL;
+}
+
+
+static void
+lw_test_searchpool_remove ()
+{
+    //Declarations
+    LwDictionary *dictionary;
+    LwSearchPool pool;
+    LwSearch *search;
+    LwTestRemoval removal;
+    GThread *thread;
+    GError *error;
+    gboolean more;
+
+    //Initializations
+    error = NULL;
+    lw_test_searchpool_init (&pool);
+    dictionary = lw_test_dictionary_new (LW_TYPE_EDICTIONARY, "Pool",
+      "日本 [にほん] /(n) Japan/\n"
+      "二本 [にほん] /(n) two long things/\n"
+    );
+    search = lw_search_new (dictionary, "日本", 0, &error);
+    g_assert_no_error (error);
+
+    //Removing a running search cancels it and waits for the end of its slice
+    lw_search_prepare_search (search);
+    search->running = TRUE;
+    removal.pool = &pool;
+    removal.search = search;
+    removal.done = 0;
+    thread = g_thread_new ("test-remove", lw_test_searchpool_remove_thread, &removal);
+    while (lw_search_get_status (search) != LW_SEARCHSTATUS_CANCELING)
+    {
+      g_usleep (1000);
+    }
+    g_usleep (50000);
+    g_assert (!g_atomic_int_get (&removal.done));
+
+    more = lw_search_stream (search, LW_SEARCHPOOL_SLICE);
+    g_assert (!more);
+    g_mutex_lock (&pool.mutex);
+    search->running = FALSE;
+    g_cond_broadcast (&pool.cond);
+    g_mutex_unlock (&pool.mutex);
+    g_thread_join (thread); thread = NULL;
+
+    g_assert (g_atomic_int_get (&removal.done));
+    g_assert (!search->queued);
+    g_assert (search->fd == NULL);
+    g_assert_cmpint (search->current, ==, 0);
+    g_assert_cmpint (lw_search_get_status (search), ==, LW_SEARCHSTATUS_IDLE);
+
+    //A waiting search is dropped without reading any of it
+    lw_search_prepare_search (search);
+    g_assert (lw_searchpool_push (&pool, search));
+    lw_searchpool_remove (&pool, search);
+    g_assert (!search->queued);
+    g_assert_cmpint (g_queue_get_length (&pool.queues[search->priority]), ==, 0);
+    g_assert (search->fd == NULL);
+    g_assert_cmpint (search->current, ==, 0);
+    g_assert_cmpint (lw_search_get_status (search), ==, LW_SEARCHSTATUS_IDLE);
+    g_assert (lw_search_get_result (search) == NULL);
+
+    lw_search_free (search); search = NULL;
+    g_object_unref (dictionary); dictionary = NULL;
+    lw_test_searchpool_clear (&pool);
+}
+
+
+static void
+lw_test_searchbatch ()
+{
+    //Declarations
+    LwDictionary *dictionary;
+    LwSearchBatch *batch;
+    LwSearch *search;
+    GError *error;
+    gchar *expected[6];
+    gchar *text;
+    gint i;
+
+    //The regex query has no literal to route so it goes through the whole file
+    static const gchar *QUERIES[] = { "日本", "Japan", "本", "日.語", "猫", NULL };
+    static const LwSearchStream STREAMS[] = {
+      LW_SEARCH_STREAM_CANDIDATES,
+      LW_SEARCH_STREAM_CANDIDATES,
+      LW_SEARCH_STREAM_CANDIDATES,
+      LW_SEARCH_STREAM_DICTIONARY,
+      LW_SEARCH_STREAM_CANDIDATES
+    };
+
+    //Initializations
+    error = NULL;
+    dictionary = lw_test_dictionary_new (LW_TYPE_EDICTIONARY, "Batch",
+      "日本 [にほん] /(n) Japan/\n"
+      "日本語 [にほんご] /(n) Japanese language/\n"
+      "二本 [にほん] /(n) two long things/\n"
+      "英語 [えいご] /(n) English language/\n"
+      "本 [ほん] /(n) book/\n"
+    );
+    batch = lw_searchbatch_new (dictionary);
+
+    for (i = 0; QUERIES[i] != NULL; i++)
+    {
+      search = lw_search_new (dictionary, QUERIES[i], 0, &error);
+      g_assert_no_error (error);
+      expected[i] = lw_test_search_collect (search);
+      lw_search_free (search); search = NULL;
+
+      search = lw_search_new (dictionary, QUERIES[i], 0, &error);
+      g_assert_no_error (error);
+      lw_searchbatch_add (batch, search);
+    }
+    g_assert_cmpint (lw_searchbatch_length (batch), ==, i);
+
+    lw_searchbatch_start (batch, FALSE);
+
+    //Each search finds what it found by itself
+    for (i = 0; QUERIES[i] != NULL; i++)
+    {
+      search = lw_searchbatch_get (batch, i);
+      g_assert_cmpint (search->stream, ==, STREAMS[i]);
+      text = lw_test_search_read (search);
+      g_assert_cmpstr (text, ==, expected[i]);
+      g_free (text); text = NULL;
+      g_free (expected[i]); expected[i] = NULL;
+      lw_search_free (search); search = NULL;
+    }
+
+    lw_searchbatch_free (batch); batch = NULL;
+    g_object_unref (dictionary); dictionary = NULL;
+}
+
+
+//!
+//! @brief Ranges of a kanji query and the kanji the index should keep for
+//!        them, or NULL if the query has no ranges
+//!
+struct _LwKanjiFilterCase {
+  const gchar *strokes;
+  const gchar *grade;
+  const gchar *jlpt;
+  const gchar *frequency;
+  const gchar *kanji;
+};
+typedef struct _LwKanjiFilterCase LwKanjiFilterCase;
+
+//Kanji without a field are kept by a range of it, the way the dictionary matches them
+static const gchar _kanji_numbers_dictionary[] =
+  "# A comment line\n"
+  "一 3021 U4e00 G1 S1 F2 J4 {one}\n"
+  "二 3621 U4e8c G1 S2 F9 J4 {two}\n"
+  "五 3843 U4e94 G1 S4 F31 J4 {five}\n"
+  "日 467c U65e5 G1 S4 F1 J4 {day}\n"
+  "本 4b5c U672c G1 S5 F10 J4 {book}\n"
+  "語 386c U8a9e G2 S14 F301 J4 {word}\n"
+  "亜 3021 U4e9c S7 F1509 J1 {Asia}\n"
+  "乂 5022 U4e42 S2 {mow}\n"
+  "鬱 5f51 U9b31 G8 S29 F2022 J1 {gloom}\n"
+  "〆 2146 U3006 G9 F2500 {tie}\n";
+
+static const LwKanjiFilterCase _kanji_filter_cases[] = {
+  { "S5-7",  NULL,  NULL, NULL,    "本亜〆"         },
+  { "S7-5",  NULL,  NULL, NULL,    "本亜〆"         },
+  { NULL,    "G1",  NULL, NULL,    "一二五日本亜乂" },
+  { "S1-4",  "G1",  NULL, NULL,    "一二五日乂"     },
+  { NULL,    NULL,  "J1", NULL,    "亜乂鬱〆"       },
+  { NULL,    NULL,  NULL, "F1-10", "一二日本乂"     },
+  { "S30",   NULL,  NULL, NULL,    "〆"             },
+  { "S3",    "G2",  NULL, NULL,    ""               },
+  { NULL,    NULL,  NULL, NULL,    NULL             }
+};
+
+
+//!
+//! @brief Filters an index with the ranges of a case and writes the kanji
+//!        at the start of the lines it kept
+//!
+static gchar*
+lw_test_kanjiindex_filter (LwKanjiIndex *index, const LwKanjiFilterCase *CASE)
+{
+    //Declarations
+    LwQuery *query;
+    GArray *offsets;
+    GString *text;
+    const gchar *PATTERNS[TOTAL_LW_QUERY_RANGE_TYPES];
+    guint i;
+    gint type;
+
+    //Initializations
+    query = lw_query_new ();
+    PATTERNS[LW_QUERY_RANGE_TYPE_STROKES] = CASE->strokes;
+    PATTERNS[LW_QUERY_RANGE_TYPE_GRADE] = CASE->grade;
+    PATTERNS[LW_QUERY_RANGE_TYPE_JLPT] = CASE->jlpt;
+    PATTERNS[LW_QUERY_RANGE_TYPE_FREQUENCY] = CASE->frequency;
+    text = NULL;
+
+    lw_query_init_rangelist (query);
+    for (type = 0; type < TOTAL_LW_QUERY_RANGE_TYPES; type++)
+    {
+      if (PATTERNS[type] != NULL) lw_query_rangelist_set (query, type, lw_range_new_from_pattern (PATTERNS[type]));
+    }
+
+    offsets = lw_kanjiindex_filter (index, query);
+    if (offsets != NULL)
+    {
+      text = g_string_new (NULL);
+      for (i = 0; i < offsets->len; i++)
+      {
+        g_string_append_unichar (text, g_utf8_get_char (_kanji_numbers_dictionary + g_array_index (offsets, glong, i)));
+      }
+      g_array_free (offsets, TRUE); offsets = NULL;
+    }
+
+    lw_query_free (query); query = NULL;
+
+    return (text != NULL) ? g_string_free (text, FALSE) : NULL;
+}
+
+
+static void
+lw_test_kanjiindex_check (LwKanjiIndex *index)
+{
+    //Declarations
+    const LwKanjiFilterCase *CASE;
+    gchar *kanji;
+
+    g_assert_cmpint (lw_kanjiindex_length (index), ==, 10);
+
+    for (CASE = _kanji_filter_cases; CASE->kanji != NULL; CASE++)
+    {
+      kanji = lw_test_kanjiindex_filter (index, CASE);
+      g_assert_cmpstr (kanji, ==, CASE->kanji);
+      g_free (kanji); kanji = NULL;
+    }
+
+    //A query without ranges isn't narrowed down at all
+    g_assert (lw_test_kanjiindex_filter (index, CASE) == NULL);
+}
+
+
+static void
+lw_test_kanjiindex ()
+{
+    //Declarations
+    LwKanjiIndex *index;
+    LwKanjiIndex *loaded;
+    LwQuery *query;
+    GError *error;
+    gchar *path;
+    gchar *saved;
+
+    //Initializations
+    error = NULL;
+    path = g_build_filename (g_get_user_config_dir (), "kanji-numbers-dictionary", NULL);
+    saved = g_strjoin ("", path, LW_KANJIINDEX_SUFFIX, NULL);
+    index = lw_kanjiindex_new ();
+    loaded = lw_kanjiindex_new ();
+    query = lw_query_new ();
+
+    g_assert (g_file_set_contents (path, _kanji_numbers_dictionary, -1, NULL));
+    g_assert (lw_kanjiindex_build (index, path, NULL, &error));
+    g_assert_no_error (error);
+    lw_test_kanjiindex_check (index);
+
+    //A query that never had a range list isn't narrowed down either
+    g_assert (lw_kanjiindex_filter (index, query) == NULL);
+
+    //What is saved loads back the same, stamp included
+    g_assert (lw_kanjiindex_save (index, saved, &error));
+    g_assert_no_error (error);
+    g_assert (lw_kanjiindex_load (loaded, saved, &error));
+    g_assert_no_error (error);
+    g_assert (lw_sidecar_stamp_equal (&index->stamp, &loaded->stamp));
+    lw_test_kanjiindex_check (loaded);
+
+    lw_query_free (query); query = NULL;
+    lw_kanjiindex_unref (loaded); loaded = NULL;
+    lw_kanjiindex_unref (index); index = NULL;
+    g_remove (saved);
+    g_remove (path);
+    g_free (saved); saved = NULL;
+    g_free (path); path = NULL;
+}
+
+
+//The fourth sentence has no B line, so none of the words below it are its own
+static const gchar _examples_dictionary[] =
+  "A: 彼は何も食べなかった。\tHe ate nothing.#ID=1\n"
+  "B: 彼(かれ)[01] は 何{何も}~ 食べる{食べなかった}\n"
+  "A: 私は本を読む。\tI read a book.#ID=2\n"
+  "B: 私(わたし) は 本(ほん) を 読む\n"
+  "A: 彼は本を買った。\tHe bought a book.#ID=3\n"
+  "B: 彼(かれ) は 本 を 買う{買った}\n"
+  "A: 雨だ。\tIt is raining.#ID=4\n"
+  "A: 猫が寝る。\tThe cat sleeps.#ID=5\n"
+  "B: 猫(ねこ) が 寝る\n";
+
+
+//!
+//! @brief Looks up a word and writes the IDs of the sentences found for it,
+//!        or returns NULL if the word isn't used at all
+//!
+static gchar*
+lw_test_exampleindex_lookup (LwExampleIndex *index, const gchar *WORD)
+{
+    //Declarations
+    GArray *offsets;
+    GString *text;
+    const gchar *line;
+    guint i;
+
+    //Initializations
+    offsets = lw_exampleindex_lookup (index, WORD);
+    if (offsets == NULL) return NULL;
+    text = g_string_new (NULL);
+
+    for (i = 0; i < offsets->len; i++)
+    {
+      line = _examples_dictionary + g_array_index (offsets, glong, i);
+      g_assert (g_str_has_prefix (line, "A: "));
+      line = strstr (line, "#ID=") + strlen ("#ID=");
+      if (i > 0) g_string_append_c (text, ' ');
+      g_string_append_c (text, *line);
+    }
+
+    g_array_free (offsets, TRUE); offsets = NULL;
+
+    return g_string_free (text, FALSE);
+}
+
+
+static void
+lw_test_exampleindex_check (LwExampleIndex *index)
+{
+    //Declarations
+    gchar *ids;
+    gint i;
+
+    //A word, where it is used, or NULL if it isn't indexed
+    static const gchar *CASES[][2] = {
+      { "彼",           "1 3" },
+      { "かれ",         "1 3" },
+      { "本",           "2 3" },
+      { "ほん",         "2"   },
+      { "何",           "1"   },
+      { "食べる",       "1"   },
+      { "寝る",         "5"   },
+      { "ねこ",         "5"   },
+      { "食べなかった", NULL  },
+      { "雨",           NULL  },
+      { "犬",           NULL  },
+      { NULL,           NULL  }
+    };
+
+    //彼 かれ は 何 食べる 私 わたし 本 ほん を 読む 買う 猫 ねこ が 寝る
+    g_assert_cmpint (lw_exampleindex_length (index), ==, 16);
+
+    for (i = 0; CASES[i][0] != NULL; i++)
+    {
+      ids = lw_test_exampleindex_lookup (index, CASES[i][0]);
+      g_assert_cmpstr (ids, ==, CASES[i][1]);
+      g_free (ids); ids = NULL;
+    }
+}
+
+
+static void
+lw_test_exampleindex ()
+{
+    //Declarations
+    LwExampleIndex *index;
+    LwExampleIndex *loaded;
+    GError *error;
+    gchar *path;
+    gchar *saved;
+
+    //Initializations
+    error = NULL;
+    path = g_build_filename (g_get_user_config_dir (), "examples-dictionary", NULL);
+    saved = g_strjoin ("", path, LW_EXAMPLEINDEX_SUFFIX, NULL);
+    index = lw_exampleindex_new ();
+    loaded = lw_exampleindex_new ();
+
+    g_assert (g_file_set_contents (path, _examples_dictionary, -1, NULL));
+    g_assert (lw_exampleindex_build (index, path, NULL, &error));
+    g_assert_no_error (error);
+    lw_test_exampleindex_check (index);
+
+    //What is saved loads back the same, stamp included
+    g_assert (lw_exampleindex_save (index, saved, &error));
+    g_assert_no_error (error);
+    g_assert (lw_exampleindex_load (loaded, saved, &error));
+    g_assert_no_error (error);
+    g_assert (lw_sidecar_stamp_equal (&index->stamp, &loaded->stamp));
+    lw_test_exampleindex_check (loaded);
+
+    lw_exampleindex_unref (loaded); loaded = NULL;
+    lw_exampleindex_unref (index); index = NULL;
+    g_remove (saved);
+    g_remove (path);
+    g_free (saved); saved = NULL;
+    g_free (path); path = NULL;
+}
+
+
+static void
+lw_test_search_word ()
+{
+    //Declarations
+    LwDictionary *examples;
+    LwDictionary *words;
+    LwSearch *search;
+    GError *error;
+
+    //Initializations
+    error = NULL;
+    examples = lw_test_dictionary_new (LW_TYPE_EXAMPLEDICTIONARY, "Word", _examples_dictionary);
+    words = lw_test_dictionary_new (LW_TYPE_EDICTIONARY, "Word", "本 [ほん] /(n) book/\n");
+
+    //The sentences come from the index, which the search builds when it is missing
+    search = lw_search_new (examples, "ほん", LW_SEARCH_FLAG_WORD, &error);
+    g_assert_no_error (error);
+    g_free (lw_test_search_collect (search));
+    g_assert_cmpint (search->stream, ==, LW_SEARCH_STREAM_POSTINGS);
+    g_assert_cmpint (search->snapshot.entries->len, ==, 1);
+    g_assert_cmpint (g_array_index (search->snapshot.entries, LwSearchSnapshotEntry, 0).offset, ==, strstr (_examples_dictionary, "A: 私") - _examples_dictionary);
+    lw_search_free (search); search = NULL;
+
+    //Other dictionaries have no sentences to look up
+    search = lw_search_new (words, "本", LW_SEARCH_FLAG_WORD, &error);
+    g_assert (search == NULL);
+    g_assert (error != NULL);
+    g_clear_error (&error);
+
+    g_object_unref (words); words = NULL;
+    g_object_unref (examples); examples = NULL;
+}
+
+
+//Tokens and lines the pattern tables of every dictionary are compiled with
+//and run over.  They mix kana and latin, full and half width, and upper and
+//lower case so the caseless and \b handling of the two backends is compared.
+static const gchar *_matcher_tokens[] = {
+  "日本", "にほん", "ニホン", "japan", "JAPAN", "ｊａｐａｎ", "to be", "本", NULL
+};
+
+static const gchar *_matcher_texts[] = {
+  "日本 [にほん] /(n) Japan/(P)/",
+  "日本語 [にほんご] /(n) Japanese (language)/",
+  "御日本 [おにほん] /to be in JAPAN/",
+  "お日本で [おにほんで] /(exp) to be Japan!/",
+  "ニホン にほん ＪＡＰＡＮ ｊａｐａｎ",
+  "本 ホン もと {book} {origin} B4 G1 S5 F10",
+  "A: 私は本を日本で買った。\tJapan's books are cheap.#ID=1",
+  "japanjapan にほんにほん",
+  "",
+  NULL
+};
+
+
+//!
+//! @brief Checks that a matcher finds the same spans as a GRegex compiled
+//!        from the same expression, with and without the UTF-8 check
+//!
+static void
+lw_test_matcher_compare (LwMatcher *matcher, GRegex *regex, const gchar *TEXT)
+{
+    //Declarations
+    GMatchInfo *match_info;
+    gboolean expected;
+    gint offset;
+    gint start;
+    gint end;
+    gint regex_start;
+    gint regex_end;
+
+    //Initializations
+    offset = 0;
+
+    expected = g_regex_match (regex, TEXT, 0, NULL);
+    g_assert_cmpint (lw_matcher_match (matcher, TEXT), ==, expected);
+    g_assert_cmpint (lw_matcher_match_full (matcher, TEXT, LW_MATCHER_FLAG_VALID_UTF8), ==, expected);
+
+    while (TRUE)
+    {
+      match_info = NULL;
+      expected = g_regex_match_full (regex, TEXT, -1, offset, 0, &match_info, NULL);
+      if (expected) g_match_info_fetch_pos (match_info, 0, &regex_start, &regex_end);
+      g_match_info_free (match_info); match_info = NULL;
+
+      g_assert_cmpint (lw_matcher_find (matcher, TEXT, offset, &start, &end), ==, expected);
+      if (!expected) break;
+      g_assert_cmpint (start, ==, regex_start);
+      g_assert_cmpint (end, ==, regex_end);
+
+      g_assert (lw_matcher_find_full (matcher, TEXT, offset, LW_MATCHER_FLAG_VALID_UTF8, &start, &end));
+      g_assert_cmpint (start, ==, regex_start);
+      g_assert_cmpint (end, ==, regex_end);
+
+      //Step over empty matches like the search window does
+      if (end > start) offset = end;
+      else if (TEXT[end] != '\0') offset = g_utf8_next_char (TEXT + end) - TEXT;
+      else break;
+    }
+}
+
+
+static void
+lw_test_matcher_backends ()
+{
+    //Declarations
+    GTypeClass *klass;
+    gchar ***patterns;
+    LwMatcher *matcher;
+    GRegex *regex;
+    gchar *expression;
+    GType types[4];
+    gint i;
+    gint type;
+    gint relevance;
+    gint token;
+    gint text;
+
+    //Initializations
+    types[0] = LW_TYPE_EDICTIONARY;
+    types[1] = LW_TYPE_KANJIDICTIONARY;
+    types[2] = LW_TYPE_EXAMPLEDICTIONARY;
+    types[3] = LW_TYPE_UNKNOWNDICTIONARY;
+
+    for (i = 0; i < G_N_ELEMENTS (types); i++)
+    {
+      klass = g_type_class_ref (types[i]);
+      patterns = LW_DICTIONARY_CLASS (klass)->patterns;
+
+      for (type = 0; type < TOTAL_LW_QUERY_TYPES; type++)
+      {
+        for (relevance = 0; relevance < TOTAL_LW_RELEVANCE; relevance++)
+        {
+          if (patterns[type][relevance] == NULL) continue;
+
+          for (token = 0; _matcher_tokens[token] != NULL; token++)
+          {
+            expression = g_strdup_printf (patterns[type][relevance], _matcher_tokens[token]);
+            regex = g_regex_new (expression, LW_RE_COMPILE_FLAGS, LW_RE_EXIST_FLAGS, NULL);
+            matcher = lw_matcher_new_for_pattern (patterns[type][relevance], _matcher_tokens[token], NULL);
+            g_assert (regex != NULL);
+            g_assert (matcher != NULL);
+#ifdef WITH_PCRE2
+            //Otherwise both sides would be the same GRegex
+            g_assert (matcher->code != NULL);
+#endif
+
+            for (text = 0; _matcher_texts[text] != NULL; text++)
+            {
+              lw_test_matcher_compare (matcher, regex, _matcher_texts[text]);
+            }
+
+            lw_matcher_free (matcher); matcher = NULL;
+            g_regex_unref (regex); regex = NULL;
+            g_free (expression); expression = NULL;
+          }
+        }
+      }
+
+      g_type_class_unref (klass); klass = NULL;
+    }
+}
+
+
+static void
+lw_test_matcher_caseless ()
+{
+    //Declarations
+    LwMatcher *matcher;
+    gint start;
+    gint end;
+
+    //Latin is caseless at full width too
+    matcher = lw_matcher_new ("(ｊａｐａｎ)", NULL);
+    g_assert (lw_matcher_find (matcher, "日本 ＪＡＰＡＮ", 0, &start, &end));
+    g_assert_cmpint (start, ==, strlen ("日本 "));
+    g_assert_cmpint (end, ==, strlen ("日本 ＪＡＰＡＮ"));
+    lw_matcher_free (matcher); matcher = NULL;
+
+    //Hiragana and katakana aren't cases of each other
+    matcher = lw_matcher_new ("(にほん)", NULL);
+    g_assert (!lw_matcher_match (matcher, "ニホン"));
+    g_assert (lw_matcher_match (matcher, "おにほんで"));
+    lw_matcher_free (matcher); matcher = NULL;
+
+    //Kana are word characters, so \b doesn't fall between them
+    matcher = lw_matcher_new ("\\b(にほん)\\b", NULL);
+    g_assert (!lw_matcher_match (matcher, "おにほんで"));
+    g_assert (lw_matcher_match (matcher, "[にほん]"));
+    g_assert (lw_matcher_match_full (matcher, "JAPAN にほん", LW_MATCHER_FLAG_VALID_UTF8));
+    lw_matcher_free (matcher); matcher = NULL;
+
+    matcher = lw_matcher_new ("\\b(japan)\\b", NULL);
+    g_assert (lw_matcher_match (matcher, "/to be in JAPAN/"));
+    g_assert (!lw_matcher_match (matcher, "/Japanese/"));
+    g_assert (!lw_matcher_match (matcher, "にほんjapan"));
+    lw_matcher_free (matcher); matcher = NULL;
+}
+
+
+static const gchar _annotator_dictionary[] =
+  "# Headwords to annotate with\n"
+  "日本 [にほん] /(n) Japan/(P)/\n"
+  "日本語 [にほんご] /(n) Japanese (language)/(P)/\n"
+  "本 [ほん] /(n) book/(P)/\n"
+  "食べる [たべる] /(v1,vt) to eat/(P)/\n"
+  "読む [よむ] /(v5m,vt) to read/(P)/\n"
+  "見る;観る [みる] /(v1,vt) to see/(P)/\n"
+  "往く(iK);行く [いく(P);ゆく] /(v5k-s,vi) to go/(P)/\n"
+  "日 [ひ] /(n) day/(P)/\n";
+
+
+//!
+//! @brief Writes a token as WORD:FORM followed by the dictionary lines of its
+//!        hits, counted from the first line of _annotator_dictionary
+//!
+static void
+lw_test_annotator_append (LwAnnotator *annotator, const gchar *WORD, const gchar *FORM, GArray *hits, gpointer data)
+{
+    //Declarations
+    GString *tokens;
+    const gchar *ptr;
+    glong offset;
+    gint line;
+    guint i;
+
+    //Initializations
+    tokens = data;
+
+    g_string_append_printf (tokens, "%s:%s", WORD, FORM);
+    for (i = 0; i < hits->len; i++)
+    {
+      offset = g_array_index (hits, glong, i);
+      line = 0;
+      for (ptr = _annotator_dictionary; ptr < _annotator_dictionary + offset; ptr++)
+      {
+        if (*ptr == '\n') line++;
+      }
+      g_string_append_printf (tokens, " %d", line);
+    }
+    g_string_append_c (tokens, '\n');
+}
+
+
+//!
+//! @brief Annotates a text with the trie alone, since MeCab would split it
+//!        its own way when libwaei is built with it
+//!
+static gchar*
+lw_test_annotator_segment (LwAnnotator *annotator, const gchar *TEXT)
+{
+    //Declarations
+    GString *tokens;
+
+    //Initializations
+    tokens = g_string_new (NULL);
+
+    lw_annotator_segment (annotator, TEXT, strlen (TEXT), lw_test_annotator_append, tokens);
+
+    return g_string_free (tokens, FALSE);
+}
+
+
+static void
+lw_test_annotator_check (LwAnnotator *annotator)
+{
+    //Declarations
+    gchar *tokens;
+    gint i;
+
+    //A text and the tokens found in it
+    static const gchar *CASES[][2] = {
+      //The longest headword at each position wins
+      { "日本語の本",       "日本語:日本語 2\n本:本 3\n" },
+      { "日本の日",         "日本:日本 1\n日:日 8\n" },
+      //Readings and alternatives are headwords, without their tags
+      { "にほんごをみる",   "にほんご:にほんご 2\nみる:みる 6\n" },
+      { "観る往く行くゆく", "観る:観る 6\n往く:往く 7\n行く:行く 7\nゆく:ゆく 7\n" },
+      //Conjugations are found from their stems
+      { "本を読んだ",       "本:本 3\n読んだ:読む 5\n" },
+      { "食べませんか",     "食べません:食べる 4\n" },
+      { "食べた",           "食べた:食べる 4\n" },
+      { "見ない日",         "見ない:見る 6\n日:日 8\n" },
+      //Text without headwords is skipped
+      { "ケーキとabc",      "" },
+      { NULL,               NULL }
+    };
+
+    for (i = 0; CASES[i][0] != NULL; i++)
+    {
+      tokens = lw_test_annotator_segment (annotator, CASES[i][0]);
+      g_assert_cmpstr (tokens, ==, CASES[i][1]);
+      g_free (tokens); tokens = NULL;
+    }
+
+    g_assert (lw_annotator_lookup (annotator, "日本語", -1));
+    g_assert (lw_annotator_lookup (annotator, "日本語", strlen ("日本")));
+    g_assert (!lw_annotator_lookup (annotator, "日本人", -1));
+    g_assert (!lw_annotator_lookup (annotator, "往く(iK)", -1));
+}
+
+
+static void
+lw_test_annotator ()
+{
+    //Declarations
+    LwAnnotator *annotator;
+    LwAnnotator *loaded;
+    GError *error;
+    gchar *path;
+    gchar *saved;
+
+    //Initializations
+    error = NULL;
+    path = g_build_filename (g_get_user_config_dir (), "annotator-dictionary", NULL);
+    saved = g_strjoin ("", path, LW_ANNOTATOR_SUFFIX, NULL);
+    annotator = lw_annotator_new ();
+    loaded = lw_annotator_new ();
+
+    g_assert (g_file_set_contents (path, _annotator_dictionary, -1, NULL));
+    g_assert (lw_annotator_build (annotator, path, NULL, &error));
+    g_assert_no_error (error);
+    lw_test_annotator_check (annotator);
+
+    //The saved trie loads back the same, stamp included
+    g_assert (lw_annotator_save (annotator, saved, &error));
+    g_assert_no_error (error);
+    g_assert (lw_annotator_load (loaded, saved, &error));
+    g_assert_no_error (error);
+    g_assert (lw_sidecar_stamp_equal (&annotator->stamp, &loaded->stamp));
+    g_assert_cmpuint (loaded->nodes->len, ==, annotator->nodes->len);
+    g_assert_cmpuint (loaded->postings->len, ==, annotator->postings->len);
+    lw_test_annotator_check (loaded);
+
+    lw_annotator_free (loaded); loaded = NULL;
+    lw_annotator_free (annotator); annotator = NULL;
+    g_remove (saved);
+    g_remove (path);
+    g_free (saved); saved = NULL;
+    g_free (path); path = NULL;
+}
+
+
+//!
+//! @brief Gets the length a dictionary is listed with in the manifest
+//! @returns The length or 0 if the dictionary isn't listed
+//!
+static gsize
+lw_test_manifest_get_length (const gchar *FILENAME)
+{
+    //Declarations
+    LwDictionary *dictionary;
+    gchar **manifest;
+    gsize length;
+    gint i;
+
+    //Initializations
+    manifest = lw_dictionary_get_manifest ();
+    length = 0;
+
+    for (i = 0; manifest[i] != NULL; i++)
+    {
+      dictionary = lw_dictionary_new_from_manifest (manifest[i]);
+      if (dictionary == NULL) continue;
+      if (strcmp (lw_dictionary_get_filename (dictionary), FILENAME) == 0) length = lw_dictionary_get_length (dictionary);
+      g_object_unref (dictionary); dictionary = NULL;
+    }
+
+    g_strfreev (manifest); manifest = NULL;
+
+    return length;
+}
+
+
+static void
+lw_test_dictionary_manifest ()
+{
+    //Declarations
+    LwDictionary *dictionary;
+    FILE *file;
+    gchar *path;
+
+    //Initializations
+    dictionary = lw_test_dictionary_new (LW_TYPE_EDICTIONARY, "Manifest", "本 [ほん] /(n) book/\n");
+    path = lw_dictionary_get_path (dictionary);
+
+    lw_dictionary_invalidate_manifest ();
+    g_assert_cmpuint (lw_test_manifest_get_length ("Manifest"), ==, strlen ("本 [ほん] /(n) book/\n"));
+
+    //Written in place, which leaves the engine folder alone, so only the stamp of the line changes
+    file = g_fopen (path, "w");
+    g_assert (file != NULL);
+    fputs ("本 [ほん] /(n) book/volume/\n", file);
+    fclose (file); file = NULL;
+    g_assert_cmpuint (lw_test_manifest_get_length ("Manifest"), ==, strlen ("本 [ほん] /(n) book/volume/\n"));
+
+    g_remove (path);
+    g_assert_cmpuint (lw_test_manifest_get_length ("Manifest"), ==, 0);
+
+    g_object_unref (dictionary); dictionary = NULL;
+    g_free (path); path = NULL;
+}
+
+
+//The words the index should keep, in the order they are added
+static const gchar _fuzzy_dictionary[] =
+  "# A comment line\n"
+  "日本 [にほん] /(n) Japan/(P)/\n"
+  "日本語 [にほんご] /(n) Japanese (language)/(P)/\n"
+  "本 [ほん] /(n) book/volume/script/(P)/\n"
+  "食べる [たべる] /(v1,vt) to eat/(P)/\n"
+  "てがみ /(n) letter/EntL1234567X/\n"
+  "学校 [がっこう] /(n) school/(P)/\n"
+  "書く [かく] /(v5k) to write/(P)/\n"
+  "日本 [にっぽん] /(n) JAPAN/(P)/\n";
+
+static const gchar *_fuzzy_tokens[] = {
+  "nihon", "japan", "nihongo", "japanese", "hon", "book", "volume", "script",
+  "taberu", "eat", "tegami", "letter", "gakkou", "school", "kaku", "write",
+  "nippon", NULL
+};
+
+
+static void
+lw_test_fuzzyindex_distance ()
+{
+    //Declarations
+    gchar *long_token;
+    gint i;
+
+    //Two tokens and the edits between them
+    static const struct { const gchar *a; const gchar *b; gint distance; } CASES[] = {
+      { "",        "",        0 },
+      { "",        "abc",     3 },
+      { "school",  "school",  0 },
+      { "school",  "shcool",  2 },
+      { "japan",   "japn",    1 },
+      { "kitten",  "sitting", 3 },
+      { "flaw",    "lawn",    2 },
+      { "nihon",   "nippon",  2 },
+      { NULL,      NULL,      0 }
+    };
+
+    for (i = 0; CASES[i].a != NULL; i++)
+    {
+      g_assert_cmpint (lw_fuzzyindex_distance (CASES[i].a, CASES[i].b), ==, CASES[i].distance);
+      g_assert_cmpint (lw_fuzzyindex_distance (CASES[i].b, CASES[i].a), ==, CASES[i].distance);
+    }
+
+    //Tokens too long for the index aren't compared at all
+    long_token = g_strnfill (LW_FUZZYINDEX_MAX_LENGTH + 1, 'a');
+    g_assert_cmpint (lw_fuzzyindex_distance (long_token, "a"), ==, G_MAXINT);
+    long_token[LW_FUZZYINDEX_MAX_LENGTH] = '\0';
+    g_assert_cmpint (lw_fuzzyindex_distance (long_token, "a"), ==, LW_FUZZYINDEX_MAX_LENGTH - 1);
+    g_free (long_token); long_token = NULL;
+}
+
+
+//!
+//! @brief Corrects a word by comparing it against every token of the index,
+//!        the way lw_fuzzyindex_correct should without walking the tree
+//!
+static gchar**
+lw_test_fuzzyindex_correct_all (LwFuzzyIndex *index, const gchar *TOKEN)
+{
+    //Declarations
+    GPtrArray *corrections;
+    gchar *token;
+    gint length;
+    gint limit;
+    gint distance;
+    guint i;
+
+    //Initializations
+    token = g_ascii_strdown (TOKEN, -1);
+    length = strlen (token);
+    limit = (length > 5) ? 2 : 1;
+    corrections = g_ptr_array_new ();
+
+    if (length < LW_FUZZYINDEX_MIN_LENGTH || length > LW_FUZZYINDEX_MAX_LENGTH) goto finished;
+
+    for (i = 0; i < index->tokens->len; i++)
+    {
+      if (lw_fuzzyindex_distance (token, g_ptr_array_index (index->tokens, i)) == 0) goto finished;
+    }
+
+    for (distance = 1; distance <= limit; distance++)
+    {
+      for (i = 0; i < index->tokens->len && corrections->len < LW_FUZZYINDEX_MAX_CORRECTIONS; i++)
+      {
+        if (lw_fuzzyindex_distance (token, g_ptr_array_index (index->tokens, i)) == distance)
+          g_ptr_array_add (corrections, g_strdup (g_ptr_array_index (index->tokens, i)));
+      }
+    }
+
+finished:
+    g_free (token); token = NULL;
+    g_ptr_array_add (corrections, NULL);
+
+    return (gchar**) g_ptr_array_free (corrections, FALSE);
+}
+
+
+//!
+//! @brief Checks that the tree walk finds what comparing every token does
+//!
+static void
+lw_test_fuzzyindex_check_correct (LwFuzzyIndex *index, const gchar *TOKEN)
+{
+    //Declarations
+    gchar **corrections;
+    gchar **expected;
+    gchar *text;
+    gchar *expected_text;
+
+    //Initializations
+    corrections = lw_fuzzyindex_correct (index, TOKEN);
+    expected = lw_test_fuzzyindex_correct_all (index, TOKEN);
+    text = g_strjoinv (" ", corrections);
+    expected_text = g_strjoinv (" ", expected);
+
+    g_assert_cmpstr (text, ==, expected_text);
+
+    g_free (expected_text); expected_text = NULL;
+    g_free (text); text = NULL;
+    g_strfreev (expected); expected = NULL;
+    g_strfreev (corrections); corrections = NULL;
+}
+
+
+static void
+lw_test_fuzzyindex_check (LwFuzzyIndex *index)
+{
+    //Declarations
+    LwFuzzyIndexNode *node;
+    LwFuzzyIndexNode *sibling;
+    const gchar *TOKEN;
+    gchar **corrections;
+    gchar *token;
+    guint32 position;
+    guint i;
+    gint j;
+
+    //Mistyped words and what they correct to
+    static const gchar *CASES[][2] = {
+      { "japn",    "japan"         },
+      { "Japn",    "japan"         },
+      { "shcool",  "school"        },
+      { "nihonn",  "nihon nihongo" },
+      { "nihon",   ""              },
+      { "volum",   "volume"        },
+      { "vlume",   "volume"        },
+      { "xyzzy",   ""              },
+      { "hn",      ""              },
+      { NULL,      NULL            }
+    };
+
+    //Short words, the parts of speech and the EntL number are left out
+    g_assert_cmpuint (index->tokens->len, ==, g_strv_length ((gchar**) _fuzzy_tokens));
+    g_assert_cmpuint (index->nodes->len, ==, index->tokens->len);
+    for (i = 0; _fuzzy_tokens[i] != NULL; i++)
+    {
+      g_assert_cmpstr (g_ptr_array_index (index->tokens, i), ==, _fuzzy_tokens[i]);
+    }
+
+    //Every child is as far from its parent as it says, and no two children
+    //of a node are the same distance from it
+    for (i = 1; i < index->nodes->len; i++)
+    {
+      node = &g_array_index (index->nodes, LwFuzzyIndexNode, i);
+      g_assert_cmpuint (node->parent, <, i);
+      g_assert_cmpint (node->distance, ==, lw_fuzzyindex_distance (g_ptr_array_index (index->tokens, i), g_ptr_array_index (index->tokens, node->parent)));
+      for (position = node->sibling; position != 0; position = sibling->sibling)
+      {
+        sibling = &g_array_index (index->nodes, LwFuzzyIndexNode, position);
+        g_assert_cmpuint (sibling->parent, ==, node->parent);
+        g_assert_cmpuint (sibling->distance, !=, node->distance);
+      }
+    }
+
+    for (i = 0; CASES[i][0] != NULL; i++)
+    {
+      corrections = lw_fuzzyindex_correct (index, CASES[i][0]);
+      token = g_strjoinv (" ", corrections);
+      g_assert_cmpstr (token, ==, CASES[i][1]);
+      g_free (token); token = NULL;
+      g_strfreev (corrections); corrections = NULL;
+    }
+
+    //One edit away from every token is found like a search of every token would
+    for (i = 0; _fuzzy_tokens[i] != NULL; i++)
+    {
+      TOKEN = _fuzzy_tokens[i];
+      for (j = 0; TOKEN[j] != '\0'; j++)
+      {
+        token = g_strdup (TOKEN);
+        token[j] = 'q';
+        lw_test_fuzzyindex_check_correct (index, token);
+        memmove (token + j, token + j + 1, strlen (token + j));
+        lw_test_fuzzyindex_check_correct (index, token);
+        g_free (token); token = NULL;
+      }
+      token = g_strconcat (TOKEN, "es", NULL);
+      lw_test_fuzzyindex_check_correct (index, token);
+      g_free (token); token = NULL;
+    }
+}
+
+
+static void
+lw_test_fuzzyindex ()
+{
+    //Declarations
+    LwFuzzyIndex *index;
+    LwFuzzyIndex *loaded;
+    GError *error;
+    gchar *path;
+    gchar *saved;
+    gchar **corrections;
+
+    //Initializations
+    error = NULL;
+    path = g_build_filename (g_get_user_config_dir (), "fuzzy-dictionary", NULL);
+    saved = g_strjoin ("", path, LW_FUZZYINDEX_SUFFIX, NULL);
+    index = lw_fuzzyindex_new ();
+    loaded = lw_fuzzyindex_new ();
+
+    //An empty index has nothing to correct to
+    corrections = lw_fuzzyindex_correct (index, "japn");
+    g_assert (corrections != NULL && corrections[0] == NULL);
+    g_strfreev (corrections); corrections = NULL;
+
+    g_assert (g_file_set_contents (path, _fuzzy_dictionary, -1, NULL));
+    g_assert (lw_fuzzyindex_build (index, path, NULL, &error));
+    g_assert_no_error (error);
+    lw_test_fuzzyindex_check (index);
+
+    //What is saved loads back the same, stamp and tree included
+    g_assert (lw_fuzzyindex_save (index, saved, &error));
+    g_assert_no_error (error);
+    g_assert (lw_fuzzyindex_load (loaded, saved, &error));
+    g_assert_no_error (error);
+    g_assert (lw_sidecar_stamp_equal (&index->stamp, &loaded->stamp));
+    g_assert (memcmp (index->nodes->data, loaded->nodes->data, index->nodes->len * sizeof(LwFuzzyIndexNode)) == 0);
+    lw_test_fuzzyindex_check (loaded);
+
+    lw_fuzzyindex_unref (loaded); loaded = NULL;
+    lw_fuzzyindex_unref (index); index = NULL;
+    g_remove (saved);
+    g_remove (path);
+    g_free (saved); saved = NULL;
+    g_free (path); path = NULL;
+}
+
+
+int
+main (int argc, char *argv[])
+{
+    //Declarations
+    gchar *directory;
+    gint resolution;
+
+    g_type_init ();
+    g_test_init (&argc, &argv, NULL);
+    lw_regex_initialize ();
+
+    //Dictionaries written by the checks go in a folder of their own
+    directory = g_dir_make_tmp ("libwaei-test-XXXXXX", NULL);
+    g_assert (directory != NULL);
+    g_setenv ("XDG_CONFIG_HOME", directory, TRUE);
+
+    g_test_add_func ("/libwaei/utilities/romaji-to-kana", lw_test_romaji_to_kana);
+    g_test_add_func ("/libwaei/utilities/romaji-buffer-size", lw_test_romaji_buffer_size);
+    g_test_add_func ("/libwaei/utilities/unichar-get-script", lw_test_unichar_get_script);
+    g_test_add_func ("/libwaei/utilities/span-range", lw_test_span_range);
+    g_test_add_func ("/libwaei/utilities/span-ascii", lw_test_span_ascii);
+    g_test_add_func ("/libwaei/utilities/script-predicates", lw_test_script_predicates);
+    g_test_add_func ("/libwaei/utilities/shift-kana", lw_test_shift_kana);
+
+    g_test_add_func ("/libwaei/deinflector/deinflect", lw_test_deinflect);
+
+    g_test_add_func ("/libwaei/search/dedup", lw_test_search_dedup);
+    g_test_add_func ("/libwaei/search/snapshot-string", lw_test_search_snapshot_string);
+
+    g_test_add_func ("/libwaei/scheduler/order", lw_test_scheduler_order);
+    g_test_add_func ("/libwaei/scheduler/review", lw_test_scheduler_review);
+
+    g_test_add_func ("/libwaei/radicalindex/build-save-load", lw_test_radicalindex);
+
+    g_test_add_func ("/libwaei/searchpool/priority", lw_test_searchpool_priority);
+    g_test_add_func ("/libwaei/searchpool/orphan", lw_test_searchpool_orphan);
+    g_test_add_func ("/libwaei/searchpool/remove", lw_test_searchpool_remove);
+
+    g_test_add_func ("/libwaei/searchbatch/matches-alone", lw_test_searchbatch);
+
+    g_test_add_func ("/libwaei/kanjiindex/filter", lw_test_kanjiindex);
+
+    g_test_add_func ("/libwaei/exampleindex/build-save-load", lw_test_exampleindex);
+    g_test_add_func ("/libwaei/search/word", lw_test_search_word);
+
+    g_test_add_func ("/libwaei/matcher/backends-agree", lw_test_matcher_backends);
+    g_test_add_func ("/libwaei/matcher/caseless", lw_test_matcher_caseless);
+
+    g_test_add_func ("/libwaei/annotator/build-save-load", lw_test_annotator);
+
+    g_test_add_func ("/libwaei/dictionary/manifest", lw_test_dictionary_manifest);
+
+    g_test_add_func ("/libwaei/fuzzyindex/distance", lw_test_fuzzyindex_distance);
+    g_test_add_func ("/libwaei/fuzzyindex/build-save-load", lw_test_fuzzyindex);
+
+    resolution = g_test_run ();
+
+    lw_test_remove_directory (directory);
+    g_free (directory); directory = NULL;
+
+    return resolution;
+}
@@ -197,12 +197,14 @@ lw_unknowndictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult
     g_return_val_if_fail (result != NULL, FALSE);
 
     //Declarations
+    LwMatcherFlags flags;
     gboolean found;
     gboolean checked;
     GList *link;
-    GRegex *regex;
+    LwMatcher *matcher;
 
     //Initializations
+    flags = (result->valid_utf8) ? LW_MATCHER_FLAG_VALID_UTF8 : 0;
     checked = FALSE;
     found = TRUE;
 
@@ -210,11 +212,11 @@ lw_unknowndictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult
     link = lw_query_regexgroup_get (query, LW_QUERY_TYPE_KANJI, RELEVANCE);
     while (link != NULL)
     {
-      regex = link->data;
-      if (regex == NULL || result->text == NULL) return FALSE;
+      matcher = link->data;
+      if (matcher == NULL || result->text == NULL) return FALSE;
 
       checked = TRUE;
-      found = g_regex_match (regex, result->text, 0, NULL);
+      found = lw_matcher_match_full (matcher, result->text, flags);
       if (found == FALSE) return found;
 
       link = link->next;
@@ -224,11 +226,11 @@ lw_unknowndictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult
     link = lw_query_regexgroup_get (query, LW_QUERY_TYPE_FURIGANA, RELEVANCE);
     while (link != NULL)
     {
-      regex = link->data;
-      if (regex == NULL || result->text == NULL) return FALSE;
+      matcher = link->data;
+      if (matcher == NULL || result->text == NULL) return FALSE;
 
       checked = TRUE;
-      found = g_regex_match (regex, result->text, 0, NULL);
+      found = lw_matcher_match_full (matcher, result->text, flags);
       if (found == FALSE) return found;
 
       link = link->next;
@@ -238,11 +240,11 @@ lw_unknowndictionary_compare (LwDictionary *dictionary, LwQuery *query, LwResult
     link = lw_query_regexgroup_get (query, LW_QUERY_TYPE_ROMAJI, RELEVANCE);
     while (link != NULL)
     {
-      regex = link->data;
-      if (regex == NULL || result->text == NULL) return FALSE;
+      matcher = link->data;
+      if (matcher == NULL || result->text == NULL) return FALSE;
 
       checked = TRUE;
-      found = g_regex_match (regex, result->text, 0, NULL);
+      found = lw_matcher_match_full (matcher, result->text, flags);
       if (found == FALSE) return found;
 
       link = link->next;
@@ -31,6 +31,9 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <locale.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 #include <glib.h>
 #include <glib/gstdio.h>
@@ -167,6 +170,360 @@ lw_util_get_encodingname (const LwEncoding ENCODING)
 }
 
 
+//!
+//! @brief An inclusive range of 3 byte UTF-8 characters that all share a script
+//!
+//! UTF-8 preserves code point order byte for byte, so a character can be
+//! tested against the range with plain lexicographic comparisons and never
+//! has to be decoded.
+//!
+struct _LwUtf8Range {
+  guchar lower[3];
+  guchar upper[3];
+};
+typedef struct _LwUtf8Range LwUtf8Range;
+
+//These are kept to code points whose script has been stable since long
+//before the minimum supported glib so the fast paths can never disagree
+//with g_unichar_get_script ()
+static const LwUtf8Range _lw_utf8_range_hiragana = { { 0xE3, 0x81, 0x81 }, { 0xE3, 0x82, 0x96 } }; //U+3041-U+3096
+static const LwUtf8Range _lw_utf8_range_katakana = { { 0xE3, 0x82, 0xA1 }, { 0xE3, 0x83, 0xBA } }; //U+30A1-U+30FA
+static const LwUtf8Range _lw_utf8_range_han      = { { 0xE4, 0xB8, 0x80 }, { 0xE9, 0xBE, 0xA5 } }; //U+4E00-U+9FA5
+
+
+//!
+//! @brief Returns the fast path range for a script or NULL if there isn't one
+//!
+static const LwUtf8Range*
+lw_util_get_utf8_range (GUnicodeScript script)
+{
+    switch (script)
+    {
+      case G_UNICODE_SCRIPT_HIRAGANA:
+        return &_lw_utf8_range_hiragana;
+      case G_UNICODE_SCRIPT_KATAKANA:
+        return &_lw_utf8_range_katakana;
+      case G_UNICODE_SCRIPT_HAN:
+        return &_lw_utf8_range_han;
+      default:
+        return NULL;
+    }
+}
+
+
+//!
+//! @brief g_unichar_get_script () with the Japanese blocks answered inline
+//!
+static inline GUnicodeScript
+lw_util_unichar_get_script (gunichar character)
+{
+    if (character >= 0x3041 && character <= 0x3096) return G_UNICODE_SCRIPT_HIRAGANA;
+    if (character >= 0x30A1 && character <= 0x30FA) return G_UNICODE_SCRIPT_KATAKANA;
+    if (character >= 0x4E00 && character <= 0x9FA5) return G_UNICODE_SCRIPT_HAN;
+    return g_unichar_get_script (character);
+}
+
+
+//!
+//! @brief Checks a single 3 byte character against a range
+//!
+static inline gboolean
+lw_util_utf8_char_in_range (const guchar *ptr, const LwUtf8Range *RANGE)
+{
+    //Declarations
+    guint32 value;
+
+    if ((ptr[1] & 0xC0) != 0x80 || (ptr[2] & 0xC0) != 0x80) return FALSE;
+    value = (ptr[0] << 16) | (ptr[1] << 8) | ptr[2];
+
+    return (value >= (guint32) ((RANGE->lower[0] << 16) | (RANGE->lower[1] << 8) | RANGE->lower[2]) &&
+            value <= (guint32) ((RANGE->upper[0] << 16) | (RANGE->upper[1] << 8) | RANGE->upper[2]));
+}
+
+
+#ifdef __SSE2__
+
+//!
+//! @brief The role of each byte of a 48 byte block of 3 byte characters.
+//!        0 is the lead byte, 1 the middle byte and 2 the trailing byte.
+//!
+static const guchar _lw_utf8_block_roles[48] = {
+  0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0,
+  1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1,
+  2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2
+};
+
+
+static inline __m128i
+lw_util_sse2_role_mask (gint vector, gint role)
+{
+    return _mm_cmpeq_epi8 (_mm_loadu_si128 ((const __m128i*) (_lw_utf8_block_roles + vector * 16)), _mm_set1_epi8 (role));
+}
+
+
+//!
+//! @brief Unsigned byte wise a > b
+//!
+static inline __m128i
+lw_util_sse2_cmpgt_epu8 (__m128i a, guchar b)
+{
+    const __m128i bias = _mm_set1_epi8 ((gchar) 0x80);
+    return _mm_cmpgt_epi8 (_mm_xor_si128 (a, bias), _mm_set1_epi8 ((gchar) (b ^ 0x80)));
+}
+
+
+//!
+//! @brief Moves every byte one lane up, pulling the top lane of previous into lane 0
+//!
+static inline __m128i
+lw_util_sse2_shift_up (__m128i previous, __m128i current)
+{
+    return _mm_or_si128 (_mm_slli_si128 (current, 1), _mm_srli_si128 (previous, 15));
+}
+
+
+//!
+//! @brief Moves every byte one lane down, pulling lane 0 of next into the top lane
+//!
+static inline __m128i
+lw_util_sse2_shift_down (__m128i current, __m128i next)
+{
+    return _mm_or_si128 (_mm_srli_si128 (current, 1), _mm_slli_si128 (next, 15));
+}
+
+
+//!
+//! @brief Checks that 48 bytes are exactly 16 characters inside of a range
+//!
+static gboolean
+lw_util_sse2_block_in_range (const guchar *ptr, const LwUtf8Range *RANGE)
+{
+    //Declarations
+    __m128i bytes[3];
+    __m128i lower_gt[3], lower_eq[3], upper_lt[3], upper_eq[3];
+    __m128i lower_mid_gt, lower_mid_eq, upper_mid_lt, upper_mid_eq;
+    __m128i previous_lower_gt, previous_lower_eq, previous_upper_lt, previous_upper_eq;
+    __m128i lower_ok, upper_ok, is_continuation, ok;
+    const __m128i ones = _mm_set1_epi8 ((gchar) 0xFF);
+    gint i;
+
+    for (i = 0; i < 3; i++) bytes[i] = _mm_loadu_si128 ((const __m128i*) (ptr + i * 16));
+
+    //First the comparisons of the lead bytes are carried into the middle lanes...
+    for (i = 0; i < 3; i++)
+    {
+      lower_gt[i] = lw_util_sse2_cmpgt_epu8 (bytes[i], RANGE->lower[0]);
+      lower_eq[i] = _mm_cmpeq_epi8 (bytes[i], _mm_set1_epi8 (RANGE->lower[0]));
+      upper_lt[i] = _mm_andnot_si128 (lw_util_sse2_cmpgt_epu8 (bytes[i], RANGE->upper[0] - 1), ones);
+      upper_eq[i] = _mm_cmpeq_epi8 (bytes[i], _mm_set1_epi8 (RANGE->upper[0]));
+    }
+    previous_lower_gt = previous_lower_eq = previous_upper_lt = previous_upper_eq = _mm_setzero_si128 ();
+    for (i = 0; i < 3; i++)
+    {
+      lower_mid_gt = lw_util_sse2_shift_up (previous_lower_gt, lower_gt[i]);
+      lower_mid_eq = lw_util_sse2_shift_up (previous_lower_eq, lower_eq[i]);
+      upper_mid_lt = lw_util_sse2_shift_up (previous_upper_lt, upper_lt[i]);
+      upper_mid_eq = lw_util_sse2_shift_up (previous_upper_eq, upper_eq[i]);
+      previous_lower_gt = lower_gt[i];
+      previous_lower_eq = lower_eq[i];
+      previous_upper_lt = upper_lt[i];
+      previous_upper_eq = upper_eq[i];
+
+      lower_gt[i] = _mm_or_si128 (lower_mid_gt, _mm_and_si128 (lower_mid_eq, lw_util_sse2_cmpgt_epu8 (bytes[i], RANGE->lower[1])));
+      lower_eq[i] = _mm_and_si128 (lower_mid_eq, _mm_cmpeq_epi8 (bytes[i], _mm_set1_epi8 (RANGE->lower[1])));
+      upper_lt[i] = _mm_or_si128 (upper_mid_lt, _mm_andnot_si128 (lw_util_sse2_cmpgt_epu8 (bytes[i], RANGE->upper[1] - 1), upper_mid_eq));
+      upper_eq[i] = _mm_and_si128 (upper_mid_eq, _mm_cmpeq_epi8 (bytes[i], _mm_set1_epi8 (RANGE->upper[1])));
+    }
+
+    //...and then into the trailing lanes where the whole character is decided
+    previous_lower_gt = previous_lower_eq = previous_upper_lt = previous_upper_eq = _mm_setzero_si128 ();
+    for (i = 0; i < 3; i++)
+    {
+      lower_ok = _mm_or_si128 (
+        lw_util_sse2_shift_up (previous_lower_gt, lower_gt[i]),
+        _mm_and_si128 (lw_util_sse2_shift_up (previous_lower_eq, lower_eq[i]), lw_util_sse2_cmpgt_epu8 (bytes[i], RANGE->lower[2] - 1))
+      );
+      upper_ok = _mm_or_si128 (
+        lw_util_sse2_shift_up (previous_upper_lt, upper_lt[i]),
+        _mm_andnot_si128 (lw_util_sse2_cmpgt_epu8 (bytes[i], RANGE->upper[2]), lw_util_sse2_shift_up (previous_upper_eq, upper_eq[i]))
+      );
+      previous_lower_gt = lower_gt[i];
+      previous_lower_eq = lower_eq[i];
+      previous_upper_lt = upper_lt[i];
+      previous_upper_eq = upper_eq[i];
+
+      is_continuation = _mm_cmpeq_epi8 (_mm_and_si128 (bytes[i], _mm_set1_epi8 ((gchar) 0xC0)), _mm_set1_epi8 ((gchar) 0x80));
+
+      ok = _mm_or_si128 (
+        lw_util_sse2_role_mask (i, 0),
+        _mm_and_si128 (is_continuation, _mm_or_si128 (
+          lw_util_sse2_role_mask (i, 1),
+          _mm_and_si128 (lw_util_sse2_role_mask (i, 2), _mm_and_si128 (lower_ok, upper_ok))
+        ))
+      );
+      if (_mm_movemask_epi8 (ok) != 0xFFFF) return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Adds shift to 16 characters of a 48 byte block known to be in a range
+//!        where every shifted character stays 3 bytes long
+//!
+static void
+lw_util_sse2_block_shift (guchar *ptr, gint shift)
+{
+    //Declarations
+    __m128i bytes[3];
+    __m128i carry[3];
+    __m128i delta, mid_carry, next;
+    guchar trail_shift, mid_shift;
+    gint i;
+
+    //Initializations
+    trail_shift = (guchar) (shift & 0x3F);
+    mid_shift = (guchar) (shift >> 6);
+
+    for (i = 0; i < 3; i++)
+    {
+      bytes[i] = _mm_loadu_si128 ((const __m128i*) (ptr + i * 16));
+      carry[i] = _mm_and_si128 (lw_util_sse2_role_mask (i, 2), lw_util_sse2_cmpgt_epu8 (bytes[i], 0xBF - trail_shift));
+    }
+
+    for (i = 0; i < 3; i++)
+    {
+      next = (i < 2) ? carry[i + 1] : _mm_setzero_si128 ();
+      mid_carry = lw_util_sse2_shift_down (carry[i], next);
+      delta = _mm_or_si128 (
+        _mm_and_si128 (lw_util_sse2_role_mask (i, 1), _mm_sub_epi8 (_mm_set1_epi8 ((gchar) mid_shift), mid_carry)),
+        _mm_and_si128 (lw_util_sse2_role_mask (i, 2), _mm_sub_epi8 (_mm_set1_epi8 ((gchar) trail_shift), _mm_and_si128 (carry[i], _mm_set1_epi8 (0x40))))
+      );
+      _mm_storeu_si128 ((__m128i*) (ptr + i * 16), _mm_add_epi8 (bytes[i], delta));
+    }
+}
+
+#endif
+
+
+//!
+//! @brief Returns the number of leading bytes made up of characters inside of a range
+//!
+//! With SSE2 whole blocks of 16 characters are checked at once and the
+//! remainder is finished a character at a time.
+//!
+static gsize
+lw_util_utf8_span_range (const gchar *TEXT, gsize length, const LwUtf8Range *RANGE)
+{
+    //Declarations
+    const guchar *ptr;
+    const guchar *end;
+
+    //Initializations
+    ptr = (const guchar*) TEXT;
+    end = ptr + length;
+
+#ifdef __SSE2__
+    while (end - ptr >= 48 && lw_util_sse2_block_in_range (ptr, RANGE)) ptr += 48;
+#endif
+    while (end - ptr >= 3 && lw_util_utf8_char_in_range (ptr, RANGE)) ptr += 3;
+
+    return (ptr - (const guchar*) TEXT);
+}
+
+
+//!
+//! @brief Returns the number of leading ASCII bytes, optionally stopping at letters
+//!
+//! Everything in ASCII is either LATIN or COMMON, so a run of it can be
+//! accepted wholesale when the letters are acceptable too.
+//!
+static gsize
+lw_util_utf8_span_ascii (const gchar *TEXT, gsize length, gboolean allow_letters)
+{
+    //Declarations
+    const guchar *ptr;
+    const guchar *end;
+
+    //Initializations
+    ptr = (const guchar*) TEXT;
+    end = ptr + length;
+
+#ifdef __SSE2__
+    while (end - ptr >= 16)
+    {
+      __m128i bytes = _mm_loadu_si128 ((const __m128i*) ptr);
+      __m128i reject = bytes;
+      if (!allow_letters)
+      {
+        __m128i folded = _mm_or_si128 (bytes, _mm_set1_epi8 (0x20));
+        reject = _mm_or_si128 (reject, _mm_and_si128 (
+          _mm_cmpgt_epi8 (folded, _mm_set1_epi8 ('a' - 1)),
+          _mm_cmplt_epi8 (folded, _mm_set1_epi8 ('z' + 1))
+        ));
+      }
+      if (_mm_movemask_epi8 (reject) != 0) break;
+      ptr += 16;
+    }
+#endif
+    while (ptr < end && *ptr < 0x80 && (allow_letters || !g_ascii_isalpha (*ptr))) ptr++;
+
+    return (ptr - (const guchar*) TEXT);
+}
+
+
+//!
+//! @brief Checks that every character of a string is COMMON or one of the
+//!        scripts passed.  The fast paths skip over ASCII and the Japanese
+//!        blocks before falling back to g_unichar_get_script ().
+//!
+static gboolean
+lw_util_str_has_only_scripts (const gchar *TEXT, const GUnicodeScript *SCRIPTS, gint total)
+{
+    //Declarations
+    const gchar *ptr;
+    const gchar *end;
+    const LwUtf8Range *range;
+    gboolean allow_letters;
+    gboolean is_consistant;
+    GUnicodeScript script;
+    gsize span;
+    gint i;
+
+    //Initializations
+    ptr = TEXT;
+    end = TEXT + strlen (TEXT);
+    allow_letters = FALSE;
+    for (i = 0; i < total; i++) if (SCRIPTS[i] == G_UNICODE_SCRIPT_LATIN) allow_letters = TRUE;
+
+    while (ptr < end)
+    {
+      //Skip over everything the fast paths can vouch for
+      do {
+        span = lw_util_utf8_span_ascii (ptr, end - ptr, allow_letters);
+        for (i = 0; i < total; i++)
+        {
+          range = lw_util_get_utf8_range (SCRIPTS[i]);
+          if (range != NULL) span += lw_util_utf8_span_range (ptr + span, end - ptr - span, range);
+        }
+        ptr += span;
+      } while (span > 0);
+      if (ptr >= end) break;
+
+      //Anything else gets a proper lookup
+      script = lw_util_unichar_get_script (g_utf8_get_char (ptr));
+      is_consistant = (script == G_UNICODE_SCRIPT_COMMON);
+      for (i = 0; i < total && !is_consistant; i++) if (script == SCRIPTS[i]) is_consistant = TRUE;
+      if (!is_consistant) return FALSE;
+
+      ptr = g_utf8_next_char (ptr);
+    }
+
+    return TRUE;
+}
+
+
 //!
 //! @brief Convenience function for seeing if a string is hiragana
 //! @param input The string to check
@@ -179,25 +536,9 @@ gboolean
 lw_util_is_hiragana_str (const char *input)
 {
     //Declarations
-    gboolean is_consistant;
-    gunichar character;
-    GUnicodeScript script;
-    const char *ptr;
-
-    //Initializations
-    is_consistant = TRUE;
-    
-    //Loop over the string checking for characters inconsistant with the script
-    for (ptr = input; *ptr != '\0' && is_consistant; ptr = g_utf8_next_char (ptr))
-    {
-      character = g_utf8_get_char (ptr);
-      script = g_unichar_get_script (character);
-      if (script != G_UNICODE_SCRIPT_HIRAGANA &&
-          script != G_UNICODE_SCRIPT_COMMON)
-        is_consistant = FALSE;
-    }
+    const GUnicodeScript scripts[] = { G_UNICODE_SCRIPT_HIRAGANA };
 
-    return is_consistant;
+    return lw_util_str_has_only_scripts (input, scripts, G_N_ELEMENTS (scripts));
 }
 
 
@@ -213,25 +554,9 @@ gboolean
 lw_util_is_katakana_str (const char *input)
 {
     //Declarations
-    gboolean is_consistant;
-    gunichar character;
-    GUnicodeScript script;
-    const char *ptr;
-
-    //Initializations
-    is_consistant = TRUE;
-    
-    //Loop over the string checking for characters inconsistant with the script
-    for (ptr = input; *ptr != '\0' && is_consistant; ptr = g_utf8_next_char (ptr))
-    {
-      character = g_utf8_get_char (ptr);
-      script = g_unichar_get_script (character);
-      if (script != G_UNICODE_SCRIPT_KATAKANA &&
-          script != G_UNICODE_SCRIPT_COMMON)
-        is_consistant = FALSE;
-    }
+    const GUnicodeScript scripts[] = { G_UNICODE_SCRIPT_KATAKANA };
 
-    return is_consistant;
+    return lw_util_str_has_only_scripts (input, scripts, G_N_ELEMENTS (scripts));
 }
 
 
@@ -263,27 +588,9 @@ gboolean
 lw_util_is_kanji_ish_str (const char *input)
 {
     //Declarations
-    gboolean is_consistant;
-    gunichar character;
-    GUnicodeScript script;
-    const char *ptr;
-
-    //Initializations
-    is_consistant = TRUE;
-    
-    //Loop over the string checking for characters inconsistant with the script
-    for (ptr = input; *ptr != '\0' && is_consistant; ptr = g_utf8_next_char (ptr))
-    {
-      character = g_utf8_get_char (ptr);
-      script = g_unichar_get_script (character);
-      if (script != G_UNICODE_SCRIPT_HAN &&
-          script != G_UNICODE_SCRIPT_HIRAGANA &&
-          script != G_UNICODE_SCRIPT_KATAKANA &&
-          script != G_UNICODE_SCRIPT_COMMON)
-        is_consistant = FALSE;
-    }
+    const GUnicodeScript scripts[] = { G_UNICODE_SCRIPT_HAN, G_UNICODE_SCRIPT_HIRAGANA, G_UNICODE_SCRIPT_KATAKANA };
 
-    return is_consistant;
+    return lw_util_str_has_only_scripts (input, scripts, G_N_ELEMENTS (scripts));
 }
 
 //!
@@ -298,25 +605,9 @@ gboolean
 lw_util_is_kanji_str (const char *input)
 {
     //Declarations
-    gboolean is_consistant;
-    gunichar character;
-    GUnicodeScript script;
-    const char *ptr;
-
-    //Initializations
-    is_consistant = TRUE;
-    
-    //Loop over the string checking for characters inconsistant with the script
-    for (ptr = input; *ptr != '\0' && is_consistant; ptr = g_utf8_next_char (ptr))
-    {
-      character = g_utf8_get_char (ptr);
-      script = g_unichar_get_script (character);
-      if (script != G_UNICODE_SCRIPT_HAN &&
-          script != G_UNICODE_SCRIPT_COMMON)
-        is_consistant = FALSE;
-    }
+    const GUnicodeScript scripts[] = { G_UNICODE_SCRIPT_HAN };
 
-    return is_consistant;
+    return lw_util_str_has_only_scripts (input, scripts, G_N_ELEMENTS (scripts));
 }
 
 
@@ -332,25 +623,9 @@ gboolean
 lw_util_is_romaji_str (const char *input)
 {
     //Declarations
-    gboolean is_consistant;
-    gunichar character;
-    GUnicodeScript script;
-    const char *ptr;
+    const GUnicodeScript scripts[] = { G_UNICODE_SCRIPT_LATIN };
 
-    //Initializations
-    is_consistant = TRUE;
-    
-    //Loop over the string checking for characters inconsistant with the script
-    for (ptr = input; *ptr != '\0' && is_consistant; ptr = g_utf8_next_char (ptr))
-    {
-      character = g_utf8_get_char (ptr);
-      script = g_unichar_get_script (character);
-      if (script != G_UNICODE_SCRIPT_LATIN && 
-          script != G_UNICODE_SCRIPT_COMMON)
-        is_consistant = FALSE;
-    }
-
-    return is_consistant;
+    return lw_util_str_has_only_scripts (input, scripts, G_N_ELEMENTS (scripts));
 }
 
 
@@ -376,38 +651,52 @@ lw_util_is_yojijukugo_str (const char* INPUT)
 void 
 lw_util_shift_kana_chars_in_str_by (char *input, int shift)
 {
-    //Setup
-    char *input_ptr;
-    input_ptr = input;
-
-    char output[strlen(input) + 1];
-    char *output_ptr;
-    output_ptr = output;
-
-    gunichar unic;
-    unic = g_utf8_get_char(input_ptr);
+    //Declarations
+    gchar *ptr;
+    gchar *end;
+    gchar *next;
+    gint lower;
+    gint upper;
+    gunichar character;
+#ifdef __SSE2__
+    LwUtf8Range range;
+    gboolean has_range;
+#endif
 
-    gint offset = 0;
+    //Initializations
+    ptr = input;
+    end = input + strlen (input);
+    lower = MAX (0x3041, 0x3041 - shift);
+    upper = MIN (0x30ff, 0x30ff - shift);
+    if (lower > upper) return;
+
+#ifdef __SSE2__
+    //ー is never shifted, so the block range has to stop short of it
+    has_range = (lower <= 0x30fb);
+    if (has_range)
+    {
+      g_unichar_to_utf8 (lower, (gchar*) range.lower);
+      g_unichar_to_utf8 (MIN (upper, 0x30fb), (gchar*) range.upper);
+    }
+#endif
 
-    //Start the conversion
-    while (*input_ptr != '\0')
+    //Everything that gets shifted stays 3 bytes long so it can be done in place
+    while (ptr < end)
     {
-      if (unic >= 0x3041 && unic <= 0x30ff &&
-          unic + shift >= 0x3041 && unic + shift <= 0x30ff &&
-          unic != L'ー') {
-        offset = g_unichar_to_utf8((unic + shift), output_ptr);
-      }
-      else {
-        offset = g_unichar_to_utf8((unic), output_ptr);
+#ifdef __SSE2__
+      while (has_range && end - ptr >= 48 && lw_util_sse2_block_in_range ((guchar*) ptr, &range))
+      {
+        lw_util_sse2_block_shift ((guchar*) ptr, shift);
+        ptr += 48;
       }
-      output_ptr = output_ptr + offset;
-
-      input_ptr = g_utf8_next_char(input_ptr);
-      unic = g_utf8_get_char(input_ptr);
+      if (ptr >= end) break;
+#endif
+      character = g_utf8_get_char (ptr);
+      next = g_utf8_next_char (ptr);
+      if (character >= lower && character <= upper && character != L'ー')
+        g_unichar_to_utf8 (character + shift, ptr);
+      ptr = next;
     }
-    *output_ptr = *input_ptr;
-
-    strcpy(input, output);
 }
 
 
@@ -440,471 +729,344 @@ lw_util_str_shift_kata_to_hira (char input[])
 
 
 //!
-//! @brief Gets the next hiragana equivalent char pointer in a string
+//! @brief A single romaji to kana mapping used to build the conversion trie
 //!
-//! This function returns the hiragana equivalent and skips the romanji equivalent
-//! forward in the string.  This function is used for romaji->hiragana conversions.
+struct _LwRomajiMapping {
+  const gchar *romaji;
+  const gchar *kana[TOTAL_LW_KANA_TYPES];
+};
+typedef struct _LwRomajiMapping LwRomajiMapping;
+
 //!
-//! @param input The string to jump around
-//! @return where the next hiragana equivalent character would start
+//! @brief The romaji to kana mapping table.  Every romaji spelling that the
+//!        transducer understands is listed here exactly once.
 //!
-const char* 
-lw_util_next_hira_char_from_roma (const char *input)
-{
-    const char *input_ptr;
-    input_ptr = input;
-
-    int total_n = 0;
-
-    //Cautiously up a character
-    if (*input_ptr == 'n')
-      total_n++;
-    if (*input_ptr != '\0')
-      input_ptr++;
-    if (*input_ptr == '\0')
-      return input_ptr;
-
-    //Loop until we hit a hiragana character ending
-    while ( (
-            //General conditional for hiragana processing
-              *(input_ptr    ) != '\0' &&
-              *(input_ptr - 1) != 'a'  &&
-              *(input_ptr - 1) != 'i'  &&
-              *(input_ptr - 1) != 'u'  &&
-              *(input_ptr - 1) != 'e'  &&
-              *(input_ptr - 1) != 'o'  &&
-              *(input_ptr - 1) != *input_ptr  &&
-              *(input_ptr - 1) != '-'  &&
-              total_n < 3
-            ) ||
-            //Special conditional for symbolic n processing
-            (
-              *(input_ptr    ) != '\0' &&
-              *(input_ptr - 1) == 'n'  &&
-              *(input_ptr    ) == 'n'  &&
-              total_n < 3
-            )
-          )
-    {
-      //Update the n count
-      if (*(input_ptr - 1) == 'n')
-        total_n++;
-      else
-        total_n = 0;
+static const LwRomajiMapping _romaji_mappings[] = {
+  { "a",   { "あ",   "ア"   } },
+  { "i",   { "い",   "イ"   } },
+  { "u",   { "う",   "ウ"   } },
+  { "e",   { "え",   "エ"   } },
+  { "o",   { "お",   "オ"   } },
+
+  { "ka",  { "か",   "カ"   } }, { "ca",  { "か",   "カ"   } },
+  { "ki",  { "き",   "キ"   } }, { "ci",  { "き",   "キ"   } },
+  { "ku",  { "く",   "ク"   } }, { "cu",  { "く",   "ク"   } },
+  { "ke",  { "け",   "ケ"   } }, { "ce",  { "け",   "ケ"   } },
+  { "ko",  { "こ",   "コ"   } }, { "co",  { "こ",   "コ"   } },
+  { "kya", { "きゃ", "キャ" } }, { "cya", { "きゃ", "キャ" } },
+  { "kyu", { "きゅ", "キュ" } }, { "cyu", { "きゅ", "キュ" } },
+  { "kyo", { "きょ", "キョ" } }, { "cyo", { "きょ", "キョ" } },
+
+  { "ga",  { "が",   "ガ"   } },
+  { "gi",  { "ぎ",   "ギ"   } },
+  { "gu",  { "ぐ",   "グ"   } },
+  { "ge",  { "げ",   "ゲ"   } },
+  { "go",  { "ご",   "ゴ"   } },
+  { "gya", { "ぎゃ", "ギャ" } },
+  { "gyu", { "ぎゅ", "ギュ" } },
+  { "gyo", { "ぎょ", "ギョ" } },
+
+  { "sa",  { "さ",   "サ"   } },
+  { "si",  { "し",   "シ"   } }, { "shi", { "し",   "シ"   } },
+  { "su",  { "す",   "ス"   } },
+  { "se",  { "せ",   "セ"   } },
+  { "so",  { "そ",   "ソ"   } },
+  { "sya", { "しゃ", "シャ" } }, { "sha", { "しゃ", "シャ" } },
+  { "syu", { "しゅ", "シュ" } }, { "shu", { "しゅ", "シュ" } },
+  { "syo", { "しょ", "ショ" } }, { "sho", { "しょ", "ショ" } },
+
+  { "za",  { "ざ",   "ザ"   } },
+  { "zi",  { "じ",   "ジ"   } }, { "ji",  { "じ",   "ジ"   } },
+  { "zu",  { "ず",   "ズ"   } },
+  { "ze",  { "ぜ",   "ゼ"   } },
+  { "zo",  { "ぞ",   "ゾ"   } },
+  { "zya", { "じゃ", "ジャ" } }, { "jya", { "じゃ", "ジャ" } }, { "ja", { "じゃ", "ジャ" } },
+  { "zyu", { "じゅ", "ジュ" } }, { "jyu", { "じゅ", "ジュ" } }, { "ju", { "じゅ", "ジュ" } },
+  { "zyo", { "じょ", "ジョ" } }, { "jyo", { "じょ", "ジョ" } }, { "jo", { "じょ", "ジョ" } },
+
+  { "ta",  { "た",   "タ"   } },
+  { "ti",  { "ち",   "チ"   } }, { "chi", { "ち",   "チ"   } },
+  { "tu",  { "つ",   "ツ"   } }, { "tsu", { "つ",   "ツ"   } },
+  { "te",  { "て",   "テ"   } },
+  { "to",  { "と",   "ト"   } },
+  { "tya", { "ちゃ", "チャ" } }, { "cha", { "ちゃ", "チャ" } },
+  { "tyu", { "ちゅ", "チュ" } }, { "chu", { "ちゅ", "チュ" } },
+  { "tyo", { "ちょ", "チョ" } }, { "cho", { "ちょ", "チョ" } },
+
+  { "da",  { "だ",   "ダ"   } },
+  { "di",  { "ぢ",   "ヂ"   } },
+  { "du",  { "づ",   "ヅ"   } }, { "dsu", { "づ",   "ヅ"   } },
+  { "de",  { "で",   "デ"   } },
+  { "do",  { "ど",   "ド"   } },
+  { "dya", { "ぢゃ", "ヂャ" } },
+  { "dyu", { "ぢゅ", "ヂュ" } },
+  { "dyo", { "ぢょ", "ヂョ" } },
+
+  { "na",  { "な",   "ナ"   } },
+  { "ni",  { "に",   "ニ"   } },
+  { "nu",  { "ぬ",   "ヌ"   } },
+  { "ne",  { "ね",   "ネ"   } },
+  { "no",  { "の",   "ノ"   } },
+  { "nya", { "にゃ", "ニャ" } },
+  { "nyu", { "にゅ", "ニュ" } },
+  { "nyo", { "にょ", "ニョ" } },
+
+  { "ha",  { "は",   "ハ"   } },
+  { "hi",  { "ひ",   "ヒ"   } },
+  { "hu",  { "ふ",   "フ"   } }, { "fu",  { "ふ",   "フ"   } },
+  { "he",  { "へ",   "ヘ"   } },
+  { "ho",  { "ほ",   "ホ"   } },
+  { "hya", { "ひゃ", "ヒャ" } },
+  { "hyu", { "ひゅ", "ヒュ" } },
+  { "hyo", { "ひょ", "ヒョ" } },
+
+  { "ba",  { "ば",   "バ"   } },
+  { "bi",  { "び",   "ビ"   } },
+  { "bu",  { "ぶ",   "ブ"   } },
+  { "be",  { "べ",   "ベ"   } },
+  { "bo",  { "ぼ",   "ボ"   } },
+  { "bya", { "びゃ", "ビャ" } },
+  { "byu", { "びゅ", "ビュ" } },
+  { "byo", { "びょ", "ビョ" } },
+
+  { "pa",  { "ぱ",   "パ"   } },
+  { "pi",  { "ぴ",   "ピ"   } },
+  { "pu",  { "ぷ",   "プ"   } },
+  { "pe",  { "ぺ",   "ペ"   } },
+  { "po",  { "ぽ",   "ポ"   } },
+  { "pya", { "ぴゃ", "ピャ" } },
+  { "pyu", { "ぴゅ", "ピュ" } },
+  { "pyo", { "ぴょ", "ピョ" } },
+
+  { "ma",  { "ま",   "マ"   } },
+  { "mi",  { "み",   "ミ"   } },
+  { "mu",  { "む",   "ム"   } },
+  { "me",  { "め",   "メ"   } },
+  { "mo",  { "も",   "モ"   } },
+  { "mya", { "みゃ", "ミャ" } },
+  { "myu", { "みゅ", "ミュ" } },
+  { "myo", { "みょ", "ミョ" } },
+
+  { "ya",  { "や",   "ヤ"   } },
+  { "yu",  { "ゆ",   "ユ"   } },
+  { "yo",  { "よ",   "ヨ"   } },
+
+  { "ra",  { "ら",   "ラ"   } }, { "la",  { "ら",   "ラ"   } },
+  { "ri",  { "り",   "リ"   } }, { "li",  { "り",   "リ"   } },
+  { "ru",  { "る",   "ル"   } }, { "lu",  { "る",   "ル"   } },
+  { "re",  { "れ",   "レ"   } }, { "le",  { "れ",   "レ"   } },
+  { "ro",  { "ろ",   "ロ"   } }, { "lo",  { "ろ",   "ロ"   } },
+  { "rya", { "りゃ", "リャ" } }, { "lya", { "りゃ", "リャ" } },
+  { "ryu", { "りゅ", "リュ" } }, { "lyu", { "りゅ", "リュ" } },
+  { "ryo", { "りょ", "リョ" } }, { "lyo", { "りょ", "リョ" } },
+
+  { "wa",  { "わ",   "ワ"   } },
+  { "wi",  { "うぃ", "ウィ" } },
+  { "we",  { "うぇ", "ウェ" } },
+  { "wo",  { "を",   "ヲ"   } },
+
+  { "va",  { "ゔぁ", "ヴァ" } },
+  { "vi",  { "ゔぃ", "ヴィ" } },
+  { "ve",  { "ゔぇ", "ヴェ" } },
+  { "vo",  { "ゔぉ", "ヴォ" } },
+
+  { "xa",  { "ぁ",   "ァ"   } },
+  { "xi",  { "ぃ",   "ィ"   } },
+  { "xu",  { "ぅ",   "ゥ"   } },
+  { "xe",  { "ぇ",   "ェ"   } },
+  { "xo",  { "ぉ",   "ォ"   } },
+
+  { "fa",  { "ふぁ", "ファ" } },
+  { "fi",  { "ふぃ", "フィ" } },
+  { "fe",  { "ふぇ", "フェ" } },
+  { "fo",  { "ふぉ", "フォ" } },
+
+  { "n",   { "ん",   "ン"   } },
+  { "nn",  { "ん",   "ン"   } },
+  { "n'",  { "ん",   "ン"   } },
+
+  { "-",   { "ー",   "ー"   } },
+
+  { NULL,  { NULL,   NULL   } }
+};
+
+static const gchar *_romaji_sokuon[TOTAL_LW_KANA_TYPES] = { "っ", "ッ" };
+
+#define LW_ROMAJI_TRIE_WIDTH 28
 
+//!
+//! @brief A node of the romaji trie.  Children are indexed by the romaji symbol
+//!        and a child index of 0 (the root) means there is no such edge.
+//!
+struct _LwRomajiTrieNode {
+  gint16 child[LW_ROMAJI_TRIE_WIDTH];
+  gint16 mapping;    //!< Index into _romaji_mappings or -1 if no mapping ends here
+};
+typedef struct _LwRomajiTrieNode LwRomajiTrieNode;
 
-      if (*(input_ptr - 1) == 'n' &&
-              *(input_ptr) != 'a'  &&
-              *(input_ptr) != 'i'  &&
-              *(input_ptr) != 'u'  &&
-              *(input_ptr) != 'e'  &&
-              *(input_ptr) != 'o'  &&
-              *(input_ptr) != 'y'
-         )
-        break;
+static LwRomajiTrieNode *_romaji_trie = NULL;
 
-      //Increment
-      input_ptr++;
-    }
-    if (*(input_ptr - 1) == 'n' &&
-            *(input_ptr) == 'n'
-       )
-      input_ptr++;
+
+//!
+//! @brief Maps a romaji character to its edge index in the trie
+//! @param c The character to map
+//! @returns The edge index or -1 if the character can never be part of romaji
+//!
+static gint
+lw_util_romaji_symbol_index (gchar c)
+{
+    if (c >= 'a' && c <= 'z') return c - 'a';
+    if (c == '-') return 26;
+    if (c == '\'') return 27;
+    return -1;
+}
 
 
-    return input_ptr;
+static gboolean
+lw_util_romaji_is_vowel (gchar c)
+{
+    return (c == 'a' || c == 'i' || c == 'u' || c == 'e' || c == 'o');
 }
 
 
 //!
-//! @brief Converts a romaji string to hiragana.
-//! @param input The source romaji string
-//! @param output The string to write the hiragana equivalent to
-//! @return Returns null on error/end
+//! @brief Compiles _romaji_mappings into a trie the first time it is needed.
+//!        The trie is shared by every thread and is never freed.
+//! @returns The root node of the romaji trie
 //!
-gchar* 
-lw_util_roma_char_to_hira (const gchar *input, gchar *output)
+static const LwRomajiTrieNode*
+lw_util_get_romaji_trie ()
 {
-    //Set up the input pointer
-    const char *input_ptr;
-    input_ptr = input;
-
-    //Make sure the output pointer is initialized
-    output[0] = '\0';
-    
-    //Set up the buffer variables
-    char buffer[] = "           ";
-    char *buffer_ptr = buffer;
-
-    //Copy the next hiragana char written in romaji to the buffer
-    while ( 
-            (
-              *input_ptr != '\0' &&
-              *input_ptr != 'a'  &&
-              *input_ptr != 'i'  &&
-              *input_ptr != 'u'  &&
-              *input_ptr != 'e'  &&
-              *input_ptr != 'o'  &&
-              *input_ptr != '-'  && 
-              *input_ptr != *(input_ptr + 1)  && 
-              *(buffer_ptr + 1) == ' '                
-            ) 
-          )
+    if (g_once_init_enter (&_romaji_trie))
     {
-      *buffer_ptr = *input_ptr;
-      input_ptr++;
-      buffer_ptr++;
-    }
-    *buffer_ptr = *input_ptr;
-    buffer_ptr++;
-    *buffer_ptr = '\0';
+      //Declarations
+      LwRomajiTrieNode *trie;
+      const gchar *ptr;
+      gint total;
+      gint length;
+      gint node;
+      gint symbol;
+      gint i;
+
+      //Initializations
+      total = 1;
+      for (i = 0; _romaji_mappings[i].romaji != NULL; i++)
+        total += strlen (_romaji_mappings[i].romaji);
+      trie = g_new (LwRomajiTrieNode, total);
+      memset(trie, 0, sizeof(LwRomajiTrieNode) * total);
+      for (i = 0; i < total; i++) trie[i].mapping = -1;
+      length = 1;
+
+      for (i = 0; _romaji_mappings[i].romaji != NULL; i++)
+      {
+        node = 0;
+        for (ptr = _romaji_mappings[i].romaji; *ptr != '\0'; ptr++)
+        {
+          symbol = lw_util_romaji_symbol_index (*ptr);
+          g_assert (symbol >= 0);
+          if (trie[node].child[symbol] == 0) trie[node].child[symbol] = length++;
+          node = trie[node].child[symbol];
+        }
+        trie[node].mapping = i;
+      }
 
-    //HACK!!!!!!!!!!!!!!!!
-    if (buffer[0] == 'n' &&
-              buffer[1] != 'a'  &&
-              buffer[1] != 'i'  &&
-              buffer[1] != 'u'  &&
-              buffer[1] != 'e'  &&
-              buffer[1] != 'o'  &&
-              buffer[1] != 'y'
-       )
-    {
-       buffer[1] = '\0';
-    }
-    else if ( buffer[0] != 'a'  &&
-              buffer[0] != 'i'  &&
-              buffer[0] != 'u'  &&
-              buffer[0] != 'e'  &&
-              buffer[0] != 'o'  &&
-              buffer[0] != 'n'  &&
-              strlen(input) == 1
-            )
-    {
-       return NULL;
+      g_once_init_leave (&_romaji_trie, trie);
     }
-    //HACK!!!!!!!!!!!!!!!!
 
+    return _romaji_trie;
+}
 
-    //Reset the buffer pointer
-    buffer_ptr = buffer;
 
+//!
+//! @brief Converts a romaji string to kana in a single pass.
+//!
+//! Each step takes the longest romaji spelling in _romaji_mappings that
+//! matches at the current position.  Doubled consonants (and "tch") become a
+//! small tsu, and "nn" followed by a vowel or y is read as ん plus the
+//! following syllable so that "onna" becomes おんな.
+//!
+//! @param INPUT The source romaji string
+//! @param output The string to write the kana equivalent to
+//! @param max The size of the output buffer in bytes
+//! @param type Whether to write hiragana or katakana
+//! @returns Returns TRUE if the whole string could be converted
+//! @see lw_util_str_roma_to_hira ()
+//! @see lw_util_str_roma_to_kata ()
+//!
+gboolean
+lw_util_str_roma_to_kana (const gchar *INPUT, gchar *output, gint max, LwKanaType type)
+{
+    //Sanity checks
+    g_return_val_if_fail (INPUT != NULL, FALSE);
+    g_return_val_if_fail (output != NULL, FALSE);
+    g_return_val_if_fail (max > 0, FALSE);
+    g_return_val_if_fail (type >= 0 && type < TOTAL_LW_KANA_TYPES, FALSE);
 
-    //
-    //Start main lookup for conversion
-    //
-
-    if (strcmp(buffer_ptr, "n") == 0)
-       strcpy(output, "ん");
-
-
-    else if (strlen(buffer_ptr) == 1 &&
-             buffer_ptr[0] != 'a'    &&
-             buffer_ptr[0] != 'i'    &&
-             buffer_ptr[0] != 'u'    &&
-             buffer_ptr[0] != 'e'    &&
-             buffer_ptr[0] != 'o'    &&
-             buffer_ptr[0] != '-'    &&
-             buffer_ptr[0] != 'y'    &&
-             input_ptr[1] != '\0'      )
-       strcpy(output, "っ");
-
-    else if (strcmp(buffer_ptr, "a") == 0)
-       strcpy(output, "あ");
-    else if (strcmp(buffer_ptr, "i") == 0)
-       strcpy(output, "い");
-    else if (strcmp(buffer_ptr, "u") == 0)
-       strcpy(output, "う");
-    else if (strcmp(buffer_ptr, "e") == 0)
-       strcpy(output, "え");
-    else if (strcmp(buffer_ptr, "o") == 0)
-       strcpy(output, "お");
-
-
-    else if (strcmp(buffer_ptr, "ka") == 0 || strcmp(buffer_ptr, "ca") == 0)
-       strcpy(output, "か");
-    else if (strcmp(buffer_ptr, "ki") == 0 || strcmp(buffer_ptr, "ci") == 0)
-       strcpy(output, "き");
-    else if (strcmp(buffer_ptr, "ku") == 0 || strcmp(buffer_ptr, "cu") == 0)
-       strcpy(output, "く");
-    else if (strcmp(buffer_ptr, "ke") == 0 || strcmp(buffer_ptr, "ce") == 0)
-       strcpy(output, "け");
-    else if (strcmp(buffer_ptr, "ko") == 0 || strcmp(buffer_ptr, "co") == 0)
-       strcpy(output, "こ");
-
-    else if (strcmp(buffer_ptr, "kya") == 0 || strcmp(buffer_ptr, "cya") == 0)
-       strcpy(output, "きゃ");
-    else if (strcmp(buffer_ptr, "kyu") == 0 || strcmp(buffer_ptr, "cyu") == 0)
-       strcpy(output, "きゅ");
-    else if (strcmp(buffer_ptr, "kyo") == 0 || strcmp(buffer_ptr, "cyo") == 0)
-       strcpy(output, "きょ");
-
-    else if (strcmp(buffer_ptr, "ga") == 0)
-       strcpy(output, "が");
-    else if (strcmp(buffer_ptr, "gi") == 0)
-       strcpy(output, "ぎ");
-    else if (strcmp(buffer_ptr, "gu") == 0)
-       strcpy(output, "ぐ");
-    else if (strcmp(buffer_ptr, "ge") == 0)
-       strcpy(output, "げ");
-    else if (strcmp(buffer_ptr, "go") == 0)
-       strcpy(output, "ご");
-
-    else if (strcmp(buffer_ptr, "gya") == 0)
-       strcpy(output, "ぎゃ");
-    else if (strcmp(buffer_ptr, "gyu") == 0)
-       strcpy(output, "ぎゅ");
-    else if (strcmp(buffer_ptr, "gyo") == 0)
-       strcpy(output, "ぎょ");
-
-
-    else if (strcmp(buffer_ptr, "sa") == 0)
-       strcpy(output, "さ");
-    else if (strcmp(buffer_ptr, "si") == 0 || strcmp(buffer_ptr, "shi") == 0)
-       strcpy(output, "し");
-    else if (strcmp(buffer_ptr, "su") == 0)
-       strcpy(output, "す");
-    else if (strcmp(buffer_ptr, "se") == 0)
-       strcpy(output, "せ");
-    else if (strcmp(buffer_ptr, "so") == 0)
-       strcpy(output, "そ");
-
-    else if (strcmp(buffer_ptr, "sya") == 0 || strcmp(buffer_ptr, "sha") == 0)
-       strcpy(output, "しゃ");
-    else if (strcmp(buffer_ptr, "syu") == 0 || strcmp(buffer_ptr, "shu") == 0)
-       strcpy(output, "しゅ");
-    else if (strcmp(buffer_ptr, "syo") == 0 || strcmp(buffer_ptr, "sho") == 0)
-       strcpy(output, "しょ");
-
-    else if (strcmp(buffer_ptr, "za") == 0)
-       strcpy(output, "ざ");
-    else if (strcmp(buffer_ptr, "zi") == 0 || strcmp(buffer_ptr, "ji") == 0)
-       strcpy(output, "じ");
-    else if (strcmp(buffer_ptr, "zu") == 0)
-       strcpy(output, "ず");
-    else if (strcmp(buffer_ptr, "ze") == 0)
-       strcpy(output, "ぜ");
-    else if (strcmp(buffer_ptr, "zo") == 0)
-       strcpy(output, "ぞ");
-
-    else if (strcmp(buffer_ptr, "zya") == 0 || strcmp(buffer_ptr, "jya") == 0
-                                            || strcmp(buffer_ptr, "ja" ) == 0 )
-       strcpy(output, "じゃ");
-    else if (strcmp(buffer_ptr, "zyu") == 0 || strcmp(buffer_ptr, "jyu") == 0
-                                            || strcmp(buffer_ptr, "ju" ) == 0 )
-       strcpy(output, "じゅ");
-    else if (strcmp(buffer_ptr, "zyo") == 0 || strcmp(buffer_ptr, "jyo") == 0
-                                            || strcmp(buffer_ptr, "jo" ) == 0 )
-       strcpy(output, "じょ");
-
-
-    else if (strcmp(buffer_ptr, "ta") == 0)
-       strcpy(output, "た");
-    else if (strcmp(buffer_ptr, "ti") == 0 || strcmp(buffer_ptr, "chi") == 0)
-       strcpy(output, "ち");
-    else if (strcmp(buffer_ptr, "tu") == 0 || strcmp(buffer_ptr, "tsu") == 0)
-       strcpy(output, "つ");
-    else if (strcmp(buffer_ptr, "te") == 0)
-       strcpy(output, "て");
-    else if (strcmp(buffer_ptr, "to") == 0)
-       strcpy(output, "と");
-
-    else if (strcmp(buffer_ptr, "tya") == 0 || strcmp(buffer_ptr, "cha") == 0)
-       strcpy(output, "ちゃ");
-    else if (strcmp(buffer_ptr, "tyu") == 0 || strcmp(buffer_ptr, "chu") == 0)
-       strcpy(output, "ちゅ");
-    else if (strcmp(buffer_ptr, "tyo") == 0 || strcmp(buffer_ptr, "cho") == 0)
-       strcpy(output, "ちょ");
-
-    else if (strcmp(buffer_ptr, "da") == 0)
-       strcpy(output, "だ");
-    else if (strcmp(buffer_ptr, "di") == 0)
-       strcpy(output, "ぢ");
-    else if (strcmp(buffer_ptr, "du") == 0 || strcmp(buffer_ptr, "dsu") == 0)
-       strcpy(output, "づ");
-    else if (strcmp(buffer_ptr, "de") == 0)
-       strcpy(output, "で");
-    else if (strcmp(buffer_ptr, "do") == 0)
-       strcpy(output, "ど");
-
-    else if (strcmp(buffer_ptr, "dya") == 0)
-       strcpy(output, "ぢゃ");
-    else if (strcmp(buffer_ptr, "dyu") == 0)
-       strcpy(output, "ぢゅ");
-    else if (strcmp(buffer_ptr, "dyo") == 0)
-       strcpy(output, "ぢょ");
-
-
-    else if (strcmp(buffer_ptr, "na") == 0)
-       strcpy(output, "な");
-    else if (strcmp(buffer_ptr, "ni") == 0)
-       strcpy(output, "に");
-    else if (strcmp(buffer_ptr, "nu") == 0)
-       strcpy(output, "ぬ");
-    else if (strcmp(buffer_ptr, "ne") == 0)
-       strcpy(output, "ね");
-    else if (strcmp(buffer_ptr, "no") == 0)
-       strcpy(output, "の");
-
-    else if (strcmp(buffer_ptr, "nya") == 0)
-       strcpy(output, "にゃ");
-    else if (strcmp(buffer_ptr, "nyu") == 0)
-       strcpy(output, "にゅ");
-    else if (strcmp(buffer_ptr, "nyo") == 0)
-       strcpy(output, "にょ");
-
-
-    else if (strcmp(buffer_ptr, "ha") == 0)
-       strcpy(output, "は");
-    else if (strcmp(buffer_ptr, "hi") == 0)
-       strcpy(output, "ひ");
-    else if (strcmp(buffer_ptr, "hu") == 0 || strcmp(buffer_ptr, "fu") == 0)
-       strcpy(output, "ふ");
-    else if (strcmp(buffer_ptr, "he") == 0)
-       strcpy(output, "へ");
-    else if (strcmp(buffer_ptr, "ho") == 0)
-       strcpy(output, "ほ");
-
-    else if (strcmp(buffer_ptr, "hya") == 0)
-       strcpy(output, "ひゃ");
-    else if (strcmp(buffer_ptr, "hyu") == 0)
-       strcpy(output, "ひゅ");
-    else if (strcmp(buffer_ptr, "hyo") == 0)
-       strcpy(output, "ひょ");
-   
-    else if (strcmp(buffer_ptr, "ba") == 0)
-       strcpy(output, "ば");
-    else if (strcmp(buffer_ptr, "bi") == 0)
-       strcpy(output, "び");
-    else if (strcmp(buffer_ptr, "bu") == 0)
-       strcpy(output, "ぶ");
-    else if (strcmp(buffer_ptr, "be") == 0)
-       strcpy(output, "べ");
-    else if (strcmp(buffer_ptr, "bo") == 0)
-       strcpy(output, "ぼ");
-
-    else if (strcmp(buffer_ptr, "bya") == 0)
-       strcpy(output, "びゃ");
-    else if (strcmp(buffer_ptr, "byu") == 0)
-       strcpy(output, "びゅ");
-    else if (strcmp(buffer_ptr, "byo") == 0)
-       strcpy(output, "びょ");
-
-    else if (strcmp(buffer_ptr, "pa") == 0)
-       strcpy(output, "ぱ");
-    else if (strcmp(buffer_ptr, "pi") == 0)
-       strcpy(output, "ぴ");
-    else if (strcmp(buffer_ptr, "pu") == 0)
-       strcpy(output, "ぷ");
-    else if (strcmp(buffer_ptr, "pe") == 0)
-       strcpy(output, "ぺ");
-    else if (strcmp(buffer_ptr, "po") == 0)
-       strcpy(output, "ぽ");
-
-    else if (strcmp(buffer_ptr, "pya") == 0)
-       strcpy(output, "ぴゃ");
-    else if (strcmp(buffer_ptr, "pyu") == 0)
-       strcpy(output, "ぴゅ");
-    else if (strcmp(buffer_ptr, "pyo") == 0)
-       strcpy(output, "ぴょ");
-
-
-    else if (strcmp(buffer_ptr, "ma") == 0)
-       strcpy(output, "ま");
-    else if (strcmp(buffer_ptr, "mi") == 0)
-       strcpy(output, "み");
-    else if (strcmp(buffer_ptr, "mu") == 0)
-       strcpy(output, "む");
-    else if (strcmp(buffer_ptr, "me") == 0)
-       strcpy(output, "め");
-    else if (strcmp(buffer_ptr, "mo") == 0)
-       strcpy(output, "も");
-
-    else if (strcmp(buffer_ptr, "mya") == 0)
-       strcpy(output, "みゃ");
-    else if (strcmp(buffer_ptr, "myu") == 0)
-       strcpy(output, "みゅ");
-    else if (strcmp(buffer_ptr, "myo") == 0)
-       strcpy(output, "みょ");
-
-
-    else if (strcmp(buffer_ptr, "ya") == 0)
-       strcpy(output, "や");
-    else if (strcmp(buffer_ptr, "yu") == 0)
-       strcpy(output, "ゆ");
-    else if (strcmp(buffer_ptr, "yo") == 0)
-       strcpy(output, "よ");
-
-
-    else if (strcmp(buffer_ptr, "ra") == 0 || strcmp(buffer_ptr, "la") == 0)
-       strcpy(output, "ら");
-    else if (strcmp(buffer_ptr, "ri") == 0 || strcmp(buffer_ptr, "li") == 0)
-       strcpy(output, "り");
-    else if (strcmp(buffer_ptr, "ru") == 0 || strcmp(buffer_ptr, "lu") == 0)
-       strcpy(output, "る");
-    else if (strcmp(buffer_ptr, "re") == 0 || strcmp(buffer_ptr, "le") == 0)
-       strcpy(output, "れ");
-    else if (strcmp(buffer_ptr, "ro") == 0 || strcmp(buffer_ptr, "lo") == 0)
-       strcpy(output, "ろ");
-
-    else if (strcmp(buffer_ptr, "rya") == 0 || strcmp(buffer_ptr, "lya") == 0)
-       strcpy(output, "りゃ");
-    else if (strcmp(buffer_ptr, "ryu") == 0 || strcmp(buffer_ptr, "lyu") == 0)
-       strcpy(output, "りゅ");
-    else if (strcmp(buffer_ptr, "ryo") == 0 || strcmp(buffer_ptr, "lyo") == 0)
-       strcpy(output, "りょ");
-
-
-    else if (strcmp(buffer_ptr, "wa") == 0)
-       strcpy(output, "わ");
-    else if (strcmp(buffer_ptr, "wi") == 0)
-       strcpy(output, "うぃ");
-    else if (strcmp(buffer_ptr, "we") == 0)
-       strcpy(output, "うぇ");
-    else if (strcmp(buffer_ptr, "wo") == 0)
-       strcpy(output, "を");
-
-    else if (strcmp(buffer_ptr, "va") == 0)
-       strcpy(output, "う゛ぁ");
-    else if (strcmp(buffer_ptr, "vi") == 0)
-       strcpy(output, "う゛ぃ");
-    else if (strcmp(buffer_ptr, "ve") == 0)
-       strcpy(output, "う゛ぇ");
-    else if (strcmp(buffer_ptr, "vo") == 0)
-       strcpy(output, "う゛ぉ");
-
-
-    else if (strcmp(buffer_ptr, "xa") == 0)
-       strcpy(output, "ぁ");
-    else if (strcmp(buffer_ptr, "xi") == 0)
-       strcpy(output, "ぃ");
-    else if (strcmp(buffer_ptr, "xu") == 0)
-       strcpy(output, "ぅ");
-    else if (strcmp(buffer_ptr, "xe") == 0)
-       strcpy(output, "ぇ");
-    else if (strcmp(buffer_ptr, "xo") == 0)
-       strcpy(output, "ぉ");
-
-
-    else if (strcmp(buffer_ptr, "fa") == 0)
-       strcpy(output, "ふぁ");
-    else if (strcmp(buffer_ptr, "fi") == 0)
-       strcpy(output, "ふぃ");
-    else if (strcmp(buffer_ptr, "fe") == 0)
-       strcpy(output, "ふぇ");
-    else if (strcmp(buffer_ptr, "fo") == 0)
-       strcpy(output, "ふぉ");
-   
+    //Declarations
+    const LwRomajiTrieNode *trie;
+    const gchar *ptr;
+    const gchar *kana;
+    gchar *outptr;
+    gint node;
+    gint symbol;
+    gint mapping;
+    gint consumed;
+    gint length;
+    gint i;
 
-    else if (strcmp(buffer_ptr, "-") == 0)
-       strcpy(output, "ー");
+    //Initializations
+    trie = lw_util_get_romaji_trie ();
+    ptr = INPUT;
+    outptr = output;
+    *outptr = '\0';
 
-    else
+    while (*ptr != '\0')
     {
-      input_ptr = NULL;
-      return NULL;
+      kana = NULL;
+      consumed = 0;
+
+      if (*ptr >= 'a' && *ptr <= 'z' && *ptr != 'n' && *ptr != 'y' && !lw_util_romaji_is_vowel (*ptr) &&
+          (ptr[1] == *ptr || (ptr[0] == 't' && ptr[1] == 'c' && ptr[2] == 'h')))
+      {
+        //Doubled consonants are a small tsu
+        kana = _romaji_sokuon[type];
+        consumed = 1;
+      }
+      else
+      {
+        //Walk the trie as far as the input allows, remembering the longest match
+        node = 0;
+        mapping = -1;
+        for (i = 0; ptr[i] != '\0'; i++)
+        {
+          symbol = lw_util_romaji_symbol_index (ptr[i]);
+          if (symbol < 0) break;
+          node = trie[node].child[symbol];
+          if (node == 0) break;
+          if (trie[node].mapping > -1)
+          {
+            mapping = trie[node].mapping;
+            consumed = i + 1;
+          }
+        }
+        if (mapping < 0) break;
+
+        //"nn" in front of a vowel is ん and the start of the next syllable
+        if (consumed == 2 && ptr[0] == 'n' && ptr[1] == 'n' && (lw_util_romaji_is_vowel (ptr[2]) || ptr[2] == 'y'))
+          consumed = 1;
+
+        kana = _romaji_mappings[mapping].kana[type];
+      }
+
+      length = strlen (kana);
+      if (outptr - output + length >= max) break;
+      memcpy(outptr, kana, length);
+      outptr += length;
+      *outptr = '\0';
+      ptr += consumed;
     }
 
-    return output;
+    return (*ptr == '\0');
 }
 
 
@@ -914,41 +1076,171 @@ lw_util_roma_char_to_hira (const gchar *input, gchar *output)
 //! @param input The string to shift.
 //! @param output the string to output the changes to.
 //! @param max The max length of the string to output to.
-//! @see lw_util_shift_kana_chars_in_str_by ()
-//! @see lw_util_str_shift_hira_to_kata ()
+//! @see lw_util_str_roma_to_kana ()
+//! @see lw_util_str_roma_to_kata ()
 //!
 gboolean 
 lw_util_str_roma_to_hira (const gchar* input, gchar* output, gint max)
+{
+    return lw_util_str_roma_to_kana (input, output, max, LW_KANA_TYPE_HIRAGANA);
+}
+
+
+//!
+//! @brief Convenience function to convert romaji to katakana
+//!
+//! @param input The string to shift.
+//! @param output the string to output the changes to.
+//! @param max The max length of the string to output to.
+//! @see lw_util_str_roma_to_kana ()
+//! @see lw_util_str_roma_to_hira ()
+//!
+gboolean 
+lw_util_str_roma_to_kata (const gchar* input, gchar* output, gint max)
+{
+    return lw_util_str_roma_to_kana (input, output, max, LW_KANA_TYPE_KATAKANA);
+}
+
+
+static GHashTable *_kana_romaji = NULL;
+
+
+//!
+//! @brief Tells if a spelling of _romaji_mappings should replace the one
+//!        already picked for the same kana when writing kana as romaji.
+//!        The Hepburn spellings are the ones people type the most.
+//!
+static gboolean
+lw_util_romaji_is_hepburn (const gchar *ROMAJI)
+{
+    return (strncmp (ROMAJI, "sh", 2) == 0 || strncmp (ROMAJI, "ch", 2) == 0 ||
+            strncmp (ROMAJI, "ts", 2) == 0 || ROMAJI[0] == 'j' || ROMAJI[0] == 'f');
+}
+
+
+//!
+//! @brief Compiles _romaji_mappings into a kana to romaji lookup the first
+//!        time it is needed.  The table is shared by every thread and is
+//!        never freed.
+//! @returns A GHashTable of kana strings to their romaji
+//!
+static GHashTable*
+lw_util_get_kana_romaji ()
+{
+    if (g_once_init_enter (&_kana_romaji))
+    {
+      //Declarations
+      GHashTable *table;
+      const gchar *ROMAJI;
+      const gchar *KANA;
+      gint i, j;
+
+      //Initializations
+      table = g_hash_table_new (g_str_hash, g_str_equal);
+
+      for (i = 0; _romaji_mappings[i].romaji != NULL; i++)
+      {
+        ROMAJI = _romaji_mappings[i].romaji;
+        for (j = 0; j < TOTAL_LW_KANA_TYPES; j++)
+        {
+          KANA = _romaji_mappings[i].kana[j];
+          if (g_hash_table_lookup (table, KANA) == NULL || lw_util_romaji_is_hepburn (ROMAJI))
+            g_hash_table_insert (table, (gpointer) KANA, (gpointer) ROMAJI);
+        }
+      }
+
+      g_once_init_leave (&_kana_romaji, table);
+    }
+
+    return _kana_romaji;
+}
+
+
+//!
+//! @brief Converts hiragana or katakana to Hepburn romaji.  Small kana are
+//!        read together with the kana before them and a small tsu doubles
+//!        the consonant that follows it.
+//!
+//! @param INPUT The kana string to convert
+//! @param output The string to write the romaji to
+//! @param max The size of the output buffer in bytes
+//! @returns Returns TRUE if the whole string could be converted
+//! @see lw_util_str_roma_to_kana ()
+//!
+gboolean
+lw_util_str_kana_to_roma (const gchar *INPUT, gchar *output, gint max)
 {
     //Sanity checks
-    g_return_val_if_fail (input != NULL, FALSE);
+    g_return_val_if_fail (INPUT != NULL, FALSE);
     g_return_val_if_fail (output != NULL, FALSE);
+    g_return_val_if_fail (max > 0, FALSE);
 
     //Declarations
-    const gchar *input_ptr;
-    gchar *kana_ptr;
-    gint leftover;
+    GHashTable *table;
+    const gchar *ptr;
+    const gchar *next;
+    const gchar *romaji;
+    gchar kana[16];
+    gchar *outptr;
+    gboolean sokuon;
+    gint length;
 
     //Initializations
-    input_ptr = input;
-    kana_ptr = output;
-    *kana_ptr = '\0';
-    leftover = max;
+    table = lw_util_get_kana_romaji ();
+    ptr = INPUT;
+    outptr = output;
+    *outptr = '\0';
+    sokuon = FALSE;
 
-    //Try converting to hiragana
-    while (leftover-- > 0)
+    while (*ptr != '\0')
     {
-      kana_ptr = lw_util_roma_char_to_hira (input_ptr, kana_ptr);
-      if (kana_ptr == NULL || input_ptr == NULL)
-        break;
-      input_ptr = lw_util_next_hira_char_from_roma (input_ptr);
-      if (kana_ptr == NULL || input_ptr == NULL)
-        break;
+      romaji = NULL;
+      next = g_utf8_next_char (ptr);
+
+      if (strncmp (ptr, "っ", next - ptr) == 0 || strncmp (ptr, "ッ", next - ptr) == 0)
+      {
+        if (sokuon) break;
+        sokuon = TRUE;
+        ptr = next;
+        continue;
+      }
 
-      kana_ptr = &kana_ptr[strlen(kana_ptr)];
+      //Try the kana with the small kana after it first, as in きゃ
+      if (*next != '\0')
+      {
+        length = g_utf8_next_char (next) - ptr;
+        if (length < sizeof(kana))
+        {
+          strncpy (kana, ptr, length);
+          kana[length] = '\0';
+          romaji = (const gchar*) g_hash_table_lookup (table, kana);
+          if (romaji != NULL) next = ptr + length;
+        }
+      }
+      if (romaji == NULL)
+      {
+        length = next - ptr;
+        strncpy (kana, ptr, length);
+        kana[length] = '\0';
+        romaji = (const gchar*) g_hash_table_lookup (table, kana);
+      }
+      if (romaji == NULL) break;
+
+      length = strlen (romaji);
+      if (outptr - output + length + 1 >= max) break;
+      if (sokuon)
+      {
+        if (lw_util_romaji_is_vowel (*romaji) || *romaji == 'n' || *romaji == '-') break;
+        *outptr++ = (*romaji == 'c') ? 't' : *romaji;
+        sokuon = FALSE;
+      }
+      memcpy(outptr, romaji, length);
+      outptr += length;
+      *outptr = '\0';
+      ptr = next;
     }
 
-    return (input_ptr != NULL && strlen (input_ptr) == 0);
+    return (*ptr == '\0' && !sokuon);
 }
 
 
@@ -1126,15 +1418,21 @@ lw_util_enlarge_halfwidth_japanese (const gchar* text)
 gboolean 
 lw_util_is_japanese_locale ()
 {
-    return (setlocale(LC_ALL, NULL) != NULL &&
+    //Declarations
+    const gchar *locale;
+
+    //Initializations
+    locale = setlocale(LC_ALL, NULL);
+
+    return (locale != NULL &&
              (
-               strcmp(setlocale(LC_ALL, NULL), "ja_JP.UTF8")  == 0 ||
-               strcmp(setlocale(LC_ALL, NULL), "ja_JP.UTF-8") == 0 ||
-               strcmp(setlocale(LC_ALL, NULL), "ja_JP.utf8")  == 0 ||
-               strcmp(setlocale(LC_ALL, NULL), "ja_JP.utf-8") == 0 ||
-               strcmp(setlocale(LC_ALL, NULL), "ja_JP")       == 0 ||
-               strcmp(setlocale(LC_ALL, NULL), "ja")          == 0 ||
-               strcmp(setlocale(LC_ALL, NULL), "japanese")    == 0
+               strcmp(locale, "ja_JP.UTF8")  == 0 ||
+               strcmp(locale, "ja_JP.UTF-8") == 0 ||
+               strcmp(locale, "ja_JP.utf8")  == 0 ||
+               strcmp(locale, "ja_JP.utf-8") == 0 ||
+               strcmp(locale, "ja_JP")       == 0 ||
+               strcmp(locale, "ja")          == 0 ||
+               strcmp(locale, "japanese")    == 0
              )
            );
 }
@@ -1453,20 +1751,27 @@ lw_util_delimit_script_changes (const gchar *DELIMITOR, const gchar* TEXT, gbool
     gchar *buffer;
     gint count;
     const gchar *source_ptr;
+    const gchar *end;
     gchar *target_ptr;
     GUnicodeScript this_script, previous_script;
-    gunichar c;
+    const LwUtf8Range *range;
     gboolean script_changed;
     gint delimitor_length;
+    gsize length;
+    gsize span;
 
     //Initializations
     count = 0;
     delimitor_length = strlen (DELIMITOR);
+    length = strlen (TEXT);
+    end = TEXT + length;
+
+    //A run of characters of the script just seen can never hold a change, so
+    //both passes copy such runs wholesale instead of looking each one up
     this_script = previous_script = G_UNICODE_SCRIPT_INVALID_CODE;
-    for (source_ptr = TEXT; *source_ptr != '\0'; source_ptr = g_utf8_next_char (source_ptr))
+    for (source_ptr = TEXT; source_ptr < end; source_ptr += span)
     {
-      c = g_utf8_get_char (source_ptr);
-      this_script = g_unichar_get_script (c);
+      this_script = lw_util_unichar_get_script (g_utf8_get_char (source_ptr));
       script_changed = lw_util_script_changed (previous_script, this_script, split_kanji_furigana);
 
       if (script_changed)
@@ -1474,19 +1779,22 @@ lw_util_delimit_script_changes (const gchar *DELIMITOR, const gchar* TEXT, gbool
 				count++;
       }
 
+      span = g_utf8_next_char (source_ptr) - source_ptr;
+      range = lw_util_get_utf8_range (this_script);
+      if (range != NULL) span += lw_util_utf8_span_range (source_ptr + span, end - source_ptr - span, range);
+
       previous_script = this_script;
     }
 
-    buffer = g_new (gchar, strlen(TEXT) + (delimitor_length * count) + 1);
+    buffer = g_new (gchar, length + (delimitor_length * count) + 1);
 		if (buffer != NULL)
 		{
       target_ptr = buffer;
 			*buffer = '\0';
 			this_script = previous_script = G_UNICODE_SCRIPT_INVALID_CODE;
-			for (source_ptr = TEXT; *source_ptr != '\0'; source_ptr = g_utf8_next_char (source_ptr))
+			for (source_ptr = TEXT; source_ptr < end; source_ptr += span)
 			{
-				c = g_utf8_get_char (source_ptr);
-				this_script = g_unichar_get_script (c);
+				this_script = lw_util_unichar_get_script (g_utf8_get_char (source_ptr));
         script_changed = lw_util_script_changed (previous_script, this_script, split_kanji_furigana);
 
         if (script_changed)
@@ -1494,7 +1802,11 @@ lw_util_delimit_script_changes (const gchar *DELIMITOR, const gchar* TEXT, gbool
 					strcpy(target_ptr, DELIMITOR);
 					target_ptr += delimitor_length;
 				}
-        target_ptr += g_unichar_to_utf8 (c, target_ptr);
+        span = g_utf8_next_char (source_ptr) - source_ptr;
+        range = lw_util_get_utf8_range (this_script);
+        if (range != NULL) span += lw_util_utf8_span_range (source_ptr + span, end - source_ptr - span, range);
+        memcpy (target_ptr, source_ptr, span);
+        target_ptr += span;
         *target_ptr = '\0';
 
 				previous_script = this_script;
@@ -1627,24 +1939,3 @@ lw_util_delimit_radicals (const gchar *DELIMITOR, const gchar* TEXT)
 }
 
 
-GRegex*
-lw_regex_new (const gchar *PATTERN, const gchar *EXPRESSION, GError **error)
-{
-    //Declarations
-    GRegex *regex;
-    gchar *expression;
-
-    //Initializations
-    expression = g_strdup_printf (PATTERN, EXPRESSION);
-    regex = NULL;
-
-    if (expression != NULL)
-    {
-      regex = g_regex_new (expression,  (G_REGEX_CASELESS | G_REGEX_OPTIMIZE), 0, error);
-      g_free (expression); expression = NULL;
-    }
-
-    return regex;
-}
-
-
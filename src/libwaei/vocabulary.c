@@ -27,9 +27,30 @@
 #include "config.h"
 #endif
 
+#include <stdio.h>
+#include <string.h>
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
 #include <libwaei/gettext.h>
 #include <libwaei/libwaei.h>
 
+static void lw_vocabulary_close_journal (LwVocabulary*);
+
+
+//!
+//! @brief Checks if a file in the vocabulary folder is a list rather than
+//!        the journal or unfinished snapshot of one
+//! @param FILENAME The basename of the file
+//!
+gboolean
+lw_vocabulary_is_list_filename (const gchar *FILENAME)
+{
+    return (!g_str_has_suffix (FILENAME, LW_VOCABULARY_JOURNAL_SUFFIX) &&
+            !g_str_has_suffix (FILENAME, LW_VOCABULARY_SNAPSHOT_SUFFIX));
+}
+
 
 gchar**
 lw_vocabulary_get_lists ()
@@ -53,6 +74,7 @@ lw_vocabulary_get_lists ()
         //Get the size needed for the buffer
         while ((name = g_dir_read_name (dir)) != NULL)
         {
+          if (!lw_vocabulary_is_list_filename (name)) continue;
           chars += strlen(name) + 1;
         }
 
@@ -63,6 +85,7 @@ lw_vocabulary_get_lists ()
           //Set the buffer
           while ((name = g_dir_read_name (dir)) != NULL)
           {
+            if (!lw_vocabulary_is_list_filename (name)) continue;
             strcat(buffer, name);
             strcat(buffer, ";");
           }
@@ -92,6 +115,7 @@ lw_vocabulary_new (const gchar *NAME)
     if (vocabulary != NULL)
     {
       vocabulary->name = g_strdup (NAME);
+      vocabulary->items = g_ptr_array_new ();
     }
     return vocabulary;
 }
@@ -100,24 +124,275 @@ lw_vocabulary_new (const gchar *NAME)
 void
 lw_vocabulary_free (LwVocabulary *vocabulary)
 {
+    lw_vocabulary_close_journal (vocabulary);
+    if (vocabulary->checksum != NULL) g_free (vocabulary->checksum);
     if (vocabulary->name != NULL) g_free (vocabulary->name);
     if (vocabulary->items != NULL)
     {
-      g_list_foreach (vocabulary->items, (GFunc) lw_word_free, NULL);
-      g_list_free (vocabulary->items); vocabulary->items = NULL;
+      g_ptr_array_foreach (vocabulary->items, (GFunc) lw_word_free, NULL);
+      g_ptr_array_free (vocabulary->items, TRUE); vocabulary->items = NULL;
+    }
+    if (vocabulary->arenas != NULL)
+    {
+      g_slist_foreach (vocabulary->arenas, (GFunc) g_free, NULL);
+      g_slist_free (vocabulary->arenas); vocabulary->arenas = NULL;
     }
     g_free (vocabulary);
 }
 
 
+//!
+//! @brief Builds the path of the journal that records the changes to a list since its last snapshot
+//! @param vocabulary The LwVocabulary to get the journal of
+//! @returns A newly allocated path that should be freed with g_free
+//!
+static gchar*
+lw_vocabulary_build_journal_filename (LwVocabulary *vocabulary)
+{
+    //Declarations
+    gchar *name;
+    gchar *uri;
+
+    //Initializations
+    name = g_strjoin (NULL, vocabulary->name, LW_VOCABULARY_JOURNAL_SUFFIX, NULL);
+    uri = lw_util_build_filename (LW_PATH_VOCABULARY, name);
+
+    g_free (name);
+
+    return uri;
+}
+
+
+//!
+//! @brief Returns the name of the list a file in the vocabulary folder belongs to
+//! @param FILENAME The basename of a file in the vocabulary folder
+//! @returns A newly allocated list name that should be freed with g_free
+//!
+gchar*
+lw_vocabulary_filename_to_name (const gchar *FILENAME)
+{
+    //Sanity checks
+    g_return_val_if_fail (FILENAME != NULL, NULL);
+
+    //Declarations
+    const gchar *SUFFIXES[] = { LW_VOCABULARY_JOURNAL_SUFFIX, LW_VOCABULARY_SNAPSHOT_SUFFIX, NULL };
+    gint i;
+
+    for (i = 0; SUFFIXES[i] != NULL; i++)
+    {
+      if (g_str_has_suffix (FILENAME, SUFFIXES[i]))
+        return g_strndup (FILENAME, strlen(FILENAME) - strlen(SUFFIXES[i]));
+    }
+
+    return g_strdup (FILENAME);
+}
+
+
+static void
+lw_vocabulary_close_journal (LwVocabulary *vocabulary)
+{
+    if (vocabulary->journal != NULL) fclose (vocabulary->journal); vocabulary->journal = NULL;
+}
+
+
+//!
+//! @brief Parses a position out of a journal record
+//! @param ptr The text to parse
+//! @param endptr Set to the text after the position and its delimiter
+//! @param length The number of words the position has to be in, inclusive
+//! @returns The position or -1 if it isn't valid
+//!
+static gint
+lw_vocabulary_parse_journal_position (const gchar *ptr, gchar **endptr, gint length)
+{
+    //Declarations
+    gint64 position;
+
+    position = g_ascii_strtoll (ptr, endptr, 10);
+    if (*endptr == ptr || **endptr != ';' || position < 0 || position > length) return -1;
+    (*endptr)++;
+
+    return (gint) position;
+}
+
+
+//!
+//! @brief Applies a change to the words of a list
+//! @param vocabulary The LwVocabulary to change
+//! @param record The kind of change
+//! @param position A position checked to be in the list
+//! @param word The new values.  An inserted word is taken over by the list.
+//!
+static void
+lw_vocabulary_apply (LwVocabulary *vocabulary, LwVocabularyRecord record, gint position, LwWord *word)
+{
+    //Declarations
+    GPtrArray *items;
+    LwWord *item;
+
+    //Initializations
+    items = vocabulary->items;
+
+    switch (record)
+    {
+      case LW_VOCABULARY_RECORD_WORD:
+        item = g_ptr_array_index (items, position);
+        lw_word_set_kanji (item, lw_word_get_kanji (word));
+        lw_word_set_furigana (item, lw_word_get_furigana (word));
+        lw_word_set_definitions (item, lw_word_get_definitions (word));
+        //Fall through
+      case LW_VOCABULARY_RECORD_GUESSES:
+        item = g_ptr_array_index (items, position);
+        lw_word_set_correct_guesses (item, lw_word_get_correct_guesses (word));
+        lw_word_set_incorrect_guesses (item, lw_word_get_incorrect_guesses (word));
+        lw_word_set_hours (item, lw_word_get_hours (word));
+        lw_word_set_ease (item, word->ease);
+        lw_word_set_interval (item, lw_word_get_interval (word));
+        break;
+      case LW_VOCABULARY_RECORD_INSERT:
+        g_ptr_array_add (items, word);
+        memmove (items->pdata + position + 1, items->pdata + position, sizeof(gpointer) * (items->len - 1 - position));
+        g_ptr_array_index (items, position) = word;
+        break;
+      case LW_VOCABULARY_RECORD_REMOVE:
+        lw_word_free (g_ptr_array_remove_index (items, position));
+        break;
+    }
+}
+
+
+//!
+//! @brief Applies one journal record to the words of a list
+//! @param vocabulary The LwVocabulary to change
+//! @param RECORD A line of the journal without its newline
+//! @returns FALSE if the record couldn't be understood
+//!
+static gboolean
+lw_vocabulary_replay_journal_record (LwVocabulary *vocabulary, const gchar *RECORD)
+{
+    //Declarations
+    LwVocabularyRecord record;
+    LwWord *word;
+    gchar *ptr;
+    gint position;
+    gint last;
+
+    //Initializations
+    if (RECORD[0] == '\0' || RECORD[1] != ';') return FALSE;
+    record = RECORD[0];
+    last = vocabulary->items->len - 1;
+
+    switch (record)
+    {
+      case LW_VOCABULARY_RECORD_INSERT:
+        last++;
+        //Fall through
+      case LW_VOCABULARY_RECORD_GUESSES:
+      case LW_VOCABULARY_RECORD_WORD:
+      case LW_VOCABULARY_RECORD_REMOVE:
+        position = lw_vocabulary_parse_journal_position (RECORD + 2, &ptr, last);
+        if (position < 0) return FALSE;
+        word = (record == LW_VOCABULARY_RECORD_REMOVE) ? NULL : lw_word_new_from_string (ptr);
+        if (word == NULL && record != LW_VOCABULARY_RECORD_REMOVE) return FALSE;
+        lw_vocabulary_apply (vocabulary, record, position, word);
+        if (word != NULL && record != LW_VOCABULARY_RECORD_INSERT) lw_word_free (word);
+        return TRUE;
+
+      default:
+        return FALSE;
+    }
+}
+
+
+//!
+//! @brief Replays the journal of a list on top of the words of its snapshot
+//!
+//! A journal only belongs to the snapshot whose checksum is on its first
+//! line.  Anything else is left over from before the last compaction and
+//! is removed.  A last line without a newline was cut off by a crash.
+//!
+//! @param vocabulary The LwVocabulary the snapshot was loaded into
+//! @returns TRUE if the journal should be compacted away right away
+//!
+static gboolean
+lw_vocabulary_replay_journal (LwVocabulary *vocabulary)
+{
+    //Declarations
+    gchar *uri;
+    gchar *contents;
+    gchar *ptr;
+    gchar *end;
+    gboolean needs_compaction;
+
+    //Initializations
+    uri = lw_vocabulary_build_journal_filename (vocabulary);
+    contents = NULL;
+    needs_compaction = FALSE;
+    if (uri == NULL) return FALSE;
+
+    if (g_file_get_contents (uri, &contents, NULL, NULL))
+    {
+      ptr = contents;
+      if ((end = strchr (ptr, '\n')) != NULL) *end = '\0';
+      if (end == NULL || *ptr != '#' || vocabulary->checksum == NULL || strcmp (ptr + 1, vocabulary->checksum) != 0)
+      {
+        g_remove (uri);
+      }
+      else
+      {
+        for (ptr = end + 1; *ptr != '\0'; ptr = end + 1)
+        {
+          if ((end = strchr (ptr, '\n')) == NULL)
+          {
+            needs_compaction = TRUE;
+            break;
+          }
+          *end = '\0';
+          if (!lw_vocabulary_replay_journal_record (vocabulary, ptr)) needs_compaction = TRUE;
+          vocabulary->journal_length++;
+        }
+      }
+    }
+
+    g_free (contents);
+    g_free (uri);
+
+    return needs_compaction;
+}
+
+
+//!
+//! @brief Loads the words of a vocabulary list file and, for the list's own
+//!        file, replays its journal
+//!
+//! The whole file is read at once and becomes the arena of the words.  Each
+//! line is split in place and the words are laid out in a single block
+//! instead of every field and word being allocated on its own.
+//!
+//! @param vocabulary The LwVocabulary to add the words to
+//! @param FILENAME The name of the file in the vocabulary folder or NULL for the list's own
+//! @param cb A callback to report the progress to with the vocabulary as its data or NULL
+//!
 void
 lw_vocabulary_load (LwVocabulary *vocabulary, const gchar *FILENAME, LwIoProgressCallback cb)
 {
-    LwWord *word;
+    //Declarations
+    LwWord *words;
     gchar *uri;
-    FILE *stream;
-    const gint MAX = 512;
-    gchar buffer[MAX + 1];
+    gchar *contents;
+    gsize length;
+    gchar *ptr;
+    gchar *end;
+    gboolean is_list;
+    gboolean needs_compaction;
+    guint total_lines;
+    guint i;
+    const guint CHUNK = 4096;
+
+    //Initializations
+    is_list = (FILENAME == NULL || strcmp (FILENAME, vocabulary->name) == 0);
+    needs_compaction = FALSE;
+    vocabulary->progress = 0.0;
 
     if (FILENAME != NULL)
       uri = lw_util_build_filename (LW_PATH_VOCABULARY, FILENAME);
@@ -126,40 +401,75 @@ lw_vocabulary_load (LwVocabulary *vocabulary, const gchar *FILENAME, LwIoProgres
 
     if (uri != NULL)
     {
-      stream = fopen (uri, "r");
-      if (stream != NULL)
+      if (g_file_get_contents (uri, &contents, &length, NULL))
       {
-        while (feof(stream) == 0)
+        //Only the list's own file has a journal
+        if (is_list)
         {
-          if (fgets (buffer, MAX, stream) != NULL)
-          {
-            buffer[MAX] = '\0';
-            word = lw_word_new_from_string (buffer);
-            if (word != NULL)
-            {
-              vocabulary->items = g_list_append (vocabulary->items, word);
-            }
-          }
-          if (strchr(buffer, '\n') == NULL && feof(stream) == 0)
+          lw_vocabulary_close_journal (vocabulary);
+          if (vocabulary->checksum != NULL) g_free (vocabulary->checksum);
+          vocabulary->checksum = g_compute_checksum_for_data (G_CHECKSUM_SHA1, (guchar*) contents, length);
+          vocabulary->journal_length = 0;
+        }
+
+        //Every line is a word, and a last line without a newline is one too
+        total_lines = 0;
+        for (ptr = contents; (ptr = memchr (ptr, '\n', contents + length - ptr)) != NULL; ptr++)
+          total_lines++;
+        if (length > 0 && contents[length - 1] != '\n') total_lines++;
+
+        words = g_new0 (LwWord, total_lines);
+        vocabulary->arenas = g_slist_prepend (vocabulary->arenas, contents);
+        vocabulary->arenas = g_slist_prepend (vocabulary->arenas, words);
+
+        for (ptr = contents, i = 0; i < total_lines; ptr = end + 1, i++)
+        {
+          if ((end = memchr (ptr, '\n', contents + length - ptr)) != NULL) *end = '\0';
+          else end = contents + length;
+          lw_word_parse_in_place (&words[i], ptr);
+          words[i].borrowed |= LW_WORD_BORROWED_RECORD;
+          g_ptr_array_add (vocabulary->items, &words[i]);
+
+          if (cb != NULL && i % CHUNK == 0)
           {
-            while (fgetc(stream) != '\n' && feof(stream) == 0);
+            vocabulary->progress = (gdouble) (ptr - contents) / (gdouble) length;
+            cb (vocabulary->progress, vocabulary);
           }
         }
-        fclose(stream); stream = NULL;
+
+        if (is_list) needs_compaction = lw_vocabulary_replay_journal (vocabulary);
       }
       g_free (uri); uri = NULL;
     }
+
+    if (needs_compaction) lw_vocabulary_save (vocabulary, NULL, NULL);
+
+    vocabulary->progress = 1.0;
+    if (cb != NULL) cb (vocabulary->progress, vocabulary);
 }
 
+
 void
 lw_vocabulary_save (LwVocabulary *vocabulary, const gchar *FILENAME, LwIoProgressCallback cb)
 {
     //Declarations
     LwWord *word;
-    GList *iter;
+    GChecksum *checksum;
+    GString *line;
+    guint j;
     gint i;
     gchar *uri;
+    gchar *tmp;
+    gchar *journal;
     FILE *stream;
+    gboolean is_list;
+    gboolean written;
+
+    //Initializations
+    is_list = (FILENAME == NULL);
+    checksum = g_checksum_new (G_CHECKSUM_SHA1);
+    line = g_string_new (NULL);
+    written = FALSE;
 
     if (FILENAME != NULL)
       uri = g_strdup (FILENAME);
@@ -168,32 +478,174 @@ lw_vocabulary_save (LwVocabulary *vocabulary, const gchar *FILENAME, LwIoProgres
 
     if (uri != NULL)
     {
-      stream = fopen (uri, "w");
+      //The snapshot is swapped in whole so a crash never leaves half a list behind
+      tmp = g_strjoin (NULL, uri, LW_VOCABULARY_SNAPSHOT_SUFFIX, NULL);
+      stream = g_fopen (tmp, "wb");
       if (stream != NULL)
       {
-        for (iter = vocabulary->items; iter != NULL; iter = iter->next)
+        for (j = 0; j < vocabulary->items->len; j++)
         {
-          word = LW_WORD (iter->data);
+          word = LW_WORD (g_ptr_array_index (vocabulary->items, j));
           if (word != NULL)
           {
-            for (i = 0; i < TOTAL_LW_WORD_FIELDS - 1 && feof (stream) == 0; i++)
+            g_string_truncate (line, 0);
+            for (i = 0; i < TOTAL_LW_WORD_FIELDS - 1; i++)
             {
               if (word->fields[i] != NULL)
               {
-                fputs(word->fields[i], stream);
-                fputc(';', stream);
+                g_string_append (line, word->fields[i]);
+                g_string_append_c (line, ';');
               }
             }
-            if (word->fields[i] != NULL) fputs(word->fields[i], stream);
-            fputc('\n', stream);
+            if (word->fields[i] != NULL) g_string_append (line, word->fields[i]);
+            g_string_append_c (line, '\n');
+
+            fputs(line->str, stream);
+            g_checksum_update (checksum, (guchar*) line->str, line->len);
           }
         }
-        fclose(stream);
+        written = (ferror (stream) == 0);
+        if (fclose (stream) != 0) written = FALSE;
       }
+
+#ifdef G_OS_WIN32
+      if (written) g_remove (uri);
+#endif
+      if (written) written = (g_rename (tmp, uri) == 0);
+      if (!written) g_remove (tmp);
+
+      //The snapshot now holds everything the journal did
+      if (written && is_list)
+      {
+        lw_vocabulary_close_journal (vocabulary);
+        journal = lw_vocabulary_build_journal_filename (vocabulary);
+        if (journal != NULL) g_remove (journal);
+        g_free (journal);
+        if (vocabulary->checksum != NULL) g_free (vocabulary->checksum);
+        vocabulary->checksum = g_strdup (g_checksum_get_string (checksum));
+        vocabulary->journal_length = 0;
+      }
+
+      g_free (tmp);
       g_free (uri);
     }
+
+    g_string_free (line, TRUE);
+    g_checksum_free (checksum);
 }
 
+
+//!
+//! @brief Appends a change to the journal of a list instead of rewriting the whole file
+//!
+//! The change is applied to the items too.  Guess and timestamp updates take
+//! the counts and hours of WORD, word edits and insertions take all of its
+//! fields and removals ignore it.  The journal is compacted into a new
+//! snapshot by lw_vocabulary_save.
+//!
+//! @param vocabulary The LwVocabulary to change.  It must have been loaded or saved
+//! @param record The kind of change
+//! @param position The position of the word in the list
+//! @param word The new values for the word
+//! @param error A GError to write errors to or NULL
+//! @returns FALSE if the change couldn't be journaled.  The list should then be saved whole.
+//!
+gboolean
+lw_vocabulary_journal (LwVocabulary         *vocabulary,
+                       LwVocabularyRecord    record,
+                       gint                  position,
+                       LwWord               *word,
+                       GError              **error)
+{
+    //Sanity checks
+    g_return_val_if_fail (vocabulary != NULL, FALSE);
+    g_return_val_if_fail (word != NULL || record == LW_VOCABULARY_RECORD_REMOVE, FALSE);
+    if (error != NULL && *error != NULL) return FALSE;
+
+    //Declarations
+    GQuark quark;
+    gchar *uri;
+    gchar *text;
+    gboolean written;
+    gint last;
+
+    //Initializations
+    quark = g_quark_from_string (LW_IO_ERROR);
+    if (vocabulary->checksum == NULL)
+    {
+      g_set_error (error, quark, LW_IO_WRITE_ERROR, "The vocabulary list %s has no snapshot to journal against", vocabulary->name);
+      return FALSE;
+    }
+    last = vocabulary->items->len - 1;
+    if (record == LW_VOCABULARY_RECORD_INSERT) last++;
+    if (position < 0 || position > last)
+    {
+      g_set_error (error, quark, LW_IO_WRITE_ERROR, "Position %d is not in the vocabulary list %s", position, vocabulary->name);
+      return FALSE;
+    }
+
+    if (vocabulary->journal == NULL)
+    {
+      uri = lw_vocabulary_build_journal_filename (vocabulary);
+      if (uri != NULL) vocabulary->journal = g_fopen (uri, "ab");
+      if (vocabulary->journal != NULL && fseek (vocabulary->journal, 0, SEEK_END) == 0 && ftell (vocabulary->journal) == 0)
+      {
+        fprintf (vocabulary->journal, "#%s\n", vocabulary->checksum);
+      }
+      g_free (uri);
+      if (vocabulary->journal == NULL)
+      {
+        g_set_error (error, quark, LW_IO_WRITE_ERROR, "Can't open the journal of the vocabulary list %s", vocabulary->name);
+        return FALSE;
+      }
+    }
+
+    //Records are single lines so a crash can at most cut off the last one
+    if (record == LW_VOCABULARY_RECORD_REMOVE)
+      text = g_strdup ("");
+    else
+      text = lw_word_to_string (word);
+    fprintf (vocabulary->journal, "%c;%d;%s\n", (gchar) record, position, text);
+    written = (fflush (vocabulary->journal) == 0 && ferror (vocabulary->journal) == 0);
+    g_free (text);
+
+    if (!written)
+    {
+      lw_vocabulary_close_journal (vocabulary);
+      g_set_error (error, quark, LW_IO_WRITE_ERROR, "Can't write to the journal of the vocabulary list %s", vocabulary->name);
+      return FALSE;
+    }
+    vocabulary->journal_length++;
+
+    if (record == LW_VOCABULARY_RECORD_INSERT)
+    {
+      text = lw_word_to_string (word);
+      word = lw_word_new_from_string (text);
+      g_free (text);
+    }
+    lw_vocabulary_apply (vocabulary, record, position, word);
+
+    return TRUE;
+}
+
+
+//!
+//! @brief Checks if the journal of a list has grown big enough that it should be compacted
+//!        into a new snapshot with lw_vocabulary_save
+//! @param vocabulary The LwVocabulary to check
+//!
+gboolean
+lw_vocabulary_journal_is_full (LwVocabulary *vocabulary)
+{
+    //Sanity checks
+    g_return_val_if_fail (vocabulary != NULL, FALSE);
+
+    if (vocabulary->journal_length < LW_VOCABULARY_MIN_JOURNAL_LENGTH) return FALSE;
+
+    return ((guint) vocabulary->journal_length >= vocabulary->items->len);
+}
+
+
 void
 lw_vocabulary_set_name (LwVocabulary *vocabulary, const gchar *name)
 {
@@ -208,7 +660,7 @@ lw_vocabulary_get_name (LwVocabulary *vocabulary)
     return vocabulary->name;
 }
 
-GList *
+GPtrArray*
 lw_vocabulary_get_items (LwVocabulary *vocabulary)
 {
     return vocabulary->items;
@@ -29,10 +29,28 @@
 #endif
 
 #include <locale.h>
+#include <string.h>
 
 #include <libwaei/gettext.h>
 #include <libwaei/libwaei.h>
 
+//!
+//! @brief Replaces a field of a word, freeing the old text unless it is
+//!        borrowed from the arena of a vocabulary list
+//! @param word The LwWord to change
+//! @param field The field to replace
+//! @param text Newly allocated text the word takes ownership of
+//!
+static void
+lw_word_set_field (LwWord *word, LwWordField field, gchar *text)
+{
+    if (word->fields[field] != NULL && !(word->borrowed & LW_WORD_BORROWED_FIELD (field)))
+      g_free (word->fields[field]);
+    word->fields[field] = text;
+    word->borrowed &= ~LW_WORD_BORROWED_FIELD (field);
+}
+
+
 const gchar* 
 lw_word_get_kanji (LwWord *word)
 {
@@ -42,9 +60,7 @@ lw_word_get_kanji (LwWord *word)
 void 
 lw_word_set_kanji (LwWord *word, const gchar *text)
 {
-  if (word->fields[LW_WORD_FIELD_KANJI] != NULL)
-    g_free (word->fields[LW_WORD_FIELD_KANJI]);
-  word->fields[LW_WORD_FIELD_KANJI] = g_strdup (text);
+  lw_word_set_field (word, LW_WORD_FIELD_KANJI, g_strdup (text));
 }
 
 const gchar* 
@@ -56,9 +72,7 @@ lw_word_get_furigana (LwWord *word)
 void 
 lw_word_set_furigana (LwWord *word, const gchar *text)
 {
-  if (word->fields[LW_WORD_FIELD_FURIGANA] != NULL)
-    g_free (word->fields[LW_WORD_FIELD_FURIGANA]);
-  word->fields[LW_WORD_FIELD_FURIGANA] = g_strdup (text);
+  lw_word_set_field (word, LW_WORD_FIELD_FURIGANA, g_strdup (text));
 }
 
 const gchar* 
@@ -70,9 +84,7 @@ lw_word_get_definitions (LwWord *word)
 void 
 lw_word_set_definitions (LwWord *word, const gchar *text)
 {
-  if (word->fields[LW_WORD_FIELD_DEFINITIONS] != NULL)
-    g_free (word->fields[LW_WORD_FIELD_DEFINITIONS]);
-  word->fields[LW_WORD_FIELD_DEFINITIONS] = g_strdup (text);
+  lw_word_set_field (word, LW_WORD_FIELD_DEFINITIONS, g_strdup (text));
 }
 
 gint 
@@ -84,9 +96,7 @@ lw_word_get_correct_guesses (LwWord *word)
 void 
 lw_word_set_correct_guesses (LwWord *word, gint number)
 {
-  if (word->fields[LW_WORD_FIELD_CORRECT_GUESSES] != NULL)
-    g_free (word->fields[LW_WORD_FIELD_CORRECT_GUESSES]);
-  word->fields[LW_WORD_FIELD_CORRECT_GUESSES] = g_strdup_printf ("%d", number);
+  lw_word_set_field (word, LW_WORD_FIELD_CORRECT_GUESSES, g_strdup_printf ("%d", number));
   word->correct_guesses = number;
   if (word->score != NULL) g_free (word->score); word->score = NULL;
 }
@@ -100,9 +110,7 @@ lw_word_get_incorrect_guesses (LwWord *word)
 void 
 lw_word_set_incorrect_guesses (LwWord *word, gint number)
 {
-  if (word->fields[LW_WORD_FIELD_INCORRECT_GUESSES] != NULL)
-    g_free (word->fields[LW_WORD_FIELD_INCORRECT_GUESSES]);
-  word->fields[LW_WORD_FIELD_INCORRECT_GUESSES] = g_strdup_printf ("%d", number);
+  lw_word_set_field (word, LW_WORD_FIELD_INCORRECT_GUESSES, g_strdup_printf ("%d", number));
   word->incorrect_guesses = number;
   if (word->score != NULL) g_free (word->score); word->score = NULL;
 }
@@ -165,10 +173,7 @@ lw_word_set_hours (LwWord *word, guint32 hours)
     word->timestamp = hours;
 
     if (word->days != NULL) g_free (word->days); word->days = NULL;
-    if (word->fields[LW_WORD_FIELD_TIMESTAMP] != NULL)
-      g_free (word->fields[LW_WORD_FIELD_TIMESTAMP]);
-
-    word->fields[LW_WORD_FIELD_TIMESTAMP] = g_strdup_printf ("%" G_GUINT32_FORMAT, word->timestamp);
+    lw_word_set_field (word, LW_WORD_FIELD_TIMESTAMP, g_strdup_printf ("%" G_GUINT32_FORMAT, word->timestamp));
 }
 
 
@@ -199,6 +204,67 @@ lw_word_get_timestamp_as_string (LwWord *word)
 }
 
 
+//!
+//! @brief Gets the ease factor the review interval of a word grows by
+//! @param word The LwWord to get the ease of
+//! @returns The ease in thousandths, so 2500 is an ease of 2.5
+//!
+gint
+lw_word_get_ease (LwWord *word)
+{
+    if (word->ease < LW_WORD_MIN_EASE) return LW_WORD_DEFAULT_EASE;
+    return word->ease;
+}
+
+
+//!
+//! @brief Sets the ease factor of a word.  It never drops below
+//!        LW_WORD_MIN_EASE, but 0 marks the word as unreviewed again.
+//! @param word The LwWord to change
+//! @param ease The ease in thousandths
+//!
+void
+lw_word_set_ease (LwWord *word, gint ease)
+{
+    if (ease != 0 && ease < LW_WORD_MIN_EASE) ease = LW_WORD_MIN_EASE;
+    word->ease = ease;
+
+    lw_word_set_field (word, LW_WORD_FIELD_EASE, g_strdup_printf ("%d", word->ease));
+}
+
+
+gint
+lw_word_get_interval (LwWord *word)
+{
+    return word->interval;
+}
+
+
+void
+lw_word_set_interval (LwWord *word, gint days)
+{
+    if (days < 0) days = 0;
+    word->interval = days;
+
+    lw_word_set_field (word, LW_WORD_FIELD_INTERVAL, g_strdup_printf ("%d", word->interval));
+}
+
+
+//!
+//! @brief Gets when a word should next be reviewed.  Words that were never
+//!        studied are due right away and words from lists older than the
+//!        scheduler are due from when they were last studied.
+//! @param word The LwWord to check
+//! @returns The due time in hours since the epoch like lw_word_get_hours
+//!
+guint32
+lw_word_get_due_hours (LwWord *word)
+{
+    if (word->timestamp == 0) return 0;
+    return (guint32) word->timestamp + (guint32) word->interval * 24;
+}
+
+
 LwWord*
 lw_word_new ()
 {
@@ -244,6 +310,10 @@ lw_word_new_from_string (const gchar *text)
         word->incorrect_guesses =  (gint) g_ascii_strtoll (ptr, &endptr, 10);
         ptr = word->fields[LW_WORD_FIELD_TIMESTAMP];
         word->timestamp =  (guint32) g_ascii_strtoll (ptr, &endptr, 10);
+        ptr = word->fields[LW_WORD_FIELD_EASE];
+        word->ease =  (gint) g_ascii_strtoll (ptr, &endptr, 10);
+        ptr = word->fields[LW_WORD_FIELD_INTERVAL];
+        word->interval =  (gint) g_ascii_strtoll (ptr, &endptr, 10);
       }
       g_strfreev (atoms); atoms = NULL;
     }
@@ -252,23 +322,68 @@ lw_word_new_from_string (const gchar *text)
 }
 
 
+//!
+//! @brief Splits a line of a vocabulary list into the fields of a word
+//!        without copying them.  The line is cut up in place and the fields
+//!        point into it, so it has to outlive the word.
+//! @param word A zeroed LwWord to fill
+//! @param text The line to parse.  It is modified.
+//!
+void
+lw_word_parse_in_place (LwWord *word, gchar *text)
+{
+    //Declarations
+    gchar *ptr;
+    gchar *endptr;
+    gint i;
+
+    //Initializations
+    ptr = text;
+
+    //Same splitting as g_strsplit with TOTAL_LW_WORD_FIELDS tokens
+    for (i = 0; i < TOTAL_LW_WORD_FIELDS && ptr != NULL; i++)
+    {
+      word->fields[i] = ptr;
+      if (i < TOTAL_LW_WORD_FIELDS - 1 && (ptr = strchr (ptr, ';')) != NULL) *(ptr++) = '\0';
+      else ptr = NULL;
+      g_strstrip (word->fields[i]);
+    }
+    for (; i < TOTAL_LW_WORD_FIELDS; i++)
+    {
+      word->fields[i] = (gchar*) "";
+    }
+    for (i = 0; i < TOTAL_LW_WORD_FIELDS; i++)
+    {
+      word->borrowed |= LW_WORD_BORROWED_FIELD (i);
+    }
+
+    //Set up the integers
+    word->correct_guesses = (gint) g_ascii_strtoll (word->fields[LW_WORD_FIELD_CORRECT_GUESSES], &endptr, 10);
+    word->incorrect_guesses = (gint) g_ascii_strtoll (word->fields[LW_WORD_FIELD_INCORRECT_GUESSES], &endptr, 10);
+    word->timestamp = (guint32) g_ascii_strtoll (word->fields[LW_WORD_FIELD_TIMESTAMP], &endptr, 10);
+    word->ease = (gint) g_ascii_strtoll (word->fields[LW_WORD_FIELD_EASE], &endptr, 10);
+    word->interval = (gint) g_ascii_strtoll (word->fields[LW_WORD_FIELD_INTERVAL], &endptr, 10);
+}
+
+
 void
 lw_word_free (LwWord *word)
 {
   gint i;
   for (i = 0; i < TOTAL_LW_WORD_FIELDS; i++)
   {
-    if (word->fields[i] != NULL)
+    if (word->fields[i] != NULL && !(word->borrowed & LW_WORD_BORROWED_FIELD (i)))
     {
       g_free (word->fields[i]);
-      word->fields[i] = NULL;
     }
+    word->fields[i] = NULL;
   }
 
   g_free (word->score); word->score = NULL;
   g_free (word->days); word->days = NULL;
 
-  g_free (word);
+  //Words loaded in bulk live in a block owned by their list
+  if (!(word->borrowed & LW_WORD_BORROWED_RECORD)) g_free (word);
 }
 
 
@@ -157,12 +157,16 @@ w_application_parse_args (WApplication *application, int *argc, char** argv[])
     );
     GOptionEntry entries[] = {
       { "exact", 'e', 0, G_OPTION_ARG_NONE, &(priv->arg_exact_switch), gettext("Do not display less relevant results"), NULL },
+      { "fuzzy", 'f', 0, G_OPTION_ARG_NONE, &(priv->arg_fuzzy_switch), gettext("Also search for the words closest to mistyped romaji or English"), NULL },
+      { "word", 'w', 0, G_OPTION_ARG_NONE, &(priv->arg_word_switch), gettext("Show the example sentences a word is used in"), NULL },
       { "quiet", 'q', 0, G_OPTION_ARG_NONE, &(priv->arg_quiet_switch), gettext("Display less information"), NULL },
       { "color", 'c', 0, G_OPTION_ARG_NONE, &(priv->arg_color_switch), gettext("Display results with color"), NULL },
       { "dictionary", 'd', 0, G_OPTION_ARG_STRING, &(priv->arg_dictionary_switch_data), gettext("Search using a chosen dictionary"), NULL },
       { "list", 'l', 0, G_OPTION_ARG_NONE, &(priv->arg_list_switch), gettext("Show available dictionaries for searches"), NULL },
       { "install", 'i', 0, G_OPTION_ARG_STRING, &(priv->arg_install_switch_data), gettext("Install dictionary"), NULL },
       { "uninstall", 'u', 0, G_OPTION_ARG_STRING, &(priv->arg_uninstall_switch_data), gettext("Uninstall dictionary"), NULL },
+      { "batch", 'b', 0, G_OPTION_ARG_STRING, &(priv->arg_batch_switch_data), gettext("Search for every line of a word list with a single pass over the dictionary"), NULL },
+      { "annotate", 'a', 0, G_OPTION_ARG_STRING, &(priv->arg_annotate_switch_data), gettext("Look up every word of a Japanese text file"), NULL },
       { "version", 'v', 0, G_OPTION_ARG_NONE, &(priv->arg_version_switch), gettext("Check the waei version information"), NULL },
       { NULL }
     };
@@ -326,6 +330,14 @@ w_application_run (WApplication *application, int *argc, char **argv[])
     else if (priv->arg_uninstall_switch_data != NULL)
       resolution = w_console_uninstall_dictionary (application, &error);
 
+    //User wants to search for every word of a word list
+    else if (priv->arg_batch_switch_data != NULL)
+      resolution = w_console_search_batch (application, &error);
+
+    //User wants to look up the words of a text file
+    else if (priv->arg_annotate_switch_data != NULL)
+      resolution = w_console_annotate (application, &error);
+
     //User wants to do a search
     else if (priv->arg_query_text_data != NULL)
       resolution = w_console_search (application, &error);
@@ -366,6 +378,24 @@ w_application_get_exact_switch (WApplication *application)
 }
 
 
+gboolean
+w_application_get_fuzzy_switch (WApplication *application)
+{
+  WApplicationPrivate *priv;
+  priv = application->priv;
+  return priv->arg_fuzzy_switch;
+}
+
+
+gboolean
+w_application_get_word_switch (WApplication *application)
+{
+  WApplicationPrivate *priv;
+  priv = application->priv;
+  return priv->arg_word_switch;
+}
+
+
 gboolean
 w_application_get_list_switch (WApplication *application)
 {
@@ -420,6 +450,24 @@ w_application_get_uninstall_switch_data (WApplication *application)
 }
 
 
+const gchar*
+w_application_get_batch_switch_data (WApplication *application)
+{
+  WApplicationPrivate *priv;
+  priv = application->priv;
+  return priv->arg_batch_switch_data;
+}
+
+
+const gchar*
+w_application_get_annotate_switch_data (WApplication *application)
+{
+  WApplicationPrivate *priv;
+  priv = application->priv;
+  return priv->arg_annotate_switch_data;
+}
+
+
 const gchar*
 w_application_get_query_text_data (WApplication *application)
 {
@@ -80,6 +80,8 @@ w_console_append_edict_result (WApplication *application, LwSearch *search)
 {
     //Definitions
     LwResult *result;
+    LwResultVariant *variant;
+    GList *link;
     gboolean color_switch;
     gint cont;
 
@@ -116,6 +118,17 @@ w_console_append_edict_result (WApplication *application, LwSearch *search)
       else
         printf(" %s", "P");
     }
+    //Entries with the same definitions grouped under this one
+    for (link = result->variants; link != NULL; link = link->next)
+    {
+      variant = LW_RESULTVARIANT (link->data);
+      if (color_switch)
+        printf("[0m / [32m%s[0m", (variant->kanji_start != NULL) ? variant->kanji_start : "");
+      else
+        printf(" / %s", (variant->kanji_start != NULL) ? variant->kanji_start : "");
+      if (variant->furigana_start)
+        printf(" [%s]", variant->furigana_start);
+    }
 
     printf("\n");
     while (cont < result->def_total)
@@ -283,6 +296,56 @@ w_console_append_unknowndict_result (WApplication *application, LwSearch *search
 }
 
 
+//!
+//! @brief Prints a word of an annotated text followed by its dictionary lines
+//! @param annotator The LwAnnotator that found the word
+//! @param WORD The word as it is written in the text
+//! @param FORM The headword the word was found as
+//! @param hits The offsets of the dictionary lines of the headword
+//! @param application The WApplication with the output switches
+//!
+void 
+w_console_append_annotation (LwAnnotator *annotator, const gchar *WORD, const gchar *FORM, GArray *hits, WApplication *application)
+{
+    //Declarations
+    LwResult *result;
+    gboolean color_switch;
+    guint i;
+    gint j;
+
+    //Initializations
+    color_switch = w_application_get_color_switch (application);
+
+    if (color_switch)
+      printf("[32m%s[0m", WORD);
+    else
+      printf("%s", WORD);
+    if (strcmp (WORD, FORM) != 0)
+      printf(" (%s)", FORM);
+    printf("\n");
+
+    for (i = 0; i < hits->len; i++)
+    {
+      result = lw_annotator_get_result (annotator, g_array_index (hits, glong, i));
+      if (result == NULL) continue;
+
+      printf("      %s", (result->kanji_start != NULL) ? result->kanji_start : "");
+      if (result->furigana_start)
+        printf(" [%s]", result->furigana_start);
+      for (j = 0; j < result->def_total; j++)
+      {
+        if (color_switch)
+          printf(" [35m%s[0m %s", result->number[j], result->def_start[j]);
+        else
+          printf(" %s %s", result->number[j], result->def_start[j]);
+      }
+      printf("\n");
+
+      lw_result_free (result);
+    }
+}
+
+
 //!
 //! @brief Print the "no result" message where necessary.
 //!
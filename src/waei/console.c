@@ -283,12 +283,15 @@ w_console_search (WApplication *application, GError **error)
     const gchar* query_text_data;
     gboolean quiet_switch;
     gboolean exact_switch;
+    gboolean fuzzy_switch;
+    gboolean word_switch;
     gint total_results;
     gint total_relevant_results;
 
     char *message_total;
     char *message_relevant;
     LwDictionary *dictionary;
+    LwFuzzyIndex *index;
     gint resolution;
     GMainLoop *loop;
     LwSearchFlags flags;
@@ -300,9 +303,13 @@ w_console_search (WApplication *application, GError **error)
     query_text_data = w_application_get_query_text_data (application);
     quiet_switch = w_application_get_quiet_switch (application);
     exact_switch = w_application_get_exact_switch (application);
+    fuzzy_switch = w_application_get_fuzzy_switch (application);
+    word_switch = w_application_get_word_switch (application);
     flags = 0;
 
     if (exact_switch) flags = flags | LW_SEARCH_FLAG_EXACT;
+    if (fuzzy_switch) flags = flags | LW_SEARCH_FLAG_FUZZY;
+    if (word_switch) flags = flags | LW_SEARCH_FLAG_WORD;
     resolution = 0;
 
     dictionary = lw_dictionarylist_get_dictionary_fuzzy (dictionarylist, dictionary_switch_data);
@@ -313,6 +320,22 @@ w_console_search (WApplication *application, GError **error)
       return resolution;
     }
 
+    //Only the sentences of the Examples dictionary are indexed by word.  Its
+    //index is built by lw_search_new if it has to be.
+    if (word_switch && !LW_IS_EXAMPLEDICTIONARY (dictionary))
+    {
+      resolution = 1;
+      fprintf (stderr, gettext("Only the Examples dictionary can show the sentences a word is used in.\n"));
+      return resolution;
+    }
+
+    //A search only uses the fuzzy index once it is loaded so wait for it here
+    if (fuzzy_switch)
+    {
+      index = lw_fuzzyindex_get_for_dictionary (dictionary);
+      if (index != NULL) lw_fuzzyindex_unref (index); index = NULL;
+    }
+
     search = lw_search_new (dictionary, query_text_data, flags, error);
     if (search == NULL)
     {
@@ -368,3 +391,157 @@ w_console_search (WApplication *application, GError **error)
 
     return 0;
 }
+
+
+//!
+//! @brief Searches for every line of a word list, reading the dictionary
+//!        once for all of them instead of once for each
+//! @param application The WApplication with the path of the word list
+//! @param error A GError to place errors into or NULL
+//! @returns The exit status of the program
+//!
+gint
+w_console_search_batch (WApplication *application, GError **error)
+{
+    //Sanity check
+    if (error != NULL && *error != NULL) return 1;
+
+    //Declarations
+    LwDictionaryList *dictionarylist;
+    LwDictionary *dictionary;
+    LwSearchBatch *batch;
+    LwSearch *search;
+    LwSearchFlags flags;
+    const gchar *dictionary_switch_data;
+    const gchar *batch_switch_data;
+    gboolean quiet_switch;
+    gchar *contents;
+    gchar **lines;
+    gchar *message_total;
+    gint total_results;
+    gint resolution;
+    guint i;
+
+    //Initializations
+    dictionarylist = w_application_get_installed_dictionarylist (application);
+    dictionary_switch_data = w_application_get_dictionary_switch_data (application);
+    batch_switch_data = w_application_get_batch_switch_data (application);
+    quiet_switch = w_application_get_quiet_switch (application);
+    flags = 0;
+    if (w_application_get_exact_switch (application)) flags = flags | LW_SEARCH_FLAG_EXACT;
+    contents = NULL;
+    lines = NULL;
+    batch = NULL;
+    resolution = 1;
+
+    dictionary = lw_dictionarylist_get_dictionary_fuzzy (dictionarylist, dictionary_switch_data);
+    if (dictionary == NULL)
+    {
+      fprintf (stderr, gettext("\"%s\" Dictionary was not found!\n"), dictionary_switch_data);
+      goto errored;
+    }
+
+    if (!g_file_get_contents (batch_switch_data, &contents, NULL, error)) goto errored;
+    lines = g_strsplit (contents, "\n", -1);
+    batch = lw_searchbatch_new (dictionary);
+
+    for (i = 0; lines[i] != NULL; i++)
+    {
+      g_strstrip (lines[i]);
+      if (*lines[i] == '\0') continue;
+      search = lw_search_new (dictionary, lines[i], flags, error);
+      if (search == NULL) goto errored;
+      lw_searchbatch_add (batch, search);
+    }
+
+    //Every search is finished when this returns
+    lw_searchbatch_start (batch, FALSE);
+
+    for (i = 0; i < lw_searchbatch_length (batch); i++)
+    {
+      search = lw_searchbatch_get (batch, i);
+
+      if (!quiet_switch)
+      {
+        printf(gettext("Searching for \"%s\" in %s Dictionary...\n"), lw_query_get_text (search->query), lw_dictionary_get_name (dictionary));
+        printf("\n");
+      }
+
+      while (lw_search_has_results (search))
+      {
+        w_console_append_result (application, search);
+      }
+      w_console_no_result (application, search);
+
+      if (!quiet_switch)
+      {
+        total_results = lw_search_get_total_results (search);
+        message_total = ngettext("Found %d result", "Found %d results", total_results);
+        printf(message_total, total_results);
+        printf("\n\n");
+      }
+    }
+
+    resolution = 0;
+
+errored:
+    //Cleanup
+    for (i = 0; batch != NULL && i < lw_searchbatch_length (batch); i++)
+    {
+      lw_search_free (lw_searchbatch_get (batch, i));
+    }
+    if (batch != NULL) lw_searchbatch_free (batch); batch = NULL;
+    if (lines != NULL) g_strfreev (lines); lines = NULL;
+    if (contents != NULL) g_free (contents); contents = NULL;
+
+    return resolution;
+}
+
+
+//!
+//! @brief Looks up every word of a text file in an EDICT style dictionary,
+//!        printing the dictionary lines of each word as it is found
+//! @param application The WApplication with the path of the file
+//! @param error A GError to place errors into or NULL
+//! @returns The exit status of the program
+//!
+gint
+w_console_annotate (WApplication *application, GError **error)
+{
+    //Declarations
+    LwDictionaryList *dictionarylist;
+    LwDictionary *dictionary;
+    LwAnnotator *annotator;
+    const gchar *dictionary_switch_data;
+    const gchar *annotate_switch_data;
+    gint resolution;
+
+    //Initializations
+    dictionarylist = w_application_get_installed_dictionarylist (application);
+    dictionary_switch_data = w_application_get_dictionary_switch_data (application);
+    annotate_switch_data = w_application_get_annotate_switch_data (application);
+    resolution = 0;
+
+    dictionary = lw_dictionarylist_get_dictionary_fuzzy (dictionarylist, dictionary_switch_data);
+    if (dictionary == NULL)
+    {
+      fprintf (stderr, gettext("\"%s\" Dictionary was not found!\n"), dictionary_switch_data);
+      return 1;
+    }
+    if (!LW_IS_EDICTIONARY (dictionary))
+    {
+      fprintf (stderr, gettext("Only word dictionaries like English can be used to annotate text.\n"));
+      return 1;
+    }
+
+    annotator = lw_annotator_new_for_dictionary (dictionary, error);
+    if (annotator == NULL) return 1;
+
+    if (!lw_annotator_annotate_file (annotator, annotate_switch_data, LW_ANNOTATOR_FUNC (w_console_append_annotation), application, NULL, error))
+      resolution = 1;
+
+    //Cleanup
+    lw_annotator_free (annotator); annotator = NULL;
+
+    return resolution;
+}
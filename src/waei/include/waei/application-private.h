@@ -13,6 +13,8 @@ struct _WApplicationPrivate {
 
   gboolean arg_quiet_switch;
   gboolean arg_exact_switch;
+  gboolean arg_fuzzy_switch;
+  gboolean arg_word_switch;
   gboolean arg_list_switch;
   gboolean arg_version_switch;
   gboolean arg_color_switch;
@@ -20,6 +22,8 @@ struct _WApplicationPrivate {
   gchar* arg_dictionary_switch_data;
   gchar* arg_install_switch_data;
   gchar* arg_uninstall_switch_data;
+  gchar* arg_batch_switch_data;
+  gchar* arg_annotate_switch_data;
   gchar* arg_query_text_data;
 
   GOptionContext *context;
@@ -40,12 +40,16 @@ LwDictionaryList* w_application_get_installable_dictionarylist (WApplication*);
 
 gboolean w_application_get_quiet_switch (WApplication*);
 gboolean w_application_get_exact_switch (WApplication*);
+gboolean w_application_get_fuzzy_switch (WApplication*);
+gboolean w_application_get_word_switch (WApplication*);
 gboolean w_application_get_list_switch (WApplication*);
 gboolean w_application_get_version_switch (WApplication*);
 gboolean w_application_get_color_switch (WApplication*);
 const gchar* w_application_get_dictionary_switch_data (WApplication*);
 const gchar* w_application_get_install_switch_data (WApplication*);
 const gchar* w_application_get_uninstall_switch_data (WApplication*);
+const gchar* w_application_get_batch_switch_data (WApplication*);
+const gchar* w_application_get_annotate_switch_data (WApplication*);
 const gchar* w_application_get_query_text_data (WApplication*);
 
 G_END_DECLS
@@ -3,5 +3,6 @@
 
 void w_console_append_result (WApplication*, LwSearch*);
 void w_console_no_result (WApplication*, LwSearch*);
+void w_console_append_annotation (LwAnnotator*, const gchar*, const gchar*, GArray*, WApplication*);
 
 #endif
@@ -10,6 +10,8 @@ void w_console_print_installable_dictionaries (WApplication*);
 int w_console_install_dictionary (WApplication*, GError**);
 int w_console_uninstall_dictionary (WApplication*, GError**);
 int w_console_search (WApplication*, GError**);
+int w_console_search_batch (WApplication*, GError**);
+int w_console_annotate (WApplication*, GError**);
 
 #include "console-output.h"
 #include "console-callbacks.h"